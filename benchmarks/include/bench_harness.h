@@ -0,0 +1,326 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <daw/benchmark.h>
+#include <daw/daw_move.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace daw::bench {
+	enum class output_format { text, csv, json };
+
+	struct bench_options {
+		std::size_t warmup = 2;
+		std::size_t trials = 15;
+		/// Items per benchmark where the benchmark lets it vary
+		std::size_t size = 1'000'000;
+		/// Scheduler sizes each benchmark is repeated for
+		std::vector<std::size_t> thread_counts{
+		  std::max( std::thread::hardware_concurrency( ), 1U ) };
+		output_format format = output_format::text;
+		/// Only run benchmarks whose name contains this
+		std::string filter{ };
+		/// Write results here instead of to std::cout
+		std::string output{ };
+	};
+
+	/// Thread counts 1, 2, 4... up to and including max_threads
+	[[nodiscard]] inline std::vector<std::size_t>
+	thread_sweep( std::size_t max_threads ) {
+		auto result = std::vector<std::size_t>( );
+		for( std::size_t n = 1; n < max_threads; n *= 2U ) {
+			result.push_back( n );
+		}
+		result.push_back( max_threads );
+		return result;
+	}
+
+	/// Parse --warmup=N --trials=N --size=N --threads=N[,N...]
+	/// --format=text|csv|json --filter=STR --output=PATH over defaults.
+	/// Throws std::invalid_argument on anything else
+	[[nodiscard]] inline bench_options
+	parse_options( int argc, char **argv, bench_options result = { } ) {
+		auto const to_size = []( std::string const &value ) {
+			auto pos = std::size_t{ 0 };
+			auto const n = std::stoull( value, &pos );
+			if( pos != value.size( ) ) {
+				throw std::invalid_argument( "Expected a number, got " + value );
+			}
+			return static_cast<std::size_t>( n );
+		};
+		for( int n = 1; n < argc; ++n ) {
+			auto const arg = std::string( argv[n] );
+			auto const eq = arg.find( '=' );
+			auto const key = arg.substr( 0, eq );
+			auto const value =
+			  eq == std::string::npos ? std::string( ) : arg.substr( eq + 1 );
+			if( key == "--warmup" ) {
+				result.warmup = to_size( value );
+			} else if( key == "--trials" ) {
+				result.trials = std::max( to_size( value ), std::size_t{ 1 } );
+			} else if( key == "--size" ) {
+				result.size = to_size( value );
+			} else if( key == "--threads" ) {
+				result.thread_counts.clear( );
+				auto first = std::size_t{ 0 };
+				while( first <= value.size( ) ) {
+					auto const last = std::min( value.find( ',', first ), value.size( ) );
+					result.thread_counts.push_back(
+					  std::max( to_size( value.substr( first, last - first ) ),
+					            std::size_t{ 1 } ) );
+					first = last + 1U;
+				}
+			} else if( key == "--format" and value == "text" ) {
+				result.format = output_format::text;
+			} else if( key == "--format" and value == "csv" ) {
+				result.format = output_format::csv;
+			} else if( key == "--format" and value == "json" ) {
+				result.format = output_format::json;
+			} else if( key == "--filter" ) {
+				result.filter = value;
+			} else if( key == "--output" ) {
+				result.output = value;
+			} else {
+				throw std::invalid_argument( "Unknown option " + arg );
+			}
+		}
+		return result;
+	}
+
+	/// parse_options, printing usage and exiting on bad arguments
+	[[nodiscard]] inline bench_options
+	options_from_command_line( int argc, char **argv,
+	                           bench_options defaults = { } ) {
+		try {
+			return parse_options( argc, argv, daw::move( defaults ) );
+		} catch( std::exception const &ex ) {
+			std::cerr << ex.what( ) << "\nusage: " << argv[0]
+			          << " [--warmup=N] [--trials=N] [--size=N]"
+			             " [--threads=N[,N...]] [--format=text|csv|json]"
+			             " [--filter=STR] [--output=PATH]\n";
+			std::exit( EXIT_FAILURE );
+		}
+	}
+
+	/// The timings of one benchmark at one thread count
+	struct bench_result {
+		std::string name;
+		std::size_t threads = 1;
+		std::size_t items = 1;
+		/// Bytes read or written per trial, 0 when that means nothing
+		std::size_t bytes = 0;
+		/// Sorted, one per trial
+		std::vector<double> seconds{ };
+
+		[[nodiscard]] inline double median( ) const {
+			auto const mid = seconds.size( ) / 2U;
+			if( seconds.size( ) % 2U == 0U ) {
+				return ( seconds[mid - 1U] + seconds[mid] ) / 2.0;
+			}
+			return seconds[mid];
+		}
+
+		/// Nearest rank, so with fewer than 100 trials this is the slowest
+		[[nodiscard]] inline double p99( ) const {
+			auto const rank = ( seconds.size( ) * 99U + 99U ) / 100U;
+			return seconds[rank - 1U];
+		}
+
+		[[nodiscard]] inline double mean( ) const {
+			return std::accumulate( seconds.begin( ), seconds.end( ), 0.0 ) /
+			       static_cast<double>( seconds.size( ) );
+		}
+
+		[[nodiscard]] inline double median_per_item( ) const {
+			return median( ) / static_cast<double>( items );
+		}
+
+		[[nodiscard]] inline double items_per_second( ) const {
+			return static_cast<double>( items ) / median( );
+		}
+	};
+
+	/// Runs benchmarks with warmup and repeated trials, then writes the
+	/// results as a table, CSV or JSON
+	class bench_suite {
+		bench_options m_options;
+		std::vector<bench_result> m_results{ };
+
+		static void write_json_string( std::ostream &os, std::string const &str ) {
+			os << '"';
+			for( auto const c : str ) {
+				if( c == '"' or c == '\\' ) {
+					os << '\\';
+				}
+				os << c;
+			}
+			os << '"';
+		}
+
+		void write_text( std::ostream &os ) const {
+			os << std::left << std::setw( 40 ) << "name" << std::right
+			   << std::setw( 8 ) << "threads" << std::setw( 12 ) << "items"
+			   << std::setw( 12 ) << "median" << std::setw( 12 ) << "p99"
+			   << std::setw( 12 ) << "per item" << std::setw( 14 ) << "items/s"
+			   << '\n';
+			for( auto const &r : m_results ) {
+				os << std::left << std::setw( 40 ) << r.name << std::right
+				   << std::setw( 8 ) << r.threads << std::setw( 12 ) << r.items
+				   << std::setw( 12 ) << utility::format_seconds( r.median( ), 2 )
+				   << std::setw( 12 ) << utility::format_seconds( r.p99( ), 2 )
+				   << std::setw( 12 )
+				   << utility::format_seconds( r.median_per_item( ), 2 )
+				   << std::setw( 14 ) << std::setprecision( 0 ) << std::fixed
+				   << r.items_per_second( ) << '\n';
+			}
+		}
+
+		void write_csv( std::ostream &os ) const {
+			os << "name,threads,items,bytes,trials,median_ns,p99_ns,min_ns,max_ns,"
+			      "mean_ns,median_ns_per_item,items_per_second\n";
+			os << std::setprecision( 1 ) << std::fixed;
+			for( auto const &r : m_results ) {
+				os << r.name << ',' << r.threads << ',' << r.items << ',' << r.bytes
+				   << ',' << r.seconds.size( ) << ',' << r.median( ) * 1e9 << ','
+				   << r.p99( ) * 1e9 << ',' << r.seconds.front( ) * 1e9 << ','
+				   << r.seconds.back( ) * 1e9 << ',' << r.mean( ) * 1e9 << ','
+				   << r.median_per_item( ) * 1e9 << ',' << r.items_per_second( )
+				   << '\n';
+			}
+		}
+
+		void write_json( std::ostream &os ) const {
+			os << std::setprecision( 1 ) << std::fixed;
+			os << "{\"context\":{\"hardware_concurrency\":"
+			   << std::thread::hardware_concurrency( )
+			   << ",\"warmup\":" << m_options.warmup
+			   << ",\"trials\":" << m_options.trials << "},\n\"benchmarks\":[";
+			bool is_first = true;
+			for( auto const &r : m_results ) {
+				os << ( is_first ? "\n" : ",\n" ) << "{\"name\":";
+				is_first = false;
+				write_json_string( os, r.name );
+				os << ",\"threads\":" << r.threads << ",\"items\":" << r.items
+				   << ",\"bytes\":" << r.bytes << ",\"trials\":" << r.seconds.size( )
+				   << ",\"median_ns\":" << r.median( ) * 1e9
+				   << ",\"p99_ns\":" << r.p99( ) * 1e9
+				   << ",\"min_ns\":" << r.seconds.front( ) * 1e9
+				   << ",\"max_ns\":" << r.seconds.back( ) * 1e9
+				   << ",\"mean_ns\":" << r.mean( ) * 1e9
+				   << ",\"median_ns_per_item\":" << r.median_per_item( ) * 1e9
+				   << ",\"items_per_second\":" << r.items_per_second( ) << '}';
+			}
+			os << "\n]}\n";
+		}
+
+	public:
+		explicit bench_suite( bench_options options )
+		  : m_options( daw::move( options ) ) {}
+
+		[[nodiscard]] inline bench_options const &options( ) const {
+			return m_options;
+		}
+
+		[[nodiscard]] inline std::vector<bench_result> const &results( ) const {
+			return m_results;
+		}
+
+		[[nodiscard]] inline bool is_selected( std::string const &name ) const {
+			return name.find( m_options.filter ) != std::string::npos;
+		}
+
+		/// Time func over the configured trials.  setup runs, untimed, before
+		/// every call of func, e.g. to reshuffle data a sort has sorted
+		template<typename Setup, typename Func>
+		void run( std::string name, std::size_t threads, std::size_t items,
+		          std::size_t bytes, Setup &&setup, Func &&func ) {
+			if( not is_selected( name ) ) {
+				return;
+			}
+			for( std::size_t n = 0; n < m_options.warmup; ++n ) {
+				setup( );
+				(void)func( );
+			}
+			auto result = bench_result{ daw::move( name ), threads, items, bytes };
+			result.seconds.reserve( m_options.trials );
+			for( std::size_t n = 0; n < m_options.trials; ++n ) {
+				setup( );
+				result.seconds.push_back( daw::benchmark( func ) );
+			}
+			std::sort( result.seconds.begin( ), result.seconds.end( ) );
+			// Progress, kept off std::cout so that stays machine readable
+			std::cerr << result.name << " threads=" << threads << " median="
+			          << utility::format_seconds( result.median( ), 2 ) << '\n';
+			m_results.push_back( daw::move( result ) );
+		}
+
+		template<typename Func>
+		void run( std::string name, std::size_t threads, std::size_t items,
+		          std::size_t bytes, Func &&func ) {
+			run( daw::move( name ), threads, items, bytes, []( ) {},
+			     std::forward<Func>( func ) );
+		}
+
+		void write( std::ostream &os ) const {
+			switch( m_options.format ) {
+			case output_format::text:
+				write_text( os );
+				break;
+			case output_format::csv:
+				write_csv( os );
+				break;
+			case output_format::json:
+				write_json( os );
+				break;
+			}
+		}
+
+		/// Write to options( ).output, or std::cout when that is empty
+		void write( ) const {
+			if( m_options.output.empty( ) ) {
+				write( std::cout );
+				return;
+			}
+			auto file = std::ofstream( m_options.output );
+			if( not file ) {
+				throw std::runtime_error( "Unable to open " + m_options.output );
+			}
+			write( file );
+		}
+	};
+} // namespace daw::bench
@@ -0,0 +1,267 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+#include "daw/fs/function_stream.h"
+#include "daw/fs/future_result.h"
+#include "daw/fs/impl/daw_latch.h"
+#include "daw/fs/task_scheduler.h"
+
+#include "bench_harness.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+	using value_t = std::int64_t;
+	namespace par = daw::algorithm::parallel;
+
+	std::vector<value_t> make_data( std::size_t size ) {
+		auto result = std::vector<value_t>( size );
+		// Fixed seed so runs compare like with like
+		auto rng = std::mt19937_64( 0x5eed );
+		auto dist = std::uniform_int_distribution<value_t>( -1'000'000, 1'000'000 );
+		std::generate( result.begin( ), result.end( ),
+		               [&]( ) { return dist( rng ); } );
+		return result;
+	}
+
+	void bench_element_wise( daw::bench::bench_suite &suite,
+	                         daw::task_scheduler ts ) {
+		auto const size = suite.options( ).size;
+		auto const threads = ts.size( );
+		auto const bytes = size * sizeof( value_t );
+		auto const data = make_data( size );
+		auto out = std::vector<value_t>( size );
+
+		suite.run( "for_each", threads, size, bytes, [&]( ) {
+			par::for_each(
+			  out.begin( ), out.end( ), []( auto &&v ) { v += 1; }, ts );
+		} );
+		suite.run( "fill", threads, size, bytes, [&]( ) {
+			par::fill( out.begin( ), out.end( ), value_t{ 42 }, ts );
+		} );
+		suite.run( "transform", threads, size, 2U * bytes, [&]( ) {
+			par::transform(
+			  data.begin( ), data.end( ), out.begin( ),
+			  []( value_t v ) { return v * 3 + 1; }, ts );
+		} );
+		suite.run( "chunked_for_each", threads, size, bytes, [&]( ) {
+			par::chunked_for_each(
+			  out.begin( ), out.end( ),
+			  []( auto rng ) {
+				  for( auto &v : rng ) {
+					  v ^= 0x55;
+				  }
+			  },
+			  ts );
+		} );
+	}
+
+	void bench_reductions( daw::bench::bench_suite &suite,
+	                       daw::task_scheduler ts ) {
+		auto const size = suite.options( ).size;
+		auto const threads = ts.size( );
+		auto const bytes = size * sizeof( value_t );
+		auto const data = make_data( size );
+		auto const copy = data;
+
+		suite.run( "reduce", threads, size, bytes, [&]( ) {
+			daw::do_not_optimize(
+			  par::reduce( data.begin( ), data.end( ), value_t{ 0 }, ts ) );
+		} );
+		suite.run( "map_reduce", threads, size, bytes, [&]( ) {
+			daw::do_not_optimize( par::map_reduce(
+			  data.begin( ), data.end( ), []( value_t v ) { return v * v; },
+			  std::plus<>{ }, ts ) );
+		} );
+		suite.run( "min_element", threads, size, bytes, [&]( ) {
+			daw::do_not_optimize(
+			  par::min_element( data.begin( ), data.end( ), ts ) );
+		} );
+		suite.run( "max_element", threads, size, bytes, [&]( ) {
+			daw::do_not_optimize(
+			  par::max_element( data.begin( ), data.end( ), ts ) );
+		} );
+		suite.run( "count_if", threads, size, bytes, [&]( ) {
+			daw::do_not_optimize( par::count_if(
+			  data.begin( ), data.end( ), []( value_t v ) { return v > 0; }, ts ) );
+		} );
+		// Searches for a value that is not there, so every item is visited
+		suite.run( "find_if", threads, size, bytes, [&]( ) {
+			daw::do_not_optimize( par::find_if(
+			  data.begin( ), data.end( ),
+			  []( value_t v ) { return v > 1'000'000; }, ts ) );
+		} );
+		suite.run( "equal", threads, size, 2U * bytes, [&]( ) {
+			daw::do_not_optimize( par::equal( data.begin( ), data.end( ),
+			                                  copy.begin( ), copy.end( ), ts ) );
+		} );
+	}
+
+	void bench_scans( daw::bench::bench_suite &suite, daw::task_scheduler ts ) {
+		auto const size = suite.options( ).size;
+		auto const threads = ts.size( );
+		auto const bytes = 2U * size * sizeof( value_t );
+		auto const data = make_data( size );
+		auto out = std::vector<value_t>( size );
+		auto flags = std::vector<bool>( size );
+		for( std::size_t n = 0; n < size; n += 1000U ) {
+			flags[n] = true;
+		}
+
+		suite.run( "scan", threads, size, bytes, [&]( ) {
+			par::scan( data.begin( ), data.end( ), out.begin( ), out.end( ),
+			           std::plus<>{ }, ts );
+		} );
+		suite.run( "exclusive_scan", threads, size, bytes, [&]( ) {
+			par::exclusive_scan( data.begin( ), data.end( ), out.begin( ),
+			                     out.end( ), value_t{ 0 }, std::plus<>{ }, ts );
+		} );
+		suite.run( "segmented_scan", threads, size, bytes, [&]( ) {
+			par::segmented_scan( data.begin( ), data.end( ), flags.begin( ),
+			                     out.begin( ), out.end( ), std::plus<>{ }, ts );
+		} );
+	}
+
+	void bench_sorts( daw::bench::bench_suite &suite, daw::task_scheduler ts ) {
+		auto const size = suite.options( ).size;
+		auto const threads = ts.size( );
+		auto const bytes = size * sizeof( value_t );
+		auto const data = make_data( size );
+		auto work = std::vector<value_t>( size );
+		auto const reset = [&]( ) {
+			std::copy( data.begin( ), data.end( ), work.begin( ) );
+		};
+
+		suite.run( "sort", threads, size, bytes, reset,
+		           [&]( ) { par::sort( work.begin( ), work.end( ), ts ); } );
+		suite.run( "stable_sort", threads, size, bytes, reset,
+		           [&]( ) { par::stable_sort( work.begin( ), work.end( ), ts ); } );
+		suite.run( "radix_sort", threads, size, bytes, reset,
+		           [&]( ) { par::radix_sort( work.begin( ), work.end( ), ts ); } );
+	}
+
+	/// The cost of getting small tasks through the scheduler and run
+	void bench_scheduler( daw::bench::bench_suite &suite,
+	                      daw::task_scheduler ts ) {
+		constexpr std::size_t TASKS = 10'000U;
+		suite.run( "scheduler/schedule_task", ts.size( ), TASKS, 0, [&]( ) {
+			auto sem = daw::shared_latch( TASKS );
+			for( std::size_t n = 0; n < TASKS; ++n ) {
+				if( not daw::schedule_task( sem, []( ) {}, ts ) ) {
+					std::terminate( );
+				}
+			}
+			ts.wait_for( sem );
+		} );
+		suite.run( "scheduler/add_tasks", ts.size( ), TASKS, 0, [&]( ) {
+			auto tasks = std::vector<std::function<void( )>>( TASKS, []( ) {} );
+			auto sem = daw::shared_latch( TASKS );
+			if( not ts.add_tasks( daw::move( tasks ), sem ) ) {
+				std::terminate( );
+			}
+			ts.wait_for( sem );
+		} );
+	}
+
+	/// Latency from the start of a chain of next( ) continuations to its
+	/// result
+	void bench_future_chain( daw::bench::bench_suite &suite,
+	                         daw::task_scheduler ts ) {
+		constexpr std::size_t LINKS = 16U;
+		suite.run( "future_result/next_chain", ts.size( ), LINKS, 0, [&]( ) {
+			auto const inc = []( value_t v ) { return v + 1; };
+			auto f = daw::make_future_result( ts, []( ) { return value_t{ 0 }; } )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc )
+			           .next( inc );
+			daw::do_not_optimize( f.get( ) );
+		} );
+	}
+
+	value_t stage_a( value_t v ) {
+		return v + 1;
+	}
+
+	value_t stage_b( value_t v ) {
+		return v * 2;
+	}
+
+	value_t stage_c( value_t v ) {
+		return v - 3;
+	}
+
+	/// function_stream always runs on the global scheduler
+	void bench_function_stream( daw::bench::bench_suite &suite ) {
+		constexpr std::size_t ITEMS = 1'000U;
+		static constexpr auto fs =
+		  daw::make_function_stream( &stage_a, &stage_b, &stage_c );
+		suite.run( "function_stream/throughput",
+		           daw::get_task_scheduler( ).size( ), ITEMS, 0, [&]( ) {
+			           auto results = std::vector<decltype( fs( value_t{ } ) )>( );
+			           results.reserve( ITEMS );
+			           for( std::size_t n = 0; n < ITEMS; ++n ) {
+				           results.push_back( fs( static_cast<value_t>( n ) ) );
+			           }
+			           for( auto &r : results ) {
+				           daw::do_not_optimize( r.get( ) );
+			           }
+		           } );
+	}
+} // namespace
+
+int main( int argc, char **argv ) {
+	auto suite = daw::bench::bench_suite(
+	  daw::bench::options_from_command_line( argc, argv ) );
+	for( auto const threads : suite.options( ).thread_counts ) {
+		auto ts = daw::task_scheduler( threads );
+		bench_element_wise( suite, ts );
+		bench_reductions( suite, ts );
+		bench_scans( suite, ts );
+		bench_sorts( suite, ts );
+		bench_scheduler( suite, ts );
+		bench_future_chain( suite, ts );
+	}
+	bench_function_stream( suite );
+	suite.write( );
+}
@@ -0,0 +1,249 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/future_result.h"
+#include "daw/fs/impl/daw_latch.h"
+#include "daw/fs/message_queue.h"
+#include "daw/fs/task_scheduler.h"
+
+#include "bench_harness.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+	/// Operations timed per trial.  Results are per item, so this only has to
+	/// be large enough to hide the clock
+	constexpr std::size_t ROUNDS = 1'000U;
+
+	/// Threads started, untimed, by setup and released by run( ) so that
+	/// thread creation is not part of the measurement
+	class thread_gang {
+		daw::shared_latch m_start{ };
+		std::vector<std::thread> m_threads{ };
+
+	public:
+		template<typename Body>
+		void start( std::size_t count, Body body ) {
+			m_start = daw::shared_latch( 1 );
+			m_threads.clear( );
+			m_threads.reserve( count );
+			for( std::size_t n = 0; n < count; ++n ) {
+				m_threads.emplace_back( [start = m_start, body, n]( ) mutable {
+					start.wait( );
+					body( n );
+				} );
+			}
+		}
+
+		/// Release the threads then wait for all of them to finish
+		template<typename Body>
+		void run( Body &&also_on_this_thread ) {
+			m_start.notify( );
+			also_on_this_thread( );
+			for( auto &t : m_threads ) {
+				t.join( );
+			}
+			m_threads.clear( );
+		}
+	};
+
+	/// One task through schedule_task, a worker's run_task and back to a
+	/// waiting thread, one at a time
+	void bench_task_round_trip( daw::bench::bench_suite &suite,
+	                            daw::task_scheduler ts ) {
+		suite.run( "add_task/round_trip", ts.size( ), ROUNDS, 0, [&]( ) {
+			for( std::size_t n = 0; n < ROUNDS; ++n ) {
+				auto sem = daw::shared_latch( 1 );
+				if( not daw::schedule_task( sem, []( ) {}, ts ) ) {
+					std::terminate( );
+				}
+				sem.wait( );
+			}
+		} );
+	}
+
+	/// This thread releases a latch that threads others wait on, then waits
+	/// for all of them to answer on a second latch
+	void bench_latch_latency( daw::bench::bench_suite &suite,
+	                          std::size_t threads ) {
+		auto gang = thread_gang( );
+		auto released = std::vector<daw::shared_latch>( );
+		auto answered = std::vector<daw::shared_latch>( );
+		suite.run(
+		  "shared_latch/notify_wait", threads, ROUNDS, 0,
+		  [&]( ) {
+			  released.clear( );
+			  answered.clear( );
+			  for( std::size_t n = 0; n < ROUNDS; ++n ) {
+				  released.emplace_back( 1 );
+				  answered.emplace_back( threads );
+			  }
+			  gang.start( threads, [released, answered]( std::size_t ) mutable {
+				  for( std::size_t n = 0; n < ROUNDS; ++n ) {
+					  released[n].wait( );
+					  answered[n].notify( );
+				  }
+			  } );
+		  },
+		  [&]( ) {
+			  gang.run( [&]( ) {
+				  for( std::size_t n = 0; n < ROUNDS; ++n ) {
+					  released[n].notify( );
+					  answered[n].wait( );
+				  }
+			  } );
+		  } );
+	}
+
+	/// threads producers and threads consumers moving ITEMS values through
+	/// one queue.  A full or empty queue is retried after a yield
+	void bench_queue_throughput( daw::bench::bench_suite &suite,
+	                             std::size_t threads ) {
+		constexpr std::size_t ITEMS = 100'000U;
+		using queue_t = daw::parallel::mpmc_bounded_queue<std::size_t, 1024U>;
+		auto queue = std::make_unique<queue_t>( );
+		auto gang = thread_gang( );
+		auto consumed = std::atomic_size_t( 0ULL );
+		suite.run(
+		  "mpmc_bounded_queue/push_pop", threads, ITEMS, 0,
+		  [&]( ) {
+			  consumed = 0;
+			  gang.start( 2U * threads, [&, threads]( std::size_t id ) {
+				  if( id < threads ) {
+					  for( std::size_t n = id; n < ITEMS; n += threads ) {
+						  auto value = std::make_unique<std::size_t>( n );
+						  while( queue->try_push_back( daw::move( value ) ) ==
+						         daw::parallel::push_back_result::failed ) {
+							  std::this_thread::yield( );
+						  }
+					  }
+					  return;
+				  }
+				  while( consumed.load( std::memory_order_relaxed ) < ITEMS ) {
+					  if( auto value = queue->try_pop_front( ); value ) {
+						  daw::do_not_optimize( *value );
+						  consumed.fetch_add( 1U, std::memory_order_relaxed );
+					  } else {
+						  std::this_thread::yield( );
+					  }
+				  }
+			  } );
+		  },
+		  [&]( ) { gang.run( []( ) {} ); } );
+	}
+
+	/// As bench_queue_throughput through an mpmc_channel of values, moved in
+	/// batches of 16 with waiting instead of retrying
+	void bench_channel_throughput( daw::bench::bench_suite &suite,
+	                               std::size_t threads ) {
+		constexpr std::size_t ITEMS = 100'000U;
+		constexpr std::size_t BATCH = 16U;
+		using channel_t = daw::parallel::mpmc_channel<std::size_t>;
+		auto channel = std::unique_ptr<channel_t>( );
+		auto gang = thread_gang( );
+		auto consumed = std::atomic_size_t( 0ULL );
+		suite.run(
+		  "mpmc_channel/push_pop_n", threads, ITEMS, 0,
+		  [&]( ) {
+			  consumed = 0;
+			  channel = std::make_unique<channel_t>( 1024U );
+			  gang.start( 2U * threads, [&, threads]( std::size_t id ) {
+				  auto items = std::array<std::size_t, BATCH>{ };
+				  if( id < threads ) {
+					  for( std::size_t n = id * BATCH; n < ITEMS;
+					       n += threads * BATCH ) {
+						  auto const count = std::min( BATCH, ITEMS - n );
+						  for( std::size_t i = 0; i < count; ++i ) {
+							  items[i] = n + i;
+						  }
+						  (void)channel->push_n( items.begin( ), count );
+					  }
+					  return;
+				  }
+				  while( auto const n = channel->pop_n( items.begin( ), BATCH ) ) {
+					  daw::do_not_optimize( items );
+					  if( consumed.fetch_add( n, std::memory_order_relaxed ) + n ==
+					      ITEMS ) {
+						  channel->close( );
+					  }
+				  }
+			  } );
+		  },
+		  [&]( ) { gang.run( []( ) {} ); } );
+	}
+
+	void bench_future_create_get( daw::bench::bench_suite &suite,
+	                              daw::task_scheduler ts ) {
+		suite.run( "future_result/create_get", ts.size( ), ROUNDS, 0, [&]( ) {
+			for( std::size_t n = 0; n < ROUNDS; ++n ) {
+				daw::do_not_optimize(
+				  daw::make_future_result( ts, [n]( ) { return n; } ).get( ) );
+			}
+		} );
+	}
+
+	/// Called from a worker, where each call starts and stops a temporary
+	/// runner
+	void bench_wait_for_scope( daw::bench::bench_suite &suite,
+	                           daw::task_scheduler ts ) {
+		suite.run( "wait_for_scope", ts.size( ), ROUNDS, 0, [&]( ) {
+			auto sem = daw::shared_latch( 1 );
+			auto body = [ts]( ) mutable {
+				for( std::size_t n = 0; n < ROUNDS; ++n ) {
+					daw::do_not_optimize( ts.wait_for_scope( [n]( ) { return n; } ) );
+				}
+			};
+			if( not daw::schedule_task( sem, daw::move( body ), ts ) ) {
+				std::terminate( );
+			}
+			sem.wait( );
+		} );
+	}
+} // namespace
+
+int main( int argc, char **argv ) {
+	auto defaults = daw::bench::bench_options( );
+	defaults.thread_counts = daw::bench::thread_sweep(
+	  std::max( std::thread::hardware_concurrency( ), 1U ) );
+	auto suite = daw::bench::bench_suite(
+	  daw::bench::options_from_command_line( argc, argv, defaults ) );
+	for( auto const threads : suite.options( ).thread_counts ) {
+		auto ts = daw::task_scheduler( threads );
+		bench_task_round_trip( suite, ts );
+		bench_future_create_get( suite, ts );
+		bench_wait_for_scope( suite, ts );
+		bench_latch_latency( suite, threads );
+		bench_queue_throughput( suite, threads );
+		bench_channel_throughput( suite, threads );
+	}
+	suite.write( );
+}
@@ -23,10 +23,14 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
 
 #include <daw/daw_sort_n.h>
 #include <daw/daw_view.h>
 
+#include "cancellation.h"
 #include "impl/algorithms_impl.h"
 #include "impl/concept_checks.h"
 
@@ -34,7 +38,8 @@ namespace daw::algorithm::parallel {
 	template<typename RandomIterator, typename UnaryOperation>
 	void for_each( RandomIterator first, RandomIterator last,
 	               UnaryOperation unary_op,
-	               task_scheduler ts = get_task_scheduler( ) ) {
+	               task_scheduler ts = get_task_scheduler( ),
+	               cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		static_assert(
@@ -45,12 +50,39 @@ namespace daw::algorithm::parallel {
 
 		impl::parallel_for_each( daw::view( first, last ),
 		                         ::daw::traits::lift_func( unary_op ),
-		                         daw::move( ts ) );
+		                         daw::move( ts ), hint );
+	}
+
+	/// As for_each, skipping the remaining items once tok is cancelled
+	/// @throws operation_cancelled_exception when tok was cancelled
+	template<typename RandomIterator, typename UnaryOperation>
+	void for_each( RandomIterator first, RandomIterator last,
+	               UnaryOperation unary_op, cancellation_token const &tok,
+	               task_scheduler ts = get_task_scheduler( ),
+	               cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<UnaryOperation, RandomIterator>,
+		  "UnaryOperation passed to for_each must accept the value referenced "
+		  "by first. e.g "
+		  "unary_op( *first ) must be valid" );
+
+		impl::parallel_for_each(
+		  daw::view( first, last ),
+		  [&tok, op = ::daw::traits::lift_func( unary_op )]( auto &&value ) {
+			  if( not tok.is_cancelled( ) ) {
+				  op( DAW_FWD( value ) );
+			  }
+		  },
+		  daw::move( ts ), hint );
+		tok.throw_if_cancelled( );
 	}
 
 	template<typename RandomIterator, typename UnaryOperation>
 	void for_each_n( RandomIterator first, size_t N, UnaryOperation unary_op,
-	                 task_scheduler ts = get_task_scheduler( ) ) {
+	                 task_scheduler ts = get_task_scheduler( ),
+	                 cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		static_assert(
@@ -60,15 +92,16 @@ namespace daw::algorithm::parallel {
 		  "unary_op( *first ) must be valid" );
 
 		auto const last = ::std::next( first, static_cast<intmax_t>( N ) );
-		impl::parallel_for_each( daw__view( first, last ),
+		impl::parallel_for_each( daw::view( first, last ),
 		                         ::daw::traits::lift_func( unary_op ),
-		                         daw::move( ts ) );
+		                         daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename UnaryOperation>
 	void for_each_index( RandomIterator first, RandomIterator last,
 	                     UnaryOperation indexed_op,
-	                     task_scheduler ts = get_task_scheduler( ) ) {
+	                     task_scheduler ts = get_task_scheduler( ),
+	                     cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		static_assert( traits::is_callable_v<UnaryOperation, size_t>,
@@ -76,23 +109,42 @@ namespace daw::algorithm::parallel {
 		               "for_each_index must a size_t argument "
 		               "unary_op( (size_t)5 ) must be valid" );
 
-		impl::parallel_for_each_index( daw::view( first, last ),
+		impl::parallel_for_each_index( first, last,
 		                               ::daw::traits::lift_func( indexed_op ),
-		                               daw::move( ts ) );
+		                               daw::move( ts ), hint );
+	}
+
+	/// Call func( tile_bounds<N> const & ) for every tile of tile_shape in the
+	/// N dimensional index space, tiles at its edges being cut to fit.  Tiles
+	/// are scheduled in order, so that workers take runs of neighbouring ones.
+	/// cache_tile_shape gives a shape that fits the L2 cache
+	template<std::size_t N, typename Function>
+	void for_each_tile( extents<N> const &space, extents<N> const &tile_shape,
+	                    Function &&func, tile_order order = tile_order::morton,
+	                    task_scheduler ts = get_task_scheduler( ) ) {
+
+		static_assert( std::is_invocable_v<Function, tile_bounds<N> const &>,
+		               "Function passed to for_each_tile must accept the "
+		               "bounds of a tile. e.g. func( tile_bounds<N>{ } ) must be "
+		               "valid" );
+		impl::parallel_for_each_tile(
+		  space, tile_shape,
+		  ::daw::traits::lift_func( ::std::forward<Function>( func ) ), order,
+		  daw::move( ts ) );
 	}
 
 	template<typename RandomIterator, typename T>
 	void fill( RandomIterator first, RandomIterator last, T const &value,
-	           task_scheduler ts = get_task_scheduler( ) ) {
+	           task_scheduler ts = get_task_scheduler( ),
+	           cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		static_assert( traits::is_assignable_iterator_v<RandomIterator, T>,
 		               "T value must be assignable to the "
 		               "dereferenced RandomIterator first. "
 		               "e.g. *first = value is valid" );
-		impl::parallel_for_each(
-		  daw::view( first, last ), [&value]( auto &item ) { item = value; },
-		  daw::move( ts ) );
+		impl::parallel_fill( daw::view( first, last ), value, daw::move( ts ),
+		                     hint );
 	}
 
 	template<typename RandomIterator, typename Compare = ::std::less<>>
@@ -124,10 +176,154 @@ namespace daw::algorithm::parallel {
 		  daw::move( ts ) );
 	}
 
+	/// Sort using scratch as merge space instead of allocating it.  scratch
+	/// must hold at least std::distance( first, last ) items
+	template<typename RandomIterator, typename ScratchIterator,
+	         typename Compare = ::std::less<>>
+	void sort( RandomIterator first, RandomIterator last,
+	           daw::view<ScratchIterator> scratch,
+	           task_scheduler ts = get_task_scheduler( ),
+	           Compare &&comp = Compare{} ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		traits::is_random_access_iterator_test<ScratchIterator>( );
+		concept_checks::is_binary_predicate_test<Compare, RandomIterator,
+		                                         RandomIterator>( );
+		daw::exception::precondition_check(
+		  scratch.size( ) >= static_cast<size_t>( std::distance( first, last ) ),
+		  "Scratch buffer must be at least as large as the range" );
+
+		impl::parallel_sort(
+		  daw::view( first, last ), scratch.begin( ), impl::sorter{},
+		  ::daw::traits::lift_func( ::std::forward<Compare>( comp ) ),
+		  daw::move( ts ) );
+	}
+
+	/// Stable sort using scratch as merge space instead of allocating it.
+	/// scratch must hold at least std::distance( first, last ) items
+	template<typename RandomIterator, typename ScratchIterator,
+	         typename Compare = ::std::less<>>
+	void stable_sort( RandomIterator first, RandomIterator last,
+	                  daw::view<ScratchIterator> scratch,
+	                  task_scheduler ts = get_task_scheduler( ),
+	                  Compare &&comp = Compare{} ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		traits::is_random_access_iterator_test<ScratchIterator>( );
+		concept_checks::is_binary_predicate_test<Compare, RandomIterator,
+		                                         RandomIterator>( );
+		daw::exception::precondition_check(
+		  scratch.size( ) >= static_cast<size_t>( std::distance( first, last ) ),
+		  "Scratch buffer must be at least as large as the range" );
+
+		impl::parallel_sort(
+		  daw::view( first, last ), scratch.begin( ), impl::stable_sorter{},
+		  ::daw::traits::lift_func( ::std::forward<Compare>( comp ) ),
+		  daw::move( ts ) );
+	}
+
+	/// Rearrange the range so *nth is the item a sort would put there, with
+	/// no item after it ordered before it and none before it ordered after it.
+	/// Parallel quickselect, each round partitions around the median of a
+	/// sample like stable_partition does
+	template<typename RandomIterator, typename Compare = ::std::less<>>
+	void nth_element( RandomIterator first, RandomIterator nth,
+	                  RandomIterator last,
+	                  task_scheduler ts = get_task_scheduler( ),
+	                  Compare &&comp = Compare{} ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_binary_predicate_test<Compare, RandomIterator,
+		                                         RandomIterator>( );
+		impl::parallel_nth_element(
+		  daw::view( first, last ), nth,
+		  ::daw::traits::lift_func( ::std::forward<Compare>( comp ) ),
+		  daw::move( ts ) );
+	}
+
+	/// Sort the items that belong in [first, middle), leaving the others in
+	/// [middle, last) in no particular order.  nth_element at middle followed
+	/// by a sort of the front
+	template<typename RandomIterator, typename Compare = ::std::less<>>
+	void partial_sort( RandomIterator first, RandomIterator middle,
+	                   RandomIterator last,
+	                   task_scheduler ts = get_task_scheduler( ),
+	                   Compare &&comp = Compare{} ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_binary_predicate_test<Compare, RandomIterator,
+		                                         RandomIterator>( );
+		auto cmp = ::daw::traits::lift_func( ::std::forward<Compare>( comp ) );
+		impl::parallel_nth_element( daw::view( first, last ), middle, cmp, ts );
+		impl::parallel_sort( daw::view( first, middle ), impl::sorter{ }, cmp,
+		                     daw::move( ts ) );
+	}
+
+	/// Copies of the k first items of the range in the order of comp, sorted.
+	/// Each part of the range keeps a heap of its k best, the heaps are merged
+	/// at the end, so the range is left untouched
+	template<typename RandomIterator, typename Compare = ::std::less<>>
+	[[nodiscard]] auto top_k( RandomIterator first, RandomIterator last,
+	                          size_t k, task_scheduler ts = get_task_scheduler( ),
+	                          Compare &&comp = Compare{} ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_binary_predicate_test<Compare, RandomIterator,
+		                                         RandomIterator>( );
+		return impl::parallel_top_k(
+		  daw::view( first, last ), k,
+		  ::daw::traits::lift_func( ::std::forward<Compare>( comp ) ),
+		  daw::move( ts ) );
+	}
+
+	/// Stable LSD radix sort by key( *first ), which must be integral or
+	/// floating point.  For floating point keys -0.0 sorts before 0.0
+	template<typename RandomIterator,
+	         typename KeyFunction = impl::radix_identity_key>
+	void radix_sort( RandomIterator first, RandomIterator last,
+	                 task_scheduler ts = get_task_scheduler( ),
+	                 KeyFunction key = KeyFunction{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<KeyFunction, RandomIterator>,
+		  "KeyFunction passed to radix_sort must accept the value referenced "
+		  "by first. e.g key( *first ) must be valid" );
+
+		impl::parallel_radix_sort( daw::view( first, last ),
+		                           ::daw::traits::lift_func( daw::move( key ) ),
+		                           daw::move( ts ) );
+	}
+
+	/// Radix sort using scratch as the space items are moved to between
+	/// passes.  scratch must hold at least std::distance( first, last ) items
+	template<typename RandomIterator, typename ScratchIterator,
+	         typename KeyFunction = impl::radix_identity_key>
+	void radix_sort( RandomIterator first, RandomIterator last,
+	                 daw::view<ScratchIterator> scratch,
+	                 task_scheduler ts = get_task_scheduler( ),
+	                 KeyFunction key = KeyFunction{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		traits::is_random_access_iterator_test<ScratchIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<KeyFunction, RandomIterator>,
+		  "KeyFunction passed to radix_sort must accept the value referenced "
+		  "by first. e.g key( *first ) must be valid" );
+		daw::exception::precondition_check(
+		  scratch.size( ) >= static_cast<size_t>( std::distance( first, last ) ),
+		  "Scratch buffer must be at least as large as the range" );
+
+		impl::parallel_radix_sort( daw::view( first, last ), scratch.begin( ),
+		                           ::daw::traits::lift_func( daw::move( key ) ),
+		                           daw::move( ts ) );
+	}
+
 	template<typename T, typename RandomIterator, typename BinaryOperation>
 	[[nodiscard]] T reduce( RandomIterator first, RandomIterator last, T init,
 	                        BinaryOperation &&binary_op,
-	                        task_scheduler ts = get_task_scheduler( ) ) {
+	                        task_scheduler ts = get_task_scheduler( ),
+	                        cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		static_assert(
@@ -152,35 +348,74 @@ namespace daw::algorithm::parallel {
 		return impl::parallel_reduce(
 		  daw::view( first, last ), daw::move( init ),
 		  ::daw::traits::lift_func( ::std::forward<BinaryOperation>( binary_op ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
 	}
 
 	template<typename T, typename RandomIterator>
 	[[nodiscard]] T reduce( RandomIterator first, RandomIterator last, T init,
-	                        task_scheduler ts = get_task_scheduler( ) ) {
+	                        task_scheduler ts = get_task_scheduler( ),
+	                        cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
-		return ::daw::algorithm::parallel::reduce(
-		  first, last, daw::move( init ), ::std::plus<>{}, daw::move( ts ) );
+		return ::daw::algorithm::parallel::reduce( first, last, daw::move( init ),
+		                                           ::std::plus<>{}, daw::move( ts ),
+		                                           hint );
+	}
+
+	/// As reduce, in the block order of opts so that the result does not
+	/// depend on ts.  See deterministic
+	template<typename T, typename RandomIterator, typename BinaryOperation>
+	[[nodiscard]] T reduce( RandomIterator first, RandomIterator last, T init,
+	                        BinaryOperation &&binary_op, deterministic opts,
+	                        task_scheduler ts = get_task_scheduler( ),
+	                        cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<BinaryOperation, RandomIterator,
+		                                RandomIterator>,
+		  "BinaryOperation passed to reduce must take two values referenced by "
+		  "first. e.g binary_op( *first, *(first+1) ) must be valid" );
+
+		return static_cast<T>( impl::parallel_deterministic_reduce(
+		  daw::view( first, last ), daw::move( init ),
+		  []( auto const &value ) -> decltype( auto ) { return value; },
+		  ::daw::traits::lift_func( ::std::forward<BinaryOperation>( binary_op ) ),
+		  opts, daw::move( ts ), hint ) );
+	}
+
+	/// As reduce with std::plus, see deterministic
+	template<typename T, typename RandomIterator>
+	[[nodiscard]] T reduce( RandomIterator first, RandomIterator last, T init,
+	                        deterministic opts,
+	                        task_scheduler ts = get_task_scheduler( ),
+	                        cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		return ::daw::algorithm::parallel::reduce( first, last, daw::move( init ),
+		                                           ::std::plus<>{}, opts,
+		                                           daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator>
 	[[nodiscard]] decltype( auto )
 	reduce( RandomIterator first, RandomIterator last,
-	        task_scheduler ts = get_task_scheduler( ) ) {
+	        task_scheduler ts = get_task_scheduler( ),
+	        cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		using value_type =
 		  typename ::std::iterator_traits<RandomIterator>::value_type;
-		return ::daw::algorithm::parallel::reduce( daw::view( first, last ),
-		                                           value_type{}, daw::move( ts ) );
+		return ::daw::algorithm::parallel::reduce(
+		  first, last, value_type{}, daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename Compare = ::std::less<>>
 	[[nodiscard]] decltype( auto )
 	min_element( RandomIterator first, RandomIterator last,
 	             task_scheduler ts = get_task_scheduler( ),
-	             Compare &&comp = Compare{} ) {
+	             Compare &&comp = Compare{},
+	             cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		traits::is_input_iterator_test<RandomIterator>( );
@@ -190,14 +425,15 @@ namespace daw::algorithm::parallel {
 		return impl::parallel_min_element(
 		  daw::view( first, last ),
 		  ::daw::traits::lift_func( ::std::forward<Compare>( comp ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename Compare = ::std::less<>>
 	[[nodiscard]] decltype( auto )
 	max_element( RandomIterator first, RandomIterator const last,
 	             task_scheduler ts = get_task_scheduler( ),
-	             Compare comp = Compare{} ) {
+	             Compare comp = Compare{},
+	             cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		concept_checks::is_binary_predicate_test<Compare, RandomIterator,
@@ -206,14 +442,15 @@ namespace daw::algorithm::parallel {
 		return impl::parallel_max_element(
 		  daw::view( first, last ),
 		  ::daw::traits::lift_func( ::std::forward<Compare>( comp ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename RandomOutputIterator,
 	         typename UnaryOperation>
 	void transform( RandomIterator first, RandomIterator const last,
 	                RandomOutputIterator first_out, UnaryOperation &&unary_op,
-	                task_scheduler ts = get_task_scheduler( ) ) {
+	                task_scheduler ts = get_task_scheduler( ),
+	                cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		static_assert(
@@ -233,7 +470,7 @@ namespace daw::algorithm::parallel {
 		impl::parallel_map(
 		  daw::view( first, last ), first_out,
 		  ::daw::traits::lift_func( ::std::forward<UnaryOperation>( unary_op ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator1, typename RandomIterator2,
@@ -241,7 +478,8 @@ namespace daw::algorithm::parallel {
 	void transform( RandomIterator1 first1, RandomIterator1 const last1,
 	                RandomIterator2 first2, RandomOutputIterator first_out,
 	                BinaryOperation &&binary_op,
-	                task_scheduler ts = get_task_scheduler( ) ) {
+	                task_scheduler ts = get_task_scheduler( ),
+	                cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator1>( );
 		traits::is_random_access_iterator_test<RandomIterator2>( );
@@ -266,13 +504,14 @@ namespace daw::algorithm::parallel {
 		impl::parallel_map(
 		  daw::view( first1, last1 ), first2, first_out,
 		  ::daw::traits::lift_func( ::std::forward<BinaryOperation>( binary_op ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename UnaryOperation>
 	void transform( RandomIterator first, RandomIterator last,
 	                UnaryOperation &&unary_op,
-	                task_scheduler ts = get_task_scheduler( ) ) {
+	                task_scheduler ts = get_task_scheduler( ),
+	                cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		static_assert(
@@ -292,7 +531,7 @@ namespace daw::algorithm::parallel {
 		impl::parallel_map(
 		  daw::view( first, last ), first,
 		  ::daw::traits::lift_func( ::std::forward<UnaryOperation>( unary_op ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
 	}
 
 	template<
@@ -302,7 +541,8 @@ namespace daw::algorithm::parallel {
 	[[nodiscard]] decltype( auto )
 	map_reduce( RandomIterator first, RandomIterator last,
 	            UnaryOperation &&map_function, BinaryOperation &&reduce_function,
-	            ::daw::task_scheduler ts = get_task_scheduler( ) ) {
+	            ::daw::task_scheduler ts = get_task_scheduler( ),
+	            cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		static_assert(
@@ -332,7 +572,7 @@ namespace daw::algorithm::parallel {
 		    ::std::forward<UnaryOperation>( map_function ) ),
 		  ::daw::traits::lift_func(
 		    ::std::forward<BinaryOperation>( reduce_function ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
 	}
 
 	/// @brief Perform MapReduce on range and return result
@@ -358,7 +598,8 @@ namespace daw::algorithm::parallel {
 	[[nodiscard]] decltype( auto )
 	map_reduce( RandomIterator first, RandomIterator last, T const &init,
 	            UnaryOperation &&map_function, BinaryOperation &&reduce_function,
-	            ::daw::task_scheduler ts = get_task_scheduler( ) ) {
+	            ::daw::task_scheduler ts = get_task_scheduler( ),
+	            cost_hint hint = cost_hint{ } ) {
 		/*
 		        traits::is_random_access_iterator_test<RandomIterator>( );
 		        static_assert(
@@ -384,7 +625,119 @@ namespace daw::algorithm::parallel {
 		    ::std::forward<UnaryOperation>( map_function ) ),
 		  ::daw::traits::lift_func(
 		    ::std::forward<BinaryOperation>( reduce_function ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
+	}
+
+	/// As map_reduce with an init, in the block order of opts so that the
+	/// result does not depend on ts.  See deterministic
+	template<typename RandomIterator, typename T, typename UnaryOperation,
+	         typename BinaryOperation>
+	[[nodiscard]] decltype( auto )
+	map_reduce( RandomIterator first, RandomIterator last, T const &init,
+	            UnaryOperation &&map_function, BinaryOperation &&reduce_function,
+	            deterministic opts,
+	            ::daw::task_scheduler ts = get_task_scheduler( ),
+	            cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<UnaryOperation, RandomIterator>,
+		  "UnaryOperation map_function passed to map_reduce must accept the "
+		  "value referenced by first. e.g map_function( *first ) must be valid" );
+
+		auto map_fn = ::daw::traits::lift_func(
+		  ::std::forward<UnaryOperation>( map_function ) );
+		auto mapped_init = map_fn( init );
+		return impl::parallel_deterministic_reduce(
+		  daw::view( first, last ), daw::move( mapped_init ), daw::move( map_fn ),
+		  ::daw::traits::lift_func(
+		    ::std::forward<BinaryOperation>( reduce_function ) ),
+		  opts, daw::move( ts ), hint );
+	}
+
+	/// The type of key_function( *first )
+	template<typename KeyFunction, typename RandomIterator>
+	using key_result_t =
+	  daw::remove_cvref_t<concept_checks::is_callable_t<KeyFunction,
+	                                                    RandomIterator>>;
+
+	/// @brief Reduce the items of each key separately
+	/// @param key_function maps an item to its key
+	/// @param value_function maps an item to the value reduced for its key
+	/// @param reduce_function combines two values of the same key
+	/// @return one ( key, value ) pair per distinct key, in no particular order
+	/// Every worker aggregates its part of the range into open addressing hash
+	/// tables of its own, one per split of the hash space.  Each split is then
+	/// merged by a single task, so no lock is taken for any key
+	template<typename RandomIterator, typename KeyFunction,
+	         typename ValueFunction, typename BinaryOperation,
+	         typename Hash = std::hash<key_result_t<KeyFunction, RandomIterator>>,
+	         typename KeyEqual = std::equal_to<>>
+	[[nodiscard]] auto
+	reduce_by_key( RandomIterator first, RandomIterator last,
+	               KeyFunction &&key_function, ValueFunction &&value_function,
+	               BinaryOperation &&reduce_function,
+	               task_scheduler ts = get_task_scheduler( ),
+	               cost_hint hint = cost_hint{ }, Hash const &hash = Hash{ },
+	               KeyEqual const &key_equal = KeyEqual{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<KeyFunction, RandomIterator>,
+		  "KeyFunction passed to reduce_by_key must accept the value referenced "
+		  "by first. e.g key_function( *first ) must be valid" );
+		static_assert(
+		  concept_checks::is_callable_v<ValueFunction, RandomIterator>,
+		  "ValueFunction passed to reduce_by_key must accept the value "
+		  "referenced by first. e.g value_function( *first ) must be valid" );
+
+		auto value_of = ::daw::traits::lift_func(
+		  ::std::forward<ValueFunction>( value_function ) );
+		auto reduce = ::daw::traits::lift_func(
+		  ::std::forward<BinaryOperation>( reduce_function ) );
+		return impl::parallel_aggregate_by_key(
+		  daw::view( first, last ),
+		  ::daw::traits::lift_func( ::std::forward<KeyFunction>( key_function ) ),
+		  [&value_of]( auto const &item ) { return value_of( item ); },
+		  [&]( auto &acc, auto const &item ) {
+			  acc = reduce( daw::move( acc ), value_of( item ) );
+		  },
+		  [&]( auto &acc, auto &&other ) {
+			  acc = reduce( daw::move( acc ), daw::move( other ) );
+		  },
+		  hash, key_equal, daw::move( ts ), hint );
+	}
+
+	/// @brief Collect copies of the items of each key
+	/// @return one ( key, items ) pair per distinct key_function( item ), in no
+	/// particular order.  Items of a key from the same part of the range keep
+	/// their order.  Built like reduce_by_key
+	template<typename RandomIterator, typename KeyFunction,
+	         typename Hash = std::hash<key_result_t<KeyFunction, RandomIterator>>,
+	         typename KeyEqual = std::equal_to<>>
+	[[nodiscard]] auto group_by( RandomIterator first, RandomIterator last,
+	                             KeyFunction &&key_function,
+	                             task_scheduler ts = get_task_scheduler( ),
+	                             cost_hint hint = cost_hint{ },
+	                             Hash const &hash = Hash{ },
+	                             KeyEqual const &key_equal = KeyEqual{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<KeyFunction, RandomIterator>,
+		  "KeyFunction passed to group_by must accept the value referenced "
+		  "by first. e.g key_function( *first ) must be valid" );
+
+		using value_t = typename std::iterator_traits<RandomIterator>::value_type;
+		return impl::parallel_aggregate_by_key(
+		  daw::view( first, last ),
+		  ::daw::traits::lift_func( ::std::forward<KeyFunction>( key_function ) ),
+		  []( auto const &item ) { return std::vector<value_t>{ item }; },
+		  []( auto &acc, auto const &item ) { acc.push_back( item ); },
+		  []( auto &acc, auto &&other ) {
+			  std::move( other.begin( ), other.end( ), std::back_inserter( acc ) );
+		  },
+		  hash, key_equal, daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename RandomOutputIterator,
@@ -392,7 +745,8 @@ namespace daw::algorithm::parallel {
 	void scan( RandomIterator first, RandomIterator last,
 	           RandomOutputIterator first_out, RandomOutputIterator last_out,
 	           BinaryOperation &&binary_op,
-	           task_scheduler ts = get_task_scheduler( ) ) {
+	           task_scheduler ts = get_task_scheduler( ),
+	           cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		traits::is_input_iterator_test<RandomIterator>( );
@@ -412,13 +766,39 @@ namespace daw::algorithm::parallel {
 		impl::parallel_scan(
 		  daw::view( first, last ), daw::view( first_out, last_out ),
 		  ::daw::traits::lift_func( ::std::forward<BinaryOperation>( binary_op ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
+	}
+
+	/// As scan, in the block order of opts so that the results do not depend
+	/// on ts.  See deterministic
+	template<typename RandomIterator, typename RandomOutputIterator,
+	         typename BinaryOperation>
+	void scan( RandomIterator first, RandomIterator last,
+	           RandomOutputIterator first_out, RandomOutputIterator last_out,
+	           BinaryOperation &&binary_op, deterministic opts,
+	           task_scheduler ts = get_task_scheduler( ),
+	           cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		traits::is_input_iterator_test<RandomIterator>( );
+		traits::is_random_access_iterator_test<RandomOutputIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<BinaryOperation, RandomIterator,
+		                                RandomIterator>,
+		  "BinaryOperation passed to scan must take two values referenced by "
+		  "first. e.g binary_op( *first, *(first+1) ) must be valid" );
+
+		impl::parallel_deterministic_scan(
+		  daw::view( first, last ), daw::view( first_out, last_out ),
+		  ::daw::traits::lift_func( ::std::forward<BinaryOperation>( binary_op ) ),
+		  opts, daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename BinaryOperation>
 	void scan( RandomIterator first, RandomIterator last,
 	           BinaryOperation &&binary_op,
-	           task_scheduler ts = get_task_scheduler( ) ) {
+	           task_scheduler ts = get_task_scheduler( ),
+	           cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		static_assert(
@@ -435,15 +815,101 @@ namespace daw::algorithm::parallel {
 		                    BinaryOperation, RandomIterator, RandomIterator>>( );
 
 		impl::parallel_scan(
-		  daw::view( first, last ), first, last,
+		  daw::view( first, last ), daw::view( first, last ),
 		  ::daw::traits::lift_func( ::std::forward<BinaryOperation>( binary_op ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
+	}
+
+	/// Exclusive scan, *first_out is init and every later output is the
+	/// result of binary_op over init and the inputs before it
+	template<typename RandomIterator, typename RandomOutputIterator, typename T,
+	         typename BinaryOperation>
+	void exclusive_scan( RandomIterator first, RandomIterator last,
+	                     RandomOutputIterator first_out,
+	                     RandomOutputIterator last_out, T init,
+	                     BinaryOperation &&binary_op,
+	                     task_scheduler ts = get_task_scheduler( ),
+	                     cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		traits::is_input_iterator_test<RandomIterator>( );
+		traits::is_random_access_iterator_test<RandomOutputIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<BinaryOperation, RandomIterator,
+		                                RandomIterator>,
+		  "BinaryOperation passed to exclusive_scan must take two values "
+		  "referenced by first. e.g "
+		  "binary_op( *first, *(first+1) ) must be valid" );
+
+		impl::parallel_exclusive_scan(
+		  daw::view( first, last ), daw::view( first_out, last_out ),
+		  daw::move( init ),
+		  ::daw::traits::lift_func( ::std::forward<BinaryOperation>( binary_op ) ),
+		  daw::move( ts ), hint );
+	}
+
+	/// As exclusive_scan, in the block order of opts so that the results do
+	/// not depend on ts.  See deterministic
+	template<typename RandomIterator, typename RandomOutputIterator, typename T,
+	         typename BinaryOperation>
+	void exclusive_scan( RandomIterator first, RandomIterator last,
+	                     RandomOutputIterator first_out,
+	                     RandomOutputIterator last_out, T init,
+	                     BinaryOperation &&binary_op, deterministic opts,
+	                     task_scheduler ts = get_task_scheduler( ),
+	                     cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		traits::is_input_iterator_test<RandomIterator>( );
+		traits::is_random_access_iterator_test<RandomOutputIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<BinaryOperation, RandomIterator,
+		                                RandomIterator>,
+		  "BinaryOperation passed to exclusive_scan must take two values "
+		  "referenced by first. e.g binary_op( *first, *(first+1) ) must be "
+		  "valid" );
+
+		impl::parallel_deterministic_exclusive_scan(
+		  daw::view( first, last ), daw::view( first_out, last_out ),
+		  daw::move( init ),
+		  ::daw::traits::lift_func( ::std::forward<BinaryOperation>( binary_op ) ),
+		  opts, daw::move( ts ), hint );
+	}
+
+	/// Inclusive scan that starts over at each item whose flag is true.
+	/// first_flag refers to one flag per item, convertible to bool
+	template<typename RandomIterator, typename RandomFlagIterator,
+	         typename RandomOutputIterator, typename BinaryOperation>
+	void segmented_scan( RandomIterator first, RandomIterator last,
+	                     RandomFlagIterator first_flag,
+	                     RandomOutputIterator first_out,
+	                     RandomOutputIterator last_out,
+	                     BinaryOperation &&binary_op,
+	                     task_scheduler ts = get_task_scheduler( ),
+	                     cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		traits::is_input_iterator_test<RandomIterator>( );
+		traits::is_random_access_iterator_test<RandomFlagIterator>( );
+		traits::is_random_access_iterator_test<RandomOutputIterator>( );
+		static_assert(
+		  concept_checks::is_callable_v<BinaryOperation, RandomIterator,
+		                                RandomIterator>,
+		  "BinaryOperation passed to segmented_scan must take two values "
+		  "referenced by first. e.g "
+		  "binary_op( *first, *(first+1) ) must be valid" );
+
+		impl::parallel_segmented_scan(
+		  daw::view( first, last ), first_flag, daw::view( first_out, last_out ),
+		  ::daw::traits::lift_func( ::std::forward<BinaryOperation>( binary_op ) ),
+		  daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename UnaryPredicate>
 	[[nodiscard]] RandomIterator
 	find_if( RandomIterator first, RandomIterator last, UnaryPredicate &&pred,
-	         task_scheduler ts = get_task_scheduler( ) ) {
+	         task_scheduler ts = get_task_scheduler( ),
+	         cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		concept_checks::is_unary_predicate_test<UnaryPredicate, RandomIterator>( );
@@ -451,7 +917,78 @@ namespace daw::algorithm::parallel {
 		return impl::parallel_find_if(
 		  daw::view( first, last ),
 		  ::daw::traits::lift_func( ::std::forward<UnaryPredicate>( pred ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
+	}
+
+	/// As find_if, with every part stopping early once tok is cancelled
+	/// @throws operation_cancelled_exception when tok was cancelled
+	template<typename RandomIterator, typename UnaryPredicate>
+	[[nodiscard]] RandomIterator
+	find_if( RandomIterator first, RandomIterator last, UnaryPredicate &&pred,
+	         cancellation_token const &tok,
+	         task_scheduler ts = get_task_scheduler( ),
+	         cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_unary_predicate_test<UnaryPredicate, RandomIterator>( );
+
+		// A cancelled token looks like a match, so each part returns at once
+		auto result = impl::parallel_find_if(
+		  daw::view( first, last ),
+		  [&tok, pred = ::daw::traits::lift_func(
+		           ::std::forward<UnaryPredicate>( pred ) )]( auto const &value ) {
+			  return tok.is_cancelled( ) or pred( value );
+		  },
+		  daw::move( ts ), hint );
+		tok.throw_if_cancelled( );
+		return result;
+	}
+
+	/// Is pred true for any item.  Stops every part once one finds a match
+	template<typename RandomIterator, typename UnaryPredicate>
+	[[nodiscard]] bool any_of( RandomIterator first, RandomIterator last,
+	                           UnaryPredicate &&pred,
+	                           task_scheduler ts = get_task_scheduler( ),
+	                           cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_unary_predicate_test<UnaryPredicate, RandomIterator>( );
+
+		return impl::parallel_any_of(
+		  daw::view( first, last ),
+		  ::daw::traits::lift_func( ::std::forward<UnaryPredicate>( pred ) ),
+		  daw::move( ts ), hint );
+	}
+
+	/// Is pred true for every item.  Stops every part once one finds an item
+	/// it is false for
+	template<typename RandomIterator, typename UnaryPredicate>
+	[[nodiscard]] bool all_of( RandomIterator first, RandomIterator last,
+	                           UnaryPredicate &&pred,
+	                           task_scheduler ts = get_task_scheduler( ),
+	                           cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_unary_predicate_test<UnaryPredicate, RandomIterator>( );
+
+		return not impl::parallel_any_of(
+		  daw::view( first, last ),
+		  [pred = ::daw::traits::lift_func(
+		     ::std::forward<UnaryPredicate>( pred ) )]( auto const &value ) {
+			  return not pred( value );
+		  },
+		  daw::move( ts ), hint );
+	}
+
+	/// Is pred false for every item.  Stops every part once one finds a match
+	template<typename RandomIterator, typename UnaryPredicate>
+	[[nodiscard]] bool none_of( RandomIterator first, RandomIterator last,
+	                            UnaryPredicate &&pred,
+	                            task_scheduler ts = get_task_scheduler( ),
+	                            cost_hint hint = cost_hint{ } ) {
+
+		return not any_of( first, last, ::std::forward<UnaryPredicate>( pred ),
+		                   daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator1, typename RandomIterator2,
@@ -459,7 +996,8 @@ namespace daw::algorithm::parallel {
 	[[nodiscard]] bool equal( RandomIterator1 first1, RandomIterator1 last1,
 	                          RandomIterator2 first2, RandomIterator2 last2,
 	                          BinaryPredicate &&pred,
-	                          task_scheduler ts = get_task_scheduler( ) ) {
+	                          task_scheduler ts = get_task_scheduler( ),
+	                          cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator1>( );
 		traits::is_input_iterator_test<RandomIterator1>( );
@@ -471,13 +1009,14 @@ namespace daw::algorithm::parallel {
 		return impl::parallel_equal(
 		  first1, last1, first2, last2,
 		  ::daw::traits::lift_func( ::std::forward<BinaryPredicate>( pred ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator1, typename RandomIterator2>
 	[[nodiscard]] bool equal( RandomIterator1 first1, RandomIterator1 last1,
 	                          RandomIterator2 first2, RandomIterator2 last2,
-	                          task_scheduler ts = get_task_scheduler( ) ) {
+	                          task_scheduler ts = get_task_scheduler( ),
+	                          cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator1>( );
 		traits::is_input_iterator_test<RandomIterator1>( );
@@ -486,15 +1025,143 @@ namespace daw::algorithm::parallel {
 		concept_checks::is_equality_comparable_test<RandomIterator1,
 		                                            RandomIterator2>( );
 
-		auto pred = []( auto const &lhs, auto const &rhs ) { return lhs == rhs; };
 		return impl::parallel_equal( first1, last1, first2, last2,
-		                             ::daw::move( pred ), daw::move( ts ) );
+		                             ::std::equal_to<>{ }, daw::move( ts ), hint );
+	}
+
+	/// Copy [first, last) to first_out, which must not overlap it.  Contiguous
+	/// ranges of a trivially copyable type are copied in cache sized chunks
+	/// by only as many workers as saturate the memory bandwidth, and with
+	/// streamed stores when too big for the last level cache
+	/// @return the end of the items written
+	template<typename RandomIterator, typename RandomOutputIterator>
+	RandomOutputIterator copy( RandomIterator first, RandomIterator last,
+	                           RandomOutputIterator first_out,
+	                           task_scheduler ts = get_task_scheduler( ),
+	                           cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		traits::is_input_iterator_test<RandomIterator>( );
+		traits::is_random_access_iterator_test<RandomOutputIterator>( );
+		static_assert(
+		  traits::is_assignable_iterator_v<
+		    RandomOutputIterator,
+		    typename std::iterator_traits<RandomIterator>::reference>,
+		  "The items of first must be assignable to the dereferenced "
+		  "RandomOutputIterator. e.g. *first_out = *first must be valid" );
+
+		return impl::parallel_copy( daw::view( first, last ), first_out,
+		                            daw::move( ts ), hint );
+	}
+
+	/// Copy the items for which pred is true to first_out, in order.  The
+	/// items are counted per tile, the counts scanned into offsets and each
+	/// tile written at its offset, so no lock is taken
+	/// @return the end of the items written
+	template<typename RandomIterator, typename RandomOutputIterator,
+	         typename UnaryPredicate>
+	RandomOutputIterator copy_if( RandomIterator first, RandomIterator last,
+	                              RandomOutputIterator first_out,
+	                              UnaryPredicate &&pred,
+	                              task_scheduler ts = get_task_scheduler( ),
+	                              cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		traits::is_input_iterator_test<RandomIterator>( );
+		traits::is_random_access_iterator_test<RandomOutputIterator>( );
+		concept_checks::is_unary_predicate_test<UnaryPredicate, RandomIterator>( );
+
+		return impl::parallel_copy_if(
+		  daw::view( first, last ), first_out,
+		  ::daw::traits::lift_func( ::std::forward<UnaryPredicate>( pred ) ),
+		  daw::move( ts ), hint );
+	}
+
+	/// Remove the items for which pred is true, keeping the order of the
+	/// rest.  Compacts like copy_if into a buffer that is moved back, so the
+	/// items must be default constructible
+	/// @return the new end of the range
+	template<typename RandomIterator, typename UnaryPredicate>
+	RandomIterator remove_if( RandomIterator first, RandomIterator last,
+	                          UnaryPredicate &&pred,
+	                          task_scheduler ts = get_task_scheduler( ),
+	                          cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_unary_predicate_test<UnaryPredicate, RandomIterator>( );
+
+		return impl::parallel_remove_if(
+		  daw::view( first, last ),
+		  ::daw::traits::lift_func( ::std::forward<UnaryPredicate>( pred ) ),
+		  daw::move( ts ), hint );
+	}
+
+	/// Move the items for which pred is true before the others, keeping the
+	/// order within both groups.  Items must be default constructible
+	/// @return the first item of the second group
+	template<typename RandomIterator, typename UnaryPredicate>
+	RandomIterator stable_partition( RandomIterator first, RandomIterator last,
+	                                 UnaryPredicate &&pred,
+	                                 task_scheduler ts = get_task_scheduler( ),
+	                                 cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_unary_predicate_test<UnaryPredicate, RandomIterator>( );
+
+		return impl::parallel_stable_partition(
+		  daw::view( first, last ),
+		  ::daw::traits::lift_func( ::std::forward<UnaryPredicate>( pred ) ),
+		  daw::move( ts ), hint );
+	}
+
+	/// As stable_partition, the order within the groups is kept here too
+	template<typename RandomIterator, typename UnaryPredicate>
+	RandomIterator partition( RandomIterator first, RandomIterator last,
+	                          UnaryPredicate &&pred,
+	                          task_scheduler ts = get_task_scheduler( ),
+	                          cost_hint hint = cost_hint{ } ) {
+
+		return stable_partition( first, last, std::forward<UnaryPredicate>( pred ),
+		                         daw::move( ts ), hint );
+	}
+
+	/// Remove all but the first of each run of items where pred( prev, item )
+	/// is true.  Items must be default constructible
+	/// @return the new end of the range
+	template<typename RandomIterator, typename BinaryPredicate>
+	RandomIterator unique( RandomIterator first, RandomIterator last,
+	                       BinaryPredicate &&pred,
+	                       task_scheduler ts = get_task_scheduler( ),
+	                       cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_binary_predicate_test<BinaryPredicate, RandomIterator,
+		                                         RandomIterator>( );
+
+		return impl::parallel_unique(
+		  daw::view( first, last ),
+		  ::daw::traits::lift_func( ::std::forward<BinaryPredicate>( pred ) ),
+		  daw::move( ts ), hint );
+	}
+
+	template<typename RandomIterator>
+	RandomIterator unique( RandomIterator first, RandomIterator last,
+	                       task_scheduler ts = get_task_scheduler( ),
+	                       cost_hint hint = cost_hint{ } ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		concept_checks::is_equality_comparable_test<RandomIterator,
+		                                            RandomIterator>( );
+
+		return impl::parallel_unique( daw::view( first, last ),
+		                              ::std::equal_to<>{ }, daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename UnaryPredicate>
 	[[nodiscard]] decltype( auto )
 	count_if( RandomIterator first, RandomIterator last, UnaryPredicate &&pred,
-	          task_scheduler ts = get_task_scheduler( ) ) {
+	          task_scheduler ts = get_task_scheduler( ),
+	          cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		concept_checks::is_unary_predicate_test<UnaryPredicate, RandomIterator>( );
@@ -502,25 +1169,31 @@ namespace daw::algorithm::parallel {
 		return impl::parallel_count(
 		  daw::view( first, last ),
 		  ::daw::traits::lift_func( ::std::forward<UnaryPredicate>( pred ) ),
-		  daw::move( ts ) );
+		  daw::move( ts ), hint );
 	}
 
 	template<typename RandomIterator, typename T>
 	[[nodiscard]] decltype( auto )
 	count( RandomIterator first, RandomIterator last, T const &value,
-	       task_scheduler ts = get_task_scheduler( ) ) {
+	       task_scheduler ts = get_task_scheduler( ),
+	       cost_hint hint = cost_hint{ } ) {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		traits::is_input_iterator_test<RandomIterator>( );
 
-		return impl::parallel_count(
-		  first, last, [&value]( auto const &rhs ) { return value == rhs; },
-		  daw::move( ts ) );
+		return impl::parallel_count( daw::view( first, last ),
+		                             impl::equal_to_value<T>{ value },
+		                             daw::move( ts ), hint );
 	}
 
 	template<size_t minimum_size = 1>
 	using default_range_splitter = impl::split_range_t<minimum_size>;
 
+	/// Splits ranges lazily, only when another worker could take the other
+	/// half.  Suits work where the cost per item varies a lot
+	template<size_t minimum_size = 1024>
+	using lazy_range_splitter = impl::split_lazy_t<minimum_size>;
+
 	template<typename PartitionPolicy = default_range_splitter<>,
 	         typename RandomIterator, typename Function>
 	void chunked_for_each( RandomIterator first, RandomIterator last,
@@ -529,10 +1202,32 @@ namespace daw::algorithm::parallel {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		auto ranges = PartitionPolicy{}( daw::view( first, last ), ts.size( ) );
-		impl::partition_range(
+		impl::run_partition_range(
 		  ranges, ::daw::traits::lift_func( ::std::forward<Function>( func ) ),
-		  daw::move( ts ) )
-		  .wait( );
+		  ts );
+	}
+
+	/// As chunked_for_each, dropping the chunks that have not started once tok
+	/// is cancelled.  Long running func's can poll tok themselves
+	/// @throws operation_cancelled_exception when tok was cancelled
+	template<typename PartitionPolicy = default_range_splitter<>,
+	         typename RandomIterator, typename Function>
+	void chunked_for_each( RandomIterator first, RandomIterator last,
+	                       Function &&func, cancellation_token const &tok,
+	                       task_scheduler ts = get_task_scheduler( ) ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		auto ranges = PartitionPolicy{}( daw::view( first, last ), ts.size( ) );
+		impl::run_partition_range(
+		  ranges,
+		  [&tok, func = ::daw::traits::lift_func( ::std::forward<Function>(
+		           func ) )]( daw::view<RandomIterator> rng ) mutable {
+			  if( not tok.is_cancelled( ) ) {
+				  func( rng );
+			  }
+		  },
+		  ts );
+		tok.throw_if_cancelled( );
 	}
 
 	template<typename PartitionPolicy = default_range_splitter<>,
@@ -543,9 +1238,31 @@ namespace daw::algorithm::parallel {
 
 		traits::is_random_access_iterator_test<RandomIterator>( );
 		auto ranges = PartitionPolicy{}( daw::view( first, last ), ts.size( ) );
-		impl::partition_range_pos(
+		impl::run_partition_range_pos(
 		  ranges, ::daw::traits::lift_func( ::std::forward<Function>( func ) ),
-		  ::daw::move( ts ) )
-		  .wait( );
+		  ts );
+	}
+
+	/// As chunked_for_each_pos, dropping the chunks that have not started once
+	/// tok is cancelled
+	/// @throws operation_cancelled_exception when tok was cancelled
+	template<typename PartitionPolicy = default_range_splitter<>,
+	         typename RandomIterator, typename Function>
+	void chunked_for_each_pos( RandomIterator first, RandomIterator last,
+	                           Function &&func, cancellation_token const &tok,
+	                           task_scheduler ts = get_task_scheduler( ) ) {
+
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		auto ranges = PartitionPolicy{}( daw::view( first, last ), ts.size( ) );
+		impl::run_partition_range_pos(
+		  ranges,
+		  [&tok, func = ::daw::traits::lift_func( ::std::forward<Function>(
+		           func ) )]( daw::view<RandomIterator> rng, size_t pos ) mutable {
+			  if( not tok.is_cancelled( ) ) {
+				  func( rng, pos );
+			  }
+		  },
+		  ts );
+		tok.throw_if_cancelled( );
 	}
 } // namespace daw::algorithm::parallel
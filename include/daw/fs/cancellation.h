@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <daw/daw_move.h>
+#include <daw/daw_utility.h>
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <type_traits>
+
+namespace daw {
+	/// Thrown, or stored in a future, for work that was cancelled before it
+	/// produced a result
+	struct operation_cancelled_exception : std::exception {
+		operation_cancelled_exception( ) = default;
+
+		[[nodiscard]] inline char const *what( ) const noexcept override {
+			return "Operation cancelled";
+		}
+	};
+
+	/// The observing side of a cancellation_source.  Cheap to copy and safe to
+	/// read from any thread.  A default constructed token is never cancelled
+	class cancellation_token {
+		std::shared_ptr<std::atomic_bool const> m_state{ };
+
+		explicit cancellation_token(
+		  std::shared_ptr<std::atomic_bool const> state ) noexcept
+		  : m_state( daw::move( state ) ) {}
+
+		friend class cancellation_source;
+
+	public:
+		cancellation_token( ) noexcept = default;
+
+		/// Relaxed, this is meant to be polled in loops.  Anything the canceller
+		/// wrote before cancelling is not guaranteed to be visible
+		[[nodiscard]] inline bool is_cancelled( ) const noexcept {
+			return m_state and m_state->load( std::memory_order_relaxed );
+		}
+
+		/// False for a default constructed token
+		[[nodiscard]] inline bool can_be_cancelled( ) const noexcept {
+			return static_cast<bool>( m_state );
+		}
+
+		inline void throw_if_cancelled( ) const {
+			if( is_cancelled( ) ) {
+				throw operation_cancelled_exception{ };
+			}
+		}
+	};
+
+	/// Owns a cancellation request.  Copies share it, cancelling through any
+	/// of them cancels every token from get_token( )
+	class cancellation_source {
+		std::shared_ptr<std::atomic_bool> m_state =
+		  std::make_shared<std::atomic_bool>( false );
+
+	public:
+		cancellation_source( ) = default;
+
+		[[nodiscard]] inline cancellation_token get_token( ) const noexcept {
+			return cancellation_token( m_state );
+		}
+
+		inline void request_cancel( ) noexcept {
+			m_state->store( true, std::memory_order_relaxed );
+		}
+
+		[[nodiscard]] inline bool is_cancelled( ) const noexcept {
+			return m_state->load( std::memory_order_relaxed );
+		}
+	};
+
+	/// A task that does nothing when tok is cancelled by the time it starts,
+	/// so queued work is dropped instead of run
+	template<typename Task>
+	[[nodiscard]] auto cancellable( cancellation_token tok, Task &&task ) {
+		static_assert( std::is_invocable_v<Task>,
+		               "Task passed to cancellable must be callable without an "
+		               "argument. e.g. task( )" );
+		return [tok = daw::move( tok ),
+		        task = daw::mutable_capture( DAW_FWD( task ) )]( ) {
+			if( tok.is_cancelled( ) ) {
+				return;
+			}
+			(void)( *task )( );
+		};
+	}
+} // namespace daw
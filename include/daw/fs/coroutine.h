@@ -0,0 +1,404 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#if __has_include( <coroutine> ) and defined( __cpp_impl_coroutine )
+
+#include "future_result.h"
+#include "impl/daw_latch.h"
+#include "task_scheduler.h"
+
+#include <daw/daw_exception.h>
+#include <daw/daw_move.h>
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace daw {
+	template<typename T = void>
+	class [[nodiscard]] task;
+
+	namespace impl {
+		/// State shared by the promises of coroutines that resume on a
+		/// task_scheduler.  Awaiters use it to know where to resume
+		struct scheduled_promise_base {
+			std::optional<task_scheduler> m_task_scheduler{ };
+
+			[[nodiscard]] task_scheduler &get_scheduler( ) {
+				if( not m_task_scheduler ) {
+					m_task_scheduler.emplace( get_task_scheduler( ) );
+				}
+				return *m_task_scheduler;
+			}
+		};
+
+		template<typename Promise>
+		inline constexpr bool is_scheduled_promise_v =
+		  std::is_base_of_v<scheduled_promise_base, Promise>;
+
+		/// The scheduler a coroutine resumes on, fallback when the coroutine
+		/// is not one of ours
+		template<typename Promise>
+		[[nodiscard]] task_scheduler
+		scheduler_for( std::coroutine_handle<Promise> h,
+		               task_scheduler const &fallback ) {
+			if constexpr( is_scheduled_promise_v<Promise> ) {
+				return h.promise( ).get_scheduler( );
+			} else {
+				return fallback;
+			}
+		}
+
+		/// Resume h on a worker of ts.  When ts no longer accepts tasks, h is
+		/// resumed on the calling thread so that it is never lost
+		inline void schedule_resume( task_scheduler &ts,
+		                             std::coroutine_handle<> h ) {
+			if( not ts.add_task( [h]( ) { h.resume( ); } ) ) {
+				h.resume( );
+			}
+		}
+
+		template<typename T>
+		struct task_promise_result {
+			std::optional<T> m_value{ };
+			std::exception_ptr m_exception{ };
+
+			template<typename U>
+			void return_value( U &&value ) {
+				m_value.emplace( std::forward<U>( value ) );
+			}
+
+			[[nodiscard]] T take_result( ) {
+				if( m_exception ) {
+					std::rethrow_exception( m_exception );
+				}
+				return daw::move( *m_value );
+			}
+		};
+
+		template<>
+		struct task_promise_result<void> {
+			std::exception_ptr m_exception{ };
+
+			void return_void( ) noexcept {}
+
+			void take_result( ) const {
+				if( m_exception ) {
+					std::rethrow_exception( m_exception );
+				}
+			}
+		};
+
+		template<typename T>
+		struct task_promise : scheduled_promise_base, task_promise_result<T> {
+			std::coroutine_handle<> m_continuation{ };
+
+			[[nodiscard]] task<T> get_return_object( ) noexcept;
+
+			[[nodiscard]] std::suspend_always initial_suspend( ) const noexcept {
+				return { };
+			}
+
+			/// Transfer straight to the awaiting coroutine instead of growing the
+			/// stack or going through the queues
+			struct final_awaiter {
+				[[nodiscard]] bool await_ready( ) const noexcept {
+					return false;
+				}
+
+				[[nodiscard]] std::coroutine_handle<>
+				await_suspend( std::coroutine_handle<task_promise> h ) noexcept {
+					if( auto next = h.promise( ).m_continuation; next ) {
+						return next;
+					}
+					return std::noop_coroutine( );
+				}
+
+				void await_resume( ) const noexcept {}
+			};
+
+			[[nodiscard]] final_awaiter final_suspend( ) const noexcept {
+				return { };
+			}
+
+			void unhandled_exception( ) noexcept {
+				this->m_exception = std::current_exception( );
+			}
+		};
+
+		template<typename T>
+		struct task_awaiter {
+			std::coroutine_handle<task_promise<T>> m_handle;
+
+			[[nodiscard]] bool await_ready( ) const noexcept {
+				return false;
+			}
+
+			template<typename Promise>
+			[[nodiscard]] std::coroutine_handle<>
+			await_suspend( std::coroutine_handle<Promise> awaiting ) {
+				auto &promise = m_handle.promise( );
+				promise.m_continuation = awaiting;
+				if constexpr( is_scheduled_promise_v<Promise> ) {
+					if( not promise.m_task_scheduler ) {
+						promise.m_task_scheduler.emplace(
+						  awaiting.promise( ).get_scheduler( ) );
+					}
+				}
+				return m_handle;
+			}
+
+			T await_resume( ) {
+				return m_handle.promise( ).take_result( );
+			}
+		};
+
+		/// A self destroying coroutine used to run a task from code that is not
+		/// a coroutine
+		struct detached_task {
+			struct promise_type : scheduled_promise_base {
+				[[nodiscard]] detached_task get_return_object( ) noexcept {
+					return detached_task{
+					  std::coroutine_handle<promise_type>::from_promise( *this ) };
+				}
+
+				[[nodiscard]] std::suspend_always initial_suspend( ) const noexcept {
+					return { };
+				}
+
+				[[nodiscard]] std::suspend_never final_suspend( ) const noexcept {
+					return { };
+				}
+
+				void return_void( ) noexcept {}
+
+				[[noreturn]] void unhandled_exception( ) const noexcept {
+					std::terminate( );
+				}
+			};
+
+			std::coroutine_handle<promise_type> m_handle;
+		};
+	} // namespace impl
+
+	/// A lazily started coroutine producing a T.  It runs when awaited, or when
+	/// passed to spawn_task/sync_wait, and resumes on the task_scheduler it
+	/// was started on.  Waiting inside it suspends instead of blocking a worker
+	template<typename T>
+	class [[nodiscard]] task {
+	public:
+		using promise_type = impl::task_promise<T>;
+		using value_type = T;
+
+	private:
+		std::coroutine_handle<promise_type> m_handle{ };
+
+		explicit task( std::coroutine_handle<promise_type> h ) noexcept
+		  : m_handle( h ) {}
+
+		friend promise_type;
+
+	public:
+		task( ) = default;
+
+		task( task &&other ) noexcept
+		  : m_handle( std::exchange( other.m_handle, nullptr ) ) {}
+
+		task &operator=( task &&rhs ) noexcept {
+			if( this != &rhs ) {
+				if( m_handle ) {
+					m_handle.destroy( );
+				}
+				m_handle = std::exchange( rhs.m_handle, nullptr );
+			}
+			return *this;
+		}
+
+		task( task const & ) = delete;
+		task &operator=( task const & ) = delete;
+
+		~task( ) {
+			if( m_handle ) {
+				m_handle.destroy( );
+			}
+		}
+
+		[[nodiscard]] explicit operator bool( ) const noexcept {
+			return static_cast<bool>( m_handle );
+		}
+
+		/// Start the task and resume the awaiting coroutine when it is finished.
+		/// The task inherits the scheduler of the awaiting coroutine
+		[[nodiscard]] impl::task_awaiter<T> operator co_await( ) && {
+			daw::exception::precondition_check( m_handle,
+			                                    "Cannot await an empty task" );
+			return impl::task_awaiter<T>{ m_handle };
+		}
+	};
+
+	template<typename T>
+	task<T> impl::task_promise<T>::get_return_object( ) noexcept {
+		return task<T>(
+		  std::coroutine_handle<task_promise>::from_promise( *this ) );
+	}
+
+	/// Suspend the current coroutine and resume it on a worker of ts.  Later
+	/// awaits in the coroutine resume on ts too
+	struct resume_on {
+		task_scheduler m_task_scheduler;
+
+		explicit resume_on( task_scheduler ts )
+		  : m_task_scheduler( daw::move( ts ) ) {}
+
+		[[nodiscard]] bool await_ready( ) const noexcept {
+			return false;
+		}
+
+		template<typename Promise>
+		[[nodiscard]] bool await_suspend( std::coroutine_handle<Promise> h ) {
+			// Once the task is added h may already be running and this awaiter gone
+			auto ts = m_task_scheduler;
+			if constexpr( impl::is_scheduled_promise_v<Promise> ) {
+				h.promise( ).m_task_scheduler = ts;
+			}
+			return ts.add_task( [h]( ) { h.resume( ); } );
+		}
+
+		void await_resume( ) const noexcept {}
+	};
+
+	namespace impl {
+		template<typename Result>
+		struct future_awaiter {
+			future_result_t<Result> m_future;
+			std::optional<daw::expected_t<Result>> m_value{ };
+
+			[[nodiscard]] bool await_ready( ) const {
+				return m_future.try_wait( );
+			}
+
+			template<typename Promise>
+			void await_suspend( std::coroutine_handle<Promise> h ) {
+				// A local copy, the callback can run and destroy this awaiter before
+				// on_complete returns
+				auto fut = m_future;
+				fut.on_complete(
+				  [self = this, h,
+				   ts = impl::scheduler_for( h, fut.get_scheduler( ) )](
+				    daw::expected_t<Result> value ) mutable {
+					  self->m_value.emplace( daw::move( value ) );
+					  impl::schedule_resume( ts, h );
+				  } );
+			}
+
+			Result await_resume( ) {
+				if( not m_value ) {
+					return m_future.get( );
+				}
+				if constexpr( std::is_void_v<Result> ) {
+					m_value->get( );
+				} else {
+					return daw::move( m_value->get( ) );
+				}
+			}
+		};
+
+		struct latch_awaiter {
+			daw::shared_latch m_latch;
+
+			[[nodiscard]] bool await_ready( ) const {
+				return m_latch.try_wait( );
+			}
+
+			template<typename Promise>
+			[[nodiscard]] bool await_suspend( std::coroutine_handle<Promise> h ) {
+				auto sem = m_latch;
+				auto ts = impl::scheduler_for( h, get_task_scheduler( ) );
+				// The scheduler holds tasks with a latch back until it is released
+				if( ts.add_task( [h]( ) { h.resume( ); }, sem ) ) {
+					return true;
+				}
+				sem.wait( );
+				return false;
+			}
+
+			void await_resume( ) const noexcept {}
+		};
+
+		template<typename T>
+		detached_task run_detached( task<T> tsk, future_result_t<T> result ) {
+			auto value = std::optional<daw::expected_t<T>>( );
+			try {
+				if constexpr( std::is_void_v<T> ) {
+					co_await daw::move( tsk );
+				} else {
+					value.emplace( co_await daw::move( tsk ) );
+				}
+			} catch( ... ) { value.emplace( std::current_exception( ) ); }
+			// Publish outside of the try, an inline continuation may throw
+			if( value and value->has_exception( ) ) {
+				result.set_exception( value->get_exception_ptr( ) );
+			} else if constexpr( std::is_void_v<T> ) {
+				result.set_value( );
+			} else {
+				result.set_value( daw::move( value->get( ) ) );
+			}
+		}
+	} // namespace impl
+
+	/// Suspend until fut is ready, then resume on the scheduler of the
+	/// awaiting coroutine.  The future is continued after
+	template<typename Result>
+	[[nodiscard]] auto operator co_await( future_result_t<Result> const &fut ) {
+		return impl::future_awaiter<Result>{ fut };
+	}
+
+	/// Suspend until sem is released, then resume on the scheduler of the
+	/// awaiting coroutine
+	[[nodiscard]] inline auto operator co_await( daw::shared_latch const &sem ) {
+		return impl::latch_awaiter{ sem };
+	}
+
+	/// Start tsk on ts and return a future for its result
+	template<typename T>
+	[[nodiscard]] future_result_t<T>
+	spawn_task( task<T> tsk, task_scheduler ts = get_task_scheduler( ) ) {
+		daw::exception::precondition_check( tsk, "Cannot spawn an empty task" );
+		auto result = future_result_t<T>( ts );
+		auto h = impl::run_detached( daw::move( tsk ), result ).m_handle;
+		h.promise( ).m_task_scheduler.emplace( ts );
+		impl::schedule_resume( ts, h );
+		return result;
+	}
+
+	/// Run tsk on ts and block the calling thread until it is finished
+	template<typename T>
+	T sync_wait( task<T> tsk, task_scheduler ts = get_task_scheduler( ) ) {
+		return spawn_task( daw::move( tsk ), daw::move( ts ) ).get( );
+	}
+} // namespace daw
+
+#endif
@@ -0,0 +1,319 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "future_result.h"
+#include "task_scheduler.h"
+
+#include <daw/daw_exception.h>
+#include <daw/daw_move.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace daw::distributed {
+	/// A serialized message, chunk or partial result
+	using bytes_t = std::vector<std::byte>;
+
+	/// Thrown, or stored in a future, when a node cannot run a chunk or its
+	/// reply cannot be read
+	struct remote_error : std::runtime_error {
+		using std::runtime_error::runtime_error;
+	};
+
+	/// Append the bytes of value.  Nodes must agree on byte order and layout
+	template<typename T>
+	void write_value( bytes_t &out, T const &value ) {
+		static_assert( std::is_trivially_copyable_v<T>,
+		               "Only trivially copyable values can be serialized" );
+		auto const pos = out.size( );
+		out.resize( pos + sizeof( T ) );
+		std::memcpy( out.data( ) + pos, &value, sizeof( T ) );
+	}
+
+	/// Read a T at pos and move pos past it
+	template<typename T>
+	[[nodiscard]] T read_value( bytes_t const &in, std::size_t &pos ) {
+		static_assert( std::is_trivially_copyable_v<T>,
+		               "Only trivially copyable values can be serialized" );
+		static_assert( std::is_default_constructible_v<T> );
+		if( in.size( ) < pos or in.size( ) - pos < sizeof( T ) ) {
+			throw remote_error( "Message is too short" );
+		}
+		auto result = T{ };
+		std::memcpy( &result, in.data( ) + pos, sizeof( T ) );
+		pos += sizeof( T );
+		return result;
+	}
+
+	template<typename T>
+	[[nodiscard]] bytes_t to_bytes( T const &value ) {
+		auto result = bytes_t( );
+		write_value( result, value );
+		return result;
+	}
+
+	/// The T held by all of in
+	template<typename T>
+	[[nodiscard]] T from_bytes( bytes_t const &in ) {
+		std::size_t pos = 0;
+		auto result = read_value<T>( in, pos );
+		if( pos != in.size( ) ) {
+			throw remote_error( "Message is too long" );
+		}
+		return result;
+	}
+
+	/// Run the function registered as function_id over [first, last) of the
+	/// node's own input, with args.  The range is a position in the whole
+	/// input that each node maps onto the data it holds, e.g. its slice of a
+	/// memory mapped file, so only the descriptor is sent
+	struct chunk_descriptor {
+		std::uint32_t function_id = 0;
+		std::uint64_t first = 0;
+		std::uint64_t last = 0;
+		bytes_t args{ };
+	};
+
+	[[nodiscard]] bytes_t serialize( chunk_descriptor const &chunk );
+	[[nodiscard]] chunk_descriptor deserialize_chunk( bytes_t const &data );
+
+	/// The functions a node can run, by id.  Every node registers the same
+	/// functions under the same ids
+	class function_registry {
+		using function_t =
+		  std::function<bytes_t( chunk_descriptor const &, task_scheduler & )>;
+		std::unordered_map<std::uint32_t, function_t> m_functions{ };
+
+	public:
+		/// Register func( first, last, Args const &, task_scheduler & ) under
+		/// function_id.  Args and the result, if any, are trivially copyable
+		template<typename Args, typename Function>
+		void add( std::uint32_t function_id, Function func ) {
+			static_assert(
+			  std::is_invocable_v<Function const &, std::uint64_t, std::uint64_t,
+			                      Args const &, task_scheduler &>,
+			  "Function must be callable as func( first, last, args, ts )" );
+			daw::exception::precondition_check(
+			  m_functions.count( function_id ) == 0,
+			  "function_id is already registered" );
+			m_functions[function_id] = [func = daw::move( func )](
+			                             chunk_descriptor const &chunk,
+			                             task_scheduler &ts ) -> bytes_t {
+				auto const args = from_bytes<Args>( chunk.args );
+				using result_t = std::invoke_result_t<Function const &, std::uint64_t,
+				                                      std::uint64_t, Args const &,
+				                                      task_scheduler &>;
+				if constexpr( std::is_void_v<result_t> ) {
+					func( chunk.first, chunk.last, args, ts );
+					return bytes_t( );
+				} else {
+					return to_bytes( func( chunk.first, chunk.last, args, ts ) );
+				}
+			};
+		}
+
+		/// The serialized result of running chunk.  Throws remote_error for an
+		/// unknown function_id
+		[[nodiscard]] bytes_t run( chunk_descriptor const &chunk,
+		                           task_scheduler &ts ) const;
+	};
+
+	/// Where the chunks of the distributed algorithms run
+	class executor {
+	public:
+		executor( ) = default;
+		executor( executor const & ) = delete;
+		executor &operator=( executor const & ) = delete;
+		virtual ~executor( );
+
+		/// A future of the serialized result of chunk
+		[[nodiscard]] virtual future_result_t<bytes_t>
+		execute( chunk_descriptor chunk ) = 0;
+	};
+
+	/// Runs chunks in this process.  registry must outlive it
+	class local_executor final : public executor {
+		function_registry const *m_registry;
+		task_scheduler m_ts;
+
+	public:
+		explicit local_executor( function_registry const &registry,
+		                         task_scheduler ts = get_task_scheduler( ) );
+
+		[[nodiscard]] future_result_t<bytes_t>
+		execute( chunk_descriptor chunk ) override;
+	};
+
+	/// Messages larger than this are refused instead of allocated, unless
+	/// configured otherwise
+	inline constexpr std::uint64_t default_max_message_size = 64ULL << 20U;
+
+	/// Limits on how long a tcp_executor waits for a node
+	struct tcp_executor_config {
+		std::uint64_t max_reply_size = default_max_message_size;
+		std::chrono::milliseconds connect_timeout = std::chrono::seconds( 10 );
+		/// How long a read or write may block.  The wait for a reply includes
+		/// running the chunk, so chunks that take longer fail
+		std::chrono::milliseconds io_timeout = std::chrono::minutes( 5 );
+	};
+
+	/// Sends chunks to a tcp_worker, one connection per chunk.  Replies are
+	/// waited for off the task_scheduler, which only runs the continuations,
+	/// on threads the executor joins when it is destroyed.  Replies that are
+	/// too large or too late fail with a remote_error
+	class tcp_executor final : public executor {
+		struct state_t;
+		std::unique_ptr<state_t> m_state;
+
+	public:
+		tcp_executor( std::string host, std::uint16_t port,
+		              task_scheduler ts = get_task_scheduler( ),
+		              tcp_executor_config config = tcp_executor_config( ) );
+
+		/// Shuts down the connections still waiting and joins their threads.
+		/// Their futures fail with a remote_error
+		~tcp_executor( ) override;
+
+		[[nodiscard]] future_result_t<bytes_t>
+		execute( chunk_descriptor chunk ) override;
+	};
+
+	/// Where a tcp_worker listens and what it accepts.  There is no
+	/// authentication, anyone who can connect can run registered functions, so
+	/// only bind beyond loopback on a trusted network
+	struct tcp_worker_config {
+		/// A host name or address.  "0.0.0.0" or "::" listen on every interface
+		std::string bind_address = "127.0.0.1";
+		/// 0 picks a free port
+		std::uint16_t port = 0;
+		std::uint64_t max_message_size = default_max_message_size;
+		/// Connections past this wait in the listen backlog
+		std::size_t max_connections = 64U;
+		/// How long a connection may block in a read or write
+		std::chrono::milliseconds io_timeout = std::chrono::seconds( 30 );
+	};
+
+	/// Serves the chunks of tcp_executors with registry on ts until stopped.
+	/// Connections are read and answered off the task_scheduler, each on a
+	/// thread the worker joins when it stops.  registry must outlive it
+	class tcp_worker {
+		struct state_t;
+		std::unique_ptr<state_t> m_state;
+
+	public:
+		explicit tcp_worker( function_registry const &registry,
+		                     tcp_worker_config config,
+		                     task_scheduler ts = get_task_scheduler( ) );
+
+		/// Listen on loopback
+		explicit tcp_worker( function_registry const &registry,
+		                     std::uint16_t port = 0,
+		                     task_scheduler ts = get_task_scheduler( ) );
+
+		tcp_worker( tcp_worker const & ) = delete;
+		tcp_worker &operator=( tcp_worker const & ) = delete;
+		~tcp_worker( );
+
+		[[nodiscard]] std::uint16_t port( ) const;
+
+		/// Stop accepting, shut down the open connections and wait for their
+		/// threads.  A chunk already running finishes but its reply is lost
+		void stop( );
+	};
+
+	namespace impl {
+		/// One chunk of [0, size) for each executor
+		template<typename Args>
+		[[nodiscard]] std::vector<chunk_descriptor>
+		make_chunks( std::size_t count, std::uint32_t function_id,
+		             std::uint64_t size, Args const &args ) {
+			daw::exception::precondition_check( count > 0,
+			                                    "At least one executor is needed" );
+			auto const args_bytes = to_bytes( args );
+			// size * n / count without overflowing size * n
+			auto const boundary = [&]( std::uint64_t n ) {
+				return size / count * n + size % count * n / count;
+			};
+			auto result = std::vector<chunk_descriptor>( );
+			result.reserve( count );
+			for( std::size_t n = 0; n < count; ++n ) {
+				result.push_back( chunk_descriptor{ function_id, boundary( n ),
+				                                    boundary( n + 1U ), args_bytes } );
+			}
+			return result;
+		}
+	} // namespace impl
+
+	/// Split [0, size) into one chunk per executor and call the function
+	/// registered as function_id on each.  The partial results are combined
+	/// with reduce_function, as the futures finish
+	template<typename Result, typename Args, typename ReduceFunction>
+	[[nodiscard]] future_result_t<Result>
+	map_reduce( std::vector<std::shared_ptr<executor>> const &executors,
+	            std::uint32_t function_id, std::uint64_t size, Args const &args,
+	            ReduceFunction reduce_function ) {
+		auto chunks =
+		  impl::make_chunks( executors.size( ), function_id, size, args );
+		auto partials = std::vector<future_result_t<Result>>( );
+		partials.reserve( chunks.size( ) );
+		for( std::size_t n = 0; n < chunks.size( ); ++n ) {
+			partials.push_back(
+			  executors[n]
+			    ->execute( daw::move( chunks[n] ) )
+			    .next(
+			      []( bytes_t const &data ) { return from_bytes<Result>( data ); },
+			      continuation_mode::run_inline ) );
+		}
+		return reduce_futures( partials.begin( ), partials.end( ),
+		                       daw::move( reduce_function ) );
+	}
+
+	/// Split [0, size) into one chunk per executor and call the function
+	/// registered as function_id on each.  Ready when every chunk is done
+	template<typename Args>
+	[[nodiscard]] future_result_t<void>
+	for_each( std::vector<std::shared_ptr<executor>> const &executors,
+	          std::uint32_t function_id, std::uint64_t size, Args const &args ) {
+		auto chunks =
+		  impl::make_chunks( executors.size( ), function_id, size, args );
+		auto results = std::vector<future_result_t<bytes_t>>( );
+		results.reserve( chunks.size( ) );
+		for( std::size_t n = 0; n < chunks.size( ); ++n ) {
+			results.push_back( executors[n]->execute( daw::move( chunks[n] ) ) );
+		}
+		return when_all( results.begin( ), results.end( ) )
+		  .next( []( std::vector<bytes_t> const & ) {},
+		         continuation_mode::run_inline );
+	}
+} // namespace daw::distributed
@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <tuple>
 #include <utility>
 
@@ -92,6 +94,22 @@ namespace daw {
 		return function_stream( std::make_tuple( daw::make_callable( funcs )... ) );
 	}
 
+	/// Mark func as a cheap stage of a function_stream.  It runs in the same
+	/// task as the stage before it, skipping a trip through the task queue
+	template<typename Function>
+	[[nodiscard]] constexpr auto cheap_stage( Function &&func ) {
+		return impl::cheap_stage_t<daw::remove_cvref_t<Function>>{
+		  std::forward<Function>( func )};
+	}
+
+	/// Fuse funcs into a single function_stream stage that calls each with the
+	/// result of the one before
+	template<typename... Functions>
+	[[nodiscard]] constexpr auto fuse_stages( Functions &&... funcs ) {
+		return impl::function_composer_t<daw::remove_cvref_t<Functions>...>(
+		  std::forward<Functions>( funcs )... );
+	}
+
 	template<typename FunctionStream>
 	void wait_for_function_streams( FunctionStream &&function_stream ) {
 		function_stream.wait( );
@@ -104,6 +122,62 @@ namespace daw {
 		                0 )... );
 	}
 
+	struct channel_stream_options {
+		/// Items each stage boundary holds before the stage feeding it waits
+		std::size_t capacity = 256U;
+		/// Items a stage handles per task before giving the worker back
+		std::size_t batch_size = 16U;
+	};
+
+	/// A long running function_stream for a flow of items.  Stage boundaries
+	/// are bounded channels, so a slow stage holds up the ones before it, and
+	/// push( ) waits, instead of items piling up in memory.  Items move through
+	/// in batches, one task per stage at a time.  The result of the last stage
+	/// is dropped, it is the sink.  If a stage throws, the items still in the
+	/// stream are dropped and wait( ) rethrows the first exception
+	template<typename Input, typename... Functions>
+	class channel_stream {
+		static_assert( sizeof...( Functions ) > 0,
+		               "A channel_stream needs at least one stage" );
+		using state_t = impl::channel_stream_state<Input, Functions...>;
+
+		std::shared_ptr<state_t> m_state;
+
+	public:
+		explicit channel_stream( channel_stream_options const &options,
+		                         task_scheduler ts, Functions... funcs )
+		  : m_state( std::make_shared<state_t>(
+		      options.capacity, options.batch_size, daw::move( ts ),
+		      std::tuple<Functions...>( daw::move( funcs )... ) ) ) {}
+
+		/// Feed value to the first stage, waiting while its channel is full.
+		/// false once close( ) has been called
+		bool push( Input value ) {
+			return m_state->push( value );
+		}
+
+		/// No more items will be pushed
+		void close( ) {
+			m_state->close( );
+		}
+
+		/// Wait until close( ) was called and every item pushed before it has
+		/// been through all the stages
+		void wait( ) const {
+			auto ts = m_state->get_task_scheduler( );
+			ts.wait_for( m_state->done( ) );
+		}
+	};
+
+	/// A channel_stream of Input items on the default task scheduler
+	template<typename Input, typename... Functions>
+	[[nodiscard]] auto
+	make_channel_stream( channel_stream_options const &options,
+	                     Functions &&... funcs ) {
+		return channel_stream<Input, daw::remove_cvref_t<Functions>...>(
+		  options, get_task_scheduler( ), std::forward<Functions>( funcs )... );
+	}
+
 	template<typename... Funcs>
 	class future_generator_t {
 		template<typename...>
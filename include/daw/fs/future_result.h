@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "cancellation.h"
 #include "impl/daw_latch.h"
 #include "impl/future_result_impl.h"
 #include "task_scheduler.h"
@@ -32,11 +33,13 @@
 #include <daw/daw_function.h>
 #include <daw/daw_traits.h>
 
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <memory>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace daw {
 	template<typename Result>
@@ -57,12 +60,25 @@ namespace daw {
 		explicit future_result_t( task_scheduler ts )
 		  : m_data( ::daw::move( ts ) ) {}
 
+		/// Continuations of this future inherit tok, their work is dropped once
+		/// it is cancelled
+		future_result_t( task_scheduler ts, cancellation_token tok )
+		  : m_data( ::daw::move( ts ), ::daw::move( tok ) ) {}
+
 		explicit future_result_t( daw::shared_latch sem, task_scheduler ts )
 		  : m_data( ::daw::move( sem ), ::daw::move( ts ) ) {}
 
 		explicit future_result_t( daw::shared_latch sem )
 		  : m_data( ::daw::move( sem ), get_task_scheduler( ) ) {}
 
+		/// Allocate the shared state with alloc, e.g. a
+		/// std::pmr::polymorphic_allocator over a pool.  The state may be
+		/// released on any thread, so the allocator must be thread safe
+		template<typename Allocator>
+		future_result_t( std::allocator_arg_t, Allocator const &alloc,
+		                 task_scheduler ts = get_task_scheduler( ) )
+		  : m_data( std::allocator_arg, alloc, ::daw::move( ts ) ) {}
+
 		future_result_t( future_result_t const & ) = default;
 		future_result_t &operator=( future_result_t const & ) = default;
 		future_result_t( future_result_t &&other )
@@ -173,10 +189,44 @@ namespace daw {
 			return m_data.get( );
 		}
 
+		/// Call func( result ) once this future has a value, giving a future of
+		/// its result.  By default func runs as a new task, see
+		/// continuation_mode for running cheap continuations inline.  The new
+		/// future has this future's cancellation token
 		template<typename Function>
-		[[nodiscard]] decltype( auto ) next( Function &&func ) {
-			return m_data.next(
-			  daw::make_callable( std::forward<Function>( func ) ) );
+		[[nodiscard]] decltype( auto )
+		next( Function &&func,
+		      continuation_mode mode = continuation_mode::scheduled ) {
+			return m_data.next( daw::make_callable( std::forward<Function>( func ) ),
+			                    mode, get_cancellation_token( ) );
+		}
+
+		/// As next, with tok as the new future's cancellation token.  When it is
+		/// cancelled before func starts, func is skipped and the future holds an
+		/// operation_cancelled_exception
+		template<typename Function>
+		[[nodiscard]] decltype( auto )
+		next( Function &&func, cancellation_token tok,
+		      continuation_mode mode = continuation_mode::scheduled ) {
+			return m_data.next( daw::make_callable( std::forward<Function>( func ) ),
+			                    mode, daw::move( tok ) );
+		}
+
+		/// Call func( result_t ) on the thread that completes this future,
+		/// without scheduling a task.  Exceptions are passed along in the
+		/// expected instead of skipping func.  The future is continued after
+		template<typename Function>
+		void on_complete( Function &&func ) {
+			m_data.on_complete( std::forward<Function>( func ) );
+		}
+
+		/// The task_scheduler that continuations of this future are run on
+		[[nodiscard]] task_scheduler const &get_scheduler( ) const {
+			return m_data.m_data->m_task_scheduler;
+		}
+
+		[[nodiscard]] cancellation_token const &get_cancellation_token( ) const {
+			return m_data.m_data->m_cancel;
 		}
 
 		template<typename... Functions>
@@ -211,9 +261,15 @@ namespace daw {
 	public:
 		future_result_t( ) = default;
 		explicit future_result_t( task_scheduler ts );
+		future_result_t( task_scheduler ts, cancellation_token tok );
 		explicit future_result_t( daw::shared_latch sem,
 		                          task_scheduler ts = get_task_scheduler( ) );
 
+		template<typename Allocator>
+		future_result_t( std::allocator_arg_t, Allocator const &alloc,
+		                 task_scheduler ts = get_task_scheduler( ) )
+		  : m_data( std::allocator_arg, alloc, ::daw::move( ts ) ) {}
+
 		[[nodiscard]] auto get_handle( ) const {
 			using data_handle_t =
 			  daw::remove_cvref_t<decltype( m_data.get_handle( ) )>;
@@ -248,13 +304,13 @@ namespace daw {
 		template<typename Rep, typename Period>
 		[[nodiscard]] future_status
 		wait_for( std::chrono::duration<Rep, Period> rel_time ) const {
-			return wait_for( rel_time );
+			return m_data.wait_for( rel_time );
 		}
 
 		template<typename Clock, typename Duration>
 		[[nodiscard]] future_status
 		wait_until( std::chrono::time_point<Clock, Duration> timeout_time ) const {
-			return wait_until( timeout_time );
+			return m_data.wait_until( timeout_time );
 		}
 
 		void get( ) const;
@@ -280,9 +336,37 @@ namespace daw {
 		}
 
 		template<typename Function>
-		[[nodiscard]] decltype( auto ) next( Function &&function ) {
+		[[nodiscard]] decltype( auto )
+		next( Function &&function,
+		      continuation_mode mode = continuation_mode::scheduled ) {
+			return m_data.next(
+			  daw::make_callable( std::forward<Function>( function ) ), mode,
+			  get_cancellation_token( ) );
+		}
+
+		template<typename Function>
+		[[nodiscard]] decltype( auto )
+		next( Function &&function, cancellation_token tok,
+		      continuation_mode mode = continuation_mode::scheduled ) {
 			return m_data.next(
-			  daw::make_callable( std::forward<Function>( function ) ) );
+			  daw::make_callable( std::forward<Function>( function ) ), mode,
+			  daw::move( tok ) );
+		}
+
+		/// Call func( expected_t<void> ) on the thread that completes this
+		/// future, without scheduling a task.  The future is continued after
+		template<typename Function>
+		void on_complete( Function &&func ) {
+			m_data.on_complete( std::forward<Function>( func ) );
+		}
+
+		/// The task_scheduler that continuations of this future are run on
+		[[nodiscard]] task_scheduler const &get_scheduler( ) const {
+			return m_data.m_data->m_task_scheduler;
+		}
+
+		[[nodiscard]] cancellation_token const &get_cancellation_token( ) const {
+			return m_data.m_data->m_cancel;
 		}
 
 		template<typename Function, typename... Functions>
@@ -323,6 +407,35 @@ namespace daw {
 		return lhs.next( daw::make_callable( std::forward<Function>( rhs ) ) );
 	}
 
+	namespace impl {
+		template<typename Result, typename Urgency, typename Function,
+		         typename... Args>
+		[[nodiscard]] future_result_t<Result>
+		schedule_future_result( future_result_t<Result> result, task_scheduler &ts,
+		                        Urgency urgency, Function &&func,
+		                        Args &&...args ) {
+			if( not ts.add_task(
+			      [result = daw::mutable_capture( result ),
+			       func = daw::mutable_capture(
+			         daw::make_callable( std::forward<Function>( func ) ) ),
+			       args = daw::mutable_capture(
+			         std::make_tuple( std::forward<Args>( args )... ) )]( ) -> void {
+				      if( complete_if_cancelled( *result ) ) {
+					      return;
+				      }
+				      result->from_code(
+				        [func = daw::mutable_capture( daw::move( *func ) ),
+				         args = daw::mutable_capture( daw::move( *args ) )]( ) {
+					        return daw::apply( daw::move( *func ), daw::move( *args ) );
+				        } );
+			      },
+			      urgency ) ) {
+				throw ::daw::unable_to_add_task_exception{ };
+			}
+			return result;
+		}
+	} // namespace impl
+
 	template<typename Function, typename... Args,
 	         std::enable_if_t<daw::traits::is_callable_v<Function, Args...>,
 	                          std::nullptr_t> = nullptr>
@@ -330,22 +443,57 @@ namespace daw {
 	                                       Args &&...args ) {
 		using result_t =
 		  daw::remove_cvref_t<decltype( func( std::forward<Args>( args )... ) )>;
-		auto result = future_result_t<result_t>( );
-
-		if( not ts.add_task( [result = daw::mutable_capture( result ),
-		                      func = daw::mutable_capture( daw::make_callable(
-		                        std::forward<Function>( func ) ) ),
-		                      args = daw::mutable_capture( std::make_tuple(
-		                        std::forward<Args>( args )... ) )]( ) -> void {
-			    result->from_code(
-			      [func = daw::mutable_capture( daw::move( *func ) ),
-			       args = daw::mutable_capture( daw::move( *args ) )]( ) {
-				      return daw::apply( daw::move( *func ), daw::move( *args ) );
-			      } );
-		    } ) ) {
-			throw ::daw::unable_to_add_task_exception{ };
-		}
-		return result;
+		return impl::schedule_future_result(
+		  future_result_t<result_t>( ts ), ts, task_priority::normal,
+		  std::forward<Function>( func ), std::forward<Args>( args )... );
+	}
+
+	/// As make_future_result, with a priority class or deadline for the task
+	template<typename Urgency, typename Function, typename... Args,
+	         std::enable_if_t<is_task_urgency_v<Urgency> and
+	                            daw::traits::is_callable_v<Function, Args...>,
+	                          std::nullptr_t> = nullptr>
+	[[nodiscard]] auto make_future_result( task_scheduler ts, Urgency urgency,
+	                                       Function &&func, Args &&...args ) {
+		using result_t =
+		  daw::remove_cvref_t<decltype( func( std::forward<Args>( args )... ) )>;
+		return impl::schedule_future_result(
+		  future_result_t<result_t>( ts ), ts, urgency,
+		  std::forward<Function>( func ), std::forward<Args>( args )... );
+	}
+
+	/// As make_future_result, dropping func when tok is cancelled before it
+	/// starts.  The future then holds an operation_cancelled_exception.
+	/// Continuations added with next inherit tok
+	template<typename Function, typename... Args,
+	         std::enable_if_t<daw::traits::is_callable_v<Function, Args...>,
+	                          std::nullptr_t> = nullptr>
+	[[nodiscard]] auto make_future_result( task_scheduler ts,
+	                                       cancellation_token tok,
+	                                       Function &&func, Args &&...args ) {
+		using result_t =
+		  daw::remove_cvref_t<decltype( func( std::forward<Args>( args )... ) )>;
+		return impl::schedule_future_result(
+		  future_result_t<result_t>( ts, daw::move( tok ) ), ts,
+		  task_priority::normal, std::forward<Function>( func ),
+		  std::forward<Args>( args )... );
+	}
+
+	/// As make_future_result, with the future's shared state allocated by
+	/// alloc instead of the global heap
+	template<typename Allocator, typename Function, typename... Args,
+	         std::enable_if_t<daw::traits::is_callable_v<Function, Args...>,
+	                          std::nullptr_t> = nullptr>
+	[[nodiscard]] auto make_future_result( std::allocator_arg_t,
+	                                       Allocator const &alloc,
+	                                       task_scheduler ts, Function &&func,
+	                                       Args &&...args ) {
+		using result_t =
+		  daw::remove_cvref_t<decltype( func( std::forward<Args>( args )... ) )>;
+		return impl::schedule_future_result(
+		  future_result_t<result_t>( std::allocator_arg, alloc, ts ), ts,
+		  task_priority::normal, std::forward<Function>( func ),
+		  std::forward<Args>( args )... );
 	}
 
 	namespace impl {
@@ -387,7 +535,7 @@ namespace daw {
 		  daw::traits::is_callable_v<std::remove_reference_t<Function>, Args...> );
 		using result_t = decltype( std::forward<Function>( func )(
 		  std::forward<Args>( args )... ) );
-		auto result = future_result_t<result_t>( daw::move( sem ) );
+		auto result = future_result_t<result_t>( daw::move( sem ), ts );
 		ts.add_task( impl::make_future_task(
 		  result, daw::make_callable( std::forward<Function>( func ) ),
 		  std::forward<Args>( args )... ) );
@@ -395,11 +543,12 @@ namespace daw {
 		return result;
 	} // namespace daw
 
-	template<typename Function, typename... Args>
+	template<typename Function, typename... Args,
+	         std::enable_if_t<daw::traits::is_callable_v<
+	                            std::remove_reference_t<Function>, Args...>,
+	                          std::nullptr_t> = nullptr>
 	[[nodiscard]] decltype( auto ) make_future_result( Function &&func,
 	                                                   Args &&...args ) {
-		static_assert(
-		  daw::traits::is_callable_v<std::remove_reference_t<Function>, Args...> );
 		return make_future_result(
 		  get_task_scheduler( ),
 		  daw::make_callable( std::forward<Function>( func ) ),
@@ -451,6 +600,52 @@ namespace daw {
 	  decltype( is_future_result_impl( std::declval<T>( ) ) )::value;
 
 	namespace impl {
+		/// Combine two futures with binary_op once both are ready.  Neither
+		/// side is waited on, the last one to complete runs binary_op.  This
+		/// keeps workers from blocking on a future whose task is queued behind
+		/// them
+		template<typename L, typename R, typename BinaryOp>
+		[[nodiscard]] auto join_futures( future_result_t<L> l,
+		                                 future_result_t<R> r,
+		                                 BinaryOp const &binary_op ) {
+			using result_t = daw::remove_cvref_t<decltype(
+			  binary_op( std::declval<L>( ), std::declval<R>( ) ) )>;
+
+			struct join_state_t {
+				std::atomic_int remaining = 2;
+				daw::expected_t<L> left{ };
+				daw::expected_t<R> right{ };
+				BinaryOp binary_op;
+				future_result_t<result_t> result;
+
+				join_state_t( BinaryOp const &op, task_scheduler const &ts )
+				  : binary_op( op )
+				  , result( ts ) {}
+
+				void arrive( ) {
+					if( remaining.fetch_sub( 1, std::memory_order_acq_rel ) != 1 ) {
+						return;
+					}
+					result.from_code( [&]( ) {
+						return binary_op( daw::move( left.get( ) ),
+						                  daw::move( right.get( ) ) );
+					} );
+				}
+			};
+
+			auto state = std::make_shared<join_state_t>( binary_op, l.get_scheduler( ) );
+			auto result = state->result;
+			l.on_complete( [state]( daw::expected_t<L> value ) {
+				state->left = daw::move( value );
+				state->arrive( );
+			} );
+			r.on_complete( [state]( daw::expected_t<R> value ) {
+				state->right = daw::move( value );
+				state->arrive( );
+			} );
+			return result;
+		}
+
 		template<typename Iterator, typename OutputIterator, typename BinaryOp>
 		inline OutputIterator reduce_futures2( Iterator first, Iterator last,
 		                                       OutputIterator out_it,
@@ -470,12 +665,7 @@ namespace daw {
 			while( first != last ) {
 				auto l_it = first++;
 				auto r_it = first++;
-				*out_it++ = l_it->next(
-				  [r = daw::mutable_capture( *r_it ),
-				   binary_op = daw::mutable_capture( binary_op )]( auto &&result ) {
-					  return ( *binary_op )( std::forward<decltype( result )>( result ),
-					                         r->get( ) );
-				  } );
+				*out_it++ = join_futures( *l_it, *r_it, binary_op );
 			}
 			if( odd_count ) {
 				*out_it++ = *last;
@@ -514,6 +704,124 @@ namespace daw {
 		return results.front( );
 	}
 
+	namespace impl {
+		template<typename T>
+		using when_all_result_t =
+		  std::conditional_t<std::is_void_v<T>, void, std::vector<T>>;
+
+		/// The one shared state of a when_all group.  Each future writes its own
+		/// slot and counts down, the last one to arrive publishes the group
+		template<typename T>
+		struct when_all_state_t {
+			std::atomic_size_t remaining;
+			std::vector<daw::expected_t<T>> slots;
+			future_result_t<when_all_result_t<T>> result;
+
+			when_all_state_t( std::size_t count, task_scheduler const &ts )
+			  : remaining( count )
+			  , slots( count )
+			  , result( ts ) {}
+
+			void arrive( ) {
+				if( remaining.fetch_sub( 1, std::memory_order_acq_rel ) != 1 ) {
+					return;
+				}
+				for( auto const &slot : slots ) {
+					if( not slot.has_value( ) ) {
+						result.set_exception( slot.get_exception_ptr( ) );
+						return;
+					}
+				}
+				if constexpr( std::is_void_v<T> ) {
+					result.set_value( );
+				} else {
+					result.from_code( [&]( ) {
+						auto values = std::vector<T>( );
+						values.reserve( slots.size( ) );
+						for( auto &slot : slots ) {
+							values.push_back( daw::move( slot.get( ) ) );
+						}
+						return values;
+					} );
+				}
+			}
+		};
+	} // namespace impl
+
+	/// A future of every value in [first, last), in order, once all are ready.
+	/// If any fail, the exception of the first failed future in the range is
+	/// used.  The futures' continuations are used to collect the results
+	template<typename Iterator,
+	         typename T = typename daw::remove_cvref_t<
+	           decltype( *std::declval<Iterator>( ) )>::result_type_t>
+	[[nodiscard]] future_result_t<impl::when_all_result_t<T>>
+	when_all( Iterator first, Iterator last ) {
+		static_assert( is_future_result_v<decltype( *first )>,
+		               "Iterator's value type must be a future result" );
+
+		auto const count = static_cast<std::size_t>( std::distance( first, last ) );
+		if( count == 0 ) {
+			auto result = future_result_t<impl::when_all_result_t<T>>( );
+			if constexpr( std::is_void_v<T> ) {
+				result.set_value( );
+			} else {
+				result.set_value( std::vector<T>( ) );
+			}
+			return result;
+		}
+		auto state = std::make_shared<impl::when_all_state_t<T>>(
+		  count, first->get_scheduler( ) );
+		auto result = state->result;
+		for( std::size_t n = 0; first != last; ++first, ++n ) {
+			first->on_complete( [state, n]( daw::expected_t<T> value ) {
+				state->slots[n] = daw::move( value );
+				state->arrive( );
+			} );
+		}
+		return result;
+	}
+
+	/// The position and result of the first future of a when_any group to
+	/// complete
+	template<typename T>
+	struct when_any_result_t {
+		std::size_t index;
+		daw::expected_t<T> value;
+	};
+
+	/// A future of the first future in [first, last) to complete, with or
+	/// without an exception.  The range cannot be empty
+	template<typename Iterator,
+	         typename T = typename daw::remove_cvref_t<
+	           decltype( *std::declval<Iterator>( ) )>::result_type_t>
+	[[nodiscard]] future_result_t<when_any_result_t<T>>
+	when_any( Iterator first, Iterator last ) {
+		static_assert( is_future_result_v<decltype( *first )>,
+		               "Iterator's value type must be a future result" );
+		daw::exception::precondition_check( first != last,
+		                                    "when_any needs at least one future" );
+
+		struct when_any_state_t {
+			std::atomic_bool done = false;
+			future_result_t<when_any_result_t<T>> result;
+
+			explicit when_any_state_t( task_scheduler const &ts )
+			  : result( ts ) {}
+		};
+
+		auto state = std::make_shared<when_any_state_t>( first->get_scheduler( ) );
+		auto result = state->result;
+		for( std::size_t n = 0; first != last; ++first, ++n ) {
+			first->on_complete( [state, n]( daw::expected_t<T> value ) {
+				if( not state->done.exchange( true, std::memory_order_acq_rel ) ) {
+					state->result.set_value(
+					  when_any_result_t<T>{ n, daw::move( value ) } );
+				}
+			} );
+		}
+		return result;
+	}
+
 	namespace impl {
 		template<typename F, typename Tuple, std::size_t... I>
 		[[nodiscard]] constexpr decltype( auto )
@@ -23,18 +23,33 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iterator>
+#include <memory>
 #include <numeric>
 #include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include <daw/daw_algorithm.h>
 #include <daw/daw_scope_guard.h>
 #include <daw/daw_view.h>
 #include "daw_latch.h"
-#include <daw/parallel/daw_spin_lock.h>
 
 #include "../future_result.h"
 #include "../task_scheduler.h"
+#include "cache_padded.h"
+#include "cost_model.h"
+#include "cpu_topology.h"
+#include "deterministic.h"
+#include "simd_kernels.h"
+#include "streaming_stores.h"
+#include "tiling.h"
 
 namespace daw::algorithm::parallel::impl {
 	template<size_t MinRangeSize = 1>
@@ -91,93 +106,363 @@ namespace daw::algorithm::parallel::impl {
 		}
 	};
 
+	/// The ranges handed out by split_lazy_t.  Chunk n is the n'th chunk_size
+	/// sized piece of the range.  Chunks are not scheduled up front, a task
+	/// works through a run of them and only splits off the back half of its
+	/// run when another worker could take it
+	template<typename Iterator>
+	class lazy_ranges {
+		daw::view<Iterator> m_range;
+		size_t m_chunk_size;
+
+	public:
+		lazy_ranges( daw::view<Iterator> rng, size_t chunk_size )
+		  : m_range( rng )
+		  , m_chunk_size( chunk_size ) {
+			assert( m_chunk_size > 0 );
+		}
+
+		[[nodiscard]] size_t size( ) const {
+			return ( m_range.size( ) + m_chunk_size - 1 ) / m_chunk_size;
+		}
+
+		[[nodiscard]] bool empty( ) const {
+			return m_range.empty( );
+		}
+
+		[[nodiscard]] daw::view<Iterator> operator[]( size_t n ) const {
+			assert( n < size( ) );
+			auto const first = n * m_chunk_size;
+			auto const last = std::min( first + m_chunk_size, m_range.size( ) );
+			return { std::next( m_range.begin( ), static_cast<ptrdiff_t>( first ) ),
+			         std::next( m_range.begin( ), static_cast<ptrdiff_t>( last ) ) };
+		}
+	};
+
+	template<typename>
+	inline constexpr bool is_lazy_ranges_v = false;
+
+	template<typename Iterator>
+	inline constexpr bool is_lazy_ranges_v<lazy_ranges<Iterator>> = true;
+
+	/// Lazy binary splitting.  Work is cut in half only while a worker is idle
+	/// or has nothing to steal, so tiny inputs stay in one task and uneven per
+	/// item costs are balanced at run time.  MinRangeSize is the chunk size
+	/// that is never split further
+	template<size_t MinRangeSize = 1024>
+	struct [[nodiscard]] split_lazy_t {
+		static_assert( MinRangeSize != 0, "Minimum range size must be > 0" );
+		static inline constexpr size_t min_range_size = MinRangeSize;
+
+		template<typename Iterator>
+		[[nodiscard]] lazy_ranges<Iterator> operator( )( Iterator first,
+		                                                 Iterator last,
+		                                                 size_t ) const {
+			return lazy_ranges<Iterator>( daw::view<Iterator>( first, last ),
+			                              MinRangeSize );
+		}
+
+		template<typename Iterator>
+		[[nodiscard]] lazy_ranges<Iterator>
+		operator( )( daw::view<Iterator> rng, size_t const max_parts ) const {
+			return operator( )( rng.begin( ), rng.end( ), max_parts );
+		}
+	};
+
+	/// Run func( ranges[n], n ) for n in [first, last), handing the back half
+	/// to a new task whenever the scheduler wants more tasks.  Stops early once
+	/// a task of the group has thrown
+	template<typename Iterator, typename Func>
+	void run_lazy_split( lazy_ranges<Iterator> const &ranges, size_t first,
+	                     size_t last, Func const &func, daw::shared_latch sem,
+	                     task_scheduler ts ) {
+		while( first < last and not sem.has_exception( ) ) {
+			if( last - first >= 2 and ts.wants_more_tasks( ) ) {
+				auto const mid = first + ( last - first ) / 2;
+				sem.add_notifier( );
+				if( schedule_task(
+				      sem,
+				      [ranges, mid, last, func, sem, ts]( ) {
+					      run_lazy_split( ranges, mid, last, func, sem, ts );
+				      },
+				      ts ) ) {
+					last = mid;
+					continue;
+				}
+				// Could not add the task, keep the work ourselves
+				sem.notify( );
+			}
+			func( ranges[first], first );
+			++first;
+		}
+	}
+
 	template<typename RandomIterator, typename Func>
 	[[nodiscard]] daw::shared_latch
-	partition_range( std::vector<daw::view<RandomIterator>> ranges, Func &&func,
+	partition_range_pos( lazy_ranges<RandomIterator> const &ranges, Func func,
+	                     task_scheduler ts, size_t const start_pos = 0 ) {
+		if( start_pos >= ranges.size( ) ) {
+			return daw::shared_latch( 0 );
+		}
+		auto sem = daw::shared_latch( 1 );
+		if( not schedule_task(
+		      sem,
+		      [ranges, start_pos, func = daw::move( func ), sem, ts]( ) {
+			      run_lazy_split( ranges, start_pos, ranges.size( ), func, sem, ts );
+		      },
+		      ts ) ) {
+			throw ::daw::unable_to_add_task_exception{ };
+		}
+		return sem;
+	}
+
+	template<typename RandomIterator, typename Func>
+	[[nodiscard]] daw::shared_latch
+	partition_range( lazy_ranges<RandomIterator> const &ranges, Func &&func,
 	                 task_scheduler ts ) {
-		auto sem = daw::shared_latch( ranges.size( ) );
-		for( auto rng : ranges ) {
-			if( not schedule_task(
-			      sem,
-			      [func = daw::mutable_capture( func ), rng = daw::move( rng )]( ) {
-				      ( *func )( rng );
-			      },
-			      ts ) ) {
+		return partition_range_pos(
+		  ranges,
+		  [func = daw::mutable_capture( std::forward<Func>( func ) )](
+		    daw::view<RandomIterator> rng, size_t ) { ( *func )( rng ); },
+		  daw::move( ts ) );
+	}
 
-				throw ::daw::unable_to_add_task_exception{};
-			}
+	template<typename RandomIterator, typename Func>
+	[[nodiscard]] daw::shared_latch
+	partition_range( std::vector<daw::view<RandomIterator>> ranges, Func &&func,
+	                 task_scheduler ts ) {
+		auto const make_task = [&]( size_t n ) {
+			return [func = daw::mutable_capture( func ), rng = ranges[n], n]( ) {
+				auto const span =
+				  trace_span( "partition_range", static_cast<std::int64_t>( n ) );
+				( *func )( rng );
+			};
+		};
+		auto tasks = std::vector<decltype( make_task( 0 ) )>( );
+		tasks.reserve( ranges.size( ) );
+		for( size_t n = 0; n < ranges.size( ); ++n ) {
+			tasks.push_back( make_task( n ) );
 		}
+		auto sem = daw::shared_latch( ranges.size( ) );
+		// Tasks that could not be added leave their exception in sem, as some
+		// may already be running it cannot be thrown here
+		(void)ts.add_tasks( daw::move( tasks ), sem );
 		return sem;
 	}
 
 	template<typename RandomIterator, typename Func>
 	[[nodiscard]] daw::shared_latch
 	partition_range_pos( std::vector<daw::view<RandomIterator>> ranges, Func func,
-	                     task_scheduler ts,
-	                     size_t const start_pos = 0 ) noexcept {
-		auto sem = daw::shared_latch( 0 );
+	                     task_scheduler ts, size_t const start_pos = 0 ) {
+		if( start_pos >= ranges.size( ) ) {
+			return daw::shared_latch( 0 );
+		}
+		auto const make_task = [&]( size_t n ) {
+			return [func = daw::mutable_capture( func ), rng = ranges[n], n]( ) {
+				auto const span =
+				  trace_span( "partition_range", static_cast<std::int64_t>( n ) );
+				( *func )( rng, n );
+			};
+		};
+		auto tasks = std::vector<decltype( make_task( 0 ) )>( );
+		tasks.reserve( ranges.size( ) - start_pos );
 		for( size_t n = start_pos; n < ranges.size( ); ++n ) {
-			sem.add_notifier( );
-			try {
-				if( not schedule_task(
-				      sem,
-				      [func = daw::mutable_capture( func ), rng = ranges[n], n]( ) {
-					      ( *func )( rng, n );
-				      },
-				      ts ) ) {
-
-					// Unable to add task, consider a better error mechanism like optional
-					// with the latch reduced to match the number of items
-					sem.notify( );
-					std::abort( );
-				}
-			} catch( ... ) {
-				// Unable to add task, consider a better error mechanism like optional
-				// with the latch reduced to match the number of items
-				sem.notify( );
-				std::abort( );
-			}
+			tasks.push_back( make_task( n ) );
 		}
+		auto sem = daw::shared_latch( ranges.size( ) - start_pos );
+		// As in partition_range, a failure to add is reported through sem
+		(void)ts.add_tasks( daw::move( tasks ), sem );
 		return sem;
 	}
 
 	template<typename PartitionPolicy, typename RandomIterator, typename Func>
 	[[nodiscard]] daw::shared_latch
 	partition_range( daw::view<RandomIterator> range, Func &&func,
-	                 task_scheduler ts ) noexcept {
+	                 task_scheduler ts ) {
 		if( range.empty( ) ) {
 			return {};
 		}
 		auto const ranges = PartitionPolicy{}( range, ts.size( ) );
-		auto sem = daw::shared_latch( 0 );
-		for( auto rng : ranges ) {
-			sem.add_notifier( );
-			try {
-				if( not schedule_task(
+		if constexpr( is_lazy_ranges_v<daw::remove_cvref_t<decltype( ranges )>> ) {
+			return partition_range_pos(
+			  ranges,
+			  [func = daw::mutable_capture( std::forward<Func>( func ) )](
+			    daw::view<RandomIterator> rng, size_t ) {
+				  ( *func )( rng.begin( ), rng.end( ) );
+			  },
+			  daw::move( ts ) );
+		} else {
+			auto sem = daw::shared_latch( 0 );
+			for( size_t n = 0; n < ranges.size( ); ++n ) {
+				sem.add_notifier( );
+				try {
+					if( not schedule_partition_task(
+					      sem,
+					      [func = daw::mutable_capture( std::forward<Func>( func ) ),
+					       rng = ranges[n]]( ) { ( *func )( rng.begin( ), rng.end( ) ); },
+					      n, ranges.size( ), ts ) ) {
+						throw ::daw::unable_to_add_task_exception{ };
+					}
+				} catch( ... ) {
+					// Earlier partitions may be running, so the waiter rethrows this
+					// once they are done
+					sem.set_exception( std::current_exception( ) );
+					sem.notify( );
+					break;
+				}
+			}
+			return sem;
+		}
+	}
+
+	/// As run_lazy_split, for the latch of run_partition_range_pos.  The
+	/// caller waits for every task, so they refer to its ranges, func, latch
+	/// and scheduler instead of sharing copies of them
+	template<typename Iterator, typename Func>
+	void run_lazy_split_on( lazy_ranges<Iterator> const &ranges, size_t first,
+	                        size_t last, Func const &func, daw::latch &sem,
+	                        task_scheduler &ts ) {
+		while( first < last and not sem.has_exception( ) ) {
+			if( last - first >= 2 and ts.wants_more_tasks( ) ) {
+				auto const mid = first + ( last - first ) / 2;
+				sem.add_notifier( );
+				if( daw::impl::schedule_task_on(
 				      sem,
-				      [func = daw::mutable_capture( std::forward<Func>( func ) ),
-				       rng]( ) { ( *func )( rng.begin( ), rng.end( ) ); },
+				      [&ranges, mid, last, &func, &sem, &ts]( ) {
+					      run_lazy_split_on( ranges, mid, last, func, sem, ts );
+				      },
 				      ts ) ) {
-
-					sem.notify( );
-					::std::abort( );
+					last = mid;
+					continue;
 				}
-			} catch( ... ) {
+				// Could not add the task, keep the work ourselves
 				sem.notify( );
-				::std::abort( );
 			}
+			func( ranges[first], first );
+			++first;
+		}
+	}
+
+	/// Run func( ranges[n], n ) for each n from start_pos and wait for them.
+	/// This is run_partition_range_pos( ... ) with the latch on our
+	/// stack, counted once up front, so the tasks do not touch a shared
+	/// reference count as they start and finish
+	template<typename RandomIterator, typename Func>
+	void run_partition_range_pos( lazy_ranges<RandomIterator> const &ranges,
+	                              Func func, task_scheduler &ts,
+	                              size_t const start_pos = 0 ) {
+		if( start_pos >= ranges.size( ) ) {
+			return;
+		}
+		auto sem = daw::latch( 1 );
+		if( not daw::impl::schedule_task_on(
+		      sem,
+		      [&]( ) {
+			      run_lazy_split_on( ranges, start_pos, ranges.size( ), func, sem,
+			                         ts );
+		      },
+		      ts ) ) {
+			throw ::daw::unable_to_add_task_exception{ };
+		}
+		ts.wait_for( sem );
+	}
+
+	template<typename RandomIterator, typename Func>
+	void
+	run_partition_range_pos( std::vector<daw::view<RandomIterator>> const &ranges,
+	                         Func func, task_scheduler &ts,
+	                         size_t const start_pos = 0 ) {
+		if( start_pos >= ranges.size( ) ) {
+			return;
+		}
+		auto const make_task = [&]( size_t n ) {
+			return [func = daw::mutable_capture( func ), rng = ranges[n], n]( ) {
+				auto const span =
+				  trace_span( "partition_range", static_cast<std::int64_t>( n ) );
+				( *func )( rng, n );
+			};
+		};
+		auto tasks = std::vector<decltype( make_task( 0 ) )>( );
+		tasks.reserve( ranges.size( ) - start_pos );
+		for( size_t n = start_pos; n < ranges.size( ); ++n ) {
+			tasks.push_back( make_task( n ) );
+		}
+		auto sem = daw::latch( ranges.size( ) - start_pos );
+		// As in partition_range, a failure to add is reported through sem
+		(void)ts.add_tasks( daw::move( tasks ), sem );
+		ts.wait_for( sem );
+	}
+
+	/// Run func( rng ) for each of ranges and wait for them, as
+	/// run_partition_range_pos
+	template<typename Ranges, typename Func>
+	void run_partition_range( Ranges const &ranges, Func &&func,
+	                          task_scheduler &ts ) {
+		run_partition_range_pos(
+		  ranges,
+		  [func = daw::mutable_capture( std::forward<Func>( func ) )](
+		    auto rng, size_t ) { ( *func )( rng ); },
+		  ts );
+	}
+
+	/// Split range with PartitionPolicy, run func( first, last ) for each part
+	/// and wait for them, as run_partition_range_pos
+	template<typename PartitionPolicy, typename RandomIterator, typename Func>
+	void run_partition_range( daw::view<RandomIterator> range, Func &&func,
+	                          task_scheduler &ts ) {
+		if( range.empty( ) ) {
+			return;
+		}
+		auto const ranges = PartitionPolicy{}( range, ts.size( ) );
+		if constexpr( is_lazy_ranges_v<daw::remove_cvref_t<decltype( ranges )>> ) {
+			run_partition_range_pos(
+			  ranges,
+			  [func = daw::mutable_capture( std::forward<Func>( func ) )](
+			    daw::view<RandomIterator> rng, size_t ) {
+				  ( *func )( rng.begin( ), rng.end( ) );
+			  },
+			  ts );
+		} else {
+			auto sem = daw::latch( ranges.size( ) );
+			for( size_t n = 0; n < ranges.size( ); ++n ) {
+				try {
+					if( not daw::impl::schedule_partition_task_on(
+					      sem,
+					      [func = daw::mutable_capture( func ), rng = ranges[n]]( ) {
+						      ( *func )( rng.begin( ), rng.end( ) );
+					      },
+					      n, ranges.size( ), ts ) ) {
+						throw ::daw::unable_to_add_task_exception{ };
+					}
+				} catch( ... ) {
+					// Earlier partitions may be running, so the waiter rethrows this
+					// once they are done.  The partitions not added never notify
+					sem.set_exception( std::current_exception( ) );
+					for( size_t m = n; m < ranges.size( ); ++m ) {
+						sem.notify( );
+					}
+					break;
+				}
+			}
+			ts.wait_for( sem );
 		}
-		return sem;
 	}
 
 	template<typename PartitionPolicy = split_range_t<>, typename RandomIterator,
 	         typename Func>
 	void parallel_for_each( daw::view<RandomIterator> rng, Func &&func,
-	                        task_scheduler ts ) {
+	                        task_scheduler ts, cost_hint hint = cost_hint{ } ) {
 
 		static_assert( std::is_invocable_v<Func, decltype( rng.front( ) )> );
+		using value_t = typename std::iterator_traits<RandomIterator>::value_type;
+		if( should_run_inline<value_t>( rng.size( ), hint, ts ) ) {
+			for( auto it = rng.begin( ); it != rng.end( ); ++it ) {
+				func( *it );
+			}
+			return;
+		}
 
-		ts.wait_for( partition_range<PartitionPolicy>(
+		run_partition_range<PartitionPolicy>(
 		  rng,
 		  [func = daw::mutable_capture( std::forward<Func>( func ) )](
 		    auto &&first, auto &&last ) {
@@ -186,29 +471,192 @@ namespace daw::algorithm::parallel::impl {
 				  ++first;
 			  }
 		  },
-		  ts ) );
+		  ts );
+	}
+
+	/// Workers used by the memory bound algorithms, at most
+	/// ts.bandwidth_workers_per_node( ) on each NUMA node
+	[[nodiscard]] inline size_t
+	bandwidth_worker_count( task_scheduler const &ts ) {
+		auto const per_node = ts.bandwidth_workers_per_node( );
+		if( per_node == 0U ) {
+			return std::max<size_t>( 1U, ts.size( ) );
+		}
+		auto const nodes = daw::parallel::cpu_topology::get( ).node_count( );
+		return std::max<size_t>( 1U, std::min( ts.size( ), nodes * per_node ) );
+	}
+
+	/// Items per chunk when each item reads and writes item_bytes, so that a
+	/// chunk takes up half of the L2 cache
+	[[nodiscard]] inline size_t cache_chunk_size( size_t item_bytes ) {
+		auto const bytes = daw::parallel::cpu_cache_sizes( ).l2 / 2U;
+		return std::max<size_t>( 1U, bytes / std::max<size_t>( 1U, item_bytes ) );
+	}
+
+	/// Outputs written a chunk at a time by the memory bound algorithms, and
+	/// with streamed stores when large
+	template<typename Iterator>
+	inline constexpr bool is_bandwidth_range_v =
+	  simd::is_contiguous_iterator_v<Iterator> and
+	  streaming::is_streamable_v<
+	    typename std::iterator_traits<Iterator>::value_type>;
+
+	/// Streamed stores only pay off once count items of T are too many to
+	/// stay in the last level cache
+	template<typename T>
+	[[nodiscard]] bool should_stream( size_t count ) {
+		return streaming::streaming_stores_enabled and
+		       count >= daw::parallel::cpu_cache_sizes( ).llc / sizeof( T );
+	}
+
+	/// Run func( first, last ) over the indices [0, count) in chunks of
+	/// chunk_size.  At most bandwidth_worker_count( ts ) tasks, the caller
+	/// being one of them, take the chunks in turn
+	template<typename Func>
+	void run_bandwidth_bound( size_t count, size_t chunk_size, Func const &func,
+	                          task_scheduler &ts ) {
+		auto const chunk_count = ( count + chunk_size - 1U ) / chunk_size;
+		auto const workers = std::min( chunk_count, bandwidth_worker_count( ts ) );
+		auto next_chunk = std::atomic_size_t( 0U );
+		auto sem = daw::latch( workers );
+		auto const work = [&]( ) {
+			for( auto chunk = next_chunk.fetch_add( 1U, std::memory_order_relaxed );
+			     chunk < chunk_count and not sem.has_exception( );
+			     chunk = next_chunk.fetch_add( 1U, std::memory_order_relaxed ) ) {
+				auto const first = chunk * chunk_size;
+				func( first, std::min( first + chunk_size, count ) );
+			}
+		};
+		for( size_t n = 1; n < workers; ++n ) {
+			try {
+				if( not daw::impl::schedule_task_on( sem, work, ts ) ) {
+					// The workers that did start take its chunks
+					sem.notify( );
+				}
+			} catch( ... ) {
+				sem.set_exception( std::current_exception( ) );
+				sem.notify( );
+			}
+		}
+		daw::impl::run_group_task( sem, work );
+		sem.notify( );
+		ts.wait_for( sem );
+	}
+
+	/// Fill each part with std::fill, which compilers turn into vector stores
+	/// or memset, rather than assigning one item per call.  Contiguous ranges
+	/// are filled in cache sized chunks by as many workers as the memory
+	/// bandwidth needs, with streamed stores when too big for the cache
+	template<typename PartitionPolicy = split_range_t<>, typename RandomIterator,
+	         typename T>
+	void parallel_fill( daw::view<RandomIterator> rng, T const &value,
+	                    task_scheduler ts, cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<RandomIterator>::value_type;
+		if( should_run_inline<value_t>( rng.size( ), hint, ts ) ) {
+			std::fill( rng.begin( ), rng.end( ), value );
+			return;
+		}
+		if constexpr( std::is_same_v<PartitionPolicy, split_range_t<>> and
+		              is_bandwidth_range_v<RandomIterator> and
+		              ( std::is_same_v<T, value_t> or
+		                ( std::is_arithmetic_v<T> and
+		                  std::is_arithmetic_v<value_t> ) ) ) {
+			auto *const out = simd::data_of( rng.begin( ) );
+			auto const item = static_cast<value_t>( value );
+			bool const stream = should_stream<value_t>( rng.size( ) );
+			run_bandwidth_bound(
+			  rng.size( ), cache_chunk_size( sizeof( value_t ) ),
+			  [out, stream, &item]( size_t first, size_t last ) {
+				  if( stream ) {
+					  auto gen = [&item]( size_t ) -> value_t const & { return item; };
+					  streaming::generate( out + first, last - first, gen );
+					  streaming::fence( );
+				  } else {
+					  std::fill( out + first, out + last, item );
+				  }
+			  },
+			  ts );
+		} else {
+			run_partition_range<PartitionPolicy>(
+			  rng,
+			  [&value]( RandomIterator first, RandomIterator last ) {
+				  std::fill( first, last, value );
+			  },
+			  ts );
+		}
+	}
+
+	/// Copy range to first_out, which must not overlap it.  Ranges of the
+	/// same trivially copyable type are copied as memory bound, like
+	/// parallel_fill
+	template<typename Iterator, typename OutputIterator>
+	OutputIterator parallel_copy( daw::view<Iterator> range,
+	                              OutputIterator first_out, task_scheduler ts,
+	                              cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		using out_t = typename std::iterator_traits<OutputIterator>::value_type;
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			return std::copy( range.begin( ), range.end( ), first_out );
+		}
+		if constexpr( simd::is_contiguous_iterator_v<Iterator> and
+		              simd::is_contiguous_iterator_v<OutputIterator> and
+		              std::is_same_v<value_t, out_t> and
+		              std::is_trivially_copyable_v<value_t> ) {
+			auto const *const in = simd::data_of( range.begin( ) );
+			auto *const out = simd::data_of( first_out );
+			bool const stream = should_stream<value_t>( range.size( ) );
+			run_bandwidth_bound(
+			  range.size( ), cache_chunk_size( 2U * sizeof( value_t ) ),
+			  [in, out, stream]( size_t first, size_t last ) {
+				  if( stream ) {
+					  streaming::copy_bytes( out + first, in + first,
+					                         ( last - first ) * sizeof( value_t ) );
+					  streaming::fence( );
+				  } else {
+					  std::copy( in + first, in + last, out + first );
+				  }
+			  },
+			  ts );
+		} else {
+			run_partition_range<split_range_t<>>(
+			  range,
+			  [first_in = range.begin( ), first_out]( Iterator first,
+			                                          Iterator last ) {
+				  std::copy( first, last,
+				             std::next( first_out, std::distance( first_in, first ) ) );
+			  },
+			  ts );
+		}
+		return std::next( first_out, static_cast<ptrdiff_t>( range.size( ) ) );
 	}
 
 	template<typename Ranges, typename Func>
 	void parallel_for_each( Ranges &ranges, Func func, task_scheduler ts ) {
-		ts.wait_for( partition_range(
+		run_partition_range(
 		  ranges,
 		  [func]( auto f, auto l ) mutable {
 			  for( auto it = f; it != l; ++it ) {
 				  func( *it );
 			  }
 		  },
-		  ts ) );
+		  ts );
 	}
 
 	template<typename PartitionPolicy = split_range_t<>, typename RandomIterator,
 	         typename Func>
 	void parallel_for_each_index( RandomIterator first, RandomIterator last,
-	                              Func func, task_scheduler ts ) {
+	                              Func func, task_scheduler ts,
+	                              cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<RandomIterator>::value_type;
+		auto const sz = static_cast<size_t>( std::distance( first, last ) );
+		if( should_run_inline<value_t>( sz, hint, ts ) ) {
+			for( size_t n = 0; n < sz; ++n ) {
+				func( n );
+			}
+			return;
+		}
 		auto const ranges = PartitionPolicy{}( first, last, ts.size( ) );
-		auto sem = daw::shared_latch( ranges.size( ) );
-		Unused( sem );
-		partition_range(
+		run_partition_range(
 		  ranges,
 		  [func, first]( auto rng ) {
 			  auto const start_pos =
@@ -219,8 +667,34 @@ namespace daw::algorithm::parallel::impl {
 				  func( n );
 			  }
 		  },
-		  ts )
-		  .wait( );
+		  ts );
+	}
+
+	/// Run func( tile ) for the tiles of shape covering space.  Workers take
+	/// runs of tiles that are next to each other in order, split lazily as in
+	/// split_lazy_t
+	template<std::size_t N, typename Func>
+	void parallel_for_each_tile( extents<N> const &space,
+	                             extents<N> const &shape, Func func,
+	                             tile_order order, task_scheduler ts ) {
+		auto const tiles = make_tiles( space, shape, order );
+		if( tiles.empty( ) ) {
+			return;
+		}
+		if( tiles.size( ) == 1U or ts.size( ) < 2U ) {
+			for( auto const &tile : tiles ) {
+				func( tile );
+			}
+			return;
+		}
+		run_partition_range_pos(
+		  lazy_ranges( daw::view( tiles.begin( ), tiles.end( ) ), 1U ),
+		  [&func]( auto rng, size_t ) {
+			  for( auto const &tile : rng ) {
+				  func( tile );
+			  }
+		  },
+		  ts );
 	}
 
 	template<typename Compare>
@@ -264,39 +738,392 @@ namespace daw::algorithm::parallel::impl {
 	template<typename Compare>
 	parallel_sort_merger( Compare cmp )->parallel_sort_merger<Compare>;
 
-	template<typename PartitionPolicy = split_fixed_t<>, typename Iterator,
+	/// How many of the first k items of the merge of the sorted ranges
+	/// [a, a + a_size) and [b, b + b_size) come from a.  Ties go to a, so a
+	/// merge cut up this way is still stable
+	template<typename Iterator, typename Compare>
+	[[nodiscard]] size_t merge_co_rank( size_t const k, Iterator a,
+	                                    size_t const a_size, Iterator b,
+	                                    size_t const b_size, Compare &cmp ) {
+		auto lo = k > b_size ? k - b_size : size_t{ 0 };
+		auto hi = std::min( k, a_size );
+		while( lo < hi ) {
+			auto const i = lo + ( hi - lo ) / 2;
+			auto const j = k - i;
+			if( j > 0 and i < a_size and
+			    not cmp( b[static_cast<ptrdiff_t>( j - 1 )],
+			             a[static_cast<ptrdiff_t>( i )] ) ) {
+				// b[j - 1] does not sort before a[i], so a[i] is in the first k
+				lo = i + 1;
+			} else {
+				hi = i;
+			}
+		}
+		return lo;
+	}
+
+	/// Merge each pair of neighbouring sorted runs in src into the same
+	/// positions of dst.  bounds holds the run boundaries and is updated to the
+	/// merged runs.  Merges are cut into pieces of about piece_size items by
+	/// co-ranking, so the last merge of two halves still uses every worker
+	template<typename Iterator, typename OutputIterator, typename Compare>
+	void parallel_merge_pass( Iterator src, OutputIterator dst,
+	                          std::vector<size_t> &bounds,
+	                          size_t const piece_size, Compare const &cmp,
+	                          task_scheduler &ts ) {
+		struct merge_piece_t {
+			size_t first;
+			size_t mid;
+			size_t last;
+			size_t k_first;
+			size_t k_last;
+		};
+		auto pieces = std::vector<merge_piece_t>( );
+		auto merged_bounds = std::vector<size_t>( );
+		merged_bounds.reserve( bounds.size( ) / 2U + 1U );
+		merged_bounds.push_back( 0 );
+		for( size_t r = 0; r + 1U < bounds.size( ); r += 2U ) {
+			auto const first = bounds[r];
+			auto const mid = bounds[r + 1U];
+			// An odd run out is merged with nothing, a copy
+			auto const last = r + 2U < bounds.size( ) ? bounds[r + 2U] : mid;
+			for( size_t k = 0; k < last - first; k += piece_size ) {
+				pieces.push_back(
+				  { first, mid, last, k, std::min( k + piece_size, last - first ) } );
+			}
+			merged_bounds.push_back( last );
+		}
+		auto sem = daw::latch( pieces.size( ) );
+		for( auto const &piece : pieces ) {
+			if( not daw::impl::schedule_task_on(
+			      sem,
+			      [piece, src, dst, cmp = daw::mutable_capture( cmp )]( ) {
+				      auto const a =
+				        std::next( src, static_cast<ptrdiff_t>( piece.first ) );
+				      auto const a_size = piece.mid - piece.first;
+				      auto const b =
+				        std::next( src, static_cast<ptrdiff_t>( piece.mid ) );
+				      auto const b_size = piece.last - piece.mid;
+				      auto const i_first =
+				        merge_co_rank( piece.k_first, a, a_size, b, b_size, *cmp );
+				      auto const i_last =
+				        merge_co_rank( piece.k_last, a, a_size, b, b_size, *cmp );
+				      auto const j_first = piece.k_first - i_first;
+				      auto const j_last = piece.k_last - i_last;
+				      std::merge(
+				        std::make_move_iterator(
+				          std::next( a, static_cast<ptrdiff_t>( i_first ) ) ),
+				        std::make_move_iterator(
+				          std::next( a, static_cast<ptrdiff_t>( i_last ) ) ),
+				        std::make_move_iterator(
+				          std::next( b, static_cast<ptrdiff_t>( j_first ) ) ),
+				        std::make_move_iterator(
+				          std::next( b, static_cast<ptrdiff_t>( j_last ) ) ),
+				        std::next( dst, static_cast<ptrdiff_t>( piece.first +
+				                                                piece.k_first ) ),
+				        *cmp );
+			      },
+			      ts ) ) {
+				// Pieces already added may be running, release the rest and let
+				// wait_for rethrow once they finish
+				sem.set_exception(
+				  std::make_exception_ptr( unable_to_add_task_exception{ } ) );
+				auto const added = static_cast<size_t>( &piece - pieces.data( ) );
+				for( size_t n = added; n < pieces.size( ); ++n ) {
+					sem.notify( );
+				}
+				break;
+			}
+		}
+		ts.wait_for( sem );
+		bounds = daw::move( merged_bounds );
+	}
+
+	/// Move the items at the same positions as ranges from scratch back
+	/// into the ranges, one task per range
+	template<typename Iterator, typename ScratchIterator>
+	void move_from_scratch( std::vector<daw::view<Iterator>> const &ranges,
+	                        Iterator first, ScratchIterator scratch,
+	                        task_scheduler &ts ) {
+		run_partition_range_pos(
+		  ranges,
+		  [first, scratch]( daw::view<Iterator> rng, size_t ) {
+			  auto const pos = std::distance( first, rng.begin( ) );
+			  std::move( std::next( scratch, pos ),
+			             std::next( scratch, pos + std::distance( rng.begin( ),
+			                                                      rng.end( ) ) ),
+			             rng.begin( ) );
+		  },
+		  ts );
+	}
+
+	/// Sort the runs given by PartitionPolicy in parallel, then merge them
+	/// pairwise with parallel_merge_pass, moving between range and scratch.
+	/// scratch must have room for range.size( ) items
+	template<typename PartitionPolicy = split_range_t<4096>, typename Iterator,
+	         typename ScratchIterator, typename Sort, typename Compare>
+	void parallel_sort( daw::view<Iterator> range, ScratchIterator scratch,
+	                    Sort &&srt, Compare &&cmp, task_scheduler ts ) {
+		if( PartitionPolicy::min_range_size > range.size( ) or ts.size( ) < 2U ) {
+			srt( range.begin( ), range.end( ), cmp );
+			return;
+		}
+		auto const ranges = PartitionPolicy( )( range, ts.size( ) );
+		auto bounds = std::vector<size_t>( );
+		bounds.reserve( ranges.size( ) + 1U );
+		bounds.push_back( 0 );
+		for( auto const &rng : ranges ) {
+			bounds.push_back(
+			  static_cast<size_t>( std::distance( range.begin( ), rng.end( ) ) ) );
+		}
+
+		run_partition_range_pos(
+		  ranges,
+		  [cmp = daw::mutable_capture( cmp ),
+		   srt = daw::mutable_capture( std::forward<Sort>( srt ) )](
+		    daw::view<Iterator> rng, size_t ) {
+			  ( *srt )( rng.begin( ), rng.end( ), *cmp );
+		  },
+		  ts );
+
+		auto const piece_size =
+		  std::max( PartitionPolicy::min_range_size,
+		            ( range.size( ) + ts.size( ) - 1U ) / ts.size( ) );
+		bool in_scratch = false;
+		std::int64_t level = 0;
+		while( bounds.size( ) > 2U ) {
+			auto const span = trace_span( "parallel_sort merge", level++ );
+			if( in_scratch ) {
+				parallel_merge_pass( scratch, range.begin( ), bounds, piece_size, cmp,
+				                     ts );
+			} else {
+				parallel_merge_pass( range.begin( ), scratch, bounds, piece_size, cmp,
+				                     ts );
+			}
+			in_scratch = not in_scratch;
+		}
+		if( in_scratch ) {
+			move_from_scratch( ranges, range.begin( ), scratch, ts );
+		}
+	}
+
+	template<typename PartitionPolicy = split_range_t<4096>, typename Iterator,
 	         typename Sort, typename Compare>
 	void parallel_sort( daw::view<Iterator> range, Sort &&srt, Compare &&cmp,
 	                    task_scheduler ts ) {
-		if( PartitionPolicy::min_range_size > range.size( ) ) {
+		if( PartitionPolicy::min_range_size > range.size( ) or ts.size( ) < 2U ) {
 			srt( range.begin( ), range.end( ), cmp );
 			return;
 		}
-		auto ranges = PartitionPolicy( )( range, ts.size( ) );
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if constexpr( std::is_default_constructible_v<value_t> ) {
+			// Default initialized, trivial types are left as is
+			auto scratch = std::unique_ptr<value_t[]>( new value_t[range.size( )] );
+			parallel_sort<PartitionPolicy>( range, scratch.get( ),
+			                                std::forward<Sort>( srt ),
+			                                std::forward<Compare>( cmp ), ts );
+		} else {
+			auto ranges = PartitionPolicy( )( range, ts.size( ) );
+
+			auto sorters = std::vector<future_result_t<daw::view<Iterator>>>( );
+			sorters.reserve( ranges.size( ) );
+
+			auto const sort_fn =
+			  [cmp = mutable_capture( cmp ),
+			   srt = mutable_capture( std::forward<Sort>( srt ) )](
+			    daw::view<Iterator> r ) {
+				  ( *srt )( r.begin( ), r.end( ), *cmp );
+				  return r;
+			  };
+
+			daw::algorithm::transform(
+			  ranges.begin( ), ranges.end( ), std::back_inserter( sorters ),
+			  [ts = daw::mutable_capture( ts ), sort_fn]( daw::view<Iterator> rng ) {
+				  return make_future_result( *ts, sort_fn, rng );
+			  } );
+			auto sem = reduce_futures( sorters.begin( ), sorters.end( ),
+			                           parallel_sort_merger{ cmp } );
+			ts.wait_for( sem );
+		}
+	}
+
+	/// Map an arithmetic key to an unsigned integer with the same order.
+	/// Negative numbers have their sign bit flipped, negative floating point
+	/// numbers all their bits, so -0.0 sorts before 0.0 and NaNs sort to the
+	/// end matching their sign
+	template<typename Key>
+	[[nodiscard]] auto to_radix_key( Key key ) noexcept {
+		static_assert( std::is_arithmetic_v<Key>,
+		               "radix_sort keys must be integral or floating point" );
+		if constexpr( std::is_floating_point_v<Key> ) {
+			using uint_t =
+			  std::conditional_t<sizeof( Key ) == sizeof( uint32_t ), uint32_t,
+			                     uint64_t>;
+			static_assert( sizeof( Key ) == sizeof( uint_t ),
+			               "Only 32 and 64 bit floating point keys are supported" );
+			constexpr auto sign_bit = uint_t{ 1 } << ( sizeof( uint_t ) * 8U - 1U );
+			uint_t bits = 0;
+			std::memcpy( &bits, &key, sizeof( Key ) );
+			if( ( bits & sign_bit ) != 0 ) {
+				return static_cast<uint_t>( ~bits );
+			}
+			return static_cast<uint_t>( bits | sign_bit );
+		} else if constexpr( std::is_signed_v<Key> ) {
+			using uint_t = std::make_unsigned_t<Key>;
+			constexpr auto sign_bit = static_cast<uint_t>(
+			  uint_t{ 1 } << ( sizeof( uint_t ) * 8U - 1U ) );
+			return static_cast<uint_t>( static_cast<uint_t>( key ) ^ sign_bit );
+		} else {
+			return key;
+		}
+	}
 
-		auto sorters = std::vector<future_result_t<daw::view<Iterator>>>( );
-		sorters.reserve( ranges.size( ) );
+	struct radix_identity_key {
+		template<typename T>
+		[[nodiscard]] constexpr T const &operator( )( T const &value ) const
+		  noexcept {
+			return value;
+		}
+	};
+
+	using radix_histogram_t = std::array<size_t, 256>;
+
+	/// One LSD pass of radix_sort on the 8 bit digit given by digit_of.  Each
+	/// range counts its digits, the counts are turned into output offsets by
+	/// digit then range, and each range scatters its items into dst.  Returns
+	/// false, having moved nothing, when every item has the same digit
+	template<typename Iterator, typename SrcIterator, typename DstIterator,
+	         typename DigitOf>
+	[[nodiscard]] bool
+	radix_scatter_pass( std::vector<daw::view<Iterator>> const &ranges,
+	                    Iterator first, SrcIterator src, DstIterator dst,
+	                    DigitOf const &digit_of,
+	                    std::vector<radix_histogram_t> &histograms,
+	                    task_scheduler &ts ) {
+
+		run_partition_range_pos(
+		  ranges,
+		  [&]( daw::view<Iterator> rng, size_t n ) {
+			  auto &histogram = histograms[n];
+			  histogram.fill( 0 );
+			  auto it = std::next( src, std::distance( first, rng.begin( ) ) );
+			  auto const last =
+			    std::next( it, std::distance( rng.begin( ), rng.end( ) ) );
+			  for( ; it != last; ++it ) {
+				  ++histogram[digit_of( *it )];
+			  }
+		  },
+		  ts );
 
-		auto const sort_fn = [cmp = mutable_capture( cmp ),
-		                      srt = mutable_capture( std::forward<Sort>( srt ) )](
-		                       daw::view<Iterator> r ) {
-			( *srt )( r.begin( ), r.end( ), *cmp );
-			return r;
+		auto const item_count =
+		  static_cast<size_t>( std::distance( first, ranges.back( ).end( ) ) );
+		auto offset = size_t{ 0 };
+		for( size_t digit = 0; digit < std::tuple_size_v<radix_histogram_t>;
+		     ++digit ) {
+			auto const digit_first = offset;
+			for( auto &histogram : histograms ) {
+				auto const count = histogram[digit];
+				histogram[digit] = offset;
+				offset += count;
+			}
+			if( digit_first == 0 and offset == item_count ) {
+				// Every item has this digit, nothing would move
+				return false;
+			}
+		}
+
+		run_partition_range_pos(
+		  ranges,
+		  [&]( daw::view<Iterator> rng, size_t n ) {
+			  auto offsets = histograms[n];
+			  auto it = std::next( src, std::distance( first, rng.begin( ) ) );
+			  auto const last =
+			    std::next( it, std::distance( rng.begin( ), rng.end( ) ) );
+			  for( ; it != last; ++it ) {
+				  auto &pos = offsets[digit_of( *it )];
+				  *std::next( dst, static_cast<ptrdiff_t>( pos ) ) = daw::move( *it );
+				  ++pos;
+			  }
+		  },
+		  ts );
+		return true;
+	}
+
+	/// Stable LSD radix sort ordered by to_radix_key( key_fn( item ) ), one
+	/// byte of the key per pass, moving between range and scratch.  scratch
+	/// must have room for range.size( ) items
+	template<typename Iterator, typename ScratchIterator, typename KeyFunction>
+	void parallel_radix_sort( daw::view<Iterator> range, ScratchIterator scratch,
+	                          KeyFunction key_fn, task_scheduler ts ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		using key_t = daw::remove_cvref_t<decltype( to_radix_key(
+		  key_fn( std::declval<value_t const &>( ) ) ) )>;
+		constexpr size_t digit_count = sizeof( key_t );
+
+		auto const digit_of = [&key_fn]( size_t shift ) {
+			return [&key_fn, shift]( value_t const &value ) {
+				return static_cast<size_t>(
+				  ( to_radix_key( key_fn( value ) ) >> shift ) & 0xFFU );
+			};
 		};
+		if( range.empty( ) or
+		    should_run_inline<value_t>( range.size( ), cost_hint{ digit_count },
+		                                ts ) ) {
+			std::stable_sort( range.begin( ), range.end( ),
+			                  [&key_fn]( value_t const &lhs, value_t const &rhs ) {
+				                  return to_radix_key( key_fn( lhs ) ) <
+				                         to_radix_key( key_fn( rhs ) );
+			                  } );
+			return;
+		}
+		auto const ranges = split_range_t<>{ }( range, ts.size( ) );
+		auto histograms = std::vector<radix_histogram_t>( ranges.size( ) );
+		bool in_scratch = false;
+		for( size_t digit = 0; digit < digit_count; ++digit ) {
+			auto const get_digit = digit_of( digit * 8U );
+			if( in_scratch ) {
+				if( radix_scatter_pass( ranges, range.begin( ), scratch, range.begin( ),
+				                        get_digit, histograms, ts ) ) {
+					in_scratch = false;
+				}
+			} else {
+				if( radix_scatter_pass( ranges, range.begin( ), range.begin( ), scratch,
+				                        get_digit, histograms, ts ) ) {
+					in_scratch = true;
+				}
+			}
+		}
+		if( in_scratch ) {
+			move_from_scratch( ranges, range.begin( ), scratch, ts );
+		}
+	}
 
-		daw::algorithm::transform(
-		  ranges.begin( ), ranges.end( ), std::back_inserter( sorters ),
-		  [ts = daw::mutable_capture( ts ), sort_fn]( daw::view<Iterator> rng ) {
-			  return make_future_result( *ts, sort_fn, rng );
-		  } );
-		auto sem = reduce_futures( sorters.begin( ), sorters.end( ), parallel_sort_merger{cmp});
-		ts.wait_for( sem );
+	template<typename Iterator, typename KeyFunction>
+	void parallel_radix_sort( daw::view<Iterator> range, KeyFunction key_fn,
+	                          task_scheduler ts ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if constexpr( std::is_default_constructible_v<value_t> ) {
+			if( range.size( ) < 2U ) {
+				return;
+			}
+			auto scratch = std::unique_ptr<value_t[]>( new value_t[range.size( )] );
+			parallel_radix_sort( range, scratch.get( ), daw::move( key_fn ),
+			                     daw::move( ts ) );
+		} else {
+			parallel_sort( range, stable_sorter{ },
+			               [key_fn]( value_t const &lhs, value_t const &rhs ) {
+				               return to_radix_key( key_fn( lhs ) ) <
+				                      to_radix_key( key_fn( rhs ) );
+			               },
+			               daw::move( ts ) );
+		}
 	}
 
 	template<typename PartitionPolicy = split_range_t<>, typename T,
 	         typename Iterator, typename BinaryOp>
 	[[nodiscard]] auto parallel_reduce( daw::view<Iterator> range, T init,
-	                                    BinaryOp binary_op, task_scheduler ts ) {
+	                                    BinaryOp binary_op, task_scheduler ts,
+	                                    cost_hint hint = cost_hint{ } ) {
 		using result_t =
 		  daw::remove_cvref_t<decltype( binary_op( init, range.front( ) ) )>;
 		{
@@ -307,83 +1134,219 @@ namespace daw::algorithm::parallel::impl {
 				return binary_op( init, range.front( ) );
 			}
 		}
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			return sequential_reduce( range.cbegin( ), range.cend( ),
+			                          static_cast<result_t>( init ), binary_op );
+		}
 		auto const ranges = PartitionPolicy{}( range, ts.size( ) );
-		auto results = std::vector<std::optional<T>>( ranges.size( ) );
-		auto sem = partition_range_pos(
+		auto results =
+		  std::vector<daw::parallel::cache_padded<std::optional<T>>>(
+		    ranges.size( ) );
+		run_partition_range_pos(
 		  ranges,
 		  [&results, binary_op]( daw::view<Iterator> rng, size_t n ) {
-			  results[n] = std::accumulate( std::next( rng.cbegin( ) ), rng.cend( ),
-			                                rng.front( ), binary_op );
+			  results[n].value = sequential_reduce(
+			    std::next( rng.cbegin( ) ), rng.cend( ),
+			    static_cast<T>( rng.front( ) ), binary_op );
 		  },
 		  ts );
-		ts.wait_for( sem );
 		// At this point we know that all results optional have values
 		auto result = static_cast<result_t>( init );
 		for( size_t n = 0; n < ranges.size( ); ++n ) {
-			result = binary_op( result, *results[n] );
+			result = binary_op( result, *results[n].value );
 		}
 		return result;
 	}
 
+	/// Run func( blocks[n], n ) for every block, on the caller alone when
+	/// run_inline is true
+	template<typename Iterator, typename Func>
+	void run_blocks( lazy_ranges<Iterator> const &blocks, Func &&func,
+	                 bool run_inline, task_scheduler &ts ) {
+		if( run_inline ) {
+			for( size_t n = 0; n < blocks.size( ); ++n ) {
+				func( blocks[n], n );
+			}
+			return;
+		}
+		run_partition_range_pos( blocks, DAW_FWD( func ), ts );
+	}
+
+	/// binary_op( init, map_function( range[0] ), ... ) in the block order of
+	/// opts, see deterministic.  The result does not depend on ts
+	template<typename T, typename Iterator, typename MapFunction,
+	         typename BinaryOp>
+	[[nodiscard]] auto
+	parallel_deterministic_reduce( daw::view<Iterator> range, T init,
+	                               MapFunction map_function, BinaryOp binary_op,
+	                               deterministic opts, task_scheduler ts,
+	                               cost_hint hint ) {
+		using result_t = daw::remove_cvref_t<decltype(
+		  binary_op( init, map_function( range.front( ) ) ) )>;
+		if( range.empty( ) ) {
+			return static_cast<result_t>( init );
+		}
+		auto const blocks =
+		  lazy_ranges<Iterator>( range, std::max<size_t>( 1U, opts.block_size ) );
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		bool const run_inline =
+		  should_run_inline<value_t>( range.size( ), hint, ts );
+
+		if constexpr( std::is_floating_point_v<result_t> and
+		              simd::is_plus_v<BinaryOp, result_t> ) {
+			if( opts.compensated ) {
+				using sum_t = compensated_sum<result_t>;
+				auto sums = std::vector<sum_t>( blocks.size( ) );
+				run_blocks(
+				  blocks,
+				  [&sums, &map_function]( daw::view<Iterator> rng, size_t n ) {
+					  auto sum = sum_t{ };
+					  for( auto it = rng.begin( ); it != rng.end( ); ++it ) {
+						  sum.add( static_cast<result_t>( map_function( *it ) ) );
+					  }
+					  sums[n] = sum;
+				  },
+				  run_inline, ts );
+				auto total = sum_t{ };
+				total.add( static_cast<result_t>( init ) );
+				total.add( pairwise_combine( daw::move( sums ),
+				                             []( sum_t lhs, sum_t const &rhs ) {
+					                             lhs.add( rhs );
+					                             return lhs;
+				                             } ) );
+				return total.value( );
+			}
+		}
+		auto results = std::vector<std::optional<result_t>>( blocks.size( ) );
+		run_blocks(
+		  blocks,
+		  [&results, &map_function, &binary_op]( daw::view<Iterator> rng,
+		                                         size_t n ) {
+			  auto result = static_cast<result_t>( map_function( rng.front( ) ) );
+			  for( auto it = std::next( rng.begin( ) ); it != rng.end( ); ++it ) {
+				  result = binary_op( result, map_function( *it ) );
+			  }
+			  results[n] = daw::move( result );
+		  },
+		  run_inline, ts );
+		return static_cast<result_t>( binary_op(
+		  init, *pairwise_combine(
+		          daw::move( results ),
+		          [&binary_op]( std::optional<result_t> const &lhs,
+		                        std::optional<result_t> const &rhs ) {
+			          return std::optional<result_t>( binary_op( *lhs, *rhs ) );
+		          } ) ) );
+	}
+
 	template<typename PartitionPolicy = split_range_t<>, typename Iterator,
 	         typename Compare>
 	[[nodiscard]] Iterator parallel_min_element( daw::view<Iterator> range,
-	                                             Compare cmp,
-	                                             task_scheduler ts ) {
+	                                             Compare cmp, task_scheduler ts,
+	                                             cost_hint hint = cost_hint{ } ) {
 		if( range.empty( ) ) {
 			return range.end( );
 		}
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			return sequential_min_element( range.begin( ), range.end( ), cmp );
+		}
 		struct min_element_worker {
-			std::vector<Iterator> &r;
+			std::vector<daw::parallel::cache_padded<Iterator>> &r;
 			Compare c;
 
 			inline void operator( )( daw::view<Iterator> rng, size_t n ) const {
-				r[n] = ::std::min_element( rng.cbegin( ), rng.cend( ), c );
+				r[n].value = sequential_min_element( rng.cbegin( ), rng.cend( ), c );
 			}
 		};
 		auto const ranges = PartitionPolicy{}( range, ts.size( ) );
-		auto results = std::vector<Iterator>( ranges.size( ), range.end( ) );
-		auto sem =
-		  partition_range_pos( ranges, min_element_worker{results, cmp}, ts );
-		ts.wait_for( sem );
-
-		return *std::min_element(
-		  results.cbegin( ), results.cend( ),
-		  [cmp]( auto const &lhs, auto const &rhs ) { return cmp( *lhs, *rhs ); } );
+		auto results = std::vector<daw::parallel::cache_padded<Iterator>>(
+		  ranges.size( ),
+		  daw::parallel::cache_padded<Iterator>( std::in_place, range.end( ) ) );
+		run_partition_range_pos( ranges, min_element_worker{results, cmp}, ts );
+
+		return std::min_element( results.cbegin( ), results.cend( ),
+		                         [cmp]( auto const &lhs, auto const &rhs ) {
+			                         return cmp( **lhs, **rhs );
+		                         } )
+		  ->value;
 	}
 
 	template<typename PartitionPolicy = split_range_t<>, typename Iterator,
 	         typename Compare>
 	[[nodiscard]] Iterator parallel_max_element( daw::view<Iterator> range,
-	                                             Compare cmp,
-	                                             task_scheduler ts ) {
+	                                             Compare cmp, task_scheduler ts,
+	                                             cost_hint hint = cost_hint{ } ) {
 		if( range.empty( ) ) {
 			return range.end( );
 		}
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			return sequential_max_element( range.begin( ), range.end( ), cmp );
+		}
 		auto const ranges = PartitionPolicy{}( range, ts.size( ) );
-		std::vector<Iterator> results( ranges.size( ), range.end( ) );
-		auto sem = partition_range_pos(
+		auto results = std::vector<daw::parallel::cache_padded<Iterator>>(
+		  ranges.size( ),
+		  daw::parallel::cache_padded<Iterator>( std::in_place, range.end( ) ) );
+		run_partition_range_pos(
 		  ranges,
 		  [&results, cmp]( daw::view<Iterator> rng, size_t n ) {
-			  results[n] =
-			    std::max_element( rng.cbegin( ), rng.cend( ),
-			                      [cmp]( auto const &lhs, auto const &rhs ) {
-				                      return cmp( lhs, rhs );
-			                      } );
+			  results[n].value =
+			    sequential_max_element( rng.cbegin( ), rng.cend( ), cmp );
 		  },
 		  ts );
-		ts.wait_for( sem );
-		return *std::max_element(
-		  results.cbegin( ), results.cend( ),
-		  [cmp]( auto const &lhs, auto const &rhs ) { return cmp( *lhs, *rhs ); } );
+		return std::max_element( results.cbegin( ), results.cend( ),
+		                         [cmp]( auto const &lhs, auto const &rhs ) {
+			                         return cmp( **lhs, **rhs );
+		                         } )
+		  ->value;
 	}
 
 	template<typename PartitionPolicy = split_range_t<>, typename Iterator,
 	         typename OutputIterator, typename UnaryOperation>
 	void parallel_map( daw::view<Iterator> range_in, OutputIterator first_out,
-	                   UnaryOperation unary_op, task_scheduler ts ) {
+	                   UnaryOperation unary_op, task_scheduler ts,
+	                   cost_hint hint = cost_hint{ } ) {
 
-		partition_range<PartitionPolicy>(
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range_in.size( ), hint, ts ) ) {
+			daw::algorithm::map( range_in.begin( ), range_in.end( ), first_out,
+			                     unary_op );
+			return;
+		}
+		using out_t = typename std::iterator_traits<OutputIterator>::value_type;
+		if constexpr( std::is_same_v<PartitionPolicy, split_range_t<>> and
+		              simd::is_contiguous_iterator_v<Iterator> and
+		              is_bandwidth_range_v<OutputIterator> and
+		              std::is_same_v<daw::remove_cvref_t<decltype( unary_op(
+		                               range_in.front( ) ) )>,
+		                             out_t> ) {
+			if( is_bandwidth_bound( hint ) ) {
+				// Memory bound, as in parallel_fill, unless the op costs more than
+				// moving the items
+				auto const *const in = simd::data_of( range_in.begin( ) );
+				auto *const out = simd::data_of( first_out );
+				bool const stream = should_stream<out_t>( range_in.size( ) );
+				run_bandwidth_bound(
+				  range_in.size( ),
+				  cache_chunk_size( sizeof( value_t ) + sizeof( out_t ) ),
+				  [in, out, stream, &unary_op]( size_t first, size_t last ) {
+					  if( stream ) {
+						  auto gen = [&unary_op, in = in + first]( size_t n ) {
+							  return unary_op( in[n] );
+						  };
+						  streaming::generate( out + first, last - first, gen );
+						  streaming::fence( );
+					  } else {
+						  daw::algorithm::map( in + first, in + last, out + first,
+						                       unary_op );
+					  }
+				  },
+				  ts );
+				return;
+			}
+		}
+		run_partition_range<PartitionPolicy>(
 		  range_in,
 		  [first_in = range_in.begin( ), first_out, unary_op]( Iterator first,
 		                                                       Iterator last ) {
@@ -393,21 +1356,63 @@ namespace daw::algorithm::parallel::impl {
 			  daw::algorithm::map( first, last, std::next( first_out, step ),
 			                       unary_op );
 		  },
-		  ts )
-		  .wait( );
+		  ts );
 	}
 
 	template<typename PartitionPolicy = split_range_t<>, typename Iterator1,
 	         typename Iterator2, typename OutputIterator,
 	         typename BinaryOperation>
 	void parallel_map( daw::view<Iterator1> range_in1,
-	                   daw::view<Iterator2> range_in2, OutputIterator first_out,
-	                   BinaryOperation binary_op, task_scheduler ts ) {
-
-		partition_range<PartitionPolicy>(
+	                   Iterator2 first_in2, OutputIterator first_out,
+	                   BinaryOperation binary_op, task_scheduler ts,
+	                   cost_hint hint = cost_hint{ } ) {
+
+		using value_t = typename std::iterator_traits<Iterator1>::value_type;
+		if( should_run_inline<value_t>( range_in1.size( ), hint, ts ) ) {
+			daw::algorithm::map( range_in1.begin( ), range_in1.end( ),
+			                     first_in2, first_out, binary_op );
+			return;
+		}
+		using value2_t = typename std::iterator_traits<Iterator2>::value_type;
+		using out_t = typename std::iterator_traits<OutputIterator>::value_type;
+		if constexpr( std::is_same_v<PartitionPolicy, split_range_t<>> and
+		              simd::is_contiguous_iterator_v<Iterator1> and
+		              simd::is_contiguous_iterator_v<Iterator2> and
+		              is_bandwidth_range_v<OutputIterator> and
+		              std::is_same_v<daw::remove_cvref_t<decltype( binary_op(
+		                               range_in1.front( ), *first_in2 ) )>,
+		                             out_t> ) {
+			if( is_bandwidth_bound( hint ) ) {
+				// Memory bound, as in parallel_fill, unless the op costs more than
+				// moving the items
+				auto const *const in1 = simd::data_of( range_in1.begin( ) );
+				auto const *const in2 = simd::data_of( first_in2 );
+				auto *const out = simd::data_of( first_out );
+				bool const stream = should_stream<out_t>( range_in1.size( ) );
+				run_bandwidth_bound(
+				  range_in1.size( ),
+				  cache_chunk_size( sizeof( value_t ) + sizeof( value2_t ) +
+				                    sizeof( out_t ) ),
+				  [in1, in2, out, stream, &binary_op]( size_t first, size_t last ) {
+					  if( stream ) {
+						  auto gen = [&binary_op, in1 = in1 + first,
+						              in2 = in2 + first]( size_t n ) {
+							  return binary_op( in1[n], in2[n] );
+						  };
+						  streaming::generate( out + first, last - first, gen );
+						  streaming::fence( );
+					  } else {
+						  daw::algorithm::map( in1 + first, in1 + last, in2 + first,
+						                       out + first, binary_op );
+					  }
+				  },
+				  ts );
+				return;
+			}
+		}
+		run_partition_range<PartitionPolicy>(
 		  range_in1,
-		  [first_in1 = range_in1.begin( ), first_out,
-		   first_in2 = range_in2.begin( ),
+		  [first_in1 = range_in1.begin( ), first_out, first_in2,
 		   binary_op]( Iterator1 first1, Iterator1 last1 ) {
 			  auto const step = std::distance( first_in1, first1 );
 			  daw::exception::dbg_precondition_check( step >= 0 );
@@ -416,8 +1421,7 @@ namespace daw::algorithm::parallel::impl {
 
 			  daw::algorithm::map( first1, last1, in_it2, out_it, binary_op );
 		  },
-		  ts )
-		  .wait( );
+		  ts );
 	}
 
 	template<typename PartitionPolicy = split_range_t<2>, typename Iterator,
@@ -425,7 +1429,7 @@ namespace daw::algorithm::parallel::impl {
 	[[nodiscard]] auto
 	parallel_map_reduce( daw::view<Iterator> range, T const &init,
 	                     MapFunction map_function, ReduceFunction reduce_function,
-	                     task_scheduler ts ) {
+	                     task_scheduler ts, cost_hint hint = cost_hint{ } ) {
 		static_assert( PartitionPolicy::min_range_size >= 2,
 		               "Minimum range size must be >= 2" );
 		daw::exception::precondition_check( range.size( ) >= 2 );
@@ -433,10 +1437,21 @@ namespace daw::algorithm::parallel::impl {
 		using result_t = daw::remove_cvref_t<decltype( reduce_function(
 		  map_function( range.front( ) ), map_function( range.front( ) ) ) )>;
 
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			result_t result = map_function( init );
+			for( auto it = range.begin( ); it != range.end( ); ++it ) {
+				result = reduce_function( result, map_function( *it ) );
+			}
+			return result;
+		}
+
 		auto const ranges = PartitionPolicy{}( range, ts.size( ) );
-		auto results = std::vector<std::optional<result_t>>( ranges.size( ) );
+		auto results =
+		  std::vector<daw::parallel::cache_padded<std::optional<result_t>>>(
+		    ranges.size( ) );
 
-		auto sem = partition_range_pos(
+		run_partition_range_pos(
 		  ranges,
 		  [&results, map_function, reduce_function]( daw::view<Iterator> rng,
 		                                             size_t n ) {
@@ -444,115 +1459,960 @@ namespace daw::algorithm::parallel::impl {
 			  while( not rng.empty( ) ) {
 				  result = reduce_function( result, map_function( rng.pop_front( ) ) );
 			  }
-			  results[n] = daw::move( result );
+			  results[n].value = daw::move( result );
 		  },
 		  ts );
-
-		ts.wait_for( sem );
-		auto result = reduce_function( map_function( init ), *results[0] );
+		auto result = reduce_function( map_function( init ), *results[0].value );
 		for( size_t n = 1; n < ranges.size( ); ++n ) {
-			result = reduce_function( result, *results[n] );
+			result = reduce_function( result, *results[n].value );
 		}
 		return result;
 	}
 
-	template<typename PartitionPolicy = split_range_t<>, typename Iterator,
-	         typename OutputIterator, typename BinaryOp>
+	/// Open addressing hash table with linear probing, the per worker and per
+	/// split state of parallel_aggregate_by_key.  Hashes are mixed by the
+	/// caller, who also uses them to pick the split, and kept with each entry
+	/// so growing and merging never hash a key again
+	template<typename Key, typename Acc, typename KeyEqual>
+	class aggregate_table_t {
+	public:
+		struct entry_t {
+			uint64_t hash;
+			Key key;
+			Acc acc;
+		};
+
+	private:
+		std::vector<std::optional<entry_t>> m_slots{ };
+		std::size_t m_size = 0;
+		// Slots are indexed by the top bits of the hash
+		unsigned m_shift = 64U;
+		KeyEqual m_key_equal{ };
+
+		[[nodiscard]] std::size_t slot_of( uint64_t hash ) const {
+			return m_shift == 64U ? 0U : static_cast<std::size_t>( hash >> m_shift );
+		}
+
+		[[nodiscard]] std::size_t find_slot( uint64_t hash, Key const &key ) const {
+			auto const mask = m_slots.size( ) - 1U;
+			auto pos = slot_of( hash );
+			while( m_slots[pos] and
+			       not( m_slots[pos]->hash == hash and
+			            m_key_equal( m_slots[pos]->key, key ) ) ) {
+				pos = ( pos + 1U ) & mask;
+			}
+			return pos;
+		}
+
+		void grow( ) {
+			// Kept at most half full so probes stay short
+			auto old_slots = daw::move( m_slots );
+			auto const capacity =
+			  old_slots.empty( ) ? std::size_t{ 16U } : 2U * old_slots.size( );
+			m_slots = std::vector<std::optional<entry_t>>( capacity );
+			m_shift = 64U;
+			for( auto c = capacity; c > 1U; c >>= 1U ) {
+				--m_shift;
+			}
+			auto const mask = capacity - 1U;
+			for( auto &slot : old_slots ) {
+				if( slot ) {
+					auto pos = slot_of( slot->hash );
+					while( m_slots[pos] ) {
+						pos = ( pos + 1U ) & mask;
+					}
+					m_slots[pos] = daw::move( slot );
+				}
+			}
+		}
+
+	public:
+		aggregate_table_t( ) = default;
+
+		explicit aggregate_table_t( KeyEqual key_equal )
+		  : m_key_equal( daw::move( key_equal ) ) {}
+
+		/// Fibonacci hashing, spreads weak hashes like the identity hash of
+		/// integers over the top bits and the bits used to pick a split
+		[[nodiscard]] static constexpr uint64_t mix( std::size_t hash ) {
+			return static_cast<uint64_t>( hash ) * 0x9E37'79B9'7F4A'7C15ULL;
+		}
+
+		[[nodiscard]] std::size_t size( ) const {
+			return m_size;
+		}
+
+		/// Update the entry for key with update( acc ), or add one with the
+		/// value of init( ) when there is none
+		template<typename K, typename Init, typename Update>
+		void insert( uint64_t hash, K &&key, Init &&init, Update &&update ) {
+			if( 2U * ( m_size + 1U ) > m_slots.size( ) ) {
+				grow( );
+			}
+			auto &slot = m_slots[find_slot( hash, key )];
+			if( slot ) {
+				update( slot->acc );
+				return;
+			}
+			slot = entry_t{ hash, Key( DAW_FWD( key ) ), init( ) };
+			++m_size;
+		}
+
+		/// Move out the entries, leaving the table empty
+		[[nodiscard]] std::vector<entry_t> take_entries( ) {
+			auto result = std::vector<entry_t>( );
+			result.reserve( m_size );
+			for( auto &slot : m_slots ) {
+				if( slot ) {
+					result.push_back( daw::move( *slot ) );
+				}
+			}
+			m_slots.clear( );
+			m_size = 0;
+			m_shift = 64U;
+			return result;
+		}
+	};
+
+	/// Aggregate the items of range by key_function( item ).  The first item
+	/// of a key makes its accumulator with init( item ), later ones are added
+	/// with accumulate( acc, item ) and accumulators of the same key from
+	/// different workers are combined with merge( acc, other ).  Each worker
+	/// fills one table per split of the hash space, then each split is merged
+	/// by one task, so no table is ever shared.  Returns ( key, accumulator )
+	/// pairs in no particular order
+	template<typename PartitionPolicy = split_range_t<2>, typename Iterator,
+	         typename KeyFunction, typename Init, typename Accumulate,
+	         typename Merge, typename Hash, typename KeyEqual>
+	[[nodiscard]] auto
+	parallel_aggregate_by_key( daw::view<Iterator> range,
+	                           KeyFunction key_function, Init init,
+	                           Accumulate accumulate, Merge merge, Hash hash,
+	                           KeyEqual key_equal, task_scheduler ts,
+	                           cost_hint hint = cost_hint{ } ) {
+		using key_type =
+		  daw::remove_cvref_t<decltype( key_function( *range.begin( ) ) )>;
+		using acc_t = daw::remove_cvref_t<decltype( init( *range.begin( ) ) )>;
+		using table_t = aggregate_table_t<key_type, acc_t, KeyEqual>;
+		using padded_table_t = daw::parallel::cache_padded<table_t>;
+		using result_t = std::vector<std::pair<key_type, acc_t>>;
+
+		auto add_item = [&]( table_t &table, uint64_t h, key_type &&key,
+		                     auto const &item ) {
+			table.insert(
+			  h, daw::move( key ), [&]( ) { return init( item ); },
+			  [&]( acc_t &acc ) { accumulate( acc, item ); } );
+		};
+		auto to_result = []( table_t &table, result_t &result ) {
+			for( auto &entry : table.take_entries( ) ) {
+				result.emplace_back( daw::move( entry.key ), daw::move( entry.acc ) );
+			}
+		};
+
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( range.empty( ) or
+		    should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			auto table = table_t( key_equal );
+			for( auto it = range.begin( ); it != range.end( ); ++it ) {
+				auto key = key_function( *it );
+				auto const h = table_t::mix( hash( key ) );
+				add_item( table, h, daw::move( key ), *it );
+			}
+			auto result = result_t( );
+			result.reserve( table.size( ) );
+			to_result( table, result );
+			return result;
+		}
+
+		auto const ranges = PartitionPolicy{}( range, ts.size( ) );
+		auto const split_count = ranges.size( );
+		// Table of worker w for split s is tables[w * split_count + s]
+		auto tables = std::vector<padded_table_t>(
+		  split_count * split_count, padded_table_t( std::in_place, key_equal ) );
+		run_partition_range_pos(
+		  ranges,
+		  [&]( daw::view<Iterator> rng, std::size_t w ) {
+			  for( auto it = rng.begin( ); it != rng.end( ); ++it ) {
+				  auto key = key_function( *it );
+				  auto const h = table_t::mix( hash( key ) );
+				  // The top bits pick the slot, so the split uses lower ones
+				  auto const split =
+				    static_cast<std::size_t>( h >> 32U ) % split_count;
+				  add_item( *tables[w * split_count + split], h, daw::move( key ),
+				            *it );
+			  }
+		  },
+		  ts );
+
+		auto parts = std::vector<result_t>( split_count );
+		// Merging a split touches every entry of a worker's table
+		constexpr auto merge_hint = cost_hint{ min_parallel_work };
+		parallel_for_each_index(
+		  parts.begin( ), parts.end( ),
+		  [&]( std::size_t s ) {
+			  auto &merged = *tables[s];
+			  for( std::size_t w = 1; w < split_count; ++w ) {
+				  for( auto &entry : tables[w * split_count + s]->take_entries( ) ) {
+					  merged.insert(
+					    entry.hash, daw::move( entry.key ),
+					    [&]( ) { return daw::move( entry.acc ); },
+					    [&]( acc_t &acc ) { merge( acc, daw::move( entry.acc ) ); } );
+				  }
+			  }
+			  parts[s].reserve( merged.size( ) );
+			  to_result( merged, parts[s] );
+		  },
+		  ts, merge_hint );
+
+		auto result = daw::move( parts[0] );
+		for( std::size_t s = 1; s < split_count; ++s ) {
+			std::move( parts[s].begin( ), parts[s].end( ),
+			           std::back_inserter( result ) );
+		}
+		return result;
+	}
+
+	/// Published state of one tile in lookback_scan.  aggregate is the
+	/// reduction of the tile alone, inclusive that of every item up to the end
+	/// of the tile.  Each is written before status is released.  failed marks a
+	/// tile that threw, or was given up on because an earlier one did.  Tiles
+	/// are polled by their successors while being written, so each gets its
+	/// own cache line
+	template<typename T>
+	struct alignas( daw::parallel::cache_line_size ) scan_tile_state_t {
+		enum class status_t : uint8_t { pending, aggregate, inclusive, failed };
+
+		std::atomic<status_t> status{ status_t::pending };
+		std::optional<T> aggregate{ };
+		std::optional<T> inclusive{ };
+	};
+
+	/// Single pass scan over [0, count) by decoupled look-back.  Workers claim
+	/// tiles in order.  Each reduces its tile with reduce_tile( first, last ),
+	/// publishes that, then walks back over earlier tiles combining their
+	/// aggregates until one has a known inclusive prefix.  It then publishes its
+	/// own inclusive prefix and calls scan_tile( first, last, prefix ), where
+	/// prefix is empty for the first tile.  Only tiles claimed by running
+	/// workers are waited on, so there is no need for the tiles to be ordered
+	/// in the task queues.  If a tile throws, the tiles after it are given up
+	/// on and the exception is rethrown here
+	template<typename T, typename ReduceTile, typename ScanTile,
+	         typename BinaryOp>
+	void lookback_scan( size_t const count, size_t const tile_size,
+	                    ReduceTile const &reduce_tile, ScanTile const &scan_tile,
+	                    BinaryOp const &binary_op, task_scheduler &ts ) {
+		using status_t = typename scan_tile_state_t<T>::status_t;
+
+		auto const tile_count = ( count + tile_size - 1U ) / tile_size;
+		auto tiles = std::unique_ptr<scan_tile_state_t<T>[]>(
+		  new scan_tile_state_t<T>[tile_count] );
+		auto next_tile = std::atomic_size_t( 0 );
+		auto has_failed = std::atomic_bool( false );
+
+		// false when the tile was given up on because an earlier one failed
+		auto const run_tile = [&]( size_t tile ) -> bool {
+			auto const first = tile * tile_size;
+			auto const last = std::min( first + tile_size, count );
+			auto &state = tiles[tile];
+			state.aggregate = reduce_tile( first, last );
+			if( tile == 0 ) {
+				state.inclusive = state.aggregate;
+				state.status.store( status_t::inclusive, std::memory_order_release );
+				scan_tile( first, last, std::optional<T>( ) );
+				return true;
+			}
+			state.status.store( status_t::aggregate, std::memory_order_release );
+
+			auto prefix = std::optional<T>( );
+			for( auto pos = tile; pos-- > 0; ) {
+				auto const &prev = tiles[pos];
+				auto status = prev.status.load( std::memory_order_acquire );
+				while( status == status_t::pending ) {
+					std::this_thread::yield( );
+					status = prev.status.load( std::memory_order_acquire );
+				}
+				if( status == status_t::failed ) {
+					return false;
+				}
+				auto const &value = status == status_t::inclusive ? *prev.inclusive
+				                                                    : *prev.aggregate;
+				prefix =
+				  prefix ? static_cast<T>( binary_op( value, *prefix ) ) : value;
+				if( status == status_t::inclusive ) {
+					break;
+				}
+			}
+			state.inclusive =
+			  static_cast<T>( binary_op( *prefix, *state.aggregate ) );
+			state.status.store( status_t::inclusive, std::memory_order_release );
+			scan_tile( first, last, prefix );
+			return true;
+		};
+
+		auto const worker = [&]( ) {
+			for( auto tile = next_tile++; tile < tile_count; tile = next_tile++ ) {
+				auto &state = tiles[tile];
+				bool finished = false;
+				try {
+					finished = not has_failed.load( std::memory_order_relaxed ) and
+					           run_tile( tile );
+				} catch( ... ) {
+					has_failed.store( true, std::memory_order_relaxed );
+					state.status.store( status_t::failed, std::memory_order_release );
+					throw;
+				}
+				if( not finished ) {
+					// Those waiting on this tile give up too
+					has_failed.store( true, std::memory_order_relaxed );
+					state.status.store( status_t::failed, std::memory_order_release );
+					return;
+				}
+			}
+		};
+
+		auto const worker_count = std::min( ts.size( ), tile_count );
+		auto sem = daw::latch( worker_count );
+		for( size_t n = 0; n < worker_count; ++n ) {
+			if( not daw::impl::schedule_task_on( sem, worker, ts ) ) {
+				// The workers already running will take every tile
+				sem.notify( );
+			}
+		}
+		ts.wait_for( sem );
+		if( next_tile.load( ) < tile_count ) {
+			worker( );
+		}
+	}
+
+	/// Items per lookback_scan tile.  Sized so a tile is still in cache when it
+	/// is read the second time to write the output
+	template<typename T>
+	inline constexpr size_t scan_tile_size =
+	  std::max<size_t>( 1024U, ( 64U * 1024U ) / sizeof( T ) );
+
+	/// Inclusive scan, range_out[n] = binary_op( range_in[0]...range_in[n] )
+	template<typename Iterator, typename OutputIterator, typename BinaryOp>
 	void parallel_scan( daw::view<Iterator> range_in,
 	                    daw::view<OutputIterator> range_out, BinaryOp &&binary_op,
-	                    task_scheduler ts ) {
-		{
-			daw::exception::precondition_check(
-			  range_in.size( ) == range_out.size( ),
-			  "Output range must be the same size as input" );
-			if( range_in.size( ) == 2 ) {
-				range_out.front( ) = range_in.front( );
-				return;
+	                    task_scheduler ts, cost_hint hint = cost_hint{ } ) {
+		daw::exception::precondition_check(
+		  range_in.size( ) == range_out.size( ),
+		  "Output range must be the same size as input" );
+		using in_value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<in_value_t>( range_in.size( ), hint, ts ) ) {
+			std::partial_sum( range_in.cbegin( ), range_in.cend( ),
+			                  range_out.begin( ), binary_op );
+			return;
+		}
+		using value_t = daw::remove_cvref_t<decltype(
+		  binary_op( range_in.front( ), range_in.front( ) ) )>;
+
+		auto const in = range_in.begin( );
+		auto const out = range_out.begin( );
+		lookback_scan<value_t>(
+		  range_in.size( ), scan_tile_size<value_t>,
+		  [&]( size_t first, size_t last ) {
+			  auto result =
+			    static_cast<value_t>( in[static_cast<ptrdiff_t>( first )] );
+			  for( auto n = first + 1U; n < last; ++n ) {
+				  result = binary_op( result, in[static_cast<ptrdiff_t>( n )] );
+			  }
+			  return result;
+		  },
+		  [&]( size_t first, size_t last, std::optional<value_t> const &prefix ) {
+			  auto sum =
+			    prefix ? static_cast<value_t>(
+			               binary_op( *prefix, in[static_cast<ptrdiff_t>( first )] ) )
+			           : static_cast<value_t>( in[static_cast<ptrdiff_t>( first )] );
+			  out[static_cast<ptrdiff_t>( first )] = sum;
+			  for( auto n = first + 1U; n < last; ++n ) {
+				  sum = binary_op( sum, in[static_cast<ptrdiff_t>( n )] );
+				  out[static_cast<ptrdiff_t>( n )] = sum;
+			  }
+		  },
+		  binary_op, ts );
+	}
+
+	/// Exclusive scan, range_out[0] = init and
+	/// range_out[n] = binary_op( init, range_in[0]...range_in[n - 1] )
+	template<typename Iterator, typename OutputIterator, typename T,
+	         typename BinaryOp>
+	void parallel_exclusive_scan( daw::view<Iterator> range_in,
+	                              daw::view<OutputIterator> range_out, T init,
+	                              BinaryOp &&binary_op, task_scheduler ts,
+	                              cost_hint hint = cost_hint{ } ) {
+		daw::exception::precondition_check(
+		  range_in.size( ) == range_out.size( ),
+		  "Output range must be the same size as input" );
+		using in_value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<in_value_t>( range_in.size( ), hint, ts ) ) {
+			auto it = range_in.begin( );
+			for( auto out = range_out.begin( ); out != range_out.end( ); ++out ) {
+				auto next = binary_op( init, *it );
+				*out = daw::move( init );
+				init = daw::move( next );
+				++it;
 			}
+			return;
 		}
-		using value_t = daw::remove_cvref_t<decltype( std::forward<BinaryOp>(
-		  binary_op )( range_in.front( ), range_in.front( ) ) )>;
+		using value_t = daw::remove_cvref_t<decltype(
+		  binary_op( range_in.front( ), range_in.front( ) ) )>;
+
+		auto const in = range_in.begin( );
+		auto const out = range_out.begin( );
+		lookback_scan<value_t>(
+		  range_in.size( ), scan_tile_size<value_t>,
+		  [&]( size_t first, size_t last ) {
+			  auto result =
+			    static_cast<value_t>( in[static_cast<ptrdiff_t>( first )] );
+			  for( auto n = first + 1U; n < last; ++n ) {
+				  result = binary_op( result, in[static_cast<ptrdiff_t>( n )] );
+			  }
+			  return result;
+		  },
+		  [&]( size_t first, size_t last, std::optional<value_t> const &prefix ) {
+			  // Read in[n] before writing out[n] so that in place scans work
+			  auto sum = prefix ? static_cast<T>( binary_op( init, *prefix ) ) : init;
+			  for( auto n = first; n < last; ++n ) {
+				  auto next = binary_op( sum, in[static_cast<ptrdiff_t>( n )] );
+				  out[static_cast<ptrdiff_t>( n )] = daw::move( sum );
+				  sum = daw::move( next );
+			  }
+		  },
+		  binary_op, ts );
+	}
 
-		auto const ranges = PartitionPolicy{}( range_in, ts.size( ) );
-		auto p1_results = std::vector<std::optional<value_t>>( ranges.size( ) );
-		auto mut_p1_results = std::vector<daw::spin_lock>( ranges.size( ) );
-
-		auto const add_result = [&]( size_t pos, value_t const &value ) {
-			for( size_t n = pos + 1; n < p1_results.size( ); ++n ) {
-				std::lock_guard<daw::spin_lock> lck( mut_p1_results[n] );
-				if( p1_results[n] ) {
-					p1_results[n] = binary_op( *p1_results[n], value );
+	/// For the deterministic scans, the reduction of every block before each
+	/// block, combined from left to right.  The first block has none
+	template<typename T, typename Iterator, typename BinaryOp>
+	[[nodiscard]] std::vector<std::optional<T>>
+	block_prefixes( lazy_ranges<Iterator> const &blocks,
+	                BinaryOp const &binary_op, bool run_inline,
+	                task_scheduler &ts ) {
+		auto result = std::vector<std::optional<T>>( blocks.size( ) );
+		run_blocks(
+		  blocks,
+		  [&result, &binary_op]( daw::view<Iterator> rng, size_t n ) {
+			  auto aggregate = static_cast<T>( rng.front( ) );
+			  for( auto it = std::next( rng.begin( ) ); it != rng.end( ); ++it ) {
+				  aggregate = binary_op( aggregate, *it );
+			  }
+			  result[n] = daw::move( aggregate );
+		  },
+		  run_inline, ts );
+		auto prefix = std::optional<T>( );
+		for( auto &block : result ) {
+			auto aggregate = daw::move( block );
+			block = prefix;
+			prefix = prefix ? static_cast<T>( binary_op( *prefix, *aggregate ) )
+			                : daw::move( aggregate );
+		}
+		return result;
+	}
+
+	/// parallel_scan in the block order of opts, see deterministic
+	template<typename Iterator, typename OutputIterator, typename BinaryOp>
+	void parallel_deterministic_scan( daw::view<Iterator> range_in,
+	                                  daw::view<OutputIterator> range_out,
+	                                  BinaryOp &&binary_op, deterministic opts,
+	                                  task_scheduler ts, cost_hint hint ) {
+		daw::exception::precondition_check(
+		  range_in.size( ) == range_out.size( ),
+		  "Output range must be the same size as input" );
+		if( range_in.empty( ) ) {
+			return;
+		}
+		using in_value_t = typename std::iterator_traits<Iterator>::value_type;
+		using value_t = daw::remove_cvref_t<decltype(
+		  binary_op( range_in.front( ), range_in.front( ) ) )>;
+		auto const blocks = lazy_ranges<Iterator>(
+		  range_in, std::max<size_t>( 1U, opts.block_size ) );
+		bool const run_inline =
+		  should_run_inline<in_value_t>( range_in.size( ), hint, ts );
+		auto const prefixes =
+		  block_prefixes<value_t>( blocks, binary_op, run_inline, ts );
+
+		auto const in = range_in.begin( );
+		auto const out = range_out.begin( );
+		run_blocks(
+		  blocks,
+		  [&]( daw::view<Iterator> rng, size_t n ) {
+			  auto const first = std::distance( in, rng.begin( ) );
+			  auto const last = first + static_cast<ptrdiff_t>( rng.size( ) );
+			  auto const &prefix = prefixes[n];
+			  auto sum = prefix
+			               ? static_cast<value_t>( binary_op( *prefix, in[first] ) )
+			               : static_cast<value_t>( in[first] );
+			  out[first] = sum;
+			  for( auto pos = first + 1; pos < last; ++pos ) {
+				  sum = binary_op( sum, in[pos] );
+				  out[pos] = sum;
+			  }
+		  },
+		  run_inline, ts );
+	}
+
+	/// parallel_exclusive_scan in the block order of opts, see deterministic
+	template<typename Iterator, typename OutputIterator, typename T,
+	         typename BinaryOp>
+	void parallel_deterministic_exclusive_scan(
+	  daw::view<Iterator> range_in, daw::view<OutputIterator> range_out, T init,
+	  BinaryOp &&binary_op, deterministic opts, task_scheduler ts,
+	  cost_hint hint ) {
+		daw::exception::precondition_check(
+		  range_in.size( ) == range_out.size( ),
+		  "Output range must be the same size as input" );
+		if( range_in.empty( ) ) {
+			return;
+		}
+		using in_value_t = typename std::iterator_traits<Iterator>::value_type;
+		using value_t = daw::remove_cvref_t<decltype(
+		  binary_op( range_in.front( ), range_in.front( ) ) )>;
+		auto const blocks = lazy_ranges<Iterator>(
+		  range_in, std::max<size_t>( 1U, opts.block_size ) );
+		bool const run_inline =
+		  should_run_inline<in_value_t>( range_in.size( ), hint, ts );
+		auto const prefixes =
+		  block_prefixes<value_t>( blocks, binary_op, run_inline, ts );
+
+		auto const in = range_in.begin( );
+		auto const out = range_out.begin( );
+		run_blocks(
+		  blocks,
+		  [&]( daw::view<Iterator> rng, size_t n ) {
+			  auto const first = std::distance( in, rng.begin( ) );
+			  auto const last = first + static_cast<ptrdiff_t>( rng.size( ) );
+			  auto const &prefix = prefixes[n];
+			  // Read in[pos] before writing out[pos] so that in place scans work
+			  auto sum = prefix ? static_cast<T>( binary_op( init, *prefix ) ) : init;
+			  for( auto pos = first; pos < last; ++pos ) {
+				  auto next = binary_op( sum, in[pos] );
+				  out[pos] = daw::move( sum );
+				  sum = daw::move( next );
+			  }
+		  },
+		  run_inline, ts );
+	}
+
+	/// Inclusive scan that starts again at every item whose flag is true.
+	/// range_flags has an entry for each item in range_in
+	template<typename Iterator, typename FlagIterator, typename OutputIterator,
+	         typename BinaryOp>
+	void parallel_segmented_scan( daw::view<Iterator> range_in,
+	                              FlagIterator first_flag,
+	                              daw::view<OutputIterator> range_out,
+	                              BinaryOp &&binary_op, task_scheduler ts,
+	                              cost_hint hint = cost_hint{ } ) {
+		daw::exception::precondition_check(
+		  range_in.size( ) == range_out.size( ),
+		  "Output range must be the same size as input" );
+		using in_value_t = typename std::iterator_traits<Iterator>::value_type;
+		using value_t = daw::remove_cvref_t<decltype(
+		  binary_op( range_in.front( ), range_in.front( ) ) )>;
+
+		auto const in = range_in.begin( );
+		auto const out = range_out.begin( );
+		// Scan [first, last) continuing from the open segment in carry
+		auto const scan_segment = [&]( size_t first, size_t last,
+		                               std::optional<value_t> carry ) {
+			for( auto n = first; n < last; ++n ) {
+				auto const pos = static_cast<ptrdiff_t>( n );
+				if( carry and not static_cast<bool>( first_flag[pos] ) ) {
+					carry = binary_op( *carry, in[pos] );
 				} else {
-					p1_results[n] = value;
+					carry = static_cast<value_t>( in[pos] );
 				}
+				out[pos] = *carry;
 			}
 		};
-		// Sum each sub range, but complete the first output as it does
-		// not have to be scanned twice
-		ts.wait_for( partition_range_pos(
-		  ranges,
-		  [binary_op = daw::mutable_capture( binary_op ),
-		   range_out = daw::mutable_capture( range_out ),
-		   add_result]( daw::view<Iterator> rng, size_t n ) {
-			  if( n == 0 ) {
-				  auto const lst = std::partial_sum( rng.cbegin( ), rng.cend( ),
-				                                     range_out->begin( ), *binary_op );
-				  add_result(
-				    n, *std::next( range_out->begin( ),
-				                   std::distance( range_out->begin( ), lst ) - 1 ) );
-				  return;
+		if( should_run_inline<in_value_t>( range_in.size( ), hint, ts ) ) {
+			scan_segment( 0, range_in.size( ), std::optional<value_t>( ) );
+			return;
+		}
+		// Tiles reduce to whether they start a new segment and the sum of
+		// their last segment.  Combining these is associative
+		using segment_t = std::pair<bool, value_t>;
+		auto const combine = [&]( segment_t const &lhs, segment_t const &rhs ) {
+			if( rhs.first ) {
+				return rhs;
+			}
+			return segment_t( lhs.first, binary_op( lhs.second, rhs.second ) );
+		};
+		lookback_scan<segment_t>(
+		  range_in.size( ), scan_tile_size<value_t>,
+		  [&]( size_t first, size_t last ) {
+			  auto result = segment_t(
+			    static_cast<bool>( first_flag[static_cast<ptrdiff_t>( first )] ),
+			    in[static_cast<ptrdiff_t>( first )] );
+			  for( auto n = first + 1U; n < last; ++n ) {
+				  auto const pos = static_cast<ptrdiff_t>( n );
+				  if( static_cast<bool>( first_flag[pos] ) ) {
+					  result = segment_t( true, in[pos] );
+				  } else {
+					  result.second = binary_op( result.second, in[pos] );
+				  }
 			  }
-			  value_t result = rng.pop_front( );
-			  result = daw::algorithm::reduce( rng.cbegin( ), rng.cend( ), result,
-			                                   *binary_op );
-			  add_result( n, result );
+			  return result;
+		  },
+		  [&]( size_t first, size_t last,
+		       std::optional<segment_t> const &prefix ) {
+			  scan_segment( first, last,
+			                prefix ? std::optional<value_t>( prefix->second )
+			                       : std::optional<value_t>( ) );
 		  },
-		  ts ) );
+		  combine, ts );
+	}
 
-		ts.wait_for( partition_range_pos(
-		  ranges,
-		  [&p1_results, range_in = daw::mutable_capture( range_in ),
-		   range_out = daw::mutable_capture( range_out ),
-		   binary_op = daw::mutable_capture( binary_op )](
-		    daw::view<Iterator> cur_range, size_t n ) {
-			  auto out_pos =
-			    std::next( range_out->begin( ),
-			               std::distance( range_in->begin( ), cur_range.begin( ) ) );
-
-			  auto sum = ( *binary_op )( *p1_results[n], cur_range.pop_front( ) );
-
-			  *( out_pos++ ) = sum;
-			  while( not cur_range.empty( ) ) {
-				  sum = ( *binary_op )( sum, cur_range.pop_front( ) );
-				  *out_pos = sum;
-				  ++out_pos;
+	/// Stream compaction of [0, count) in one look-back pass.  Each tile
+	/// records keep( n ) for its items and counts the kept ones, the counts
+	/// are scanned into offsets and each item of the tile is then passed on in
+	/// order.  A kept item goes to on_kept( n, pos ) with pos the number of
+	/// kept items before it, any other to on_removed( n, pos ) with pos the
+	/// number of removed items before it.  Returns how many were kept
+	template<typename T, typename Keep, typename OnKept, typename OnRemoved>
+	[[nodiscard]] size_t parallel_compact( size_t const count, Keep const &keep,
+	                                       OnKept const &on_kept,
+	                                       OnRemoved const &on_removed,
+	                                       task_scheduler &ts ) {
+		if( count == 0 ) {
+			return 0;
+		}
+		// keep( n ) is called once, the scatter reads the recorded result
+		auto flags = std::unique_ptr<bool[]>( new bool[count] );
+		size_t total = 0;
+		lookback_scan<size_t>(
+		  count, scan_tile_size<T>,
+		  [&]( size_t first, size_t last ) {
+			  size_t kept = 0;
+			  for( auto n = first; n < last; ++n ) {
+				  flags[n] = static_cast<bool>( keep( n ) );
+				  kept += static_cast<size_t>( flags[n] );
+			  }
+			  return kept;
+		  },
+		  [&]( size_t first, size_t last, std::optional<size_t> const &prefix ) {
+			  auto kept = prefix.value_or( 0U );
+			  for( auto n = first; n < last; ++n ) {
+				  if( flags[n] ) {
+					  on_kept( n, kept );
+					  ++kept;
+				  } else {
+					  on_removed( n, n - kept );
+				  }
+			  }
+			  if( last == count ) {
+				  total = kept;
 			  }
 		  },
-		  ts, 1 ) );
+		  std::plus<>{ }, ts );
+		return total;
+	}
+
+	template<typename Iterator, typename OutputIterator,
+	         typename UnaryPredicate>
+	[[nodiscard]] OutputIterator
+	parallel_copy_if( daw::view<Iterator> range, OutputIterator first_out,
+	                  UnaryPredicate const &pred, task_scheduler ts,
+	                  cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			return std::copy_if( range.begin( ), range.end( ), first_out, pred );
+		}
+		auto const in = range.begin( );
+		auto const kept = parallel_compact<value_t>(
+		  range.size( ),
+		  [&]( size_t n ) { return pred( in[static_cast<ptrdiff_t>( n )] ); },
+		  [&]( size_t n, size_t pos ) {
+			  first_out[static_cast<ptrdiff_t>( pos )] =
+			    in[static_cast<ptrdiff_t>( n )];
+		  },
+		  []( size_t, size_t ) {}, ts );
+		return std::next( first_out, static_cast<ptrdiff_t>( kept ) );
+	}
+
+	/// Move the items of range for which keep( n ) is true to its front, in
+	/// order, by compacting them into a buffer and moving it back.  With
+	/// KeepRemoved the other items follow them in order, otherwise they are
+	/// left moved from.  keep must only look at item n, it may be moved from
+	/// as soon as its own tile is done.  Returns how many were kept
+	template<bool KeepRemoved, typename Iterator, typename Keep>
+	[[nodiscard]] size_t parallel_compact_in_place( daw::view<Iterator> range,
+	                                                Keep const &keep,
+	                                                task_scheduler &ts ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		static_assert( std::is_default_constructible_v<value_t>,
+		               "The items must be default constructible to be buffered "
+		               "while they are compacted" );
+		auto const count = range.size( );
+		auto const in = range.begin( );
+		auto buffer = std::vector<value_t>( count );
+		// Removed items fill the buffer from the back
+		auto const kept = parallel_compact<value_t>(
+		  count, keep,
+		  [&]( size_t n, size_t pos ) {
+			  buffer[pos] = daw::move( in[static_cast<ptrdiff_t>( n )] );
+		  },
+		  [&]( size_t n, size_t pos ) {
+			  if constexpr( KeepRemoved ) {
+				  buffer[count - 1U - pos] =
+				    daw::move( in[static_cast<ptrdiff_t>( n )] );
+			  } else {
+				  Unused( n );
+				  Unused( pos );
+			  }
+		  },
+		  ts );
+		auto const moved = KeepRemoved ? count : kept;
+		parallel_for_each_index(
+		  buffer.begin( ), std::next( buffer.begin( ),
+		                              static_cast<ptrdiff_t>( moved ) ),
+		  [&]( size_t n ) {
+			  auto &item = n < kept ? buffer[n] : buffer[count - 1U - ( n - kept )];
+			  in[static_cast<ptrdiff_t>( n )] = daw::move( item );
+		  },
+		  ts );
+		return kept;
+	}
+
+	template<typename Iterator, typename UnaryPredicate>
+	[[nodiscard]] Iterator parallel_remove_if( daw::view<Iterator> range,
+	                                           UnaryPredicate const &pred,
+	                                           task_scheduler ts,
+	                                           cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			return std::remove_if( range.begin( ), range.end( ), pred );
+		}
+		auto const in = range.begin( );
+		auto const kept = parallel_compact_in_place<false>(
+		  range,
+		  [&]( size_t n ) {
+			  return not static_cast<bool>( pred( in[static_cast<ptrdiff_t>( n )] ) );
+		  },
+		  ts );
+		return std::next( in, static_cast<ptrdiff_t>( kept ) );
+	}
+
+	template<typename Iterator, typename UnaryPredicate>
+	[[nodiscard]] Iterator
+	parallel_stable_partition( daw::view<Iterator> range,
+	                           UnaryPredicate const &pred, task_scheduler ts,
+	                           cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			return std::stable_partition( range.begin( ), range.end( ), pred );
+		}
+		auto const in = range.begin( );
+		auto const kept = parallel_compact_in_place<true>(
+		  range,
+		  [&]( size_t n ) { return pred( in[static_cast<ptrdiff_t>( n )] ); },
+		  ts );
+		return std::next( in, static_cast<ptrdiff_t>( kept ) );
+	}
+
+	template<typename Iterator, typename BinaryPredicate>
+	[[nodiscard]] Iterator parallel_unique( daw::view<Iterator> range,
+	                                        BinaryPredicate const &pred,
+	                                        task_scheduler ts,
+	                                        cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			return std::unique( range.begin( ), range.end( ), pred );
+		}
+		// Whether an item is kept depends on the one before it, which the
+		// compaction may move away first, so that is decided up front
+		auto const in = range.begin( );
+		auto is_first = std::unique_ptr<bool[]>( new bool[range.size( )] );
+		parallel_for_each_index(
+		  range.begin( ), range.end( ),
+		  [&]( size_t n ) {
+			  auto const pos = static_cast<ptrdiff_t>( n );
+			  is_first[n] = n == 0 or not static_cast<bool>(
+			                            pred( in[pos - 1], in[pos] ) );
+		  },
+		  ts, hint );
+		auto const kept = parallel_compact_in_place<false>(
+		  range, [&]( size_t n ) { return is_first[n]; }, ts );
+		return std::next( in, static_cast<ptrdiff_t>( kept ) );
+	}
+
+	/// Quickselect with parallel partitions.  Each round takes the median of
+	/// evenly spaced samples as the pivot and splits the range into the items
+	/// before it, those equivalent to it and those after it, then continues in
+	/// the part holding nth.  Parts small enough to run inline finish with
+	/// std::nth_element
+	template<typename Iterator, typename Compare>
+	void parallel_nth_element( daw::view<Iterator> range, Iterator nth,
+	                           Compare const &cmp, task_scheduler ts,
+	                           cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if constexpr( not std::is_default_constructible_v<value_t> or
+		              not std::is_copy_constructible_v<value_t> ) {
+			// Partitions are buffered and the pivot is a copy
+			std::nth_element( range.begin( ), nth, range.end( ), cmp );
+		} else {
+			constexpr size_t sample_count = 63U;
+			auto first = range.begin( );
+			auto last = range.end( );
+			while( nth != last ) {
+				auto const size = static_cast<size_t>( std::distance( first, last ) );
+				if( size <= sample_count or
+				    should_run_inline<value_t>( size, hint, ts ) ) {
+					std::nth_element( first, nth, last, cmp );
+					return;
+				}
+				auto samples = std::vector<value_t>( );
+				samples.reserve( sample_count );
+				for( size_t n = 0; n < sample_count; ++n ) {
+					samples.push_back(
+					  first[static_cast<ptrdiff_t>( n * size / sample_count )] );
+				}
+				auto const mid = std::next( samples.begin( ), sample_count / 2U );
+				std::nth_element( samples.begin( ), mid, samples.end( ), cmp );
+				auto const pivot = *mid;
+
+				auto const lower_end = parallel_stable_partition(
+				  daw::view( first, last ),
+				  [&]( auto const &v ) { return cmp( v, pivot ); }, ts, hint );
+				if( nth < lower_end ) {
+					last = lower_end;
+					continue;
+				}
+				auto const equal_end = parallel_stable_partition(
+				  daw::view( lower_end, last ),
+				  [&]( auto const &v ) { return not cmp( pivot, v ); }, ts, hint );
+				if( nth < equal_end ) {
+					return;
+				}
+				first = equal_end;
+			}
+		}
+	}
+
+	/// The k first items of range in the order of cmp, sorted.  Each part of
+	/// the range keeps a bounded heap of its best k items, the heaps are
+	/// merged at the end
+	template<typename PartitionPolicy = split_range_t<>, typename Iterator,
+	         typename Compare>
+	[[nodiscard]] auto parallel_top_k( daw::view<Iterator> range, size_t k,
+	                                   Compare const &cmp, task_scheduler ts,
+	                                   cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		auto const best_of = [&]( daw::view<Iterator> rng ) {
+			// A heap with the worst of the k best items on top
+			auto heap = std::vector<value_t>( );
+			heap.reserve( std::min( k, rng.size( ) ) );
+			for( auto it = rng.begin( ); it != rng.end( ); ++it ) {
+				if( heap.size( ) < k ) {
+					heap.push_back( *it );
+					std::push_heap( heap.begin( ), heap.end( ), cmp );
+				} else if( cmp( *it, heap.front( ) ) ) {
+					std::pop_heap( heap.begin( ), heap.end( ), cmp );
+					heap.back( ) = *it;
+					std::push_heap( heap.begin( ), heap.end( ), cmp );
+				}
+			}
+			return heap;
+		};
+		auto result = std::vector<value_t>( );
+		if( k == 0 or range.empty( ) ) {
+			return result;
+		}
+		if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+			result = best_of( range );
+		} else {
+			auto const ranges = PartitionPolicy{}( range, ts.size( ) );
+			auto heaps = std::vector<std::vector<value_t>>( ranges.size( ) );
+			run_partition_range_pos(
+			  ranges,
+			  [&]( daw::view<Iterator> rng, size_t n ) {
+				  heaps[n] = best_of( rng );
+			  },
+			  ts );
+			result = daw::move( heaps[0] );
+			for( size_t n = 1; n < heaps.size( ); ++n ) {
+				std::move( heaps[n].begin( ), heaps[n].end( ),
+				           std::back_inserter( result ) );
+			}
+			if( result.size( ) > k ) {
+				auto const kth =
+				  std::next( result.begin( ), static_cast<ptrdiff_t>( k ) );
+				std::nth_element( result.begin( ), kth, result.end( ), cmp );
+				result.erase( kth, result.end( ) );
+			}
+		}
+		std::sort( result.begin( ), result.end( ), cmp );
+		return result;
+	}
+
+	/// How many items a part of find_if, any_of or equal checks between looks
+	/// at the flag that tells it another part already decided the result
+	inline constexpr size_t short_circuit_block_size = 1024U;
+
+	/// std::find_if, giving up and returning range.end( ) once stop( ) is true.
+	/// stop is called every short_circuit_block_size items
+	template<typename Iterator, typename UnaryPredicate, typename Stop>
+	[[nodiscard]] Iterator find_if_until( daw::view<Iterator> range,
+	                                      UnaryPredicate const &pred,
+	                                      Stop const &stop ) {
+		auto first = range.begin( );
+		auto const last = range.end( );
+		while( first != last ) {
+			if( stop( ) ) {
+				return last;
+			}
+			auto const block_last =
+			  std::next( first, std::min( std::distance( first, last ),
+			                              static_cast<std::ptrdiff_t>(
+			                                short_circuit_block_size ) ) );
+			auto const it = std::find_if( first, block_last, pred );
+			if( it != block_last ) {
+				return it;
+			}
+			first = block_last;
+		}
+		return last;
 	}
 
 	template<typename PartitionPolicy = split_range_t<>, typename Iterator,
 	         typename UnaryPredicate>
 	[[nodiscard]] Iterator parallel_find_if( daw::view<Iterator> range_in,
 	                                         UnaryPredicate &&pred,
-	                                         task_scheduler ts ) {
+	                                         task_scheduler ts,
+	                                         cost_hint hint = cost_hint{ } ) {
 
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range_in.size( ), hint, ts ) ) {
+			return ::std::find_if( range_in.begin( ), range_in.end( ), pred );
+		}
 		auto const ranges = PartitionPolicy{}( range_in, ts.size( ) );
-		auto results = std::vector<std::optional<Iterator>>( ranges.size( ) );
-
-		ts.wait_for( partition_range_pos(
+		auto results =
+		  std::vector<daw::parallel::cache_padded<std::optional<Iterator>>>(
+		    ranges.size( ) );
+		// The leftmost part with a match so far.  Parts to its right give up,
+		// the ones to its left keep going as they may hold an earlier match
+		auto first_found = std::atomic_size_t( ranges.size( ) );
+
+		run_partition_range_pos(
 		  ranges,
-		  [&results, pred]( daw::view<Iterator> range, size_t pos ) {
-			  auto it = ::std::find_if( range.begin( ), range.end( ), pred );
-			  if( it != range.end( ) ) {
-				  results[pos] = it;
+		  [&results, &first_found, pred]( daw::view<Iterator> range, size_t pos ) {
+			  auto it = find_if_until( range, pred, [&]( ) {
+				  return first_found.load( std::memory_order_relaxed ) < pos;
+			  } );
+			  if( it == range.end( ) ) {
+				  return;
 			  }
+			  results[pos].value = it;
+			  auto found = first_found.load( std::memory_order_relaxed );
+			  while( pos < found and
+			         not first_found.compare_exchange_weak(
+			           found, pos, std::memory_order_relaxed ) ) {}
 		  },
-		  ts ) );
+		  ts );
 
 		for( auto const &it : results ) {
-			if( it ) {
-				return *it;
+			if( *it ) {
+				return **it;
 			}
 		}
 		return range_in.end( );
@@ -562,53 +2422,111 @@ namespace daw::algorithm::parallel::impl {
 	         typename Iterator2, typename BinaryPredicate>
 	[[nodiscard]] bool parallel_equal( Iterator1 first1, Iterator1 last1,
 	                                   Iterator2 first2, Iterator2 last2,
-	                                   BinaryPredicate pred, task_scheduler ts ) {
+	                                   BinaryPredicate pred, task_scheduler ts,
+	                                   cost_hint hint = cost_hint{ } ) {
 		if( std::distance( first1, last1 ) != std::distance( first2, last2 ) ) {
 			return false;
 		}
+		using value_t = typename std::iterator_traits<Iterator1>::value_type;
+		if( should_run_inline<value_t>(
+		      static_cast<size_t>( std::distance( first1, last1 ) ), hint, ts ) ) {
+			return sequential_equal( first1, last1, first2, last2, pred );
+		}
 		auto const ranges1 = PartitionPolicy{}( first1, last1, ts.size( ) );
 		auto const ranges2 = PartitionPolicy{}( first2, last2, ts.size( ) );
 
-		::std::atomic_char all_equal = static_cast<char>( true );
+		// Cleared by the first mismatch, every part stops once it sees that
+		auto all_equal = std::atomic_bool( true );
 
-		ts.wait_for( partition_range_pos(
+		run_partition_range_pos(
 		  ranges1,
 		  [&ranges2, pred, &all_equal]( daw::view<Iterator1> range1, size_t pos ) {
-			  auto range2 = ranges2[pos];
-			  all_equal &= ::std::equal( range1.cbegin( ), range1.cend( ),
-			                             range2.cbegin( ), range2.cend( ), pred );
+			  auto first1 = range1.cbegin( );
+			  auto const last1 = range1.cend( );
+			  auto first2 = ranges2[pos].cbegin( );
+			  while( first1 != last1 ) {
+				  if( not all_equal.load( std::memory_order_relaxed ) ) {
+					  return;
+				  }
+				  auto const count =
+				    std::min( std::distance( first1, last1 ),
+				              static_cast<std::ptrdiff_t>( short_circuit_block_size ) );
+				  auto const block_last1 = std::next( first1, count );
+				  auto const block_last2 = std::next( first2, count );
+				  if( not sequential_equal( first1, block_last1, first2, block_last2,
+				                            pred ) ) {
+					  all_equal.store( false, std::memory_order_relaxed );
+					  return;
+				  }
+				  first1 = block_last1;
+				  first2 = block_last2;
+			  }
 		  },
-		  ts ) );
-		return static_cast<bool>( all_equal );
+		  ts );
+		return all_equal.load( );
+	}
+
+	/// Is pred true for any item.  The first part to find one stops the others
+	template<typename PartitionPolicy = split_range_t<>, typename Iterator,
+	         typename UnaryPredicate>
+	[[nodiscard]] bool parallel_any_of( daw::view<Iterator> range_in,
+	                                    UnaryPredicate const &pred,
+	                                    task_scheduler ts,
+	                                    cost_hint hint = cost_hint{ } ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if( should_run_inline<value_t>( range_in.size( ), hint, ts ) ) {
+			return std::any_of( range_in.begin( ), range_in.end( ), pred );
+		}
+		auto const ranges = PartitionPolicy{}( range_in, ts.size( ) );
+		auto found = std::atomic_bool( false );
+		run_partition_range_pos(
+		  ranges,
+		  [&found, pred]( daw::view<Iterator> range, size_t ) {
+			  auto const it = find_if_until( range, pred, [&]( ) {
+				  return found.load( std::memory_order_relaxed );
+			  } );
+			  if( it != range.end( ) ) {
+				  found.store( true, std::memory_order_relaxed );
+			  }
+		  },
+		  ts );
+		return found.load( );
 	}
 
 	template<typename PartitionPolicy = split_range_t<2>, typename RandomIterator,
 	         typename UnaryPredicate>
 	[[nodiscard]] auto parallel_count( daw::view<RandomIterator> range_in,
-	                                   UnaryPredicate pred, task_scheduler ts ) {
+	                                   UnaryPredicate pred, task_scheduler ts,
+	                                   cost_hint hint = cost_hint{ } ) {
 		static_assert( PartitionPolicy::min_range_size >= 2,
 		               "Minimum range size must be >= 2" );
 		daw::exception::daw_throw_on_false( range_in.size( ) >= 2,
 		                                    "Must be at least 2 items in range" );
 
-		using result_t =
-		  decltype( std::count_if( range_in.begin( ), range_in.end( ), pred ) );
+		using result_t = decltype(
+		  sequential_count_if( range_in.begin( ), range_in.end( ), pred ) );
 
-		if( range_in.size( ) < PartitionPolicy::min_range_size ) {
-			return std::count_if( range_in.begin( ), range_in.end( ), pred );
+		using value_t =
+		  typename std::iterator_traits<RandomIterator>::value_type;
+		if( range_in.size( ) < PartitionPolicy::min_range_size or
+		    should_run_inline<value_t>( range_in.size( ), hint, ts ) ) {
+			return sequential_count_if( range_in.begin( ), range_in.end( ), pred );
 		}
 		auto const ranges = PartitionPolicy{}( range_in, ts.size( ) );
-		std::vector<result_t> results( ranges.size( ), 0 );
+		auto results =
+		  std::vector<daw::parallel::cache_padded<result_t>>( ranges.size( ) );
 
-		auto sem = partition_range_pos(
+		run_partition_range_pos(
 		  ranges,
 		  [&results, pred]( daw::view<RandomIterator> range, size_t n ) {
-			  results[n] = std::count_if( range.cbegin( ), range.cend( ), pred );
+			  results[n].value =
+			    sequential_count_if( range.cbegin( ), range.cend( ), pred );
 		  },
 		  ts );
-
-		ts.wait_for( sem );
-		return std::accumulate( results.cbegin( ), results.cend( ),
-		                        static_cast<result_t>( 0 ) );
+		auto result = static_cast<result_t>( 0 );
+		for( auto const &partial : results ) {
+			result += *partial;
+		}
+		return result;
 	}
 } // namespace daw::algorithm::parallel::impl
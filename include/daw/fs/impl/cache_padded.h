@@ -0,0 +1,71 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <daw/daw_move.h>
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace daw::parallel {
+#ifdef __cpp_lib_thread_hardware_interference_size
+	inline static constexpr size_t cache_line_size =
+	  ::std::hardware_destructive_interference_size;
+#else
+	inline static constexpr size_t cache_line_size = 128U; // safe default
+#endif
+
+	/// Holds a T on cache lines of its own.  Arrays of these keep the state
+	/// written by one worker or partition from sharing a line with that of its
+	/// neighbours, so they do not invalidate each other's caches
+	template<typename T>
+	struct alignas( cache_line_size ) cache_padded {
+		T value{ };
+
+		cache_padded( ) = default;
+
+		template<typename... Args,
+		         std::enable_if_t<std::is_constructible_v<T, Args...>,
+		                          std::nullptr_t> = nullptr>
+		explicit cache_padded( std::in_place_t, Args &&... args )
+		  : value( DAW_FWD( args )... ) {}
+
+		[[nodiscard]] T &operator*( ) & noexcept {
+			return value;
+		}
+
+		[[nodiscard]] T const &operator*( ) const &noexcept {
+			return value;
+		}
+
+		[[nodiscard]] T *operator->( ) noexcept {
+			return &value;
+		}
+
+		[[nodiscard]] T const *operator->( ) const noexcept {
+			return &value;
+		}
+	};
+} // namespace daw::parallel
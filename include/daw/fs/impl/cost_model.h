@@ -0,0 +1,69 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+
+#include "../task_scheduler.h"
+
+namespace daw::algorithm::parallel {
+	/// Rough cost of processing one item relative to a trivial operation on
+	/// a machine word.  Raise it when the callable is expensive so that
+	/// smaller inputs still go parallel
+	struct cost_hint {
+		std::size_t cost_per_item = 1;
+	};
+
+	namespace impl {
+		/// Estimated work, in trivial word operations, below which scheduling
+		/// tasks and waiting on them costs more than running on the caller
+		inline constexpr std::size_t min_parallel_work = 65'536;
+
+		/// True when a range of count items of type T is too little work to
+		/// pay for the scheduler, or there is no other worker to share it with
+		template<typename T>
+		[[nodiscard]] bool should_run_inline( std::size_t count, cost_hint hint,
+		                                      task_scheduler const &ts ) {
+			if( ts.size( ) < 2U ) {
+				return true;
+			}
+			constexpr std::size_t words =
+			  ( sizeof( T ) + sizeof( void * ) - 1U ) / sizeof( void * );
+			auto const per_item =
+			  words * ( hint.cost_per_item == 0 ? 1U : hint.cost_per_item );
+			// count * per_item < min_parallel_work, without overflowing
+			return count < ( min_parallel_work + per_item - 1U ) / per_item;
+		}
+
+		/// Highest cost_per_item at which an elementwise op is still bound by
+		/// the memory bandwidth rather than by the op itself
+		inline constexpr std::size_t max_bandwidth_bound_cost = 2;
+
+		/// True when an op of this cost is cheap enough to be limited to the
+		/// bandwidth workers of each NUMA node.  Costlier ops are partitioned
+		/// over every worker
+		[[nodiscard]] constexpr bool is_bandwidth_bound( cost_hint hint ) {
+			return hint.cost_per_item <= max_bandwidth_bound_cost;
+		}
+	} // namespace impl
+} // namespace daw::algorithm::parallel
@@ -0,0 +1,82 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace daw::parallel {
+	/// The NUMA nodes of the machine and the cpus on each that this process
+	/// may run on.  On Linux this comes from sysfs, everywhere else, or when
+	/// that fails, it is a single node holding every cpu
+	class cpu_topology {
+		std::vector<std::vector<unsigned>> m_node_cpus{ };
+
+	public:
+		cpu_topology( ) = default;
+		explicit cpu_topology( std::vector<std::vector<unsigned>> node_cpus );
+
+		/// Detected once and then cached
+		[[nodiscard]] static cpu_topology const &get( );
+
+		[[nodiscard]] inline std::size_t node_count( ) const {
+			return m_node_cpus.size( );
+		}
+
+		[[nodiscard]] std::size_t cpu_count( ) const;
+
+		[[nodiscard]] inline std::vector<unsigned> const &
+		node_cpus( std::size_t node ) const {
+			return m_node_cpus[node];
+		}
+	};
+
+	/// The cpus this process can really use.  hardware_concurrency( ) capped
+	/// by the affinity mask and, on Linux, a cgroup cpu quota rounded up, so
+	/// a container limited to 2 cpus on a 64 core host gets 2
+	[[nodiscard]] std::size_t available_cpu_count( );
+
+	/// Data cache sizes in bytes of one cpu.  llc is the last level, shared by
+	/// the cores of a socket or die
+	struct cache_sizes {
+		std::size_t l2 = 256U * 1024U;
+		std::size_t llc = 8U * 1024U * 1024U;
+	};
+
+	/// Detected once from sysfs on Linux.  Elsewhere, or when that fails, the
+	/// defaults of cache_sizes
+	[[nodiscard]] cache_sizes const &cpu_cache_sizes( );
+
+	/// Pin the calling thread to cpu.  Returns false when that is not
+	/// supported or allowed
+	bool pin_current_thread_to_cpu( unsigned cpu );
+
+	/// Let the calling thread run on any of cpus only.  Returns false when that
+	/// is not supported or allowed
+	bool set_current_thread_affinity( std::vector<unsigned> const &cpus );
+
+	/// Name the calling thread for debuggers and tools like top, where the
+	/// platform supports it.  Long names are cut to fit, 15 chars on Linux
+	bool set_current_thread_name( std::string const &name );
+} // namespace daw::parallel
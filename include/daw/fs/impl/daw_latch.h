@@ -21,6 +21,7 @@
 #include <ciso646>
 #include <condition_variable>
 #include <cstdint>
+#include <exception>
 #include <memory>
 
 namespace daw {
@@ -46,6 +47,9 @@ namespace daw {
 
 	class latch {
 		std::atomic<std::ptrdiff_t> m_count{ 1 };
+		// 0 none, 1 being stored, 2 m_exception is set
+		std::atomic<int> m_exception_state{ 0 };
+		std::exception_ptr m_exception{ };
 
 	public:
 		inline latch( ) = default;
@@ -55,20 +59,48 @@ namespace daw {
 		                          std::nullptr_t> = nullptr>
 		inline explicit latch( Integer count )
 		  : m_count( static_cast<std::ptrdiff_t>( count ) ) {
-			assert( count > 0 );
+			assert( count >= 0 );
 		}
 
 		inline void reset( ) {
+			m_exception = nullptr;
+			m_exception_state.store( 0, std::memory_order_relaxed );
 			m_count.store( 1, std::memory_order_release );
 		}
 
 		template<typename Integer, std::enable_if_t<std::is_integral_v<Integer>,
 		                                            std::nullptr_t> = nullptr>
 		inline void reset( Integer count ) {
+			m_exception = nullptr;
+			m_exception_state.store( 0, std::memory_order_relaxed );
 			m_count.store( static_cast<std::ptrdiff_t>( count ),
 			               std::memory_order_release );
 		}
 
+		/// Keep ex for the waiting thread if it is the first exception of the
+		/// group.  Call it before the matching notify( )
+		inline void set_exception( std::exception_ptr ex ) noexcept {
+			int expected = 0;
+			if( m_exception_state.compare_exchange_strong(
+			      expected, 1, std::memory_order_acq_rel ) ) {
+				m_exception = daw::move( ex );
+				m_exception_state.store( 2, std::memory_order_release );
+			}
+		}
+
+		/// True once a task of the group has failed.  The tasks that have not
+		/// started yet check this and skip their work
+		[[nodiscard]] inline bool has_exception( ) const noexcept {
+			return m_exception_state.load( std::memory_order_relaxed ) != 0;
+		}
+
+		/// Rethrow the first exception of the group, if any
+		inline void rethrow_if_exception( ) const {
+			if( m_exception_state.load( std::memory_order_acquire ) == 2 ) {
+				std::rethrow_exception( m_exception );
+			}
+		}
+
 		inline void add_notifier( ) {
 			(void)m_count.fetch_add( 1, std::memory_order_release );
 		}
@@ -76,7 +108,7 @@ namespace daw {
 		inline void notify( ) {
 			std::ptrdiff_t current =
 			  m_count.fetch_sub( 1, std::memory_order_release );
-			if( current == 0 ) {
+			if( current == 1 ) {
 				std::atomic_notify_all( &m_count );
 			}
 		}
@@ -84,7 +116,7 @@ namespace daw {
 		inline void notify_one( ) {
 			std::ptrdiff_t current =
 			  m_count.fetch_sub( 1, std::memory_order_release );
-			if( current == 0 ) {
+			if( current == 1 ) {
 				std::atomic_notify_one( &m_count );
 			}
 		}
@@ -174,6 +206,21 @@ namespace daw {
 			m_latch->wait( );
 		}
 
+		inline void set_exception( std::exception_ptr ex ) noexcept {
+			assert( m_latch );
+			m_latch->set_exception( daw::move( ex ) );
+		}
+
+		[[nodiscard]] inline bool has_exception( ) const noexcept {
+			assert( m_latch );
+			return m_latch->has_exception( );
+		}
+
+		inline void rethrow_if_exception( ) const {
+			assert( m_latch );
+			m_latch->rethrow_if_exception( );
+		}
+
 		[[nodiscard]] inline bool try_wait( ) const {
 			assert( m_latch );
 			return m_latch->try_wait( );
@@ -237,11 +284,35 @@ namespace daw {
 			m_latch->notify( );
 		}
 
+		/// Rearm for count notifies, clearing any exception.  Only while nobody
+		/// is waiting on or notifying it
+		template<typename Integer, std::enable_if_t<std::is_integral_v<Integer>,
+		                                            std::nullptr_t> = nullptr>
+		inline void reset( Integer count ) {
+			assert( m_latch );
+			m_latch->reset( count );
+		}
+
 		inline void wait( ) const {
 			assert( m_latch );
 			m_latch->wait( );
 		}
 
+		inline void set_exception( std::exception_ptr ex ) noexcept {
+			assert( m_latch );
+			m_latch->set_exception( daw::move( ex ) );
+		}
+
+		[[nodiscard]] inline bool has_exception( ) const noexcept {
+			assert( m_latch );
+			return m_latch->has_exception( );
+		}
+
+		inline void rethrow_if_exception( ) const {
+			assert( m_latch );
+			m_latch->rethrow_if_exception( );
+		}
+
 		[[nodiscard]] inline bool try_wait( ) const {
 			assert( m_latch );
 			return m_latch->try_wait( );
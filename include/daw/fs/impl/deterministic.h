@@ -0,0 +1,95 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <daw/daw_move.h>
+
+namespace daw::algorithm::parallel {
+	/// Ask reduce, map_reduce, scan and exclusive_scan for results that only
+	/// depend on the input, not on the number of workers or how the work was
+	/// split.  The input is cut into blocks of block_size items, each reduced
+	/// from left to right, and the blocks are combined in an order fixed by
+	/// their count.  The same block_size gives the same floating point result
+	/// on any machine, and the blocks still run in parallel
+	struct deterministic {
+		std::size_t block_size = 4096U;
+		/// Add floating point values reduced with std::plus by compensated
+		/// summation, which keeps the rounding error of every addition.  Only
+		/// reduce and map_reduce use it
+		bool compensated = false;
+	};
+
+	namespace impl {
+		/// A floating point sum together with the rounding error lost by the
+		/// additions so far ( Neumaier )
+		template<typename T>
+		struct compensated_sum {
+			T sum{ };
+			T error{ };
+
+			constexpr void add( T const &value ) {
+				auto const total = sum + value;
+				if( std::abs( sum ) >= std::abs( value ) ) {
+					error += ( sum - total ) + value;
+				} else {
+					error += ( value - total ) + sum;
+				}
+				sum = total;
+			}
+
+			constexpr void add( compensated_sum const &other ) {
+				add( other.sum );
+				error += other.error;
+			}
+
+			[[nodiscard]] constexpr T value( ) const {
+				return sum + error;
+			}
+		};
+
+		/// Combine values by a balanced pairwise tree, neighbours first.  The
+		/// shape of the tree only depends on values.size( )
+		template<typename T, typename BinaryOp>
+		[[nodiscard]] T pairwise_combine( std::vector<T> values,
+		                                  BinaryOp const &binary_op ) {
+			assert( not values.empty( ) );
+			for( auto width = values.size( ); width > 1U;
+			     width = ( width + 1U ) / 2U ) {
+				for( std::size_t n = 0; n + 1U < width; n += 2U ) {
+					values[n / 2U] = binary_op( values[n], values[n + 1U] );
+				}
+				if( width % 2U != 0 ) {
+					values[width / 2U] = daw::move( values[width - 1U] );
+				}
+			}
+			return daw::move( values.front( ) );
+		}
+	} // namespace impl
+} // namespace daw::algorithm::parallel
@@ -0,0 +1,275 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <daw/daw_move.h>
+
+#include <array>
+#include <atomic>
+#include <atomic_wait>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace daw::parallel {
+	/// How many times a waiter retries, yielding between attempts, before it
+	/// parks
+	inline constexpr std::size_t default_spin_count = 128U;
+
+	/// Timed waiters park on one of a fixed set of these, picked by the
+	/// address waited on, as there is no timed atomic wait to use
+	struct timed_wait_slot {
+		std::mutex mut{ };
+		std::condition_variable cv{ };
+	};
+
+	[[nodiscard]] inline timed_wait_slot &
+	timed_wait_slot_for( void const *address ) {
+		static auto slots = std::array<timed_wait_slot, 64>{ };
+		auto const hash = reinterpret_cast<std::uintptr_t>( address ) >> 6U;
+		return slots[hash % slots.size( )];
+	}
+
+	/// An eventcount.  It lets a thread sleep until a condition that is checked
+	/// without locks, like a lock free queue being non-empty, may have changed.
+	/// A waiter calls prepare_wait( ), rechecks the condition and then either
+	/// calls cancel_wait( ) or wait( key ).  Anyone changing the condition calls
+	/// notify_one/notify_all afterwards.  Notifying is a fence and a load when
+	/// nobody is waiting
+	class event_count {
+		std::atomic<std::uint32_t> m_epoch{ 0 };
+		std::atomic<std::uint32_t> m_waiters{ 0 };
+		std::atomic<std::uint32_t> m_timed_waiters{ 0 };
+
+		/// After the epoch has moved on.  Either a timed waiter sees the new
+		/// epoch or this sees it waiting and takes its slot's lock
+		inline void notify_timed_waiters( ) noexcept {
+			if( m_timed_waiters.load( std::memory_order_seq_cst ) == 0 ) {
+				return;
+			}
+			auto &slot = timed_wait_slot_for( this );
+			{
+				auto const lck = std::lock_guard<std::mutex>( slot.mut );
+			}
+			slot.cv.notify_all( );
+		}
+
+	public:
+		using key_t = std::uint32_t;
+
+		event_count( ) noexcept = default;
+
+		event_count( event_count const & ) = delete;
+		event_count( event_count && ) = delete;
+		event_count &operator=( event_count const & ) = delete;
+		event_count &operator=( event_count && ) = delete;
+		~event_count( ) = default;
+
+		[[nodiscard]] inline key_t prepare_wait( ) noexcept {
+			(void)m_waiters.fetch_add( 1, std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			return m_epoch.load( std::memory_order_acquire );
+		}
+
+		/// Is anyone between prepare_wait( ) and waking up
+		[[nodiscard]] inline bool has_waiters( ) const noexcept {
+			return m_waiters.load( std::memory_order_relaxed ) != 0;
+		}
+
+		inline void cancel_wait( ) noexcept {
+			(void)m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+		}
+
+		/// Sleep until a notify after the prepare_wait( ) that returned key
+		inline void wait( key_t key ) noexcept {
+			while( m_epoch.load( std::memory_order_acquire ) == key ) {
+				std::atomic_wait_explicit( &m_epoch, key, std::memory_order_acquire );
+			}
+			(void)m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+		}
+
+		/// As wait, giving up at timeout_time
+		/// @returns false when it timed out before a notify
+		template<typename Clock, typename Duration>
+		[[nodiscard]] bool
+		wait_until( key_t key,
+		            std::chrono::time_point<Clock, Duration> timeout_time ) {
+			(void)m_timed_waiters.fetch_add( 1, std::memory_order_seq_cst );
+			auto &slot = timed_wait_slot_for( this );
+			bool notified = false;
+			{
+				auto lck = std::unique_lock<std::mutex>( slot.mut );
+				notified = slot.cv.wait_until( lck, timeout_time, [&] {
+					return m_epoch.load( std::memory_order_seq_cst ) != key;
+				} );
+			}
+			(void)m_timed_waiters.fetch_sub( 1, std::memory_order_relaxed );
+			(void)m_waiters.fetch_sub( 1, std::memory_order_relaxed );
+			return notified;
+		}
+
+		inline void notify_one( ) noexcept {
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			if( m_waiters.load( std::memory_order_relaxed ) == 0 ) {
+				return;
+			}
+			(void)m_epoch.fetch_add( 1, std::memory_order_seq_cst );
+			// Prefer an untimed waiter, a timed one wakes at its deadline anyway
+			if( m_timed_waiters.load( std::memory_order_seq_cst ) <
+			    m_waiters.load( std::memory_order_relaxed ) ) {
+				std::atomic_notify_one( &m_epoch );
+				return;
+			}
+			notify_timed_waiters( );
+		}
+
+		/// Wake only the waiters in wait_until, such as one whose deadline has
+		/// moved earlier, leaving the untimed waiters asleep
+		inline void notify_timed( ) noexcept {
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			if( m_waiters.load( std::memory_order_relaxed ) == 0 ) {
+				return;
+			}
+			(void)m_epoch.fetch_add( 1, std::memory_order_seq_cst );
+			notify_timed_waiters( );
+		}
+
+		inline void notify_all( ) noexcept {
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			if( m_waiters.load( std::memory_order_relaxed ) == 0 ) {
+				return;
+			}
+			(void)m_epoch.fetch_add( 1, std::memory_order_seq_cst );
+			std::atomic_notify_all( &m_epoch );
+			notify_timed_waiters( );
+		}
+	};
+
+	namespace event_count_impl {
+		/// Spins until it has made count tries
+		class spin_count_t {
+			std::size_t m_count;
+			std::size_t m_spins = 0;
+
+		public:
+			explicit constexpr spin_count_t( std::size_t count ) noexcept
+			  : m_count( count ) {}
+
+			[[nodiscard]] inline bool keep_spinning( ) noexcept {
+				return m_spins++ < m_count;
+			}
+
+			inline void reset( ) noexcept {
+				m_spins = 0;
+			}
+		};
+
+		/// Spins until spin_time has passed since the first try
+		class spin_time_t {
+			std::chrono::steady_clock::duration m_spin_time;
+			std::chrono::steady_clock::time_point m_start{ };
+			bool m_started = false;
+
+		public:
+			explicit spin_time_t(
+			  std::chrono::steady_clock::duration spin_time ) noexcept
+			  : m_spin_time( spin_time ) {}
+
+			[[nodiscard]] inline bool keep_spinning( ) {
+				auto const now = std::chrono::steady_clock::now( );
+				if( not m_started ) {
+					m_start = now;
+					m_started = true;
+				}
+				return now - m_start < m_spin_time;
+			}
+
+			inline void reset( ) noexcept {
+				m_started = false;
+			}
+		};
+
+		template<typename TryFunction, typename Predicate, typename Spin>
+		[[nodiscard]] std::invoke_result_t<TryFunction>
+		spin_then_park( event_count &ec, TryFunction &&try_fn,
+		                Predicate &&can_continue, Spin spin ) {
+			static_assert( std::is_invocable_v<TryFunction> );
+			static_assert( std::is_invocable_r_v<bool, Predicate> );
+			using result_t = std::invoke_result_t<TryFunction>;
+
+			while( can_continue( ) ) {
+				if( auto result = try_fn( ); static_cast<bool>( result ) ) {
+					return result;
+				}
+				if( spin.keep_spinning( ) ) {
+					std::this_thread::yield( );
+					continue;
+				}
+				auto const key = ec.prepare_wait( );
+				if( not can_continue( ) ) {
+					ec.cancel_wait( );
+					break;
+				}
+				if( auto result = try_fn( ); static_cast<bool>( result ) ) {
+					ec.cancel_wait( );
+					return result;
+				}
+				ec.wait( key );
+				spin.reset( );
+			}
+			return result_t{ };
+		}
+	} // namespace event_count_impl
+
+	/// Repeatedly call try_fn until its result is truthy or can_continue( )
+	/// returns false.  Spins a little first and then parks on ec.  Whatever
+	/// makes try_fn able to succeed, or makes can_continue false, must notify ec
+	/// @returns The successful result of try_fn or a value initialized result
+	template<typename TryFunction, typename Predicate>
+	[[nodiscard]] std::invoke_result_t<TryFunction>
+	spin_then_park( event_count &ec, TryFunction &&try_fn,
+	                Predicate &&can_continue,
+	                std::size_t spin_count = default_spin_count ) {
+		return event_count_impl::spin_then_park(
+		  ec, DAW_FWD( try_fn ), DAW_FWD( can_continue ),
+		  event_count_impl::spin_count_t( spin_count ) );
+	}
+
+	/// As spin_then_park, spinning for spin_time instead of a number of tries
+	template<typename TryFunction, typename Predicate, typename Rep,
+	         typename Period>
+	[[nodiscard]] std::invoke_result_t<TryFunction>
+	spin_then_park( event_count &ec, TryFunction &&try_fn,
+	                Predicate &&can_continue,
+	                std::chrono::duration<Rep, Period> spin_time ) {
+		return event_count_impl::spin_then_park(
+		  ec, DAW_FWD( try_fn ), DAW_FWD( can_continue ),
+		  event_count_impl::spin_time_t(
+		    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		      spin_time ) ) );
+	}
+} // namespace daw::parallel
@@ -22,11 +22,18 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 #include <daw/cpp_17.h>
 
+#include "../message_queue.h"
 #include "../task_scheduler.h"
 
 namespace daw::impl {
@@ -64,51 +71,100 @@ namespace daw::impl {
 	    S < daw::tuple_size_v<daw::remove_cvref_t<Tuple>> - 1 ),
 	  function_tag, last_function_tag>::type;
 
-	template<size_t pos, typename Package>
-	void call_task( Package &&, last_function_tag );
+	/// Marks a stage of a function_stream as cheap.  A cheap stage runs in the
+	/// task of the stage before it instead of being scheduled on its own
+	template<typename Function>
+	struct cheap_stage_t {
+		Function func;
 
-	template<size_t pos, typename Package>
-	void call_task( Package &&, function_tag );
+		template<typename... Args>
+		constexpr decltype( auto ) operator( )( Args &&... args ) const {
+			return func( std::forward<Args>( args )... );
+		}
+	};
+
+	template<typename>
+	inline constexpr bool is_cheap_stage_v = false;
+
+	template<typename Function>
+	inline constexpr bool is_cheap_stage_v<cheap_stage_t<Function>> = true;
+
+	template<size_t pos, typename Package, typename Args>
+	void call_task( Package const &, Args &&, last_function_tag );
+
+	template<size_t pos, typename Package, typename Args>
+	void call_task( Package const &, Args &&, function_tag );
+
+	/// Run stage pos of package on the tuple args in the current task
+	template<size_t pos, typename Package, typename Args>
+	void run_stage( Package const &package, Args &&args ) {
+		using functions_t = decltype( package->function_list( ) );
+		using which_t = typename impl::which_type_t<pos, functions_t>::category;
+		call_task<pos>( package, std::forward<Args>( args ), which_t{} );
+	}
+
+	/// Schedule stage pos on the tuple args.  Every stage of one call shares
+	/// the package, holding the functions and the result, so a hop only moves
+	/// args into the task
+	template<size_t pos, typename Package, typename Args>
+	void call( Package package, Args args ) {
+		if( not get_task_scheduler( ).add_task(
+		      [package = daw::mutable_capture( daw::move( package ) ),
+		       args = daw::mutable_capture( daw::move( args ) )]( ) {
+			      run_stage<pos>( *package, daw::move( *args ) );
+		      } ) ) {
+
+			throw ::daw::unable_to_add_task_exception( );
+		}
+	}
 
+	/// Schedule the first stage, its arguments are in the package
 	template<size_t pos, typename Package>
 	void call( Package &&package ) {
 		if( not get_task_scheduler( ).add_task(
 		      [package =
 		         daw::mutable_capture( std::forward<Package>( package ) )]( ) {
-			      using which_t = typename impl::which_type_t<
-			        pos, decltype( ( *package )->function_list( ) )>::category;
-
-			      call_task<pos>( daw::move( *package ), which_t{} );
+			      run_stage<pos>( *package, daw::move( ( *package )->targs( ) ) );
 		      } ) ) {
 
 			throw ::daw::unable_to_add_task_exception( );
 		}
 	}
 
-	template<size_t pos, typename Package>
-	void call_task( Package &&package, last_function_tag ) {
+	template<size_t pos, typename Package, typename Args>
+	void call_task( Package const &package, Args &&args, last_function_tag ) {
 		if( not package->continue_processing( ) ) {
 			return;
 		}
-		auto func = std::get<pos>( package->function_list( ) );
+		auto &func = std::get<pos>( package->function_list( ) );
 		auto client_data = package->result( ).lock( );
 		if( client_data ) {
 			client_data->from_code(
-			  [&]( ) { return daw::apply( func, daw::move( package->targs( ) ) ); } );
+			  [&]( ) { return daw::apply( func, daw::move( args ) ); } );
 		} else {
-			(void)daw::apply( func, daw::move( package->targs( ) ) );
+			(void)daw::apply( func, daw::move( args ) );
 		}
 	}
 
-	template<size_t pos, typename Package>
-	void call_task( Package &&package, function_tag ) {
-		if( package->continue_processing( ) ) {
+	template<size_t pos, typename Package, typename Args>
+	void call_task( Package const &package, Args &&args, function_tag ) {
+		if( not package->continue_processing( ) ) {
 			return;
 		}
-		auto func = std::get<pos>( package->function_list( ) );
+		using functions_t =
+		  daw::remove_cvref_t<decltype( package->function_list( ) )>;
+		auto &func = std::get<pos>( package->function_list( ) );
 		try {
-			call<pos + 1>( package->next_package(
-			  daw::apply( func, daw::move( package->targs( ) ) ) ) );
+			using result_t =
+			  daw::remove_cvref_t<decltype( daw::apply( func, daw::move( args ) ) )>;
+			auto next_args =
+			  std::tuple<result_t>( daw::apply( func, daw::move( args ) ) );
+			if constexpr( is_cheap_stage_v<
+			                std::tuple_element_t<pos + 1, functions_t>> ) {
+				run_stage<pos + 1>( package, daw::move( next_args ) );
+			} else {
+				call<pos + 1>( package, daw::move( next_args ) );
+			}
 		} catch( ... ) {
 			auto result = package->result( ).lock( );
 			if( result ) {
@@ -247,4 +303,195 @@ namespace daw::impl {
 	           NextFunction &&next_func ) noexcept {
 		return daw::move( lhs ).next( std::forward<NextFunction>( next_func ) );
 	}
+
+	/// std::tuple of what each of Functions is given, starting with T
+	template<typename T, typename... Functions>
+	struct stage_inputs {
+		using type = std::tuple<>;
+	};
+
+	template<typename T, typename Function, typename... Functions>
+	struct stage_inputs<T, Function, Functions...> {
+		using next_t = daw::remove_cvref_t<std::invoke_result_t<Function &, T>>;
+		static_assert( sizeof...( Functions ) == 0 or not std::is_void_v<next_t>,
+		               "Only the last stage of a channel_stream may return void" );
+
+		using type = decltype( std::tuple_cat(
+		  std::declval<std::tuple<T>>( ),
+		  std::declval<typename stage_inputs<next_t, Functions...>::type>( ) ) );
+	};
+
+	/// The channel in front of stage I.  Values that can be moved without
+	/// throwing go in a ring, any thread may push to the first stage and each
+	/// later stage has one feeding it
+	template<std::size_t I, typename T>
+	using stage_channel_t = std::conditional_t<
+	  not std::is_nothrow_move_constructible_v<T>,
+	  daw::parallel::bounded_channel<T>,
+	  std::conditional_t<I == 0, daw::parallel::mpmc_channel<T>,
+	                     daw::parallel::spsc_channel<T>>>;
+
+	template<typename Inputs, typename = std::make_index_sequence<
+	                            std::tuple_size_v<Inputs>>>
+	struct stage_channels;
+
+	template<typename... Inputs, std::size_t... Is>
+	struct stage_channels<std::tuple<Inputs...>, std::index_sequence<Is...>> {
+		using type = std::tuple<stage_channel_t<Is, Inputs>...>;
+	};
+
+	/// Shared by a channel_stream and its stage tasks.  Stage I takes items
+	/// from channel I and pushes its results to channel I + 1.  At most one task
+	/// per stage runs at a time and it stops when the next channel is full, so
+	/// every boundary holds at most capacity items.  Consuming from a channel
+	/// reschedules the stage feeding it
+	template<typename Input, typename... Functions>
+	class channel_stream_state
+	  : public std::enable_shared_from_this<
+	      channel_stream_state<Input, Functions...>> {
+
+		static constexpr std::size_t stage_count = sizeof...( Functions );
+		using inputs_t = typename stage_inputs<Input, Functions...>::type;
+		using channels_t = typename stage_channels<inputs_t>::type;
+
+		std::tuple<Functions...> m_funcs;
+		channels_t m_channels;
+		std::array<std::atomic_bool, stage_count> m_scheduled{ };
+		std::size_t m_batch_size;
+		task_scheduler m_ts;
+		// One notifier for each item in flight, plus one released by close( )
+		daw::shared_latch m_done = daw::shared_latch( 1 );
+		std::atomic_bool m_closed{ false };
+
+		template<std::size_t... Is>
+		channel_stream_state( std::size_t capacity, std::size_t batch_size,
+		                      task_scheduler ts, std::tuple<Functions...> &&funcs,
+		                      std::index_sequence<Is...> )
+		  : m_funcs( daw::move( funcs ) )
+		  , m_channels( ( (void)Is, capacity )... )
+		  , m_batch_size( batch_size )
+		  , m_ts( daw::move( ts ) ) {}
+
+		template<std::size_t I>
+		void schedule_stage( ) {
+			if( m_scheduled[I].exchange( true ) ) {
+				return;
+			}
+			auto self = this->shared_from_this( );
+			if( not m_ts.add_task( [self]( ) { self->template run_stage<I>( ); } ) ) {
+				// Keep the work ourselves rather than strand the items
+				run_stage<I>( );
+			}
+		}
+
+		/// Run item through stage I.  true when a result went to channel I + 1
+		template<std::size_t I, typename Item>
+		bool run_item( Item &&item ) {
+			if( m_done.has_exception( ) ) {
+				// A stage has failed, drop what is left
+				m_done.notify( );
+				return false;
+			}
+			try {
+				auto &func = std::get<I>( m_funcs );
+				if constexpr( I + 1 < stage_count ) {
+					auto result = func( DAW_FWD( item ) );
+					bool const pushed = std::get<I + 1>( m_channels ).try_push( result );
+					assert( pushed );
+					Unused( pushed );
+					return true;
+				} else {
+					(void)func( DAW_FWD( item ) );
+					m_done.notify( );
+					return false;
+				}
+			} catch( ... ) {
+				m_done.set_exception( std::current_exception( ) );
+				m_done.notify( );
+				return false;
+			}
+		}
+
+		template<std::size_t I>
+		[[nodiscard]] bool output_full( ) const {
+			if constexpr( I + 1 < stage_count ) {
+				return std::get<I + 1>( m_channels ).is_full( );
+			} else {
+				return false;
+			}
+		}
+
+		template<std::size_t I>
+		void run_stage( ) {
+			auto &in = std::get<I>( m_channels );
+			std::size_t taken = 0;
+			bool pushed = false;
+			while( taken < m_batch_size and not output_full<I>( ) ) {
+				auto item = in.try_pop( );
+				if( not item ) {
+					break;
+				}
+				++taken;
+				pushed = run_item<I>( daw::move( *item ) ) or pushed;
+			}
+			m_scheduled[I].store( false );
+			if constexpr( I > 0 ) {
+				if( taken > 0 ) {
+					// There is room in our input now
+					schedule_stage<I - 1>( );
+				}
+			}
+			if constexpr( I + 1 < stage_count ) {
+				if( pushed ) {
+					schedule_stage<I + 1>( );
+				}
+			}
+			if( not in.is_empty( ) and not output_full<I>( ) ) {
+				schedule_stage<I>( );
+			}
+		}
+
+	public:
+		channel_stream_state( std::size_t capacity, std::size_t batch_size,
+		                      task_scheduler ts, std::tuple<Functions...> &&funcs )
+		  : channel_stream_state( capacity, batch_size, daw::move( ts ),
+		                          daw::move( funcs ),
+		                          std::make_index_sequence<stage_count>{ } ) {
+			daw::exception::precondition_check( capacity > 0 and batch_size > 0,
+			                                    "capacity and batch_size must be "
+			                                    "larger than 0" );
+		}
+
+		[[nodiscard]] bool push( Input &value ) {
+			m_done.add_notifier( );
+			if( m_closed.load( ) ) {
+				m_done.notify( );
+				return false;
+			}
+			auto &in = std::get<0>( m_channels );
+			while( not in.try_push( value ) ) {
+				// The first stage is behind.  Workers help run the stages while
+				// they wait, other threads park until there is room
+				if( not m_ts.help_until( [&]( ) { return not in.is_full( ); } ) ) {
+					in.wait_for_room( );
+				}
+			}
+			schedule_stage<0>( );
+			return true;
+		}
+
+		void close( ) {
+			if( not m_closed.exchange( true ) ) {
+				m_done.notify( );
+			}
+		}
+
+		[[nodiscard]] daw::shared_latch const &done( ) const {
+			return m_done;
+		}
+
+		[[nodiscard]] task_scheduler const &get_task_scheduler( ) const {
+			return m_ts;
+		}
+	};
 } // namespace daw::impl
@@ -22,25 +22,42 @@
 
 #pragma once
 
+#include <atomic>
+#include <atomic_wait>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <utility>
 
 #include "daw_latch.h"
+#include "event_count.h"
 #include <daw/cpp_17.h>
 #include <daw/daw_expected.h>
 #include <daw/daw_move.h>
 #include <daw/daw_traits.h>
 #include <daw/daw_tuple_helper.h>
-#include <daw/parallel/daw_locked_value.h>
 
+#include "../cancellation.h"
 #include "../task_scheduler.h"
 
 namespace daw {
 	enum class future_status : uint8_t { ready, timeout, deferred, continued };
 
+	/// How a continuation added with next runs once its input is ready
+	/// scheduled: as a new task on the future's task_scheduler
+	/// run_inline: directly on the thread that completed the input, or on the
+	/// caller of next if the input is already complete.  For cheap
+	/// continuations, where the queue round trip costs more than the work
+	enum class continuation_mode : bool { scheduled, run_inline };
+
 	template<typename Result>
 	struct [[nodiscard]] future_result_t;
 
@@ -48,72 +65,142 @@ namespace daw {
 	struct future_result_t<void>;
 
 	namespace impl {
+		/// Complete fut with an operation_cancelled_exception when its token is
+		/// cancelled.  True when it did and the work must not run
+		template<typename Future>
+		[[nodiscard]] bool complete_if_cancelled( Future &fut ) {
+			if( not fut.get_cancellation_token( ).is_cancelled( ) ) {
+				return false;
+			}
+			fut.set_exception( operation_cancelled_exception{ } );
+			return true;
+		}
+
+		/// The state shared by a future and its producer, held in a single
+		/// allocation.  Waiters sleep on m_status, so there is no separate latch.
+		/// m_status doubles as the hand off between the producer and the one
+		/// continuation.  Each writes its side, m_result or m_next, then tries to
+		/// move m_status on from deferred.  Whichever fails saw the other side
+		/// first and runs m_next, so no lock is needed
 		template<typename expected_result_t, typename next_function_t>
 		struct [[nodiscard]] member_data_members {
-			using next_t =
-			  ::daw::lockable_value_t<next_function_t, std::recursive_mutex>;
-
 			task_scheduler m_task_scheduler;
-			next_t m_next = next_t( next_function_t( ) );
-			daw::shared_latch m_semaphore = daw::shared_latch( );
 			std::atomic<future_status> m_status = future_status::deferred;
+			// Set by waiters so that completing without any skips the wake up
+			mutable std::atomic_bool m_has_waiters = false;
+			mutable std::atomic_bool m_has_timed_waiters = false;
+			next_function_t m_next = next_function_t( );
+			// Only when the creator asked to be notified through a latch of its own
+			std::optional<daw::shared_latch> m_external_latch{ };
+			// Work for this future, and the futures continuing it, is dropped once
+			// this is cancelled
+			cancellation_token m_cancel{ };
 
 			expected_result_t m_result = expected_result_t( );
 
 			explicit member_data_members( task_scheduler ts )
 			  : m_task_scheduler( std::move( ts ) ) {}
 
+			member_data_members( task_scheduler ts, cancellation_token tok )
+			  : m_task_scheduler( std::move( ts ) )
+			  , m_cancel( std::move( tok ) ) {}
+
+			/// sem is notified when the future completes or is continued
 			member_data_members( daw::shared_latch sem, task_scheduler ts )
 			  : m_task_scheduler( std::move( ts ) )
-			  , m_semaphore( std::move( sem ) ) {}
+			  , m_external_latch( std::move( sem ) ) {}
 
 			template<typename Rep, typename Period>
 			[[nodiscard]] future_status
-			wait_for( std::chrono::duration<Rep, Period> rel_time ) {
-				if( future_status::deferred == m_status or
-				    future_status::ready == m_status ) {
-					return m_status;
-				}
-				if( m_semaphore.wait_for( rel_time ) ) {
-					return m_status;
-				}
-				return future_status::timeout;
+			wait_for( std::chrono::duration<Rep, Period> rel_time ) const {
+				return wait_until( std::chrono::steady_clock::now( ) + rel_time );
 			}
 
 			template<typename Clock, typename Duration>
-			[[nodiscard]] future_status
-			wait_until( std::chrono::time_point<Clock, Duration> timeout_time ) {
-				if( future_status::deferred == m_status or
-				    future_status::ready == m_status ) {
-					return m_status;
+			[[nodiscard]] future_status wait_until(
+			  std::chrono::time_point<Clock, Duration> timeout_time ) const {
+				if( try_wait( ) ) {
+					return status( );
 				}
-				if( m_semaphore.wait_until( timeout_time ) ) {
-					return m_status;
+				// As in wait, either notify sees the flag and takes the slot's lock
+				// or the predicate sees the new status.  The slots are shared with
+				// event_count, so a future does not carry a condition variable
+				m_has_timed_waiters.store( true, std::memory_order_seq_cst );
+				auto &slot = daw::parallel::timed_wait_slot_for( this );
+				auto lck = std::unique_lock<std::mutex>( slot.mut );
+				if( not slot.cv.wait_until( lck, timeout_time,
+				                            [&] { return try_wait( ); } ) ) {
+					return future_status::timeout;
 				}
-				return future_status::timeout;
+				return status( );
 			}
 
 			void wait( ) const {
-				if( m_status != future_status::ready ) {
-					m_semaphore.wait( );
+				if( try_wait( ) ) {
+					return;
+				}
+				// seq_cst pairs with the exchanges in try_publish/try_continue, either
+				// they see the flag or this sees the new status
+				m_has_waiters.store( true, std::memory_order_seq_cst );
+				auto current = m_status.load( std::memory_order_seq_cst );
+				while( current == future_status::deferred ) {
+					std::atomic_wait_explicit( &m_status, current,
+					                           std::memory_order_acquire );
+					current = m_status.load( std::memory_order_acquire );
 				}
 			}
 
 			[[nodiscard]] bool try_wait( ) const {
-				return m_semaphore.try_wait( );
+				return m_status.load( std::memory_order_acquire ) !=
+				       future_status::deferred;
 			}
 
 			void notify( ) {
-				m_semaphore.notify( );
-			}
-
-			void status( future_status new_status ) {
-				m_status = new_status;
+				if( m_has_waiters.load( std::memory_order_seq_cst ) ) {
+					std::atomic_notify_all( &m_status );
+				}
+				if( m_has_timed_waiters.load( std::memory_order_seq_cst ) ) {
+					auto &slot = daw::parallel::timed_wait_slot_for( this );
+					{
+						auto const lck = std::lock_guard<std::mutex>( slot.mut );
+					}
+					slot.cv.notify_all( );
+				}
+				if( m_external_latch ) {
+					m_external_latch->notify( );
+				}
 			}
 
 			future_status status( ) const {
 				return static_cast<future_status>( m_status );
 			}
+
+			/// Producer side, after m_result is written.  True when a continuation
+			/// was already added and the caller must pass m_result to m_next
+			[[nodiscard]] bool try_publish( ) {
+				auto expected = future_status::deferred;
+				if( m_status.compare_exchange_strong( expected, future_status::ready,
+				                                      std::memory_order_seq_cst ) ) {
+					notify( );
+					return false;
+				}
+				return true;
+			}
+
+			/// Continuation side, after m_next is written.  True when m_result
+			/// was already published and the caller must pass it to m_next
+			[[nodiscard]] bool try_continue( ) {
+				auto expected = future_status::deferred;
+				if( m_status.compare_exchange_strong( expected,
+				                                      future_status::continued,
+				                                      std::memory_order_seq_cst ) ) {
+					// Waiters wake up to find the future continued
+					notify( );
+					return false;
+				}
+				m_status.store( future_status::continued, std::memory_order_release );
+				return true;
+			}
 		};
 
 		template<size_t N, typename... Functions, typename... Results, typename Arg>
@@ -129,6 +216,9 @@ namespace daw {
 			  [result = daw::mutable_capture( std::get<N>( results ) ),
 			   func = daw::mutable_capture( std::get<N>( funcs ) ),
 			   arg = daw::mutable_capture( std::forward<Arg>( arg ) )]( ) {
+				  if( complete_if_cancelled( *result ) ) {
+					  return;
+				  }
 				  result->from_code( daw::move( *func ), daw::move( *arg ) );
 			  },
 			  ts );
@@ -147,6 +237,9 @@ namespace daw {
 			      [result = daw::mutable_capture( std::get<N>( results ) ),
 			       func = daw::mutable_capture( std::get<N>( funcs ) ),
 			       arg = daw::mutable_capture( arg )]( ) {
+				      if( complete_if_cancelled( *result ) ) {
+					      return;
+				      }
 				      result->from_code( daw::move( *func ), daw::move( *arg ) );
 			      },
 			      ts ) ) {
@@ -185,82 +278,61 @@ namespace daw {
 			explicit member_data_t( task_scheduler ts )
 			  : m_data( std::make_shared<data_t>( daw::move( ts ) ) ) {}
 
+			member_data_t( task_scheduler ts, cancellation_token tok )
+			  : m_data(
+			      std::make_shared<data_t>( daw::move( ts ), daw::move( tok ) ) ) {}
+
 			explicit member_data_t( daw::shared_latch sem, task_scheduler ts )
 			  : m_data(
 			      std::make_shared<data_t>( daw::move( sem ), daw::move( ts ) ) ) {}
 
+			template<typename Allocator>
+			member_data_t( std::allocator_arg_t, Allocator const &alloc,
+			               task_scheduler ts )
+			  : m_data( std::allocate_shared<data_t>( alloc, daw::move( ts ) ) ) {}
+
 		private:
 			explicit member_data_t( std::shared_ptr<data_t> &&dptr ) noexcept
 			  : m_data( daw::move( dptr ) ) {}
 
-			[[nodiscard]] decltype( auto ) pass_next( expected_result_t &&value ) {
-				auto nxt = m_data->m_next.get( );
-				daw::exception::precondition_check(
-				  *nxt, "Attempt to call next function on empty function" );
-
-				return ( *nxt )( std::move( value ) );
+			void publish( expected_result_t &&value ) {
+				m_data->m_result = daw::move( value );
+				if( m_data->try_publish( ) ) {
+					m_data->m_next( daw::move( m_data->m_result ) );
+				}
 			}
 
-			[[nodiscard]] decltype( auto )
-			pass_next( expected_result_t const &value ) {
-
-				auto nxt = m_data->m_next.get( );
-				::daw::exception::precondition_check(
-				  *nxt, "Attempt to call next function on empty function" );
-
-				return ( *nxt )( value );
+			template<typename Function>
+			void continue_with( Function &&func ) {
+				assert( m_data );
+				daw::exception::precondition_check(
+				  not m_data->m_next, "Can only set next function once" );
+				m_data->m_next = std::forward<Function>( func );
+				if( m_data->try_continue( ) ) {
+					m_data->m_next( daw::move( m_data->m_result ) );
+				}
 			}
 
 		public:
 			void set_value( expected_result_t &&value ) {
-				if( auto nxt = m_data->m_next.get( ); *nxt ) {
-					pass_next( daw::move( value ) );
-					return;
-				}
-				m_data->m_result = daw::move( value );
-				m_data->status( future_status::ready );
-				m_data->notify( );
-			} // namespace impl
+				publish( daw::move( value ) );
+			}
 
 			void set_value( expected_result_t const &value ) {
-				if( auto nxt = m_data->m_next.get( ); *nxt ) {
-					pass_next( value );
-					return;
-				}
-				m_data->m_result = value;
-				m_data->status( future_status::ready );
-				m_data->notify( );
+				publish( expected_result_t( value ) );
 			}
 
 			void set_value( base_result_t &&value ) {
-				if( auto nxt = m_data->m_next.get( ); *nxt ) {
-					pass_next(
-					  ::daw::construct_a<expected_result_t>( ::daw::move( value ) ) );
-					return;
-				}
-				m_data->m_result = daw::move( value );
-				m_data->status( future_status::ready );
-				m_data->notify( );
+				publish(
+				  ::daw::construct_a<expected_result_t>( ::daw::move( value ) ) );
 			}
 
 			void set_value( base_result_t const &value ) {
-				if( auto nxt = m_data->m_next.get( ); *nxt ) {
-					pass_next( ::daw::construct_a<expected_result_t>( value ) );
-					return;
-				}
-				m_data->m_result = value;
-				m_data->status( future_status::ready );
-				m_data->notify( );
+				publish( ::daw::construct_a<expected_result_t>( value ) );
 			}
 
 			void set_exception( std::exception_ptr ptr ) {
-				if( auto nxt = m_data->m_next.get( ); *nxt ) {
-					pass_next( ::daw::construct_a<expected_result_t>( ptr ) );
-					return;
-				}
-				m_data->m_result = ptr;
-				m_data->status( future_status::ready );
-				m_data->notify( );
+				publish( ::daw::construct_a<expected_result_t>( ptr ) );
 			}
 
 			[[nodiscard]] bool is_exception( ) const {
@@ -294,62 +366,73 @@ namespace daw {
 
 			template<typename Function, typename... Args>
 			void from_code( Function &&func, Args &&...args ) {
-				try {
-					set_value( expected_from_code( std::forward<Function>( func ),
-					                               std::forward<Args>( args )... ) );
-				} catch( ... ) { set_exception( std::current_exception( ) ); }
+				// Publish outside of the try, an inline continuation may throw and
+				// the result must only be published once
+				auto value = [&]( ) -> expected_result_t {
+					try {
+						return expected_from_code( std::forward<Function>( func ),
+						                           std::forward<Args>( args )... );
+					} catch( ... ) {
+						return ::daw::construct_a<expected_result_t>(
+						  std::current_exception( ) );
+					}
+				}( );
+				publish( daw::move( value ) );
 			}
 
 			template<typename Function,
 			         std::enable_if_t<
 			           not std::is_function_v<std::remove_reference_t<Function>>,
 			           std::nullptr_t> = nullptr>
-			[[nodiscard]] auto next( Function &&func ) {
-				assert( m_data );
-				auto nxt = m_data->m_next.get( );
-				assert( not( *nxt ) ); // can only set next function once
-
+			[[nodiscard]] auto next( Function &&func, continuation_mode mode,
+			                         cancellation_token tok ) {
 				using next_result_t =
 				  decltype( func( std::declval<base_result_t>( ) ) );
 
-				auto result =
-				  future_result_t<next_result_t>( m_data->m_task_scheduler );
-
-				*nxt = [result = daw::mutable_capture( result ),
-				        func = daw::mutable_capture( std::forward<Function>( func ) ),
-				        ts = daw::mutable_capture( m_data->m_task_scheduler ),
-				        self = *this]( expected_result_t value ) -> void {
-					if( not value.has_value( ) ) {
-						result->set_exception( value.get_exception_ptr( ) );
-						return;
-					}
-					if( not ts->add_task(
-					      [result = daw::mutable_capture( std::move( *result ) ),
-					       func = daw::mutable_capture( daw::move( *func ) ),
-					       v = daw::mutable_capture( daw::move( value.get( ) ) )]( ) {
-						      result->from_code( daw::move( *func ), daw::move( *v ) );
-					      } ) ) {
-
-						throw ::daw::unable_to_add_task_exception{ };
-					}
-				};
-				if( future_status::ready == m_data->status( ) ) {
-					pass_next( daw::move( m_data->m_result ) );
-					m_data->status( future_status::continued );
-				} else {
-					m_data->status( future_status::continued );
-					nxt.release( );
-					m_data->notify( );
-				}
+				auto result = future_result_t<next_result_t>(
+				  m_data->m_task_scheduler, daw::move( tok ) );
+
+				continue_with(
+				  [result = daw::mutable_capture( result ),
+				   func = daw::mutable_capture( std::forward<Function>( func ) ),
+				   ts = daw::mutable_capture( m_data->m_task_scheduler ),
+				   mode]( expected_result_t value ) -> void {
+					  if( not value.has_value( ) ) {
+						  result->set_exception( value.get_exception_ptr( ) );
+						  return;
+					  }
+					  if( complete_if_cancelled( *result ) ) {
+						  return;
+					  }
+					  if( mode == continuation_mode::run_inline ) {
+						  result->from_code( daw::move( *func ),
+						                     daw::move( value.get( ) ) );
+						  return;
+					  }
+					  if( not ts->add_task(
+					        [result = daw::mutable_capture( std::move( *result ) ),
+					         func = daw::mutable_capture( daw::move( *func ) ),
+					         v = daw::mutable_capture( daw::move( value.get( ) ) )]( ) {
+						        if( complete_if_cancelled( *result ) ) {
+							        return;
+						        }
+						        auto const span = trace_span( "future_result next" );
+						        result->from_code( daw::move( *func ), daw::move( *v ) );
+					        } ) ) {
+
+						  throw ::daw::unable_to_add_task_exception{ };
+					  }
+				  } );
 				return result;
 			}
 
+			template<typename Function>
+			void on_complete( Function &&func ) {
+				continue_with( std::forward<Function>( func ) );
+			}
+
 			template<typename... Functions>
 			[[nodiscard]] auto fork( Functions &&...funcs ) {
-				assert( m_data );
-				auto nxt = m_data->m_next.get( );
-				assert( not( *nxt ) ); // can only set next function once
-
 				using result_t =
 				  std::tuple<future_result_t<daw::remove_cvref_t<decltype( funcs(
 				    std::declval<expected_result_t>( ).get( ) ) )>>...>;
@@ -359,37 +442,31 @@ namespace daw {
 					using fut_t = future_result_t<decltype( f(
 					  std::declval<expected_result_t>( ).get( ) ) )>;
 
-					return fut_t( m_data->m_task_scheduler );
+					return fut_t( m_data->m_task_scheduler, m_data->m_cancel );
 				};
 				auto result = result_t( construct_future( funcs )... );
-				*nxt = [result = mutable_capture( result ),
-				        tpfuncs = daw::mutable_capture(
-				          std::tuple<daw::remove_cvref_t<Functions>...>(
-				            std::forward<Functions>( funcs )... ) ),
-				        ts = daw::mutable_capture( m_data->m_task_scheduler ),
-				        self = *this]( auto &&value )
-				  -> std::enable_if_t<::std::is_same_v<
-				    expected_result_t, daw::remove_cvref_t<decltype( value )>>> {
-					if( value.has_value( ) ) {
-						if( not ts->add_task( impl::add_fork_task( *ts, *result, *tpfuncs,
-						                                           value.get( ) ) ) ) {
-
-							throw ::daw::unable_to_add_task_exception{ };
-						}
-					} else {
-						daw::tuple::apply( *result,
-						                   [ptr = value.get_exception_ptr( )]( auto &t ) {
-							                   t.set_exception( ptr );
-						                   } );
-					}
-				};
-				m_data->status( future_status::continued );
-				if( future_status::ready == m_data->status( ) ) {
-					pass_next( daw::move( m_data->m_result ) );
-				} else {
-					nxt.release( );
-					m_data->notify( );
-				}
+				continue_with(
+				  [result = mutable_capture( result ),
+				   tpfuncs = daw::mutable_capture(
+				     std::tuple<daw::remove_cvref_t<Functions>...>(
+				       std::forward<Functions>( funcs )... ) ),
+				   ts = daw::mutable_capture( m_data->m_task_scheduler )](
+				    auto &&value )
+				    -> std::enable_if_t<::std::is_same_v<
+				      expected_result_t, daw::remove_cvref_t<decltype( value )>>> {
+					  if( value.has_value( ) ) {
+						  if( not ts->add_task( impl::add_fork_task(
+						        *ts, *result, *tpfuncs, value.get( ) ) ) ) {
+
+							  throw ::daw::unable_to_add_task_exception{ };
+						  }
+					  } else {
+						  daw::tuple::apply(
+						    *result, [ptr = value.get_exception_ptr( )]( auto &t ) {
+							    t.set_exception( ptr );
+						    } );
+					  }
+				  } );
 				return result;
 			}
 
@@ -400,8 +477,6 @@ namespace daw {
 				Unused( joiner );
 				Unused( funcs... );
 				assert( m_data );
-				auto nxt = m_data->m_next.get( );
-				assert( *nxt ); // can only set next function once
 
 				static_assert(
 				  ( std::is_invocable_v<
@@ -423,6 +498,18 @@ namespace daw {
 				m_data->wait( );
 			}
 
+			template<typename Rep, typename Period>
+			[[nodiscard]] future_status
+			wait_for( std::chrono::duration<Rep, Period> rel_time ) const {
+				return m_data->wait_for( rel_time );
+			}
+
+			template<typename Clock, typename Duration>
+			[[nodiscard]] future_status wait_until(
+			  std::chrono::time_point<Clock, Duration> timeout_time ) const {
+				return m_data->wait_until( timeout_time );
+			}
+
 			[[nodiscard]] bool try_wait( ) const {
 				return m_data->try_wait( );
 			}
@@ -468,37 +555,42 @@ namespace daw {
 			explicit member_data_t( task_scheduler ts )
 			  : m_data( std::make_shared<data_t>( daw::move( ts ) ) ) {}
 
+			member_data_t( task_scheduler ts, cancellation_token tok )
+			  : m_data(
+			      std::make_shared<data_t>( daw::move( ts ), daw::move( tok ) ) ) {}
+
 			explicit member_data_t( daw::shared_latch sem, task_scheduler ts )
 			  : m_data(
 			      std::make_shared<data_t>( daw::move( sem ), daw::move( ts ) ) ) {}
 
+			template<typename Allocator>
+			member_data_t( std::allocator_arg_t, Allocator const &alloc,
+			               task_scheduler ts )
+			  : m_data( std::allocate_shared<data_t>( alloc, daw::move( ts ) ) ) {}
+
 		private:
 			explicit member_data_t( std::shared_ptr<data_t> &&dptr ) noexcept
 			  : m_data( daw::move( dptr ) ) {}
 
-			void pass_next( expected_result_t &&value ) {
-				auto nxt = m_data->m_next.get( );
-				daw::exception::precondition_check(
-				  *nxt, "Attempt to call next function on empty function" );
+			void publish( expected_result_t &&value );
 
+			template<typename Function>
+			void continue_with( Function &&func ) {
+				assert( m_data );
 				daw::exception::precondition_check(
-				  not value.has_exception( ), "Unexpected exception in expected_t" );
-
-				( *nxt )( daw::move( value ) );
+				  not m_data->m_next, "Can only set next function once" );
+				m_data->m_next = std::forward<Function>( func );
+				if( m_data->try_continue( ) ) {
+					m_data->m_next( daw::move( m_data->m_result ) );
+				}
 			}
 
-			void pass_next( expected_result_t const &value ) {
-				auto nxt = m_data->m_next.get( );
-				daw::exception::precondition_check(
-				  *nxt, "Attempt to call next function on empty function" );
-
-				daw::exception::precondition_check(
-				  not value.has_exception( ), "Unexpected exception in expected_t" );
-
-				( *nxt )( value );
+		public:
+			template<typename Function>
+			void on_complete( Function &&func ) {
+				continue_with( std::forward<Function>( func ) );
 			}
 
-		public:
 			void set_value( expected_result_t result );
 			void set_value( );
 			void set_exception( std::exception_ptr ptr );
@@ -508,63 +600,67 @@ namespace daw {
 			void from_code( Function &&func, Args &&...args ) {
 				static_assert( traits::is_callable_v<Function, Args...>,
 				               "Cannot call func with args provided" );
+				// Publish outside of the try, an inline continuation may throw and
+				// the result must only be published once
+				auto value = expected_result_t( );
 				try {
 					func( std::forward<Args>( args )... );
-					set_value( );
-				} catch( ... ) { set_exception( std::current_exception( ) ); }
+					value = true;
+				} catch( ... ) {
+					value = expected_result_t{ std::current_exception( ) };
+				}
+				publish( daw::move( value ) );
 			}
 
 			template<typename Function>
-			[[nodiscard]] auto next( Function &&func ) {
-				auto nxt = m_data->m_next.get( );
-				daw::exception::precondition_check( not *nxt,
-				                                    "Can only set next function once" );
+			[[nodiscard]] auto next( Function &&func, continuation_mode mode,
+			                         cancellation_token tok ) {
 				using next_result_t =
 				  decltype( std::declval<std::remove_reference_t<Function>>( )( ) );
 
-				auto result =
-				  future_result_t<next_result_t>( m_data->m_task_scheduler );
-
-				*nxt = [result = daw::mutable_capture( result ),
-				        func = daw::mutable_capture( std::forward<Function>( func ) ),
-				        ts = daw::mutable_capture( m_data->m_task_scheduler ),
-				        self = *this]( expected_result_t value ) -> void {
-					if( value.has_value( ) ) {
-						if( ts->add_task(
-						      [result = daw::mutable_capture( daw::move( *result ) ),
-						       func = daw::mutable_capture( daw::move( *func ) )]( ) {
-							      result->from_code( daw::move( *func ) );
-						      } ) ) {
-
-							throw ::daw::unable_to_add_task_exception{ };
-						}
-					} else {
-						result->set_exception( value.get_exception_ptr( ) );
-					}
-				};
-				if( future_status::ready == m_data->status( ) ) {
-					pass_next( daw::move( m_data->m_result ) );
-					m_data->status( future_status::continued );
-				} else {
-					m_data->status( future_status::continued );
-					nxt.release( );
-					m_data->notify( );
-				}
+				auto result = future_result_t<next_result_t>(
+				  m_data->m_task_scheduler, daw::move( tok ) );
+
+				continue_with(
+				  [result = daw::mutable_capture( result ),
+				   func = daw::mutable_capture( std::forward<Function>( func ) ),
+				   ts = daw::mutable_capture( m_data->m_task_scheduler ),
+				   mode]( expected_result_t value ) -> void {
+					  if( not value.has_value( ) ) {
+						  result->set_exception( value.get_exception_ptr( ) );
+						  return;
+					  }
+					  if( complete_if_cancelled( *result ) ) {
+						  return;
+					  }
+					  if( mode == continuation_mode::run_inline ) {
+						  result->from_code( daw::move( *func ) );
+						  return;
+					  }
+					  if( not ts->add_task(
+					        [result = daw::mutable_capture( daw::move( *result ) ),
+					         func = daw::mutable_capture( daw::move( *func ) )]( ) {
+						        if( complete_if_cancelled( *result ) ) {
+							        return;
+						        }
+						        result->from_code( daw::move( *func ) );
+					        } ) ) {
+
+						  throw ::daw::unable_to_add_task_exception{ };
+					  }
+				  } );
 				return result;
 			}
 
 			template<typename... Functions>
 			[[nodiscard]] auto fork( Functions &&...funcs ) {
-				auto nxt = m_data->m_next.get( );
-				daw::exception::precondition_check( not( *nxt ),
-				                                    "Can only set next function once" );
 				using result_t = std::tuple<
 				  future_result_t<daw::remove_cvref_t<decltype( funcs( ) )>>...>;
 
 				auto const construct_future = [&]( auto &&f ) {
 					Unused( f );
 					using fut_t = future_result_t<decltype( f( ) )>;
-					return fut_t( m_data->m_task_scheduler );
+					return fut_t( m_data->m_task_scheduler, m_data->m_cancel );
 				};
 
 				auto result =
@@ -572,28 +668,20 @@ namespace daw {
 
 				auto tpfuncs = std::tuple<daw::remove_cvref_t<Functions>...>(
 				  std::forward<Functions>( funcs )... );
-				*nxt = [result, tpfuncs = daw::move( tpfuncs ),
-				        ts = m_data->m_task_scheduler,
-				        self = *this]( auto &&value ) mutable
-				  -> std::enable_if_t<std::is_same_v<
-				    expected_result_t, daw::remove_cvref_t<decltype( value )>>> {
+				continue_with( [result, tpfuncs = daw::move( tpfuncs ),
+				                ts = m_data->m_task_scheduler]( auto &&value ) mutable
+				                 -> std::enable_if_t<std::is_same_v<
+				                   expected_result_t,
+				                   daw::remove_cvref_t<decltype( value )>>> {
 					if( value.has_value( ) ) {
 						ts.add_task( impl::add_fork_task( ts, result, tpfuncs ) );
 					} else {
 						daw::tuple::apply( result,
-						                   [ptr = value.get_exeption_ptr( )]( auto &&t ) {
+						                   [ptr = value.get_exception_ptr( )]( auto &&t ) {
 							                   t.set_exception( ptr );
 						                   } );
 					}
-				};
-				if( future_status::ready == m_data->status( ) ) {
-					pass_next( daw::move( m_data->m_result ) );
-					m_data->status( future_status::continued );
-				} else {
-					m_data->status( future_status::continued );
-					nxt.release( );
-					m_data->notify( );
-				}
+				} );
 				return result;
 			}
 
@@ -602,9 +690,6 @@ namespace daw {
 				// TODO: finish implementing
 				Unused( joiner );
 				static_assert( ( std::is_invocable_v<Functions> and ... ) );
-				auto nxt = m_data->m_next.get( );
-				daw::exception::precondition_check( not( *nxt ),
-				                                    "Can only set next function once" );
 
 				auto const construct_future = [&]( auto &&f ) {
 					// Default constructs a future of the result type with the task
@@ -619,10 +704,11 @@ namespace daw {
 
 				auto tpfuncs = std::tuple( std::forward<Functions>( funcs )... );
 
-				*nxt = [result = ::daw::mutable_capture( result ),
-				        tpfuncs = ::daw::mutable_capture( daw::move( tpfuncs ) ),
-				        ts = ::daw::mutable_capture( m_data->m_task_scheduler ),
-				        self = *this]( auto const &value ) {
+				continue_with( [result = ::daw::mutable_capture( result ),
+				                tpfuncs =
+				                  ::daw::mutable_capture( daw::move( tpfuncs ) ),
+				                ts = ::daw::mutable_capture(
+				                  m_data->m_task_scheduler )]( auto const &value ) {
 					static_assert(
 					  std::is_same_v<expected_result_t,
 					                 daw::remove_cvref_t<decltype( value )>> );
@@ -634,15 +720,7 @@ namespace daw {
 					  result, [ptr = value.get_exception_ptr( )]( auto &&t ) {
 						  std::forward<decltype( t )>( t ).set_exception( ptr );
 					  } );
-				};
-				if( future_status::ready == m_data->status( ) ) {
-					pass_next( daw::move( m_data->m_result ) );
-					m_data->status( future_status::continued );
-				} else {
-					m_data->status( future_status::continued );
-					nxt.release( );
-					m_data->notify( );
-				}
+				} );
 				return result;
 			}
 
@@ -650,6 +728,18 @@ namespace daw {
 				m_data->wait( );
 			}
 
+			template<typename Rep, typename Period>
+			[[nodiscard]] future_status
+			wait_for( std::chrono::duration<Rep, Period> rel_time ) const {
+				return m_data->wait_for( rel_time );
+			}
+
+			template<typename Clock, typename Duration>
+			[[nodiscard]] future_status wait_until(
+			  std::chrono::time_point<Clock, Duration> timeout_time ) const {
+				return m_data->wait_until( timeout_time );
+			}
+
 			[[nodiscard]] inline bool try_wait( ) const {
 				return m_data->try_wait( );
 			}
@@ -27,12 +27,23 @@
 #include <daw/daw_move.h>
 #include <daw/daw_utility.h>
 
+#include <algorithm>
 #include <atomic>
 #include <atomic_wait>
+#include <cstddef>
 #include <memory>
+#include <optional>
+#include <system_error>
 #include <thread>
+#include <tuple>
 #include <type_traits>
 
+#if defined( __linux__ ) or defined( __APPLE__ )
+#include <climits>
+#include <pthread.h>
+#define DAW_FS_HAS_PTHREADS
+#endif
+
 namespace daw::parallel {
 	class stop_token_owner;
 	class ithread;
@@ -109,30 +120,101 @@ namespace daw::parallel {
 		}
 	}
 
+	/// How an ithread's thread is created
+	struct thread_options {
+		/// 0 keeps the platform default.  Only honoured where pthreads are
+		/// available and raised to PTHREAD_STACK_MIN when smaller
+		std::size_t stack_size = 0;
+	};
+
 	class ithread {
 		std::shared_ptr<stop_token_owner> m_continue =
 		  std::make_shared<stop_token_owner>( );
-		::std::thread m_thread;
+		::std::thread m_thread{ };
+#if defined( DAW_FS_HAS_PTHREADS )
+		// Used instead of m_thread when a stack size is asked for, std::thread
+		// cannot take one
+		std::optional<pthread_t> m_native{ };
+
+		template<typename Body>
+		[[nodiscard]] static pthread_t start_native( std::size_t stack_size,
+		                                             Body &&body ) {
+			using body_t = daw::remove_cvref_t<Body>;
+			auto owned = std::make_unique<body_t>( DAW_FWD( body ) );
+			pthread_attr_t attr;
+			if( auto const err = pthread_attr_init( &attr ); err != 0 ) {
+				throw std::system_error( err, std::system_category( ),
+				                         "Unable to create thread attributes" );
+			}
+			auto const destroy_attr =
+			  daw::on_scope_exit( [&]( ) { pthread_attr_destroy( &attr ); } );
+			auto const min_size = static_cast<std::size_t>( PTHREAD_STACK_MIN );
+			if( auto const err = pthread_attr_setstacksize(
+			      &attr, std::max( stack_size, min_size ) );
+			    err != 0 ) {
+				throw std::system_error( err, std::system_category( ),
+				                         "Unable to set thread stack size" );
+			}
+			pthread_t result;
+			auto const err = pthread_create(
+			  &result, &attr,
+			  []( void *ptr ) -> void * {
+				  auto const run =
+				    std::unique_ptr<body_t>( static_cast<body_t *>( ptr ) );
+				  ( *run )( );
+				  return nullptr;
+			  },
+			  owned.get( ) );
+			if( err != 0 ) {
+				throw std::system_error( err, std::system_category( ),
+				                         "Unable to create thread" );
+			}
+			(void)owned.release( );
+			return result;
+		}
+#endif
 
 	public:
 		using id = ::std::thread::id;
 
 		template<typename Callable, typename... Args,
 		         std::enable_if_t<
-		           not std::is_same_v<daw::remove_cvref_t<Callable>, ithread>,
+		           not std::is_same_v<daw::remove_cvref_t<Callable>, ithread> and
+		             not std::is_same_v<daw::remove_cvref_t<Callable>,
+		                                thread_options>,
 		           std::nullptr_t> = nullptr>
 		explicit ithread( Callable &&callable, Args &&...args )
-		  : m_thread(
-		      []( auto func, stop_token ic, auto... lambda_args ) {
-			      auto const on_exit = daw::on_scope_exit( [&] { ic.stop( ); } );
-			      if constexpr( std::is_invocable_v<Callable, stop_token, Args...> ) {
-				      return func( ic, lambda_args... );
-			      } else {
-				      return func( lambda_args... );
-			      }
-		      },
-		      DAW_FWD( callable ), m_continue->get_interrupt_token( ),
-		      DAW_FWD( args )... ) {}
+		  : ithread( thread_options{ }, DAW_FWD( callable ), DAW_FWD( args )... ) {}
+
+		template<typename Callable, typename... Args>
+		explicit ithread( thread_options const &options, Callable &&callable,
+		                  Args &&...args ) {
+			auto body = [func = daw::remove_cvref_t<Callable>( DAW_FWD( callable ) ),
+			             ic = m_continue->get_interrupt_token( ),
+			             targs =
+			               std::make_tuple( DAW_FWD( args )... )]( ) mutable {
+				auto const on_exit = daw::on_scope_exit( [&] { ic.stop( ); } );
+				std::apply(
+				  [&]( auto &...lambda_args ) {
+					  if constexpr( std::is_invocable_v<Callable, stop_token,
+					                                    Args...> ) {
+						  (void)func( ic, lambda_args... );
+					  } else {
+						  (void)func( lambda_args... );
+					  }
+				  },
+				  targs );
+			};
+#if defined( DAW_FS_HAS_PTHREADS )
+			if( options.stack_size != 0 ) {
+				m_native = start_native( options.stack_size, daw::move( body ) );
+				return;
+			}
+#else
+			(void)options;
+#endif
+			m_thread = std::thread( daw::move( body ) );
+		}
 
 		ithread( ithread && ) = delete;
 		ithread( ithread const & ) = delete;
@@ -142,18 +224,18 @@ namespace daw::parallel {
 		inline ~ithread( ) {
 			try {
 				m_continue->request_stop( );
-				if( m_thread.joinable( ) ) {
-					m_thread.join( );
-				}
+				join_thread( );
 			} catch( ... ) {
 				// Do not let an exception take us down
 			}
 		}
 
 		[[nodiscard]] inline bool joinable( ) const {
-			return m_continue->can_continue( ) and m_thread.joinable( );
+			return m_continue->can_continue( ) and is_thread_joinable( );
 		}
 
+		/// Not meaningful for threads started with a stack size, they have no
+		/// std::thread
 		[[nodiscard]] inline std::thread::id get_id( ) const noexcept {
 			return m_thread.get_id( );
 		}
@@ -168,7 +250,7 @@ namespace daw::parallel {
 
 		inline void join( ) {
 			m_continue->wait( );
-			m_thread.join( );
+			join_thread( );
 		}
 
 		inline void stop_and_wait( ) {
@@ -177,7 +259,37 @@ namespace daw::parallel {
 		}
 
 		inline void detach( ) {
+#if defined( DAW_FS_HAS_PTHREADS )
+			if( m_native ) {
+				(void)pthread_detach( *m_native );
+				m_native.reset( );
+				return;
+			}
+#endif
 			m_thread.detach( );
 		}
+
+	private:
+		[[nodiscard]] inline bool is_thread_joinable( ) const {
+#if defined( DAW_FS_HAS_PTHREADS )
+			if( m_native ) {
+				return true;
+			}
+#endif
+			return m_thread.joinable( );
+		}
+
+		inline void join_thread( ) {
+#if defined( DAW_FS_HAS_PTHREADS )
+			if( m_native ) {
+				(void)pthread_join( *m_native, nullptr );
+				m_native.reset( );
+				return;
+			}
+#endif
+			if( m_thread.joinable( ) ) {
+				m_thread.join( );
+			}
+		}
 	};
 } // namespace daw::parallel
@@ -0,0 +1,548 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include <daw/daw_traits.h>
+
+/// Kernels for contiguous ranges of int32_t, int64_t, float and double with
+/// the standard operations.  They are written as fixed width lane loops that
+/// the compiler vectorizes.  On x86 with GCC or Clang they are also built for
+/// AVX2 and AVX-512 and the widest the cpu supports is picked at run time.
+/// Everywhere else, e.g. NEON on aarch64, the base instruction set is used.
+/// Define DAW_FS_NO_SIMD_DISPATCH to only use the base instruction set
+#if( defined( __GNUC__ ) or defined( __clang__ ) ) and                      \
+  ( defined( __x86_64__ ) or defined( __i386__ ) ) and                       \
+  not defined( DAW_FS_NO_SIMD_DISPATCH )
+#define DAW_FS_SIMD_DISPATCH
+#define DAW_FS_SIMD_INLINE inline __attribute__( ( always_inline ) )
+#define DAW_FS_SIMD_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+#define DAW_FS_SIMD_TARGET_AVX512                                            \
+	__attribute__( ( target( "avx512f,avx512bw,avx512dq,avx512vl" ) ) )
+#else
+#define DAW_FS_SIMD_INLINE inline
+#endif
+
+namespace daw::algorithm::parallel::impl {
+	/// Predicate used by count( first, last, value ) so the value can be
+	/// recognised and counted with a simd kernel
+	template<typename T>
+	struct equal_to_value {
+		T const &value;
+
+		template<typename U>
+		[[nodiscard]] constexpr bool operator( )( U const &rhs ) const {
+			return value == rhs;
+		}
+	};
+} // namespace daw::algorithm::parallel::impl
+
+namespace daw::algorithm::parallel::impl::simd {
+	template<typename T>
+	inline constexpr bool is_simd_type_v =
+	  std::is_same_v<T, int32_t> or std::is_same_v<T, int64_t> or
+	  std::is_same_v<T, float> or std::is_same_v<T, double>;
+
+	/// Pointers and std::vector iterators are known to be contiguous
+	template<typename Iterator>
+	inline constexpr bool is_contiguous_iterator_v =
+	  std::is_pointer_v<Iterator> or
+	  std::is_same_v<Iterator,
+	                 typename std::vector<typename std::iterator_traits<
+	                   Iterator>::value_type>::iterator> or
+	  std::is_same_v<Iterator,
+	                 typename std::vector<typename std::iterator_traits<
+	                   Iterator>::value_type>::const_iterator>;
+
+	template<typename Iterator>
+	inline constexpr bool is_simd_range_v =
+	  is_contiguous_iterator_v<Iterator> and
+	  is_simd_type_v<typename std::iterator_traits<Iterator>::value_type>;
+
+	template<typename Op, typename T>
+	inline constexpr bool is_plus_v =
+	  std::is_same_v<daw::remove_cvref_t<Op>, std::plus<>> or
+	  std::is_same_v<daw::remove_cvref_t<Op>, std::plus<T>>;
+
+	template<typename Op, typename T>
+	inline constexpr bool is_less_v =
+	  std::is_same_v<daw::remove_cvref_t<Op>, std::less<>> or
+	  std::is_same_v<daw::remove_cvref_t<Op>, std::less<T>>;
+
+	template<typename Op, typename T>
+	inline constexpr bool is_equal_to_v =
+	  std::is_same_v<daw::remove_cvref_t<Op>, std::equal_to<>> or
+	  std::is_same_v<daw::remove_cvref_t<Op>, std::equal_to<T>>;
+
+	template<typename Op, typename T>
+	inline constexpr bool is_equal_to_value_v =
+	  std::is_same_v<daw::remove_cvref_t<Op>, equal_to_value<T>>;
+
+	template<typename Iterator>
+	[[nodiscard]] inline auto *data_of( Iterator it ) {
+		return &*it;
+	}
+
+	/// Independent accumulators per loop, enough to fill an AVX-512 register
+	/// of 32 bit values
+	inline constexpr std::size_t lane_count = 16U;
+
+	template<typename T>
+	DAW_FS_SIMD_INLINE T sum_body( T const *first, std::size_t count ) {
+		T lanes[lane_count]{ };
+		std::size_t n = 0;
+		for( ; n + lane_count <= count; n += lane_count ) {
+			for( std::size_t l = 0; l < lane_count; ++l ) {
+				lanes[l] += first[n + l];
+			}
+		}
+		T result{ };
+		for( std::size_t l = 0; l < lane_count; ++l ) {
+			result += lanes[l];
+		}
+		for( ; n < count; ++n ) {
+			result += first[n];
+		}
+		return result;
+	}
+
+	template<typename T>
+	DAW_FS_SIMD_INLINE std::size_t count_body( T const *first, std::size_t count,
+	                                           T value ) {
+		// Same width counters vectorize best, flush them before they overflow
+		using counter_t =
+		  std::conditional_t<sizeof( T ) == sizeof( uint32_t ), uint32_t, uint64_t>;
+		constexpr std::size_t block_size = 1U << 24U;
+		std::size_t result = 0;
+		std::size_t n = 0;
+		while( n + lane_count <= count ) {
+			counter_t lanes[lane_count]{ };
+			auto const block_last =
+			  n + std::min( block_size, ( count - n ) / lane_count * lane_count );
+			for( ; n < block_last; n += lane_count ) {
+				for( std::size_t l = 0; l < lane_count; ++l ) {
+					lanes[l] += static_cast<counter_t>( first[n + l] == value );
+				}
+			}
+			for( std::size_t l = 0; l < lane_count; ++l ) {
+				result += lanes[l];
+			}
+		}
+		for( ; n < count; ++n ) {
+			result += static_cast<std::size_t>( first[n] == value );
+		}
+		return result;
+	}
+
+	/// Smallest( IsMax is false ) or largest value.  Sets *has_nan when a NaN
+	/// was seen, the result is meaningless then
+	template<bool IsMax, typename T>
+	DAW_FS_SIMD_INLINE T min_max_body( T const *first, std::size_t count,
+	                                   bool *has_nan ) {
+		T lanes[lane_count];
+		for( std::size_t l = 0; l < lane_count; ++l ) {
+			lanes[l] = first[0];
+		}
+		bool nan_lanes[lane_count]{ };
+		std::size_t n = 0;
+		for( ; n + lane_count <= count; n += lane_count ) {
+			for( std::size_t l = 0; l < lane_count; ++l ) {
+				auto const v = first[n + l];
+				if constexpr( IsMax ) {
+					lanes[l] = lanes[l] < v ? v : lanes[l];
+				} else {
+					lanes[l] = v < lanes[l] ? v : lanes[l];
+				}
+				nan_lanes[l] |= v != v;
+			}
+		}
+		T result = lanes[0];
+		bool nan = false;
+		for( std::size_t l = 0; l < lane_count; ++l ) {
+			if constexpr( IsMax ) {
+				result = result < lanes[l] ? lanes[l] : result;
+			} else {
+				result = lanes[l] < result ? lanes[l] : result;
+			}
+			nan |= nan_lanes[l];
+		}
+		for( ; n < count; ++n ) {
+			auto const v = first[n];
+			if constexpr( IsMax ) {
+				result = result < v ? v : result;
+			} else {
+				result = v < result ? v : result;
+			}
+			nan |= v != v;
+		}
+		*has_nan = nan;
+		return result;
+	}
+
+	template<typename T>
+	DAW_FS_SIMD_INLINE bool equal_body( T const *first1, T const *first2,
+	                                    std::size_t count ) {
+		// Compare a block at a time without branching, stop at the first
+		// block with a difference
+		constexpr std::size_t block_size = 256U;
+		std::size_t n = 0;
+		for( ; n + block_size <= count; n += block_size ) {
+			bool eq = true;
+			for( std::size_t b = 0; b < block_size; ++b ) {
+				eq &= first1[n + b] == first2[n + b];
+			}
+			if( not eq ) {
+				return false;
+			}
+		}
+		for( ; n < count; ++n ) {
+			if( not( first1[n] == first2[n] ) ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/// The bytes that end a field or a record in delimited text, and the quote
+	/// that hides them inside a field
+	struct separator_chars {
+		char field;
+		char record;
+		char quote;
+	};
+
+	/// Delimited text is scanned a block of 64 bytes, one bit each, at a time
+	inline constexpr std::size_t mask_block_size = 64U;
+
+	/// Gather 64 flags of 0 or 1 into a bit mask.  Each multiply moves eight
+	/// flags into the top byte, their products land on distinct bits so no
+	/// carries spill into it
+	DAW_FS_SIMD_INLINE uint64_t to_bit_mask( uint8_t const *flags ) {
+		uint64_t result = 0;
+		for( std::size_t w = 0; w < mask_block_size / 8U; ++w ) {
+			uint64_t word = 0;
+			for( std::size_t b = 0; b < 8U; ++b ) {
+				word |= static_cast<uint64_t>( flags[w * 8U + b] ) << ( 8U * b );
+			}
+			result |= ( ( word * 0x0102'0408'1020'4080ULL ) >> 56U ) << ( 8U * w );
+		}
+		return result;
+	}
+
+	/// Bit n is set when an odd number of the bits up to and including n are
+	/// set, so with the quote bits it marks every byte inside quotes
+	DAW_FS_SIMD_INLINE uint64_t prefix_xor( uint64_t bits ) {
+		bits ^= bits << 1U;
+		bits ^= bits << 2U;
+		bits ^= bits << 4U;
+		bits ^= bits << 8U;
+		bits ^= bits << 16U;
+		bits ^= bits << 32U;
+		return bits;
+	}
+
+	DAW_FS_SIMD_INLINE std::size_t trailing_zeros( uint64_t bits ) {
+#if defined( __GNUC__ ) or defined( __clang__ )
+		return static_cast<std::size_t>( __builtin_ctzll( bits ) );
+#else
+		std::size_t result = 0;
+		for( ; ( bits & 1U ) == 0; bits >>= 1U ) {
+			++result;
+		}
+		return result;
+#endif
+	}
+
+	/// Append the offset of every field and record separator outside quotes in
+	/// [first, first + count) to *separators, and after a record separator the
+	/// number of separators so far to *record_ends.  The text starts outside
+	/// quotes, returns true when it ends inside them
+	DAW_FS_SIMD_INLINE bool
+	separators_body( char const *first, std::size_t count, separator_chars chars,
+	                 std::vector<uint32_t> *separators,
+	                 std::vector<uint32_t> *record_ends ) {
+		// All ones while the previous block ended inside quotes
+		uint64_t carry = 0;
+		char tail[mask_block_size];
+		for( std::size_t pos = 0; pos < count; pos += mask_block_size ) {
+			auto const *block = first + pos;
+			auto valid = ~uint64_t{ 0 };
+			if( count - pos < mask_block_size ) {
+				std::fill( std::begin( tail ), std::end( tail ), '\0' );
+				std::copy( block, first + count, tail );
+				block = tail;
+				valid = ( uint64_t{ 1 } << ( count - pos ) ) - 1U;
+			}
+			uint8_t is_field[mask_block_size];
+			uint8_t is_record[mask_block_size];
+			uint8_t is_quote[mask_block_size];
+			for( std::size_t l = 0; l < mask_block_size; ++l ) {
+				is_field[l] = static_cast<uint8_t>( block[l] == chars.field );
+				is_record[l] = static_cast<uint8_t>( block[l] == chars.record );
+				is_quote[l] = static_cast<uint8_t>( block[l] == chars.quote );
+			}
+			auto const quoted =
+			  prefix_xor( to_bit_mask( is_quote ) & valid ) ^ carry;
+			carry = uint64_t{ 0 } - ( quoted >> 63U );
+			auto const records = to_bit_mask( is_record ) & valid & ~quoted;
+			auto seps = ( to_bit_mask( is_field ) & valid & ~quoted ) | records;
+			while( seps != 0 ) {
+				auto const bit = trailing_zeros( seps );
+				separators->push_back( static_cast<uint32_t>( pos + bit ) );
+				if( ( ( records >> bit ) & 1U ) != 0 ) {
+					record_ends->push_back(
+					  static_cast<uint32_t>( separators->size( ) ) );
+				}
+				seps &= seps - 1U;
+			}
+		}
+		return carry != 0;
+	}
+
+	/// Most points assigned by one call of nearest_centroid
+	inline constexpr std::size_t centroid_block_size = 256U;
+
+	/// Label each of count <= centroid_block_size points with the index of the
+	/// nearest of k centroids by squared euclidean distance.  coords holds a
+	/// pointer to the points' coordinates of each dimension, centroids the
+	/// coordinates of one centroid after another.  Returns the sum of the
+	/// squared distances to the nearest centroids
+	template<typename T>
+	DAW_FS_SIMD_INLINE T nearest_centroid_body( T const *const *coords,
+	                                            std::size_t dimensions,
+	                                            std::size_t count,
+	                                            T const *centroids,
+	                                            std::size_t k,
+	                                            uint32_t *labels ) {
+		T best[centroid_block_size];
+		T dist[centroid_block_size];
+		for( std::size_t i = 0; i < count; ++i ) {
+			best[i] = std::numeric_limits<T>::max( );
+			labels[i] = 0;
+		}
+		for( std::size_t c = 0; c < k; ++c ) {
+			// One dimension at a time over the block keeps every loop contiguous
+			for( std::size_t i = 0; i < count; ++i ) {
+				dist[i] = T{ };
+			}
+			for( std::size_t d = 0; d < dimensions; ++d ) {
+				auto const *x = coords[d];
+				auto const centre = centroids[c * dimensions + d];
+				for( std::size_t i = 0; i < count; ++i ) {
+					auto const diff = x[i] - centre;
+					dist[i] += diff * diff;
+				}
+			}
+			for( std::size_t i = 0; i < count; ++i ) {
+				auto const closer = dist[i] < best[i];
+				best[i] = closer ? dist[i] : best[i];
+				labels[i] = closer ? static_cast<uint32_t>( c ) : labels[i];
+			}
+		}
+		T result{ };
+		for( std::size_t i = 0; i < count; ++i ) {
+			result += best[i];
+		}
+		return result;
+	}
+
+	enum class isa_t : uint8_t { base, avx2, avx512 };
+
+	/// The widest instruction set the kernels were built for that this cpu
+	/// supports.  Detected once
+	[[nodiscard]] inline isa_t detected_isa( ) {
+#if defined( DAW_FS_SIMD_DISPATCH )
+		static isa_t const isa = [] {
+			__builtin_cpu_init( );
+			if( __builtin_cpu_supports( "avx512f" ) and
+			    __builtin_cpu_supports( "avx512bw" ) and
+			    __builtin_cpu_supports( "avx512dq" ) and
+			    __builtin_cpu_supports( "avx512vl" ) ) {
+				return isa_t::avx512;
+			}
+			if( __builtin_cpu_supports( "avx2" ) ) {
+				return isa_t::avx2;
+			}
+			return isa_t::base;
+		}( );
+		return isa;
+#else
+		return isa_t::base;
+#endif
+	}
+
+	// Each kernel is the body above built for every instruction set and a
+	// dispatcher that picks the best one for this cpu
+#if defined( DAW_FS_SIMD_DISPATCH )
+#define DAW_FS_SIMD_KERNEL( name, body )                                     \
+	template<typename... Args>                                                 \
+	DAW_FS_SIMD_TARGET_AVX2 auto name##_avx2( Args... args ) {                 \
+		return body( args... );                                                  \
+	}                                                                          \
+	template<typename... Args>                                                 \
+	DAW_FS_SIMD_TARGET_AVX512 auto name##_avx512( Args... args ) {             \
+		return body( args... );                                                  \
+	}                                                                          \
+	template<typename... Args>                                                 \
+	[[nodiscard]] auto name( Args... args ) {                                  \
+		switch( detected_isa( ) ) {                                              \
+		case isa_t::avx512:                                                      \
+			return name##_avx512( args... );                                       \
+		case isa_t::avx2:                                                        \
+			return name##_avx2( args... );                                         \
+		case isa_t::base:                                                        \
+			break;                                                                 \
+		}                                                                        \
+		return body( args... );                                                  \
+	}
+#else
+#define DAW_FS_SIMD_KERNEL( name, body )                                     \
+	template<typename... Args>                                                 \
+	[[nodiscard]] auto name( Args... args ) {                                  \
+		return body( args... );                                                  \
+	}
+#endif
+
+	DAW_FS_SIMD_KERNEL( sum, sum_body )
+	DAW_FS_SIMD_KERNEL( count_equal, count_body )
+	DAW_FS_SIMD_KERNEL( min_value, min_max_body<false> )
+	DAW_FS_SIMD_KERNEL( max_value, min_max_body<true> )
+	DAW_FS_SIMD_KERNEL( equal, equal_body )
+	DAW_FS_SIMD_KERNEL( find_separators, separators_body )
+	DAW_FS_SIMD_KERNEL( nearest_centroid, nearest_centroid_body )
+
+#undef DAW_FS_SIMD_KERNEL
+
+	/// std::min_element or std::max_element over a contiguous range.  Returns
+	/// the first extreme item like they do, falling back to them when there
+	/// are NaNs
+	template<bool IsMax, typename Iterator>
+	[[nodiscard]] Iterator min_max_element( Iterator first, Iterator last ) {
+		if( first == last ) {
+			return last;
+		}
+		auto const count = static_cast<std::size_t>( std::distance( first, last ) );
+		bool has_nan = false;
+		auto const value = IsMax ? max_value( data_of( first ), count, &has_nan )
+		                         : min_value( data_of( first ), count, &has_nan );
+		if( has_nan ) {
+			if constexpr( IsMax ) {
+				return std::max_element( first, last );
+			} else {
+				return std::min_element( first, last );
+			}
+		}
+		return std::find( first, last, value );
+	}
+} // namespace daw::algorithm::parallel::impl::simd
+
+namespace daw::algorithm::parallel::impl {
+	/// The sequential algorithms run on each part of a range.  They use a simd
+	/// kernel when the range and operation allow and the std:: algorithm
+	/// otherwise
+	template<typename Iterator, typename T, typename BinaryOp>
+	[[nodiscard]] T sequential_reduce( Iterator first, Iterator last, T init,
+	                                   BinaryOp const &binary_op ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if constexpr( simd::is_simd_range_v<Iterator> and
+		              std::is_same_v<T, value_t> and
+		              simd::is_plus_v<BinaryOp, value_t> ) {
+			return static_cast<T>(
+			  init + simd::sum( simd::data_of( first ),
+			                    static_cast<std::size_t>( last - first ) ) );
+		} else {
+			for( ; first != last; ++first ) {
+				init = binary_op( init, *first );
+			}
+			return init;
+		}
+	}
+
+	template<typename Iterator, typename Compare>
+	[[nodiscard]] Iterator sequential_min_element( Iterator first, Iterator last,
+	                                               Compare const &cmp ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if constexpr( simd::is_simd_range_v<Iterator> and
+		              simd::is_less_v<Compare, value_t> ) {
+			return simd::min_max_element<false>( first, last );
+		} else {
+			return std::min_element( first, last, cmp );
+		}
+	}
+
+	template<typename Iterator, typename Compare>
+	[[nodiscard]] Iterator sequential_max_element( Iterator first, Iterator last,
+	                                               Compare const &cmp ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		if constexpr( simd::is_simd_range_v<Iterator> and
+		              simd::is_less_v<Compare, value_t> ) {
+			return simd::min_max_element<true>( first, last );
+		} else {
+			return std::max_element( first, last, cmp );
+		}
+	}
+
+	template<typename Iterator1, typename Iterator2, typename BinaryPredicate>
+	[[nodiscard]] bool sequential_equal( Iterator1 first1, Iterator1 last1,
+	                                     Iterator2 first2, Iterator2 last2,
+	                                     BinaryPredicate const &pred ) {
+		using value_t = typename std::iterator_traits<Iterator1>::value_type;
+		if constexpr( simd::is_simd_range_v<Iterator1> and
+		              simd::is_simd_range_v<Iterator2> and
+		              std::is_same_v<value_t, typename std::iterator_traits<
+		                                        Iterator2>::value_type> and
+		              simd::is_equal_to_v<BinaryPredicate, value_t> ) {
+			if( last1 - first1 != last2 - first2 ) {
+				return false;
+			}
+			return simd::equal( simd::data_of( first1 ), simd::data_of( first2 ),
+			                    static_cast<std::size_t>( last1 - first1 ) );
+		} else {
+			return std::equal( first1, last1, first2, last2, pred );
+		}
+	}
+
+	template<typename Iterator, typename UnaryPredicate>
+	[[nodiscard]] auto sequential_count_if( Iterator first, Iterator last,
+	                                        UnaryPredicate const &pred ) {
+		using value_t = typename std::iterator_traits<Iterator>::value_type;
+		using result_t =
+		  typename std::iterator_traits<Iterator>::difference_type;
+		if constexpr( simd::is_simd_range_v<Iterator> and
+		              simd::is_equal_to_value_v<UnaryPredicate, value_t> ) {
+			return static_cast<result_t>( simd::count_equal(
+			  simd::data_of( first ), static_cast<std::size_t>( last - first ),
+			  pred.value ) );
+		} else {
+			return static_cast<result_t>( std::count_if( first, last, pred ) );
+		}
+	}
+} // namespace daw::algorithm::parallel::impl
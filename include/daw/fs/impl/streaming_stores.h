@@ -0,0 +1,128 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/// Non-temporal stores write whole cache lines to memory without reading
+/// them into the cache first.  For outputs larger than the last level cache
+/// that saves the read of every line written and keeps the cache for other
+/// work.  They need SSE2, everywhere else plain stores are used.  Define
+/// DAW_FS_NO_STREAMING_STORES to always use plain stores
+#if( defined( __SSE2__ ) or defined( _M_X64 ) ) and                         \
+  not defined( DAW_FS_NO_STREAMING_STORES )
+#define DAW_FS_STREAMING_STORES
+#include <emmintrin.h>
+#endif
+
+namespace daw::algorithm::parallel::impl::streaming {
+#if defined( DAW_FS_STREAMING_STORES )
+	inline constexpr bool streaming_stores_enabled = true;
+#else
+	inline constexpr bool streaming_stores_enabled = false;
+#endif
+
+	/// Bytes written by one non-temporal store
+	inline constexpr std::size_t store_width = 16U;
+
+	/// Bytes generated before they are streamed out, one cache line
+	inline constexpr std::size_t block_width = 64U;
+
+	/// Items written as their bytes, a whole number of them to a store
+	template<typename T>
+	inline constexpr bool is_streamable_v =
+	  std::is_trivially_copyable_v<T> and sizeof( T ) <= store_width and
+	  store_width % sizeof( T ) == 0;
+
+	[[nodiscard]] inline std::size_t misalignment( void const *ptr ) {
+		return reinterpret_cast<std::uintptr_t>( ptr ) % store_width;
+	}
+
+	/// Streamed stores are weakly ordered.  Call this when done with them and
+	/// before another thread may read what they wrote
+	inline void fence( ) {
+#if defined( DAW_FS_STREAMING_STORES )
+		_mm_sfence( );
+#endif
+	}
+
+	/// memcpy of count bytes, with dst written by non-temporal stores.  The
+	/// ranges must not overlap
+	inline void copy_bytes( void *dst, void const *src, std::size_t count ) {
+		auto *out = static_cast<unsigned char *>( dst );
+		auto const *in = static_cast<unsigned char const *>( src );
+#if defined( DAW_FS_STREAMING_STORES )
+		auto const head =
+		  std::min( count, ( store_width - misalignment( out ) ) % store_width );
+		std::memcpy( out, in, head );
+		out += head;
+		in += head;
+		count -= head;
+		for( ; count >= store_width; count -= store_width ) {
+			_mm_stream_si128(
+			  reinterpret_cast<__m128i *>( out ),
+			  _mm_loadu_si128( reinterpret_cast<__m128i const *>( in ) ) );
+			out += store_width;
+			in += store_width;
+		}
+#endif
+		std::memcpy( out, in, count );
+	}
+
+	/// out[n] = gen( n ) for n in [0, count), with whole cache lines of out
+	/// written by non-temporal stores.  gen( n ) must return a T
+	template<typename T, typename Generator>
+	void generate( T *out, std::size_t count, Generator &gen ) {
+		static_assert( is_streamable_v<T> );
+		std::size_t n = 0;
+#if defined( DAW_FS_STREAMING_STORES )
+		// Only items aligned to their size line up with the store boundaries
+		if( reinterpret_cast<std::uintptr_t>( out ) % sizeof( T ) == 0 ) {
+			for( ; n < count and misalignment( out + n ) != 0; ++n ) {
+				out[n] = gen( n );
+			}
+			constexpr std::size_t block_size = block_width / sizeof( T );
+			alignas( block_width ) unsigned char block[block_width];
+			for( ; n + block_size <= count; n += block_size ) {
+				for( std::size_t b = 0; b < block_size; ++b ) {
+					T const value = gen( n + b );
+					std::memcpy( block + b * sizeof( T ), &value, sizeof( T ) );
+				}
+				auto *const dst = reinterpret_cast<unsigned char *>( out + n );
+				for( std::size_t b = 0; b < block_width; b += store_width ) {
+					_mm_stream_si128(
+					  reinterpret_cast<__m128i *>( dst + b ),
+					  _mm_load_si128( reinterpret_cast<__m128i const *>( block + b ) ) );
+				}
+			}
+		}
+#endif
+		for( ; n < count; ++n ) {
+			out[n] = gen( n );
+		}
+	}
+} // namespace daw::algorithm::parallel::impl::streaming
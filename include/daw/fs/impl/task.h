@@ -28,13 +28,153 @@
 #include <daw/daw_move.h>
 #include <daw/daw_traits.h>
 
-#include <functional>
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <optional>
 #include <type_traits>
+#include <utility>
+
+/// GCC pairs a pointer from a class operator new with the ::operator delete
+/// inlined from the class operator delete, and warns with
+/// -Wmismatched-new-delete.  Inlining operator new as well shows it the
+/// ::operator new the block really came from
+#if defined( __GNUC__ ) or defined( __clang__ )
+#define DAW_FS_TASK_ALLOC_INLINE __attribute__( ( always_inline ) )
+#else
+#define DAW_FS_TASK_ALLOC_INLINE
+#endif
 
 namespace daw {
+	namespace impl {
+		/// Per thread free list of task_t sized blocks.  A block freed on one
+		/// thread may be handed out again on another, they all come from the
+		/// global operator new
+		class task_node_cache {
+			struct node {
+				node *next;
+			};
+			node *m_head = nullptr;
+			std::size_t m_count = 0;
+
+		public:
+			static constexpr std::size_t max_cached = 256U;
+
+			task_node_cache( ) = default;
+			task_node_cache( task_node_cache const & ) = delete;
+			task_node_cache &operator=( task_node_cache const & ) = delete;
+
+			~task_node_cache( ) {
+				while( m_head ) {
+					::operator delete( std::exchange( m_head, m_head->next ) );
+				}
+			}
+
+			[[nodiscard]] void *allocate( std::size_t sz ) {
+				if( m_head ) {
+					--m_count;
+					return std::exchange( m_head, m_head->next );
+				}
+				return ::operator new( sz );
+			}
+
+			void deallocate( void *ptr ) noexcept {
+				if( m_count >= max_cached ) {
+					::operator delete( ptr );
+					return;
+				}
+				++m_count;
+				m_head = ::new( ptr ) node{ m_head };
+			}
+		};
+
+		/// The current threads cache, or nullptr once it has been destroyed at
+		/// thread exit
+		[[nodiscard]] inline task_node_cache *this_thread_task_node_cache( ) {
+			thread_local bool is_destroyed = false;
+			thread_local struct cache_holder_t {
+				task_node_cache cache{ };
+
+				~cache_holder_t( ) {
+					is_destroyed = true;
+				}
+			} cache_holder{ };
+			if( is_destroyed ) {
+				return nullptr;
+			}
+			return &cache_holder.cache;
+		}
+	} // namespace impl
+
+	/// A type erased, move only, void( ) callable.  Callables up to
+	/// inline_size bytes are stored in place and task_t itself is allocated
+	/// from a per thread node cache, so scheduling a typical lambda does not
+	/// touch the heap
 	class [[nodiscard]] task_t {
-		std::function<void( )> m_function{ }; // from ctor
-		daw::shared_latch m_latch{ };
+	public:
+		static constexpr std::size_t inline_size = 96U;
+
+	private:
+		struct vtable_t {
+			void ( *invoke )( void * );
+			void ( *move_to )( void *from, void *to ) noexcept;
+			void ( *destroy )( void * ) noexcept;
+		};
+
+		template<typename Func>
+		static constexpr bool is_stored_inline_v =
+		  sizeof( Func ) <= inline_size and
+		  alignof( Func ) <= alignof( std::max_align_t ) and
+		  std::is_nothrow_move_constructible_v<Func>;
+
+		template<typename Func>
+		static constexpr vtable_t inline_vtable = {
+		  []( void *p ) { ( *static_cast<Func *>( p ) )( ); },
+		  []( void *from, void *to ) noexcept {
+			  auto &f = *static_cast<Func *>( from );
+			  ::new( to ) Func( daw::move( f ) );
+			  f.~Func( );
+		  },
+		  []( void *p ) noexcept { static_cast<Func *>( p )->~Func( ); } };
+
+		template<typename Func>
+		static constexpr vtable_t heap_vtable = {
+		  []( void *p ) { ( **static_cast<Func **>( p ) )( ); },
+		  []( void *from, void *to ) noexcept {
+			  ::new( to ) Func *( *static_cast<Func **>( from ) );
+		  },
+		  []( void *p ) noexcept { delete *static_cast<Func **>( p ); } };
+
+		vtable_t const *m_vtable = nullptr;
+		alignas( std::max_align_t ) unsigned char m_storage[inline_size];
+		std::optional<daw::shared_latch> m_latch{ };
+
+		template<typename Func>
+		void store( Func &&func ) {
+			using func_t = daw::remove_cvref_t<Func>;
+			static_assert( std::is_invocable_v<func_t &>,
+			               "Task must be callable without arguments" );
+			if constexpr( std::is_pointer_v<func_t> or
+			              std::is_member_pointer_v<func_t> ) {
+				daw::exception::precondition_check( func != nullptr,
+				                                    "Callable must be valid" );
+			}
+			if constexpr( is_stored_inline_v<func_t> ) {
+				::new( static_cast<void *>( m_storage ) ) func_t( DAW_FWD( func ) );
+				m_vtable = &inline_vtable<func_t>;
+			} else {
+				::new( static_cast<void *>( m_storage ) )
+				  func_t *( new func_t( DAW_FWD( func ) ) );
+				m_vtable = &heap_vtable<func_t>;
+			}
+		}
+
+		void reset( ) noexcept {
+			if( m_vtable ) {
+				m_vtable->destroy( m_storage );
+				m_vtable = nullptr;
+			}
+		}
 
 	public:
 		explicit task_t( ) = default;
@@ -43,48 +183,89 @@ namespace daw {
 		         ::std::enable_if_t<
 		           not std::is_same_v<task_t, ::daw::remove_cvref_t<Func>>,
 		           ::std::nullptr_t> = nullptr>
-		explicit task_t( Func &&func )
-		  : m_function( DAW_FWD( func ) ) {
-
-			daw::exception::precondition_check( m_function,
-			                                    "Callable must be valid" );
+		explicit task_t( Func &&func ) {
+			store( DAW_FWD( func ) );
 		}
 
 		template<typename Func, typename Latch>
-		explicit task_t( Func &&func, Latch l )
-		  : m_function( DAW_FWD( func ) )
-		  , m_latch( daw::is_shared_latch_v<Latch>
-		               ? daw::move( l )
-		               : daw::shared_latch( ::daw::move( l ) ) ) {
-
+		explicit task_t( Func &&func, Latch l ) {
 			static_assert( daw::is_shared_latch_v<Latch> or
 			               daw::is_unique_latch_v<Latch> );
 
-			daw::exception::precondition_check( m_function,
-			                                    "Callable must be valid" );
+			if constexpr( daw::is_shared_latch_v<Latch> ) {
+				m_latch.emplace( daw::move( l ) );
+			} else {
+				m_latch.emplace( daw::shared_latch( daw::move( l ) ) );
+			}
+			store( DAW_FWD( func ) );
+		}
+
+		task_t( task_t &&other ) noexcept
+		  : m_vtable( std::exchange( other.m_vtable, nullptr ) )
+		  , m_latch( daw::move( other.m_latch ) ) {
+			if( m_vtable ) {
+				m_vtable->move_to( other.m_storage, m_storage );
+			}
+		}
+
+		task_t &operator=( task_t &&rhs ) noexcept {
+			if( this != &rhs ) {
+				reset( );
+				m_vtable = std::exchange( rhs.m_vtable, nullptr );
+				if( m_vtable ) {
+					m_vtable->move_to( rhs.m_storage, m_storage );
+				}
+				m_latch = daw::move( rhs.m_latch );
+			}
+			return *this;
+		}
+
+		task_t( task_t const & ) = delete;
+		task_t &operator=( task_t const & ) = delete;
+
+		~task_t( ) {
+			reset( );
+		}
+
+		[[nodiscard]] DAW_FS_TASK_ALLOC_INLINE static void *
+		operator new( std::size_t sz ) {
+			assert( sz == sizeof( task_t ) );
+			if( auto *cache = impl::this_thread_task_node_cache( ); cache ) {
+				return cache->allocate( sz );
+			}
+			return ::operator new( sz );
+		}
+
+		static void operator delete( void *ptr ) noexcept {
+			if( auto *cache = impl::this_thread_task_node_cache( ); cache ) {
+				cache->deallocate( ptr );
+				return;
+			}
+			::operator delete( ptr );
 		}
 
 		inline void operator( )( ) {
-			daw::exception::dbg_precondition_check( m_function,
+			daw::exception::dbg_precondition_check( m_vtable,
 			                                        "Callable must be valid" );
-			(void)m_function( );
+			m_vtable->invoke( m_storage );
 		}
 
 		inline void operator( )( ) const {
-			daw::exception::dbg_precondition_check( m_function,
+			daw::exception::dbg_precondition_check( m_vtable,
 			                                        "Callable must be valid" );
-			(void)m_function( );
+			m_vtable->invoke( const_cast<unsigned char *>( m_storage ) );
 		}
 
+		/// A task with a latch is not ready until the latch is released
 		[[nodiscard]] inline bool is_ready( ) const {
 			if( m_latch ) {
-				return m_latch.try_wait( );
+				return m_latch->try_wait( );
 			}
 			return true;
 		}
 
 		[[nodiscard]] inline explicit operator bool( ) const {
-			return static_cast<bool>( m_function );
+			return m_vtable != nullptr;
 		}
 	}; // namespace daw
 } // namespace daw
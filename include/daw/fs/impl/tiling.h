@@ -0,0 +1,185 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <daw/daw_exception.h>
+
+#include "cache_padded.h"
+#include "cpu_topology.h"
+
+namespace daw::algorithm::parallel {
+	/// Sizes of an N dimensional index space, or of its tiles.  Dimension 0
+	/// varies slowest and N - 1 fastest, as in C arrays
+	template<std::size_t N>
+	using extents = std::array<std::size_t, N>;
+
+	/// One tile, the indices i with first[d] <= i[d] < last[d] in every
+	/// dimension d
+	template<std::size_t N>
+	struct tile_bounds {
+		extents<N> first{ };
+		extents<N> last{ };
+
+		[[nodiscard]] constexpr std::size_t size( std::size_t d ) const {
+			return last[d] - first[d];
+		}
+	};
+
+	/// The order tiles are handed to the workers in.  Neighbouring tiles of
+	/// morton and hilbert order are close in every dimension, so a worker
+	/// taking a run of them reuses more of what is in cache.  hilbert is only
+	/// for two dimensions
+	enum class tile_order { row_major, morton, hilbert };
+
+	/// A tile shape whose items fill about half of the L2 cache, with the
+	/// same edge in every dimension but the last, which is a whole number of
+	/// cache lines
+	template<std::size_t N>
+	[[nodiscard]] extents<N> cache_tile_shape( std::size_t item_bytes ) {
+		static_assert( N > 0, "An index space needs a dimension" );
+		item_bytes = std::max<std::size_t>( item_bytes, 1U );
+		auto const items = std::max<std::size_t>(
+		  daw::parallel::cpu_cache_sizes( ).l2 / 2U / item_bytes, 1U );
+		auto const edge = std::max<std::size_t>(
+		  static_cast<std::size_t>( std::pow( static_cast<double>( items ),
+		                                      1.0 / static_cast<double>( N ) ) ),
+		  1U );
+		auto result = extents<N>{ };
+		result.fill( edge );
+		auto const line_items = std::max<std::size_t>(
+		  daw::parallel::cache_line_size / item_bytes, 1U );
+		result[N - 1U] = std::max( line_items, edge / line_items * line_items );
+		return result;
+	}
+
+	namespace impl {
+		/// Interleave the bits of coords, dimension 0 the most significant of
+		/// each group
+		template<std::size_t N>
+		[[nodiscard]] constexpr std::uint64_t
+		morton_code( extents<N> const &coords ) {
+			std::uint64_t result = 0;
+			for( std::size_t bit = 0; bit < 64U / N; ++bit ) {
+				for( std::size_t d = 0; d < N; ++d ) {
+					auto const b = static_cast<std::uint64_t>( coords[d] ) >> bit;
+					result |= ( b & 1U ) << ( bit * N + ( N - 1U - d ) );
+				}
+			}
+			return result;
+		}
+
+		/// Distance of ( x, y ) along the Hilbert curve filling a side by side
+		/// square, side a power of 2
+		[[nodiscard]] constexpr std::uint64_t
+		hilbert_index( std::uint64_t side, std::uint64_t x, std::uint64_t y ) {
+			std::uint64_t result = 0;
+			for( auto s = side / 2U; s > 0; s /= 2U ) {
+				std::uint64_t const rx = ( x & s ) != 0 ? 1U : 0U;
+				std::uint64_t const ry = ( y & s ) != 0 ? 1U : 0U;
+				result += s * s * ( ( 3U * rx ) ^ ry );
+				// Rotate the quadrant so the curve inside it starts at its origin
+				if( ry == 0 ) {
+					if( rx == 1 ) {
+						x = side - 1U - x;
+						y = side - 1U - y;
+					}
+					auto const tmp = x;
+					x = y;
+					y = tmp;
+				}
+			}
+			return result;
+		}
+
+		/// The tiles of shape covering space, clipped at its edges, in order
+		template<std::size_t N>
+		[[nodiscard]] std::vector<tile_bounds<N>>
+		make_tiles( extents<N> const &space, extents<N> const &shape,
+		            tile_order order ) {
+			daw::exception::precondition_check(
+			  order != tile_order::hilbert or N == 2,
+			  "Hilbert order is only for two dimensions" );
+			auto counts = extents<N>{ };
+			std::size_t tile_count = 1;
+			for( std::size_t d = 0; d < N; ++d ) {
+				daw::exception::precondition_check( shape[d] > 0,
+				                                    "Tiles must not be empty" );
+				counts[d] = ( space[d] + shape[d] - 1U ) / shape[d];
+				tile_count *= counts[d];
+			}
+			// The square the Hilbert curve fills must hold every tile
+			std::uint64_t side = 1;
+			if( order == tile_order::hilbert ) {
+				while( side < *std::max_element( counts.begin( ), counts.end( ) ) ) {
+					side *= 2U;
+				}
+			}
+			// Row major tile coordinates, each with its position along the curve
+			auto coords = std::vector<std::pair<std::uint64_t, extents<N>>>( );
+			coords.reserve( tile_count );
+			auto coord = extents<N>{ };
+			for( std::size_t n = 0; n < tile_count; ++n ) {
+				auto key = static_cast<std::uint64_t>( n );
+				if( order == tile_order::morton ) {
+					key = morton_code( coord );
+				} else if constexpr( N == 2 ) {
+					if( order == tile_order::hilbert ) {
+						key = hilbert_index( side, coord[1], coord[0] );
+					}
+				}
+				coords.emplace_back( key, coord );
+				for( auto d = N; d-- > 0; ) {
+					if( ++coord[d] < counts[d] ) {
+						break;
+					}
+					coord[d] = 0;
+				}
+			}
+			if( order != tile_order::row_major ) {
+				std::sort( coords.begin( ), coords.end( ),
+				           []( auto const &lhs, auto const &rhs ) {
+					           return lhs.first < rhs.first;
+				           } );
+			}
+			auto result = std::vector<tile_bounds<N>>( );
+			result.reserve( tile_count );
+			for( auto const &c : coords ) {
+				auto &tile = result.emplace_back( );
+				for( std::size_t d = 0; d < N; ++d ) {
+					tile.first[d] = c.second[d] * shape[d];
+					tile.last[d] = std::min( tile.first[d] + shape[d], space[d] );
+				}
+			}
+			return result;
+		}
+	} // namespace impl
+} // namespace daw::algorithm::parallel
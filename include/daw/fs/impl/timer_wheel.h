@@ -0,0 +1,193 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <daw/daw_move.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace daw::parallel {
+	/// A hierarchical timer wheel.  Level 0 has a slot per tick and each level
+	/// above has slots as wide as the whole level below it.  Adding is O(1)
+	/// and advancing touches only the slots that come due, moving the entries
+	/// of a higher level slot down a level as its time arrives.  Not thread
+	/// safe, the owner locks around it
+	template<typename T>
+	class timer_wheel {
+	public:
+		using clock_t = std::chrono::steady_clock;
+		using time_point = clock_t::time_point;
+		using duration = clock_t::duration;
+
+		static constexpr std::size_t slot_bits = 6U;
+		static constexpr std::size_t slot_count = 1U << slot_bits;
+		/// 64^6 ticks, over two thousand years of 1ms ticks.  Later times wait
+		/// in the last level until they are within its reach
+		static constexpr std::size_t level_count = 6U;
+
+	private:
+		struct entry_t {
+			std::uint64_t due_tick;
+			T value;
+		};
+		using slot_t = std::vector<entry_t>;
+
+		std::array<std::array<slot_t, slot_count>, level_count> m_levels{ };
+		time_point m_start;
+		duration m_tick;
+		// Every tick up to and including m_current has fired
+		std::uint64_t m_current = 0;
+		std::size_t m_size = 0;
+
+		[[nodiscard]] static constexpr std::size_t
+		slot_index( std::uint64_t tick, std::size_t level ) noexcept {
+			return static_cast<std::size_t>( tick >> ( level * slot_bits ) ) &
+			       ( slot_count - 1U );
+		}
+
+		void place( entry_t &&entry ) {
+			auto const delta = entry.due_tick - m_current;
+			std::size_t level = 0;
+			while( level + 1U < level_count and
+			       ( delta >> ( ( level + 1U ) * slot_bits ) ) != 0 ) {
+				++level;
+			}
+			m_levels[level][slot_index( entry.due_tick, level )].push_back(
+			  daw::move( entry ) );
+		}
+
+		/// Move the entries of the level's current slot to the levels below
+		void cascade( std::size_t level ) {
+			auto entries = slot_t( );
+			using std::swap;
+			swap( entries, m_levels[level][slot_index( m_current, level )] );
+			for( auto &entry : entries ) {
+				place( daw::move( entry ) );
+			}
+		}
+
+	public:
+		explicit timer_wheel(
+		  time_point start = clock_t::now( ),
+		  duration tick = std::chrono::milliseconds( 1 ) ) noexcept
+		  : m_start( start )
+		  , m_tick( tick ) {}
+
+		[[nodiscard]] std::size_t size( ) const noexcept {
+			return m_size;
+		}
+
+		[[nodiscard]] bool empty( ) const noexcept {
+			return m_size == 0;
+		}
+
+		[[nodiscard]] duration tick( ) const noexcept {
+			return m_tick;
+		}
+
+		/// The earliest time advance has anything to do, firing or moving entries
+		/// down a level.  Empty when there are no entries.  Looks at no more than
+		/// one revolution of each level
+		[[nodiscard]] std::optional<time_point> next_due( ) const noexcept {
+			if( m_size == 0 ) {
+				return std::nullopt;
+			}
+			auto next_tick = std::numeric_limits<std::uint64_t>::max( );
+			for( std::size_t level = 0; level < level_count; ++level ) {
+				auto const shift = level * slot_bits;
+				auto const base = m_current >> shift;
+				for( std::uint64_t step = 1; step <= slot_count; ++step ) {
+					auto const tick = ( base + step ) << shift;
+					if( not m_levels[level][slot_index( tick, level )].empty( ) ) {
+						next_tick = std::min( next_tick, tick );
+						break;
+					}
+				}
+			}
+			return m_start + m_tick * static_cast<duration::rep>( next_tick );
+		}
+
+		/// Queue value to come due at when.  It never comes due early, and
+		/// times that have already passed come due on the next advance
+		void add( time_point when, T value ) {
+			auto due_tick = m_current + 1U;
+			if( when > m_start ) {
+				// Round up, a tick fires once all of it has passed
+				auto const ticks = static_cast<std::uint64_t>(
+				  ( when - m_start + m_tick - duration( 1 ) ) / m_tick );
+				if( ticks > due_tick ) {
+					due_tick = ticks;
+				}
+			}
+			place( entry_t{ due_tick, daw::move( value ) } );
+			++m_size;
+		}
+
+		/// Call on_due with every value due by now, earliest tick first
+		template<typename OnDue>
+		void advance( time_point now, OnDue &&on_due ) {
+			if( now <= m_start ) {
+				return;
+			}
+			auto const target =
+			  static_cast<std::uint64_t>( ( now - m_start ) / m_tick );
+			if( m_size == 0 ) {
+				if( target > m_current ) {
+					m_current = target;
+				}
+				return;
+			}
+			while( m_current < target and m_size != 0 ) {
+				++m_current;
+				// Higher levels first, their entries may land in the lower slots
+				// being cascaded or fired at this same tick
+				std::size_t top = 0;
+				while( top + 1U < level_count and
+				       slot_index( m_current, top ) == 0 ) {
+					++top;
+				}
+				for( std::size_t level = top; level > 0; --level ) {
+					cascade( level );
+				}
+				auto due = slot_t( );
+				using std::swap;
+				swap( due, m_levels[0][slot_index( m_current, 0 )] );
+				m_size -= std::size( due );
+				for( auto &entry : due ) {
+					on_due( daw::move( entry.value ) );
+				}
+			}
+			if( m_size == 0 and target > m_current ) {
+				m_current = target;
+			}
+		}
+	};
+} // namespace daw::parallel
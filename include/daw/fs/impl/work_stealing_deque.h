@@ -0,0 +1,121 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "../message_queue.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+namespace daw::parallel {
+	/// A single owner, multiple thief deque( Chase-Lev ).  The owning worker
+	/// pushes and pops at the back( LIFO ) and other workers steal from the
+	/// front( FIFO ).  Like mpmc_bounded_queue, ownership of the pointed to
+	/// items is transferred in and out via std::unique_ptr
+	template<typename T, std::size_t Sz>
+	class work_stealing_deque {
+		static_assert( Sz >= 2U, "Deque must be at least 2 large" );
+		static_assert( ( Sz & ( Sz - 1U ) ) == 0, "Deque must be a power of 2" );
+		static constexpr std::ptrdiff_t mask = static_cast<std::ptrdiff_t>( Sz - 1U );
+
+		alignas( cache_line_size ) std::atomic<std::ptrdiff_t> m_top{ 0 };
+		alignas( cache_line_size ) std::atomic<std::ptrdiff_t> m_bottom{ 0 };
+		alignas( cache_line_size ) std::atomic<T *> m_data[Sz]{ };
+
+	public:
+		work_stealing_deque( ) noexcept = default;
+
+		work_stealing_deque( work_stealing_deque const & ) = delete;
+		work_stealing_deque( work_stealing_deque && ) = delete;
+		work_stealing_deque &operator=( work_stealing_deque const & ) = delete;
+		work_stealing_deque &operator=( work_stealing_deque && ) = delete;
+
+		~work_stealing_deque( ) {
+			while( try_pop_back( ) ) {}
+		}
+
+		[[nodiscard]] inline bool is_empty( ) const {
+			auto const b = m_bottom.load( std::memory_order_acquire );
+			auto const t = m_top.load( std::memory_order_acquire );
+			return b <= t;
+		}
+
+		/// Owner only.
+		[[nodiscard]] push_back_result try_push_back( std::unique_ptr<T> &&ptr ) {
+			assert( ptr );
+			auto const b = m_bottom.load( std::memory_order_relaxed );
+			auto const t = m_top.load( std::memory_order_acquire );
+			if( b - t >= static_cast<std::ptrdiff_t>( Sz ) ) {
+				return push_back_result::failed;
+			}
+			m_data[b & mask].store( ptr.release( ), std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_release );
+			m_bottom.store( b + 1, std::memory_order_relaxed );
+			return push_back_result::success;
+		}
+
+		/// Owner only.  Returns the most recently pushed item
+		[[nodiscard]] std::unique_ptr<T> try_pop_back( ) {
+			auto const b = m_bottom.load( std::memory_order_relaxed ) - 1;
+			m_bottom.store( b, std::memory_order_relaxed );
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			auto t = m_top.load( std::memory_order_relaxed );
+			if( t > b ) {
+				// Empty
+				m_bottom.store( b + 1, std::memory_order_relaxed );
+				return nullptr;
+			}
+			T *result = m_data[b & mask].load( std::memory_order_relaxed );
+			if( t == b ) {
+				// Last item, race against the thieves for it
+				if( not m_top.compare_exchange_strong( t, t + 1,
+				                                       std::memory_order_seq_cst,
+				                                       std::memory_order_relaxed ) ) {
+					result = nullptr;
+				}
+				m_bottom.store( b + 1, std::memory_order_relaxed );
+			}
+			return std::unique_ptr<T>( result );
+		}
+
+		/// Any thread.  Returns the oldest item.  May spuriously fail when
+		/// another thief or the owner won the race for the item
+		[[nodiscard]] std::unique_ptr<T> try_steal( ) {
+			auto t = m_top.load( std::memory_order_acquire );
+			std::atomic_thread_fence( std::memory_order_seq_cst );
+			auto const b = m_bottom.load( std::memory_order_acquire );
+			if( t >= b ) {
+				return nullptr;
+			}
+			T *result = m_data[t & mask].load( std::memory_order_relaxed );
+			if( not m_top.compare_exchange_strong( t, t + 1,
+			                                       std::memory_order_seq_cst,
+			                                       std::memory_order_relaxed ) ) {
+				return nullptr;
+			}
+			return std::unique_ptr<T>( result );
+		}
+	};
+} // namespace daw::parallel
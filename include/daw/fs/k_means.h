@@ -0,0 +1,248 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <daw/daw_exception.h>
+#include <daw/daw_move.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "algorithms.h"
+#include "impl/cache_padded.h"
+#include "impl/simd_kernels.h"
+#include "task_scheduler.h"
+
+namespace daw::algorithm::parallel {
+	/// Points of a fixed number of dimensions, stored as one array per
+	/// dimension so that a coordinate of consecutive points is contiguous
+	template<typename T>
+	class soa_points {
+		static_assert( std::is_floating_point_v<T>,
+		               "Coordinates must be float or double" );
+
+		std::size_t m_dimensions = 0;
+		std::size_t m_size = 0;
+		std::vector<T> m_coords{ };
+
+	public:
+		soa_points( ) = default;
+
+		soa_points( std::size_t dimensions, std::size_t size )
+		  : m_dimensions( dimensions )
+		  , m_size( size )
+		  , m_coords( dimensions * size ) {}
+
+		[[nodiscard]] std::size_t dimensions( ) const {
+			return m_dimensions;
+		}
+
+		[[nodiscard]] std::size_t size( ) const {
+			return m_size;
+		}
+
+		[[nodiscard]] bool empty( ) const {
+			return m_size == 0;
+		}
+
+		/// The coordinates of every point in dimension d
+		[[nodiscard]] T *dimension( std::size_t d ) {
+			return m_coords.data( ) + d * m_size;
+		}
+
+		[[nodiscard]] T const *dimension( std::size_t d ) const {
+			return m_coords.data( ) + d * m_size;
+		}
+
+		/// Coordinate d of point
+		[[nodiscard]] T &operator( )( std::size_t point, std::size_t d ) {
+			return m_coords[d * m_size + point];
+		}
+
+		[[nodiscard]] T const &operator( )( std::size_t point,
+		                                    std::size_t d ) const {
+			return m_coords[d * m_size + point];
+		}
+	};
+
+	struct k_means_options {
+		/// Stop after this many iterations even if points still move
+		std::size_t max_iterations = 100U;
+	};
+
+	template<typename T>
+	struct k_means_result {
+		/// The coordinates of one centroid after another
+		std::vector<T> centroids{ };
+		/// The cluster of each point
+		std::vector<uint32_t> labels{ };
+		std::size_t iterations = 0;
+		/// The last iteration moved no point to another cluster
+		bool converged = false;
+		/// Sum of the squared distances from the points to the centroids they
+		/// were assigned to in the last iteration
+		double inertia = 0.0;
+	};
+
+	/// Lloyd's k-means starting from initial_centroids, the coordinates of one
+	/// centroid after another.  Each iteration is a single pass, every worker
+	/// assigns its part of the points with a vectorized distance kernel and
+	/// sums them into centroid accumulators of its own.  These are merged
+	/// into the new centroids when the pass ends.  A cluster left without
+	/// points keeps its centroid
+	template<typename T>
+	[[nodiscard]] k_means_result<T>
+	k_means( soa_points<T> const &points, std::vector<T> initial_centroids,
+	         k_means_options const &options = k_means_options{ },
+	         task_scheduler ts = get_task_scheduler( ) ) {
+		auto const dims = points.dimensions( );
+		daw::exception::precondition_check(
+		  dims > 0 and not initial_centroids.empty( ) and
+		    initial_centroids.size( ) % dims == 0,
+		  "Expected whole centroids of the points' dimensions" );
+		auto const k = initial_centroids.size( ) / dims;
+		daw::exception::precondition_check(
+		  k < std::numeric_limits<uint32_t>::max( ), "Too many clusters" );
+
+		auto result = k_means_result<T>{ };
+		result.centroids = daw::move( initial_centroids );
+		// No point starts in a cluster, so the first pass moves all of them
+		result.labels = std::vector<uint32_t>( points.size( ),
+		                                       static_cast<uint32_t>( k ) );
+		if( points.empty( ) ) {
+			result.converged = true;
+			return result;
+		}
+
+		struct accumulator_t {
+			std::vector<double> sums{ };
+			std::vector<std::size_t> counts{ };
+			std::size_t moved = 0;
+			double inertia = 0.0;
+		};
+		using label_iterator = std::vector<uint32_t>::iterator;
+		namespace simd = impl::simd;
+
+		auto const ranges =
+		  default_range_splitter<simd::centroid_block_size>{ }(
+		    result.labels.begin( ), result.labels.end( ), ts.size( ) );
+		auto accumulators =
+		  std::vector<daw::parallel::cache_padded<accumulator_t>>(
+		    ranges.size( ) );
+
+		auto const assign_range = [&]( daw::view<label_iterator> rng,
+		                               std::size_t part ) {
+			auto &acc = *accumulators[part];
+			acc.sums.assign( k * dims, 0.0 );
+			acc.counts.assign( k, 0U );
+			acc.moved = 0;
+			acc.inertia = 0.0;
+			auto coords = std::vector<T const *>( dims );
+			uint32_t block_labels[simd::centroid_block_size];
+			auto const first = static_cast<std::size_t>(
+			  std::distance( result.labels.begin( ), rng.begin( ) ) );
+			auto const last = first + rng.size( );
+			for( auto pos = first; pos < last;
+			     pos += simd::centroid_block_size ) {
+				auto const count = std::min( simd::centroid_block_size, last - pos );
+				for( std::size_t d = 0; d < dims; ++d ) {
+					coords[d] = points.dimension( d ) + pos;
+				}
+				acc.inertia += static_cast<double>(
+				  simd::nearest_centroid( coords.data( ), dims, count,
+				                          result.centroids.data( ), k, block_labels ) );
+				for( std::size_t i = 0; i < count; ++i ) {
+					auto const label = block_labels[i];
+					acc.moved += static_cast<std::size_t>( label !=
+					                                       result.labels[pos + i] );
+					result.labels[pos + i] = label;
+					++acc.counts[label];
+					for( std::size_t d = 0; d < dims; ++d ) {
+						acc.sums[label * dims + d] += static_cast<double>( coords[d][i] );
+					}
+				}
+			}
+		};
+
+		auto sums = std::vector<double>( k * dims );
+		auto counts = std::vector<std::size_t>( k );
+		while( result.iterations < options.max_iterations ) {
+			impl::run_partition_range_pos( ranges, assign_range, ts );
+			++result.iterations;
+
+			std::fill( sums.begin( ), sums.end( ), 0.0 );
+			std::fill( counts.begin( ), counts.end( ), 0U );
+			std::size_t moved = 0;
+			result.inertia = 0.0;
+			for( auto const &acc : accumulators ) {
+				for( std::size_t n = 0; n < sums.size( ); ++n ) {
+					sums[n] += acc->sums[n];
+				}
+				for( std::size_t c = 0; c < k; ++c ) {
+					counts[c] += acc->counts[c];
+				}
+				moved += acc->moved;
+				result.inertia += acc->inertia;
+			}
+			for( std::size_t c = 0; c < k; ++c ) {
+				if( counts[c] == 0 ) {
+					continue;
+				}
+				for( std::size_t d = 0; d < dims; ++d ) {
+					result.centroids[c * dims + d] = static_cast<T>(
+					  sums[c * dims + d] / static_cast<double>( counts[c] ) );
+				}
+			}
+			if( moved == 0 ) {
+				result.converged = true;
+				break;
+			}
+		}
+		return result;
+	}
+
+	/// k-means with k clusters seeded by points spread evenly over the input
+	template<typename T>
+	[[nodiscard]] k_means_result<T>
+	k_means( soa_points<T> const &points, std::size_t k,
+	         k_means_options const &options = k_means_options{ },
+	         task_scheduler ts = get_task_scheduler( ) ) {
+		daw::exception::precondition_check(
+		  k > 0 and k <= points.size( ),
+		  "Expected between 1 and size( ) clusters" );
+		auto const dims = points.dimensions( );
+		auto centroids = std::vector<T>( k * dims );
+		for( std::size_t c = 0; c < k; ++c ) {
+			auto const point = c * points.size( ) / k;
+			for( std::size_t d = 0; d < dims; ++d ) {
+				centroids[c * dims + d] = points( point, d );
+			}
+		}
+		return k_means( points, daw::move( centroids ), options, daw::move( ts ) );
+	}
+} // namespace daw::algorithm::parallel
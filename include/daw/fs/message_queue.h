@@ -22,27 +22,28 @@
 
 #pragma once
 
+#include "impl/cache_padded.h"
 #include "impl/daw_condition_variable.h"
+#include "impl/event_count.h"
 
 #include <daw/daw_move.h>
 #include <daw/daw_utility.h>
 
 #include <boost/lockfree/queue.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <cstddef>
 #include <cstdlib>
+#include <iterator>
 #include <memory>
 #include <mutex>
 #include <new>
+#include <optional>
+#include <type_traits>
 #include <utility>
 
 namespace daw::parallel {
-#ifdef __cpp_lib_thread_hardware_interference_size
-	inline static constepxr size_t cache_line_size =
-	  ::std::hardware_destructive_interference_size;
-#else
-	inline static constexpr size_t cache_line_size = 128U; // safe default
-#endif
-
 	namespace wait_impl {
 		template<typename Waiter, typename Rep, typename Period, typename Predicate,
 		         typename ConditionalChecker>
@@ -66,6 +67,8 @@ namespace daw::parallel {
 		static_assert( Sz >= 2U, "Queue must be at least 2 large" );
 		static_assert( ( Sz & ( Sz - 1U ) ) == 0, "Queue must be a power of 2" );
 		boost::lockfree::queue<T *, boost::lockfree::capacity<Sz>> m_data{ };
+		event_count m_not_empty{ };
+		event_count m_not_full{ };
 
 	public:
 		mpmc_bounded_queue( ) noexcept = default;
@@ -87,6 +90,7 @@ namespace daw::parallel {
 				return push_back_result::failed;
 			}
 			(void)ptr.release( );
+			m_not_empty.notify_one( );
 			return push_back_result::success;
 		}
 
@@ -96,44 +100,756 @@ namespace daw::parallel {
 				return nullptr;
 			}
 			assert( result );
+			m_not_full.notify_one( );
 			return std::unique_ptr<T>( result );
 		}
 
+		/// Wait until an item is available or can_continue( ) is false.  Waiters
+		/// park after a short spin, so when the state can_continue checks changes
+		/// call notify_all_waiters( )
 		template<typename Predicate>
 		[[nodiscard]] std::unique_ptr<T> pop_front( Predicate &&can_continue ) {
 			static_assert( std::is_invocable_v<Predicate> );
+			return spin_then_park(
+			  m_not_empty, [&]( ) { return try_pop_front( ); }, can_continue );
+		}
+
+		/// Wait until there is room for ptr or can_continue( ) is false.  Waiters
+		/// park after a short spin, so when the state can_continue checks changes
+		/// call notify_all_waiters( )
+		template<typename Predicate>
+		[[nodiscard]] push_back_result push_back( std::unique_ptr<T> &&ptr,
+		                                          Predicate &&can_continue ) {
+			static_assert( std::is_invocable_v<Predicate> );
+			assert( ptr );
+			return spin_then_park(
+			  m_not_full, [&]( ) { return try_push_back( daw::move( ptr ) ); },
+			  can_continue );
+		}
+
+		/// Wake every thread parked in pop_front or push_back so they recheck
+		/// their predicates
+		inline void notify_all_waiters( ) noexcept {
+			m_not_empty.notify_all( );
+			m_not_full.notify_all( );
+		}
+	};
+
+	/// What mpmc_queue does once it holds capacity items.
+	/// block: try_push_back fails and push_back waits for room
+	/// grow: more nodes are allocated and pushes never wait
+	enum class queue_overflow : bool { block, grow };
+
+	/// Multiple producer, multiple consumer queue with a runtime capacity.
+	/// capacity nodes are allocated up front, past that the overflow policy
+	/// decides whether to fail or to grow.  Either way it stays lock free
+	template<typename T>
+	class mpmc_queue {
+		boost::lockfree::queue<T *> m_data{ 0U };
+		std::size_t m_capacity = 0U;
+		queue_overflow m_overflow = queue_overflow::block;
+		event_count m_not_empty{ };
+		event_count m_not_full{ };
+
+	public:
+		static constexpr std::size_t default_capacity = 512U;
+
+		/// An unsized queue.  It holds nothing until configure( ) gives it a
+		/// capacity, so containers of queues can be sized after construction
+		mpmc_queue( ) = default;
+
+		explicit mpmc_queue( std::size_t capacity,
+		                     queue_overflow overflow = queue_overflow::block ) {
+			configure( capacity, overflow );
+		}
+
+		mpmc_queue( mpmc_queue const & ) = delete;
+		mpmc_queue( mpmc_queue && ) = delete;
+		mpmc_queue &operator=( mpmc_queue const & ) = delete;
+		mpmc_queue &operator=( mpmc_queue && ) = delete;
+
+		~mpmc_queue( ) {
+			T *item = nullptr;
+			while( m_data.pop( item ) ) {
+				delete item;
+			}
+		}
+
+		/// Size the queue to hold capacity items and set the overflow policy.
+		/// Nodes cannot be freed, so a capacity below the current one is a no-op.
+		/// Not thread safe, call it before the queue is shared
+		void configure( std::size_t capacity, queue_overflow overflow ) {
+			if( capacity > m_capacity ) {
+				m_data.reserve( capacity - m_capacity );
+				m_capacity = capacity;
+			}
+			m_overflow = overflow;
+		}
+
+		[[nodiscard]] inline std::size_t capacity( ) const {
+			return m_capacity;
+		}
+
+		[[nodiscard]] inline queue_overflow overflow( ) const {
+			return m_overflow;
+		}
+
+		[[nodiscard]] inline bool is_empty( ) const {
+			return m_data.empty( );
+		}
+
+		[[nodiscard]] inline push_back_result
+		try_push_back( std::unique_ptr<T> &&ptr ) {
+			assert( ptr );
+			bool const pushed = m_overflow == queue_overflow::grow
+			                      ? m_data.push( ptr.get( ) )
+			                      : m_data.bounded_push( ptr.get( ) );
+			if( not pushed ) {
+				return push_back_result::failed;
+			}
+			(void)ptr.release( );
+			m_not_empty.notify_one( );
+			return push_back_result::success;
+		}
+
+		[[nodiscard]] std::unique_ptr<T> try_pop_front( ) {
 			T *result = nullptr;
-			while( can_continue( ) ) {
-				if( not m_data.pop( result ) ) {
-					std::this_thread::yield( );
-					std::this_thread::sleep_for( std::chrono::nanoseconds( 2 ) );
-					result = nullptr;
-					continue;
-				}
-				assert( result );
-				return std::unique_ptr<T>( result );
+			if( not m_data.pop( result ) ) {
+				return nullptr;
 			}
-			return nullptr;
+			assert( result );
+			m_not_full.notify_one( );
+			return std::unique_ptr<T>( result );
+		}
+
+		/// Wait until an item is available or can_continue( ) is false
+		template<typename Predicate>
+		[[nodiscard]] std::unique_ptr<T> pop_front( Predicate &&can_continue ) {
+			static_assert( std::is_invocable_v<Predicate> );
+			return spin_then_park(
+			  m_not_empty, [&]( ) { return try_pop_front( ); }, can_continue );
 		}
 
+		/// Wait until there is room for ptr or can_continue( ) is false.  A
+		/// growing queue only waits if allocating a node fails
 		template<typename Predicate>
 		[[nodiscard]] push_back_result push_back( std::unique_ptr<T> &&ptr,
 		                                          Predicate &&can_continue ) {
 			static_assert( std::is_invocable_v<Predicate> );
 			assert( ptr );
-			while( can_continue( ) ) {
-				if( not m_data.push( ptr.get( ) ) ) {
-					std::this_thread::yield( );
-					std::this_thread::sleep_for( std::chrono::nanoseconds( 2 ) );
+			return spin_then_park(
+			  m_not_full, [&]( ) { return try_push_back( daw::move( ptr ) ); },
+			  can_continue );
+		}
+
+		/// Wake every thread parked in pop_front or push_back so they recheck
+		/// their predicates
+		inline void notify_all_waiters( ) noexcept {
+			m_not_empty.notify_all( );
+			m_not_full.notify_all( );
+		}
+	};
+
+	/// Multiple producer, multiple consumer channel of values holding at most
+	/// capacity items.  Producers wait for room and consumers wait for items.
+	/// After close( ) pushes fail and pops drain what is left
+	template<typename T>
+	class bounded_channel {
+		mpmc_queue<T> m_queue;
+		std::size_t m_capacity;
+		std::atomic_size_t m_size{ 0U };
+		std::atomic_bool m_closed{ false };
+		event_count m_not_empty{ };
+		event_count m_not_full{ };
+
+	public:
+		explicit bounded_channel( std::size_t capacity )
+		  : m_queue( capacity, queue_overflow::grow )
+		  , m_capacity( capacity ) {
+			assert( capacity > 0U );
+		}
+
+		bounded_channel( bounded_channel const & ) = delete;
+		bounded_channel( bounded_channel && ) = delete;
+		bounded_channel &operator=( bounded_channel const & ) = delete;
+		bounded_channel &operator=( bounded_channel && ) = delete;
+		~bounded_channel( ) = default;
+
+		[[nodiscard]] inline std::size_t capacity( ) const noexcept {
+			return m_capacity;
+		}
+
+		[[nodiscard]] inline std::size_t size( ) const noexcept {
+			return m_size.load( );
+		}
+
+		[[nodiscard]] inline bool is_empty( ) const noexcept {
+			return size( ) == 0U;
+		}
+
+		/// With a single producer, a push after is_full( ) returned false always
+		/// succeeds
+		[[nodiscard]] inline bool is_full( ) const noexcept {
+			return size( ) >= m_capacity;
+		}
+
+		[[nodiscard]] inline bool is_closed( ) const noexcept {
+			return m_closed.load( );
+		}
+
+		/// Move value in if the channel is open and has room.  Otherwise value
+		/// is left alone
+		[[nodiscard]] bool try_push( T &value ) {
+			if( is_closed( ) ) {
+				return false;
+			}
+			if( m_size.fetch_add( 1U ) >= m_capacity ) {
+				m_size.fetch_sub( 1U );
+				return false;
+			}
+			auto ptr = std::make_unique<T>( daw::move( value ) );
+			if( m_queue.try_push_back( daw::move( ptr ) ) !=
+			    push_back_result::success ) {
+				value = daw::move( *ptr );
+				m_size.fetch_sub( 1U );
+				return false;
+			}
+			m_not_empty.notify_one( );
+			return true;
+		}
+
+		/// Wait for room and move value in.  false if the channel was closed
+		/// first
+		[[nodiscard]] bool push( T value ) {
+			return spin_then_park(
+			  m_not_full, [&]( ) { return try_push( value ); },
+			  [&]( ) { return not is_closed( ); } );
+		}
+
+		/// Wait until there is room or the channel is closed
+		void wait_for_room( ) {
+			(void)spin_then_park(
+			  m_not_full, [&]( ) { return not is_full( ); },
+			  [&]( ) { return not is_closed( ); } );
+		}
+
+		[[nodiscard]] std::optional<T> try_pop( ) {
+			auto ptr = m_queue.try_pop_front( );
+			if( not ptr ) {
+				return std::nullopt;
+			}
+			m_size.fetch_sub( 1U );
+			m_not_full.notify_one( );
+			return std::optional<T>( daw::move( *ptr ) );
+		}
+
+		/// Wait for an item.  Empty once the channel is closed and drained
+		[[nodiscard]] std::optional<T> pop( ) {
+			auto result = spin_then_park(
+			  m_not_empty, [&]( ) { return try_pop( ); },
+			  [&]( ) { return not is_closed( ); } );
+			if( not result ) {
+				result = try_pop( );
+			}
+			return result;
+		}
+
+		/// Fail every push from now on and wake all waiters
+		void close( ) noexcept {
+			m_closed.store( true );
+			m_not_empty.notify_all( );
+			m_not_full.notify_all( );
+		}
+	};
+
+	namespace ring_impl {
+		/// The power of 2 number of slots that holds capacity items
+		[[nodiscard]] constexpr std::size_t slot_count( std::size_t capacity ) {
+			std::size_t result = 1U;
+			while( result < capacity ) {
+				result <<= 1U;
+			}
+			return result;
+		}
+
+		/// Uninitialized room for one T
+		template<typename T>
+		struct storage_t {
+			alignas( T ) unsigned char data[sizeof( T )];
+
+			[[nodiscard]] inline T *get( ) noexcept {
+				return std::launder( reinterpret_cast<T *>( data ) );
+			}
+
+			template<typename U>
+			inline void construct( U &&value ) noexcept {
+				::new( static_cast<void *>( data ) ) T( DAW_FWD( value ) );
+			}
+		};
+
+		/// A slot of an mpmc_ring.  Each is on its own cache line, so neighbouring
+		/// slots being filled and emptied by different threads do not contend.
+		/// seq is the position the slot is ready to be pushed at, or one past the
+		/// position it is ready to be popped at
+		template<typename T>
+		struct alignas( cache_line_size ) mpmc_slot_t {
+			std::atomic_size_t seq{ 0U };
+			storage_t<T> storage{ };
+		};
+	} // namespace ring_impl
+
+	/// A single producer, single consumer ring of at most capacity T's stored
+	/// inline, so no allocation happens after construction.  Batches move with
+	/// one atomic store on each end.  Only one thread may push and one pop at a
+	/// time; handing a side to another thread needs a happens before between
+	/// them.  Moving a T and assigning to out must not throw
+	template<typename T>
+	class spsc_ring {
+		static_assert( std::is_nothrow_move_constructible_v<T>,
+		               "ring values must be nothrow move constructible" );
+
+		struct producer_t {
+			std::atomic_size_t tail{ 0U };
+			// The consumer's head as of the last time the ring looked full
+			std::size_t head_cache = 0U;
+		};
+
+		struct consumer_t {
+			std::atomic_size_t head{ 0U };
+			// The producer's tail as of the last time the ring looked empty
+			std::size_t tail_cache = 0U;
+		};
+
+		std::size_t m_capacity;
+		std::size_t m_mask;
+		std::unique_ptr<ring_impl::storage_t<T>[]> m_slots;
+		cache_padded<producer_t> m_producer{ };
+		cache_padded<consumer_t> m_consumer{ };
+
+		[[nodiscard]] inline T *slot( std::size_t pos ) const noexcept {
+			return m_slots[pos & m_mask].get( );
+		}
+
+	public:
+		using value_type = T;
+
+		explicit spsc_ring( std::size_t capacity )
+		  : m_capacity( capacity )
+		  , m_mask( ring_impl::slot_count( capacity ) - 1U )
+		  , m_slots( std::make_unique<ring_impl::storage_t<T>[]>( m_mask + 1U ) ) {
+			assert( capacity > 0U );
+		}
+
+		spsc_ring( spsc_ring const & ) = delete;
+		spsc_ring( spsc_ring && ) = delete;
+		spsc_ring &operator=( spsc_ring const & ) = delete;
+		spsc_ring &operator=( spsc_ring && ) = delete;
+
+		~spsc_ring( ) {
+			auto const tail = m_producer->tail.load( std::memory_order_acquire );
+			for( auto pos = m_consumer->head.load( ); pos != tail; ++pos ) {
+				slot( pos )->~T( );
+			}
+		}
+
+		[[nodiscard]] inline std::size_t capacity( ) const noexcept {
+			return m_capacity;
+		}
+
+		[[nodiscard]] inline std::size_t size( ) const noexcept {
+			auto const head = m_consumer->head.load( std::memory_order_acquire );
+			return m_producer->tail.load( std::memory_order_acquire ) - head;
+		}
+
+		/// Move up to count items from first in.  Returns how many were taken
+		template<typename Iterator>
+		[[nodiscard]] std::size_t try_push_n( Iterator first, std::size_t count ) {
+			auto &p = *m_producer;
+			auto const tail = p.tail.load( std::memory_order_relaxed );
+			auto room = m_capacity - ( tail - p.head_cache );
+			if( room < count ) {
+				p.head_cache = m_consumer->head.load( std::memory_order_acquire );
+				room = m_capacity - ( tail - p.head_cache );
+			}
+			auto const n = std::min( count, room );
+			for( std::size_t i = 0; i < n; ++i, ++first ) {
+				m_slots[( tail + i ) & m_mask].construct( daw::move( *first ) );
+			}
+			p.tail.store( tail + n, std::memory_order_release );
+			return n;
+		}
+
+		/// Move value in if there is room.  Otherwise value is left alone
+		[[nodiscard]] inline bool try_push( T &value ) {
+			return try_push_n( &value, 1U ) == 1U;
+		}
+
+		/// Move up to count items out to out.  Returns how many were moved
+		template<typename OutputIterator>
+		[[nodiscard]] std::size_t try_pop_n( OutputIterator out,
+		                                     std::size_t count ) {
+			auto &c = *m_consumer;
+			auto const head = c.head.load( std::memory_order_relaxed );
+			auto ready = c.tail_cache - head;
+			if( ready < count ) {
+				c.tail_cache = m_producer->tail.load( std::memory_order_acquire );
+				ready = c.tail_cache - head;
+			}
+			auto const n = std::min( count, ready );
+			for( std::size_t i = 0; i < n; ++i, ++out ) {
+				T *item = slot( head + i );
+				*out = daw::move( *item );
+				item->~T( );
+			}
+			c.head.store( head + n, std::memory_order_release );
+			return n;
+		}
+	};
+
+	/// A multiple producer, multiple consumer ring of at most capacity T's
+	/// stored inline in cache line aligned slots, so no allocation happens after
+	/// construction.  A batch is claimed with one compare exchange.  Moving a T
+	/// and assigning to out must not throw
+	template<typename T>
+	class mpmc_ring {
+		static_assert( std::is_nothrow_move_constructible_v<T>,
+		               "ring values must be nothrow move constructible" );
+
+		using slot_t = ring_impl::mpmc_slot_t<T>;
+
+		std::size_t m_capacity;
+		std::size_t m_mask;
+		std::unique_ptr<slot_t[]> m_slots;
+		cache_padded<std::atomic_size_t> m_enqueue{ };
+		cache_padded<std::atomic_size_t> m_dequeue{ };
+
+		[[nodiscard]] inline slot_t &slot( std::size_t pos ) const noexcept {
+			return m_slots[pos & m_mask];
+		}
+
+		/// How many of the count positions from pos have a slot with seq
+		/// pos + offset
+		[[nodiscard]] inline std::size_t ready_run( std::size_t pos,
+		                                            std::size_t offset,
+		                                            std::size_t count ) const {
+			std::size_t n = 0;
+			while( n < count and
+			       slot( pos + n ).seq.load( std::memory_order_acquire ) ==
+			         pos + n + offset ) {
+				++n;
+			}
+			return n;
+		}
+
+	public:
+		using value_type = T;
+
+		explicit mpmc_ring( std::size_t capacity )
+		  : m_capacity( capacity )
+		  , m_mask( ring_impl::slot_count( capacity ) - 1U )
+		  , m_slots( std::make_unique<slot_t[]>( m_mask + 1U ) ) {
+			assert( capacity > 0U );
+			for( std::size_t n = 0; n <= m_mask; ++n ) {
+				m_slots[n].seq.store( n, std::memory_order_relaxed );
+			}
+		}
+
+		mpmc_ring( mpmc_ring const & ) = delete;
+		mpmc_ring( mpmc_ring && ) = delete;
+		mpmc_ring &operator=( mpmc_ring const & ) = delete;
+		mpmc_ring &operator=( mpmc_ring && ) = delete;
+
+		~mpmc_ring( ) {
+			auto const last = m_enqueue->load( std::memory_order_acquire );
+			for( auto pos = m_dequeue->load( ); pos != last; ++pos ) {
+				slot( pos ).storage.get( )->~T( );
+			}
+		}
+
+		[[nodiscard]] inline std::size_t capacity( ) const noexcept {
+			return m_capacity;
+		}
+
+		/// Items pushed and not yet claimed by a pop
+		[[nodiscard]] inline std::size_t size( ) const noexcept {
+			// Dequeue never passes enqueue, so load it first
+			auto const first = m_dequeue->load( std::memory_order_acquire );
+			return m_enqueue->load( std::memory_order_acquire ) - first;
+		}
+
+		/// Move up to count items from first in.  Returns how many were taken
+		template<typename Iterator>
+		[[nodiscard]] std::size_t try_push_n( Iterator first, std::size_t count ) {
+			if( count == 0U ) {
+				return 0U;
+			}
+			auto pos = m_enqueue->load( std::memory_order_relaxed );
+			while( true ) {
+				auto limit = count;
+				if( m_capacity <= m_mask ) {
+					// There are more slots than items allowed
+					auto const used =
+					  pos - m_dequeue->load( std::memory_order_acquire );
+					if( static_cast<std::ptrdiff_t>( used ) < 0 ) {
+						// pos is stale
+						pos = m_enqueue->load( std::memory_order_relaxed );
+						continue;
+					}
+					if( used >= m_capacity ) {
+						return 0U;
+					}
+					limit = std::min( count, m_capacity - used );
+				}
+				auto const n = ready_run( pos, 0U, limit );
+				if( n == 0U ) {
+					auto const seq = slot( pos ).seq.load( std::memory_order_acquire );
+					if( static_cast<std::ptrdiff_t>( seq - pos ) < 0 ) {
+						// The slot still holds an item a lap behind
+						return 0U;
+					}
+					pos = m_enqueue->load( std::memory_order_relaxed );
+					continue;
+				}
+				if( m_enqueue->compare_exchange_weak( pos, pos + n,
+				                                      std::memory_order_relaxed ) ) {
+					for( std::size_t i = 0; i < n; ++i, ++first ) {
+						auto &s = slot( pos + i );
+						s.storage.construct( daw::move( *first ) );
+						s.seq.store( pos + i + 1U, std::memory_order_release );
+					}
+					return n;
+				}
+			}
+		}
+
+		/// Move value in if there is room.  Otherwise value is left alone
+		[[nodiscard]] inline bool try_push( T &value ) {
+			return try_push_n( &value, 1U ) == 1U;
+		}
+
+		/// Move up to count items out to out.  Returns how many were moved
+		template<typename OutputIterator>
+		[[nodiscard]] std::size_t try_pop_n( OutputIterator out,
+		                                     std::size_t count ) {
+			if( count == 0U ) {
+				return 0U;
+			}
+			auto pos = m_dequeue->load( std::memory_order_relaxed );
+			while( true ) {
+				auto const n = ready_run( pos, 1U, count );
+				if( n == 0U ) {
+					auto const seq = slot( pos ).seq.load( std::memory_order_acquire );
+					if( static_cast<std::ptrdiff_t>( seq - ( pos + 1U ) ) < 0 ) {
+						// Nothing has been pushed at pos yet
+						return 0U;
+					}
+					pos = m_dequeue->load( std::memory_order_relaxed );
 					continue;
 				}
-				(void)ptr.release( );
-				return push_back_result::success;
+				if( m_dequeue->compare_exchange_weak( pos, pos + n,
+				                                      std::memory_order_relaxed ) ) {
+					for( std::size_t i = 0; i < n; ++i, ++out ) {
+						auto &s = slot( pos + i );
+						T *item = s.storage.get( );
+						*out = daw::move( *item );
+						item->~T( );
+						s.seq.store( pos + i + m_mask + 1U, std::memory_order_release );
+					}
+					return n;
+				}
+			}
+		}
+	};
+
+	/// A channel of values over an spsc_ring or mpmc_ring.  Producers wait for
+	/// room and consumers wait for items by parking on an event_count instead
+	/// of sleeping.  After close( ) pushes fail and pops drain what is left
+	template<typename Ring>
+	class ring_channel {
+		Ring m_ring;
+		std::atomic_bool m_closed{ false };
+		event_count m_not_empty{ };
+		event_count m_not_full{ };
+
+		static inline void notify( event_count &ec, std::size_t count ) noexcept {
+			if( count == 1U ) {
+				ec.notify_one( );
+			} else if( count > 1U ) {
+				ec.notify_all( );
+			}
+		}
+
+	public:
+		using value_type = typename Ring::value_type;
+
+		explicit ring_channel( std::size_t capacity )
+		  : m_ring( capacity ) {}
+
+		ring_channel( ring_channel const & ) = delete;
+		ring_channel( ring_channel && ) = delete;
+		ring_channel &operator=( ring_channel const & ) = delete;
+		ring_channel &operator=( ring_channel && ) = delete;
+		~ring_channel( ) = default;
+
+		[[nodiscard]] inline std::size_t capacity( ) const noexcept {
+			return m_ring.capacity( );
+		}
+
+		[[nodiscard]] inline std::size_t size( ) const noexcept {
+			return m_ring.size( );
+		}
+
+		[[nodiscard]] inline bool is_empty( ) const noexcept {
+			return size( ) == 0U;
+		}
+
+		/// With a single producer, a push after is_full( ) returned false always
+		/// succeeds
+		[[nodiscard]] inline bool is_full( ) const noexcept {
+			return size( ) >= capacity( );
+		}
+
+		[[nodiscard]] inline bool is_closed( ) const noexcept {
+			return m_closed.load( );
+		}
+
+		/// Move up to count items from first in if the channel is open.  Returns
+		/// how many were taken
+		template<typename Iterator>
+		[[nodiscard]] std::size_t try_push_n( Iterator first, std::size_t count ) {
+			if( is_closed( ) ) {
+				return 0U;
+			}
+			auto const n = m_ring.try_push_n( first, count );
+			notify( m_not_empty, n );
+			return n;
+		}
+
+		/// Move value in if the channel is open and has room.  Otherwise value
+		/// is left alone
+		[[nodiscard]] inline bool try_push( value_type &value ) {
+			return try_push_n( &value, 1U ) == 1U;
+		}
+
+		/// Wait for room and move value in.  false if the channel was closed
+		/// first
+		[[nodiscard]] bool push( value_type value ) {
+			return spin_then_park(
+			  m_not_full, [&]( ) { return try_push( value ); },
+			  [&]( ) { return not is_closed( ); } );
+		}
+
+		/// Move count items from the forward range starting at first in, waiting
+		/// for room as needed.  Returns how many were taken, fewer than count
+		/// only when the channel was closed first
+		template<typename ForwardIterator>
+		std::size_t push_n( ForwardIterator first, std::size_t count ) {
+			std::size_t pushed = 0U;
+			while( pushed < count ) {
+				auto const n = spin_then_park(
+				  m_not_full, [&]( ) { return try_push_n( first, count - pushed ); },
+				  [&]( ) { return not is_closed( ); } );
+				if( n == 0U ) {
+					break;
+				}
+				std::advance( first, n );
+				pushed += n;
+			}
+			return pushed;
+		}
+
+		/// Wait until there is room or the channel is closed
+		void wait_for_room( ) {
+			(void)spin_then_park(
+			  m_not_full, [&]( ) { return not is_full( ); },
+			  [&]( ) { return not is_closed( ); } );
+		}
+
+		/// Move up to count items out to out.  Returns how many were moved
+		template<typename OutputIterator>
+		[[nodiscard]] std::size_t try_pop_n( OutputIterator out,
+		                                     std::size_t count ) {
+			auto const n = m_ring.try_pop_n( out, count );
+			notify( m_not_full, n );
+			return n;
+		}
+
+		[[nodiscard]] std::optional<value_type> try_pop( ) {
+			auto result = std::optional<value_type>( );
+			struct emplace_t {
+				std::optional<value_type> *dst;
+
+				emplace_t &operator*( ) noexcept {
+					return *this;
+				}
+				emplace_t &operator++( ) noexcept {
+					return *this;
+				}
+				emplace_t &operator=( value_type &&value ) noexcept {
+					dst->emplace( daw::move( value ) );
+					return *this;
+				}
+			};
+			(void)try_pop_n( emplace_t{ &result }, 1U );
+			return result;
+		}
+
+		/// Wait for an item.  Empty once the channel is closed and drained
+		[[nodiscard]] std::optional<value_type> pop( ) {
+			auto result = spin_then_park(
+			  m_not_empty, [&]( ) { return try_pop( ); },
+			  [&]( ) { return not is_closed( ); } );
+			if( not result ) {
+				result = try_pop( );
+			}
+			return result;
+		}
+
+		/// Wait for at least one item and move up to count out to out.  Returns
+		/// how many were moved, 0 once the channel is closed and drained
+		template<typename OutputIterator>
+		[[nodiscard]] std::size_t pop_n( OutputIterator out, std::size_t count ) {
+			auto const n = spin_then_park(
+			  m_not_empty, [&]( ) { return try_pop_n( out, count ); },
+			  [&]( ) { return not is_closed( ); } );
+			if( n == 0U ) {
+				return try_pop_n( out, count );
 			}
-			return push_back_result::failed;
+			return n;
+		}
+
+		/// Fail every push from now on and wake all waiters
+		void close( ) noexcept {
+			m_closed.store( true );
+			m_not_empty.notify_all( );
+			m_not_full.notify_all( );
 		}
 	};
 
+	/// A single producer, single consumer channel of values that does not
+	/// allocate per item
+	template<typename T>
+	using spsc_channel = ring_channel<spsc_ring<T>>;
+
+	/// A multiple producer, multiple consumer channel of values that does not
+	/// allocate per item
+	template<typename T>
+	using mpmc_channel = ring_channel<mpmc_ring<T>>;
+
+	template<typename T, typename Predicate>
+	[[nodiscard]] inline std::unique_ptr<T> pop_front( mpmc_queue<T> &q,
+	                                                   Predicate &&can_continue ) {
+		return q.pop_front( DAW_FWD( can_continue ) );
+	}
+
+	template<typename T, typename Predicate>
+	[[nodiscard]] inline push_back_result push_back( mpmc_queue<T> &q,
+	                                                 std::unique_ptr<T> &&value,
+	                                                 Predicate &&can_continue ) {
+
+		return q.push_back( daw::move( value ), DAW_FWD( can_continue ) );
+	}
+
 	template<typename T, std::size_t Sz, typename Predicate>
 	[[nodiscard]] inline std::unique_ptr<T>
 	pop_front( mpmc_bounded_queue<T, Sz> &q, Predicate &&can_continue ) {
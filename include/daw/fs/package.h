@@ -27,7 +27,6 @@
 #include <utility>
 
 #include <daw/daw_move.h>
-#include <daw/daw_value_ptr.h>
 
 namespace daw {
 	template<typename Result, typename Functions, typename... Args>
@@ -79,17 +78,16 @@ namespace daw {
 		//	weak_ptr_type_t<result_t>;
 
 	private:
-		daw::value_ptr<
-		  impl::package_impl_t<functions_t, arguments_t, result_t, Args...>>
-		  m_impl;
+		// Held in place so make_shared_package is a single allocation
+		impl::package_impl_t<functions_t, arguments_t, result_t, Args...> m_impl;
 
 	public:
 		package_t( package_t const & ) = delete;
 		package_t &operator=( package_t const & ) = delete;
 
 		~package_t( ) noexcept = default;
-		constexpr package_t( package_t && ) noexcept = default;
-		constexpr package_t &operator=( package_t && ) noexcept = default;
+		constexpr package_t( package_t && ) = default;
+		constexpr package_t &operator=( package_t && ) = default;
 
 		constexpr package_t( bool continueonclientdestruction, result_t result,
 		                     functions_t &&functions, Args &&... args )
@@ -102,19 +100,19 @@ namespace daw {
 		            std::forward<Args>( args )... ) {}
 
 		[[nodiscard]] constexpr functions_t const &function_list( ) const noexcept {
-			return m_impl->m_function_list;
+			return m_impl.m_function_list;
 		}
 
 		[[nodiscard]] constexpr functions_t &function_list( ) noexcept {
-			return m_impl->m_function_list;
+			return m_impl.m_function_list;
 		}
 
 		[[nodiscard]] constexpr result_t const &result( ) const noexcept {
-			return m_impl->m_result;
+			return m_impl.m_result;
 		}
 
 		[[nodiscard]] constexpr result_t &result( ) noexcept {
-			return m_impl->m_result;
+			return m_impl.m_result;
 		}
 
 		[[nodiscard]] constexpr bool continue_processing( ) const {
@@ -124,27 +122,27 @@ namespace daw {
 		template<typename... NewArgs>
 		[[nodiscard]] decltype( auto ) next_package( NewArgs && ... nargs ) {
 			return make_shared_package( continue_on_result_destruction( ),
-			                            daw::move( m_impl->m_result ),
-			                            daw::move( m_impl->m_function_list ),
+			                            daw::move( m_impl.m_result ),
+			                            daw::move( m_impl.m_function_list ),
 			                            std::forward<NewArgs>( nargs )... );
 		}
 
 		[[nodiscard]] constexpr arguments_t const &targs( ) const noexcept {
-			return m_impl->m_targs;
+			return m_impl.m_targs;
 		}
 
 		[[nodiscard]] constexpr arguments_t &targs( ) noexcept {
-			return m_impl->m_targs;
+			return m_impl.m_targs;
 		}
 
 	private:
 		[[nodiscard]] constexpr bool const &continue_on_result_destruction( )
 		  const noexcept {
-			return m_impl->m_continue_on_result_destruction;
+			return m_impl.m_continue_on_result_destruction;
 		}
 
 		[[nodiscard]] constexpr bool &continue_on_result_destruction( ) noexcept {
-			return m_impl->m_continue_on_result_destruction;
+			return m_impl.m_continue_on_result_destruction;
 		}
 	}; // package_t
 
@@ -162,9 +160,8 @@ namespace daw {
 	make_shared_package( bool continue_on_result_destruction, Result &&result,
 	                     Functions &&functions, Args &&... args ) {
 		return std::make_shared<package_t<Result, Functions, Args...>>(
-		  make_package(
-		    continue_on_result_destruction, std::forward<Result>( result ),
-		    std::forward<Functions>( functions ), std::forward<Args>( args )... ) );
+		  continue_on_result_destruction, std::forward<Result>( result ),
+		  std::forward<Functions>( functions ), std::forward<Args>( args )... );
 	}
 
 } // namespace daw
@@ -0,0 +1,286 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <daw/daw_move.h>
+#include <daw/daw_traits.h>
+#include <daw/daw_view.h>
+
+#include "impl/algorithms_impl.h"
+#include "impl/cache_padded.h"
+#include "impl/cost_model.h"
+#include "task_scheduler.h"
+
+namespace daw::algorithm::parallel {
+	namespace impl {
+		/// Stages take an item and a sink, passing on zero or more items to the
+		/// sink.  output_t<T> is what they pass on when given a T
+		struct identity_stage {
+			template<typename T>
+			using output_t = T;
+
+			template<typename T, typename Sink>
+			inline void operator( )( T &&value, Sink &&sink ) const {
+				sink( DAW_FWD( value ) );
+			}
+		};
+
+		template<typename Function>
+		struct map_stage {
+			Function func;
+
+			template<typename T>
+			using output_t =
+			  daw::remove_cvref_t<std::invoke_result_t<Function const &, T>>;
+
+			template<typename T, typename Sink>
+			inline void operator( )( T &&value, Sink &&sink ) const {
+				sink( func( DAW_FWD( value ) ) );
+			}
+		};
+
+		template<typename Predicate>
+		struct filter_stage {
+			Predicate pred;
+
+			template<typename T>
+			using output_t = T;
+
+			template<typename T, typename Sink>
+			inline void operator( )( T &&value, Sink &&sink ) const {
+				if( pred( std::as_const( value ) ) ) {
+					sink( DAW_FWD( value ) );
+				}
+			}
+		};
+
+		/// Feeds everything first passes on through second
+		template<typename First, typename Second>
+		struct chained_stage {
+			First first;
+			Second second;
+
+			template<typename T>
+			using output_t = typename Second::template output_t<
+			  typename First::template output_t<T>>;
+
+			template<typename T, typename Sink>
+			inline void operator( )( T &&value, Sink &&sink ) const {
+				first( DAW_FWD( value ),
+				       [&]( auto &&next ) { second( DAW_FWD( next ), sink ); } );
+			}
+		};
+
+		/// Gives every partition of range a default constructed Result and calls
+		/// per_range( partition, result ) on each in one fan-out, or once on the
+		/// whole range when it is too small to be worth splitting
+		template<typename Result, typename PartitionPolicy, typename Iterator,
+		         typename PerRange>
+		[[nodiscard]] std::vector<daw::parallel::cache_padded<Result>>
+		run_pipeline( daw::view<Iterator> range, PerRange const &per_range,
+		              task_scheduler &ts, cost_hint hint ) {
+			using value_t = typename std::iterator_traits<Iterator>::value_type;
+			if( should_run_inline<value_t>( range.size( ), hint, ts ) ) {
+				auto results = std::vector<daw::parallel::cache_padded<Result>>( 1 );
+				per_range( range, *results[0] );
+				return results;
+			}
+			auto const ranges = PartitionPolicy{ }( range, ts.size( ) );
+			auto results =
+			  std::vector<daw::parallel::cache_padded<Result>>( ranges.size( ) );
+			run_partition_range_pos(
+			  ranges,
+			  [&results, &per_range]( daw::view<Iterator> rng, size_t n ) {
+				  per_range( rng, *results[n] );
+			  },
+			  ts );
+			return results;
+		}
+	} // namespace impl
+
+	/// A lazy chain of element wise stages over a range.  map and filter only
+	/// record a stage, the work happens in a terminal operation( reduce, count,
+	/// for_each or to_vector ).  Each partition runs every item through all the
+	/// stages before moving to the next item, so a chain costs one fan-out and
+	/// one join and no intermediate buffers.  The hint passed to a terminal
+	/// operation is the cost of all stages per item
+	template<typename Iterator, typename Stages = impl::identity_stage>
+	class pipeline_t {
+		daw::view<Iterator> m_range;
+		Stages m_stages;
+
+		using input_t = typename std::iterator_traits<Iterator>::value_type;
+
+		template<typename Stage>
+		[[nodiscard]] auto add_stage( Stage &&stage ) const {
+			using next_t =
+			  impl::chained_stage<Stages, daw::remove_cvref_t<Stage>>;
+			return pipeline_t<Iterator, next_t>(
+			  m_range, next_t{ m_stages, DAW_FWD( stage ) } );
+		}
+
+		template<typename Sink>
+		inline void run_range( daw::view<Iterator> rng, Sink &&sink ) const {
+			for( auto it = rng.begin( ); it != rng.end( ); ++it ) {
+				m_stages( *it, sink );
+			}
+		}
+
+	public:
+		/// Type of the items reaching the terminal operation
+		using value_type = typename Stages::template output_t<input_t>;
+
+		pipeline_t( daw::view<Iterator> range, Stages stages )
+		  : m_range( range )
+		  , m_stages( daw::move( stages ) ) {}
+
+		/// Pass on func( item ) instead of each item
+		template<typename Function>
+		[[nodiscard]] auto map( Function &&func ) const {
+			return add_stage( impl::map_stage<daw::remove_cvref_t<Function>>{
+			  DAW_FWD( func ) } );
+		}
+
+		/// Only pass on items where pred( item ) is true
+		template<typename Predicate>
+		[[nodiscard]] auto filter( Predicate &&pred ) const {
+			return add_stage( impl::filter_stage<daw::remove_cvref_t<Predicate>>{
+			  DAW_FWD( pred ) } );
+		}
+
+		/// Combine init and every item reaching the end with binary_op.  Like
+		/// reduce, binary_op must be associative
+		template<typename PartitionPolicy = impl::split_range_t<>, typename T,
+		         typename BinaryOp>
+		[[nodiscard]] auto reduce( T const &init, BinaryOp const &binary_op,
+		                           task_scheduler ts = get_task_scheduler( ),
+		                           cost_hint hint = cost_hint{ } ) const {
+			using result_t = daw::remove_cvref_t<decltype(
+			  binary_op( init, std::declval<value_type>( ) ) )>;
+
+			auto const partials =
+			  impl::run_pipeline<std::optional<result_t>, PartitionPolicy>(
+			    m_range,
+			    [&]( daw::view<Iterator> rng, std::optional<result_t> &acc ) {
+				    run_range( rng, [&]( auto &&value ) {
+					    if( acc ) {
+						    *acc = binary_op( daw::move( *acc ), DAW_FWD( value ) );
+					    } else {
+						    acc = static_cast<result_t>( DAW_FWD( value ) );
+					    }
+				    } );
+			    },
+			    ts, hint );
+
+			auto result = static_cast<result_t>( init );
+			for( auto const &partial : partials ) {
+				if( *partial ) {
+					result = binary_op( daw::move( result ), **partial );
+				}
+			}
+			return result;
+		}
+
+		/// Number of items reaching the end
+		template<typename PartitionPolicy = impl::split_range_t<>>
+		[[nodiscard]] size_t count( task_scheduler ts = get_task_scheduler( ),
+		                            cost_hint hint = cost_hint{ } ) const {
+			auto const partials = impl::run_pipeline<size_t, PartitionPolicy>(
+			  m_range,
+			  [&]( daw::view<Iterator> rng, size_t &partial ) {
+				  run_range( rng, [&]( auto && ) { ++partial; } );
+			  },
+			  ts, hint );
+
+			auto result = size_t{ 0 };
+			for( auto const &partial : partials ) {
+				result += *partial;
+			}
+			return result;
+		}
+
+		/// Call func on every item reaching the end, in no particular order
+		template<typename PartitionPolicy = impl::split_range_t<>,
+		         typename Function>
+		void for_each( Function const &func,
+		               task_scheduler ts = get_task_scheduler( ),
+		               cost_hint hint = cost_hint{ } ) const {
+			(void)impl::run_pipeline<std::monostate, PartitionPolicy>(
+			  m_range,
+			  [&]( daw::view<Iterator> rng, std::monostate & ) {
+				  run_range( rng, [&]( auto &&value ) { func( DAW_FWD( value ) ); } );
+			  },
+			  ts, hint );
+		}
+
+		/// The items reaching the end, in the order of the range
+		template<typename PartitionPolicy = impl::split_range_t<>>
+		[[nodiscard]] std::vector<value_type>
+		to_vector( task_scheduler ts = get_task_scheduler( ),
+		           cost_hint hint = cost_hint{ } ) const {
+			auto partials =
+			  impl::run_pipeline<std::vector<value_type>, PartitionPolicy>(
+			    m_range,
+			    [&]( daw::view<Iterator> rng, std::vector<value_type> &partial ) {
+				    run_range( rng, [&]( auto &&value ) {
+					    partial.emplace_back( DAW_FWD( value ) );
+				    } );
+			    },
+			    ts, hint );
+
+			if( partials.size( ) == 1U ) {
+				return daw::move( *partials.front( ) );
+			}
+			auto total = size_t{ 0 };
+			for( auto const &partial : partials ) {
+				total += partial->size( );
+			}
+			auto result = std::vector<value_type>( );
+			result.reserve( total );
+			for( auto &partial : partials ) {
+				std::move( partial->begin( ), partial->end( ),
+				           std::back_inserter( result ) );
+			}
+			return result;
+		}
+	};
+
+	/// Start a pipeline over [first, last).  The range must outlive the
+	/// terminal operation
+	template<typename RandomIterator>
+	[[nodiscard]] pipeline_t<RandomIterator> pipeline( RandomIterator first,
+	                                                   RandomIterator last ) {
+		traits::is_random_access_iterator_test<RandomIterator>( );
+		return pipeline_t<RandomIterator>( daw::view( first, last ),
+		                                   impl::identity_stage{ } );
+	}
+} // namespace daw::algorithm::parallel
@@ -0,0 +1,261 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <daw/daw_exception.h>
+#include <daw/daw_memory_mapped_file.h>
+#include <daw/daw_move.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#include "algorithms.h"
+#include "impl/simd_kernels.h"
+#include "task_scheduler.h"
+
+namespace daw {
+	struct record_split_options {
+		/// Every record ends with delimiter, except perhaps the last one
+		char delimiter = '\n';
+		/// Bytes per chunk before it is extended to the end of a record.  0
+		/// makes four chunks per worker
+		std::size_t chunk_size = 4U * 1024U * 1024U;
+	};
+
+	/// Split data into chunks of about options.chunk_size bytes, each ending
+	/// just after a delimiter or at the end of data.  Boundaries are found in
+	/// parallel and only the bytes near them are read, the records inside a
+	/// chunk are left for whoever processes it.  The chunks are views of data
+	[[nodiscard]] inline std::vector<std::string_view>
+	split_records( std::string_view data,
+	               record_split_options const &options = record_split_options{ },
+	               task_scheduler ts = get_task_scheduler( ) ) {
+		if( data.empty( ) ) {
+			return { };
+		}
+		auto chunk_size = options.chunk_size;
+		if( chunk_size == 0 ) {
+			chunk_size =
+			  std::max<std::size_t>( 1U, data.size( ) / ( 4U * ts.size( ) ) );
+		}
+		auto const chunk_count = ( data.size( ) + chunk_size - 1U ) / chunk_size;
+		// bounds[n] is where chunk n starts
+		auto bounds = std::vector<std::size_t>( chunk_count + 1U );
+		bounds.back( ) = data.size( );
+		if( chunk_count > 1U ) {
+			// Finding a boundary touches a page or two, worth more than a word
+			constexpr auto hint = algorithm::parallel::cost_hint{ 512U };
+			algorithm::parallel::impl::parallel_for_each_index(
+			  std::next( bounds.begin( ) ), std::prev( bounds.end( ) ),
+			  [&]( std::size_t n ) {
+				  // Start one early so a chunk that already ends on a delimiter
+				  // keeps its nominal size
+				  auto const pos =
+				    data.find( options.delimiter, ( n + 1U ) * chunk_size - 1U );
+				  bounds[n + 1U] =
+				    pos == std::string_view::npos ? data.size( ) : pos + 1U;
+			  },
+			  ts, hint );
+		}
+		auto chunks = std::vector<std::string_view>( );
+		chunks.reserve( chunk_count );
+		for( std::size_t n = 0; n < chunk_count; ++n ) {
+			// Records longer than chunk_size leave empty chunks behind
+			if( bounds[n + 1U] > bounds[n] ) {
+				chunks.push_back(
+				  data.substr( bounds[n], bounds[n + 1U] - bounds[n] ) );
+			}
+		}
+		return chunks;
+	}
+
+	/// Call func with each record of chunk, without its delimiter
+	template<typename Function>
+	void for_each_record( std::string_view chunk, Function &&func,
+	                      char delimiter = '\n' ) {
+		while( not chunk.empty( ) ) {
+			auto const pos = chunk.find( delimiter );
+			if( pos == std::string_view::npos ) {
+				func( chunk );
+				return;
+			}
+			func( chunk.substr( 0, pos ) );
+			chunk.remove_prefix( pos + 1U );
+		}
+	}
+
+	struct field_split_options {
+		/// Ends a field inside a record
+		char delimiter = ',';
+		/// Ends a record, best matched with record_split_options::delimiter
+		char record_delimiter = '\n';
+		/// Delimiters between a pair of these are part of the field
+		char quote = '"';
+	};
+
+	/// Where the fields of every record in a chunk of delimited text are.  The
+	/// separators are found with a bit mask per 64 bytes instead of a branch
+	/// per byte.  A chunk is assumed to start outside quotes, quotes are left
+	/// in the fields and a final record without a delimiter is still a record
+	class field_index {
+		std::string_view m_chunk{ };
+		// Offset of the separator after each field
+		std::vector<uint32_t> m_field_ends{ };
+		// Number of fields up to the end of each record
+		std::vector<uint32_t> m_record_ends{ };
+		bool m_open_quote = false;
+
+		[[nodiscard]] std::size_t first_field( std::size_t record ) const {
+			return record == 0 ? 0U : m_record_ends[record - 1U];
+		}
+
+	public:
+		field_index( ) = default;
+
+		explicit field_index(
+		  std::string_view chunk,
+		  field_split_options const &options = field_split_options{ } )
+		  : m_chunk( chunk ) {
+			daw::exception::precondition_check(
+			  chunk.size( ) < std::numeric_limits<uint32_t>::max( ),
+			  "Chunk is too large to index" );
+			// A guess of one field per eight bytes saves most of the regrowth
+			m_field_ends.reserve( chunk.size( ) / 8U + 1U );
+			m_open_quote = algorithm::parallel::impl::simd::find_separators(
+			  chunk.data( ), chunk.size( ),
+			  algorithm::parallel::impl::simd::separator_chars{
+			    options.delimiter, options.record_delimiter, options.quote },
+			  &m_field_ends, &m_record_ends );
+			auto const last_end =
+			  m_record_ends.empty( )
+			    ? std::size_t{ 0 }
+			    : std::size_t{ m_field_ends[m_record_ends.back( ) - 1U] } + 1U;
+			if( last_end < chunk.size( ) ) {
+				m_field_ends.push_back( static_cast<uint32_t>( chunk.size( ) ) );
+				m_record_ends.push_back(
+				  static_cast<uint32_t>( m_field_ends.size( ) ) );
+			}
+		}
+
+		[[nodiscard]] std::string_view chunk( ) const {
+			return m_chunk;
+		}
+
+		[[nodiscard]] std::size_t record_count( ) const {
+			return m_record_ends.size( );
+		}
+
+		[[nodiscard]] std::size_t field_count( std::size_t record ) const {
+			return m_record_ends[record] - first_field( record );
+		}
+
+		/// Field n of record, without its separator
+		[[nodiscard]] std::string_view field( std::size_t record,
+		                                      std::size_t n ) const {
+			auto const pos = first_field( record ) + n;
+			auto const start = pos == 0 ? std::size_t{ 0 }
+			                            : std::size_t{ m_field_ends[pos - 1U] } + 1U;
+			return m_chunk.substr( start, m_field_ends[pos] - start );
+		}
+
+		/// The chunk ended inside quotes, a quote was not closed or a record
+		/// delimiter inside quotes was taken as a chunk boundary
+		[[nodiscard]] bool has_open_quote( ) const {
+			return m_open_quote;
+		}
+	};
+
+	/// Index the fields of each chunk in parallel, e.g. the chunks of
+	/// split_records or mapped_records
+	template<typename Chunks>
+	[[nodiscard]] std::vector<field_index>
+	index_fields( Chunks const &chunks,
+	              field_split_options const &options = field_split_options{ },
+	              task_scheduler ts = get_task_scheduler( ) ) {
+		auto result = std::vector<field_index>(
+		  static_cast<std::size_t>( std::distance( std::begin( chunks ),
+		                                           std::end( chunks ) ) ) );
+		auto const first = std::begin( chunks );
+		// A chunk is many records, far more than a word of work
+		constexpr auto hint = algorithm::parallel::cost_hint{ 1U << 16U };
+		algorithm::parallel::impl::parallel_for_each_index(
+		  result.begin( ), result.end( ),
+		  [&]( std::size_t n ) {
+			  auto const chunk = std::string_view(
+			    *std::next( first, static_cast<std::ptrdiff_t>( n ) ) );
+			  result[n] = field_index( chunk, options );
+		  },
+		  ts, hint );
+		return result;
+	}
+
+	/// A file mapped read only into memory and split with split_records.  The
+	/// chunks, a random access range of std::string_view, can go straight to
+	/// for_each, map_reduce or a function_stream without copying the file
+	class mapped_records {
+		daw::filesystem::memory_mapped_file_t<char> m_file;
+		std::vector<std::string_view> m_chunks{ };
+
+	public:
+		using const_iterator = std::vector<std::string_view>::const_iterator;
+
+		explicit mapped_records(
+		  std::string_view path,
+		  record_split_options const &options = record_split_options{ },
+		  task_scheduler ts = get_task_scheduler( ) )
+		  : m_file( path ) {
+			daw::exception::precondition_check(
+			  static_cast<bool>( m_file ), "Could not open input file for reading" );
+			m_chunks = split_records( data( ), options, daw::move( ts ) );
+		}
+
+		mapped_records( mapped_records const & ) = delete;
+		mapped_records &operator=( mapped_records const & ) = delete;
+
+		[[nodiscard]] std::string_view data( ) const {
+			return std::string_view( m_file.data( ), m_file.size( ) );
+		}
+
+		[[nodiscard]] std::vector<std::string_view> const &chunks( ) const {
+			return m_chunks;
+		}
+
+		[[nodiscard]] const_iterator begin( ) const {
+			return m_chunks.cbegin( );
+		}
+
+		[[nodiscard]] const_iterator end( ) const {
+			return m_chunks.cend( );
+		}
+
+		[[nodiscard]] std::size_t size( ) const {
+			return m_chunks.size( );
+		}
+	};
+} // namespace daw
@@ -0,0 +1,182 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "impl/task.h"
+#include "task_scheduler.h"
+
+#include <daw/daw_move.h>
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace daw {
+	/// How many of its tasks a strand runs before it goes to the back of the
+	/// queue and lets the other work of the pool have a turn
+	inline constexpr std::size_t strand_batch_size = 64U;
+
+	namespace impl {
+		/// The queue of a strand.  Producers push onto an intrusive MPSC list,
+		/// and the push that finds it idle schedules a drain.  Only the drain
+		/// pops, so the tasks run one at a time in the order they were pushed
+		class strand_state : public std::enable_shared_from_this<strand_state> {
+			struct node_base_t {
+				std::atomic<node_base_t *> next = nullptr;
+			};
+
+			struct node_t : node_base_t {
+				daw::task_t task;
+
+				template<typename Task>
+				explicit node_t( Task &&t )
+				  : task( DAW_FWD( t ) ) {}
+			};
+
+			task_scheduler m_scheduler;
+			// The last pushed node, only exchanged by producers
+			std::atomic<node_base_t *> m_back;
+			// Tasks pushed and not yet run.  Counted before a node is linked, so
+			// a drain may briefly wait for a link but never miss a task
+			std::atomic_size_t m_pending = std::atomic_size_t( 0U );
+			// The node last run, or m_stub.  Only the drain touches it
+			node_base_t *m_front;
+			node_base_t m_stub{ };
+
+			void retire( node_base_t *node ) noexcept {
+				if( node != &m_stub ) {
+					delete static_cast<node_t *>( node );
+				}
+			}
+
+			void schedule( ) {
+				if( not m_scheduler.add_task(
+				      [self = shared_from_this( )]( ) { self->drain( ); } ) ) {
+					// Nobody else can be draining, the queue was idle
+					drain( );
+				}
+			}
+
+			/// Run up to strand_batch_size tasks, and schedule another drain if
+			/// more are waiting.  An exception is rethrown once the strand is
+			/// back in order, for the scheduler to report
+			void drain( ) {
+				std::size_t done = 0;
+				auto ex = std::exception_ptr( );
+				while( done < strand_batch_size and not ex ) {
+					auto *next = m_front->next.load( std::memory_order_acquire );
+					if( not next ) {
+						if( m_pending.load( std::memory_order_acquire ) == done ) {
+							break;
+						}
+						// A producer has counted its task and not linked it yet
+						std::this_thread::yield( );
+						continue;
+					}
+					retire( std::exchange( m_front, next ) );
+					auto &node = *static_cast<node_t *>( next );
+					try {
+						node.task( );
+					} catch( ... ) { ex = std::current_exception( ); }
+					// Drop the captures now instead of when the next task runs
+					node.task = daw::task_t( );
+					++done;
+				}
+				if( m_pending.fetch_sub( done, std::memory_order_acq_rel ) != done ) {
+					schedule( );
+				}
+				if( ex ) {
+					std::rethrow_exception( ex );
+				}
+			}
+
+		public:
+			explicit strand_state( task_scheduler ts )
+			  : m_scheduler( daw::move( ts ) )
+			  , m_back( &m_stub )
+			  , m_front( &m_stub ) {}
+
+			strand_state( strand_state const & ) = delete;
+			strand_state &operator=( strand_state const & ) = delete;
+
+			~strand_state( ) {
+				// Tasks that never ran, e.g. the scheduler stopped
+				auto *node = m_front;
+				while( node ) {
+					auto *next = node->next.load( std::memory_order_relaxed );
+					retire( node );
+					node = next;
+				}
+			}
+
+			template<typename Task>
+			void push( Task &&task ) {
+				auto *node = new node_t( DAW_FWD( task ) );
+				bool const was_idle =
+				  m_pending.fetch_add( 1U, std::memory_order_acq_rel ) == 0;
+				m_back.exchange( node, std::memory_order_acq_rel )
+				  ->next.store( node, std::memory_order_release );
+				if( was_idle ) {
+					schedule( );
+				}
+			}
+
+			[[nodiscard]] task_scheduler const &scheduler( ) const noexcept {
+				return m_scheduler;
+			}
+		};
+	} // namespace impl
+
+	/// A serial executor on a task_scheduler.  Tasks added to a strand run one
+	/// at a time, in the order they were added, on the workers of the pool and
+	/// without holding a lock, so ordered work per connection or account does
+	/// not block a worker waiting its turn.  Copies share one state.  Once a
+	/// task has run, an idle strand also keeps the emptied node of the last
+	/// one, since the queue needs a front node, so it holds two allocations
+	class strand {
+		std::shared_ptr<impl::strand_state> m_state;
+
+	public:
+		explicit strand( task_scheduler ts = get_task_scheduler( ) )
+		  : m_state( std::make_shared<impl::strand_state>( daw::move( ts ) ) ) {}
+
+		/// Run task after every task added to this strand before it.  Exceptions
+		/// go to the scheduler's unhandled_exception_handler and the strand
+		/// carries on with the next task
+		template<typename Task>
+		void add_task( Task &&task ) {
+			static_assert( std::is_invocable_v<Task>,
+			               "Task passed to strand::add_task must be callable "
+			               "without an argument. e.g. task( )" );
+			m_state->push( DAW_FWD( task ) );
+		}
+
+		[[nodiscard]] task_scheduler const &scheduler( ) const noexcept {
+			return m_state->scheduler( );
+		}
+	};
+} // namespace daw
@@ -0,0 +1,193 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "impl/daw_latch.h"
+#include "impl/task.h"
+#include "task_scheduler.h"
+
+#include <daw/daw_exception.h>
+#include <daw/daw_move.h>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace daw {
+	/// A set of tasks and the order they must run in, built once and run as
+	/// often as needed.  Each node counts the predecessors it is waiting on,
+	/// and the node that finishes last among them schedules it from the
+	/// worker it runs on.  Running the graph again reuses the nodes and their
+	/// latch, so nothing is allocated beyond the scheduler's own task nodes.
+	/// The graph must outlive its runs and is not changed while one is going
+	class task_graph {
+	public:
+		using node_id = std::size_t;
+
+	private:
+		static constexpr node_id no_node = std::numeric_limits<node_id>::max( );
+
+		struct node_t {
+			daw::task_t task;
+			std::vector<node_id> successors{ };
+			std::size_t predecessor_count = 0;
+			// Predecessors this run is still waiting on
+			std::atomic_size_t pending = std::atomic_size_t( 0U );
+
+			template<typename Task>
+			explicit node_t( Task &&t )
+			  : task( DAW_FWD( t ) ) {}
+		};
+
+		// A deque so nodes, and their atomics, never move
+		std::deque<node_t> m_nodes{ };
+		std::vector<node_id> m_roots{ };
+		bool m_is_checked = false;
+		daw::shared_latch m_done = daw::shared_latch( 0 );
+
+		/// Find the roots, and throw if some nodes can never become ready
+		void check( ) {
+			if( m_is_checked ) {
+				return;
+			}
+			m_roots.clear( );
+			auto waiting = std::vector<std::size_t>( );
+			waiting.reserve( m_nodes.size( ) );
+			for( node_id n = 0; n < m_nodes.size( ); ++n ) {
+				waiting.push_back( m_nodes[n].predecessor_count );
+				if( waiting.back( ) == 0 ) {
+					m_roots.push_back( n );
+				}
+			}
+			auto ready = m_roots;
+			std::size_t visited = 0;
+			while( not ready.empty( ) ) {
+				auto const n = ready.back( );
+				ready.pop_back( );
+				++visited;
+				for( auto s : m_nodes[n].successors ) {
+					if( --waiting[s] == 0 ) {
+						ready.push_back( s );
+					}
+				}
+			}
+			daw::exception::precondition_check( visited == m_nodes.size( ),
+			                                    "task_graph has a cycle" );
+			m_is_checked = true;
+		}
+
+		void schedule( task_scheduler &ts, node_id n ) {
+			if( not ts.add_task( [this, ts, n]( ) mutable { run_from( ts, n ); } ) ) {
+				run_from( ts, n );
+			}
+		}
+
+		/// Run node n, then whichever of its successors it made ready last, and
+		/// so on, queueing the other ready successors
+		void run_from( task_scheduler &ts, node_id n ) {
+			while( n != no_node ) {
+				auto &node = m_nodes[n];
+				impl::run_group_task( m_done, node.task );
+				auto next = no_node;
+				for( auto s : node.successors ) {
+					if( m_nodes[s].pending.fetch_sub( 1U, std::memory_order_acq_rel ) ==
+					    1U ) {
+						if( next != no_node ) {
+							schedule( ts, next );
+						}
+						next = s;
+					}
+				}
+				// With no next, this may release the waiter and end the graph's
+				// lifetime, so nothing of it is touched afterwards
+				m_done.notify( );
+				n = next;
+			}
+		}
+
+	public:
+		task_graph( ) = default;
+		task_graph( task_graph const & ) = delete;
+		task_graph &operator=( task_graph const & ) = delete;
+		task_graph( task_graph && ) = delete;
+		task_graph &operator=( task_graph && ) = delete;
+		~task_graph( ) = default;
+
+		[[nodiscard]] std::size_t size( ) const noexcept {
+			return m_nodes.size( );
+		}
+
+		[[nodiscard]] bool empty( ) const noexcept {
+			return m_nodes.empty( );
+		}
+
+		/// Add a node that runs task.  It may run many times, once per run
+		template<typename Task>
+		node_id add_node( Task &&task ) {
+			static_assert( std::is_invocable_v<Task>,
+			               "Task passed to add_node must be callable without an "
+			               "argument. e.g. task( )" );
+			m_nodes.emplace_back( DAW_FWD( task ) );
+			m_is_checked = false;
+			return m_nodes.size( ) - 1U;
+		}
+
+		/// after does not start until before has finished
+		void add_edge( node_id before, node_id after ) {
+			daw::exception::precondition_check(
+			  before < m_nodes.size( ) and after < m_nodes.size( ) and
+			    before != after,
+			  "Expected an edge between two different nodes of the graph" );
+			m_nodes[before].successors.push_back( after );
+			++m_nodes[after].predecessor_count;
+			m_is_checked = false;
+		}
+
+		/// Start a run of every node and return the latch released when all of
+		/// them have finished.  The first exception of a node is kept in it and
+		/// the nodes that have not started yet skip their work.  A run must be
+		/// waited for before the next starts
+		[[nodiscard]] daw::shared_latch
+		start( task_scheduler ts = get_task_scheduler( ) ) {
+			check( );
+			for( auto &node : m_nodes ) {
+				node.pending.store( node.predecessor_count, std::memory_order_relaxed );
+			}
+			m_done.reset( m_nodes.size( ) );
+			for( auto n : m_roots ) {
+				schedule( ts, n );
+			}
+			return m_done;
+		}
+
+		/// Run every node once and wait for them, rethrowing the first exception
+		/// of a node
+		void run( task_scheduler ts = get_task_scheduler( ) ) {
+			ts.wait_for( start( ts ) );
+		}
+	};
+} // namespace daw
@@ -24,48 +24,199 @@
 
 #include "daw/daw_fixed_array.h"
 #include "impl/daw_latch.h"
+#include "impl/event_count.h"
 #include "impl/ithread.h"
 #include "impl/task.h"
+#include "impl/timer_wheel.h"
+#include "impl/work_stealing_deque.h"
+#include "cancellation.h"
 #include "message_queue.h"
+#include "trace.h"
 
+#include <daw/daw_exception.h>
 #include <daw/daw_move.h>
 #include <daw/daw_ring_adaptor.h>
 #include <daw/daw_scope_guard.h>
 #include <daw/daw_utility.h>
 
+#include <chrono>
+#include <cstdint>
 #include <deque>
 #include <exception>
+#include <functional>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace daw {
+	struct unable_to_add_task_exception : std::exception {
+		unable_to_add_task_exception( ) = default;
+
+		[[nodiscard]] char const *what( ) const noexcept override;
+	};
+
+	class task_scheduler;
+
 	namespace impl {
 		template<typename Iterator, typename Handle>
 		struct temp_task_runner;
 
-		template<typename Handle, typename Task>
+		/// Run task as one of the group counted by sem.  The first exception of
+		/// the group is kept in sem for the waiting thread, and the tasks that
+		/// start after it skip their work
+		template<typename Latch, typename Task>
+		void run_group_task( Latch &sem, Task &&task ) {
+			if( sem.has_exception( ) ) {
+				return;
+			}
+			try {
+				(void)DAW_FWD( task )( );
+			} catch( ... ) { sem.set_exception( std::current_exception( ) ); }
+		}
+
+		/// Who the current thread works for.  A worker sets it for its whole
+		/// life and holds its scheduler meanwhile, so tasks and submissions on
+		/// a worker find the scheduler and their queue without a shared counter
+		/// or locking a weak_ptr
+		struct worker_context_t {
+			void const *owner = nullptr;
+			task_scheduler *scheduler = nullptr;
+			size_t id = 0;
+		};
+
+		inline thread_local worker_context_t current_worker{ };
+
+		template<typename Task>
 		struct task_wrapper {
-			size_t id;
-			mutable Handle wself;
+			// The task_scheduler_impl whose queues hold the task
+			void const *owner;
 			mutable Task task;
 
-			constexpr task_wrapper( size_t Id, Handle const &hnd, Task const &tsk )
-			  : id( Id )
-			  , wself( hnd )
+			constexpr task_wrapper( void const *o, Task const &tsk )
+			  : owner( o )
 			  , task( tsk ) {}
 
-			constexpr void operator( )( ) const {
+			/// Run the task, then keep running this worker's tasks.  Defined
+			/// after task_scheduler
+			void operator( )( ) const;
+		};
+
+		template<typename Task>
+		task_wrapper( void const *, Task ) -> task_wrapper<Task>;
+
+		/// Runs task and then adds itself back to the timers one period after
+		/// the time it was due, until tok is cancelled or the scheduler is gone.
+		/// Periods missed by a late run are skipped rather than run back to back
+		template<typename Handle, typename Task>
+		struct periodic_task {
+			Handle wself;
+			std::shared_ptr<Task> task;
+			std::chrono::steady_clock::duration period;
+			std::chrono::steady_clock::time_point due;
+			cancellation_token tok;
+
+			void operator( )( ) {
+				if( tok.is_cancelled( ) ) {
+					return;
+				}
+				(void)( *task )( );
+				if( tok.is_cancelled( ) ) {
+					return;
+				}
 				if( auto self = wself.lock( ); self ) {
-					(void)task( );
-					while( self->m_impl->m_continue and self->run_next_task( id ) ) {}
+					auto next = *this;
+					next.due += period;
+					auto const now = std::chrono::steady_clock::now( );
+					if( next.due <= now ) {
+						next.due += ( ( now - next.due ) / period + 1 ) * period;
+					}
+					(void)self->add_task_at( next.due, daw::move( next ) );
 				}
 			}
 		};
 
-		template<typename Handle, typename Task>
-		task_wrapper( size_t, Handle, Task ) -> task_wrapper<Handle, Task>;
+		/// The latch a group of tasks notifies, held shared or, when the caller
+		/// owns it and waits on it, by pointer
+		[[nodiscard]] inline daw::shared_latch &
+		latch_of( daw::shared_latch &sem ) noexcept {
+			return sem;
+		}
+
+		[[nodiscard]] inline daw::latch &latch_of( daw::latch *sem ) noexcept {
+			return *sem;
+		}
+
+		/// The callables of one add_tasks call, kept in a single allocation.
+		/// It is freed by the last of its tasks to run or be dropped
+		template<typename Tasks, typename Sem = daw::shared_latch>
+		struct task_batch {
+			Tasks tasks;
+			Sem sem;
+			std::atomic_size_t remaining;
+
+			task_batch( Tasks t, Sem s )
+			  : tasks( daw::move( t ) )
+			  , sem( daw::move( s ) )
+			  , remaining( std::size( tasks ) ) {}
+
+			void release( ) noexcept {
+				if( remaining.fetch_sub( 1U, std::memory_order_acq_rel ) == 1U ) {
+					delete this;
+				}
+			}
+
+			/// Task n was destroyed without running, e.g. the scheduler stopped
+			void drop( ) noexcept {
+				latch_of( sem ).set_exception(
+				  std::make_exception_ptr( unable_to_add_task_exception{ } ) );
+				latch_of( sem ).notify( );
+				release( );
+			}
+
+			void run( size_t n ) {
+				auto const at_exit = daw::on_scope_exit( [&]( ) {
+					latch_of( sem ).notify( );
+					release( );
+				} );
+				auto const span = trace_span( "task", static_cast<std::int64_t>( n ) );
+				run_group_task( latch_of( sem ), tasks[n] );
+			}
+		};
+
+		/// Task n of a batch.  Small enough to be stored inline in a task_t
+		template<typename Batch>
+		class batch_task_t {
+			Batch *m_batch;
+			size_t m_index;
+
+		public:
+			batch_task_t( Batch *batch, size_t index ) noexcept
+			  : m_batch( batch )
+			  , m_index( index ) {}
+
+			batch_task_t( batch_task_t &&other ) noexcept
+			  : m_batch( std::exchange( other.m_batch, nullptr ) )
+			  , m_index( other.m_index ) {}
+
+			batch_task_t( batch_task_t const & ) = delete;
+			batch_task_t &operator=( batch_task_t const & ) = delete;
+			batch_task_t &operator=( batch_task_t && ) = delete;
+
+			~batch_task_t( ) {
+				if( m_batch ) {
+					m_batch->drop( );
+				}
+			}
+
+			void operator( )( ) {
+				std::exchange( m_batch, nullptr )->run( m_index );
+			}
+		};
 	} // namespace impl
 
 	template<typename... Tasks>
@@ -78,14 +229,149 @@ namespace daw {
 	constexpr bool is_waitable_v =
 	  daw::is_detected_v<is_waitable_detector, std::remove_reference_t<Waitable>>;
 
-	struct unable_to_add_task_exception : std::exception {
-		unable_to_add_task_exception( ) = default;
+	template<typename Waitable>
+	using has_try_wait_detector =
+	  decltype( std::declval<Waitable const &>( ).try_wait( ) );
 
-		[[nodiscard]] char const *what( ) const noexcept override;
+	template<typename Waitable>
+	constexpr bool has_try_wait_v =
+	  daw::is_detected_v<has_try_wait_detector,
+	                     std::remove_reference_t<Waitable>>;
+
+	template<typename Waitable>
+	using has_rethrow_if_exception_detector =
+	  decltype( std::declval<Waitable const &>( ).rethrow_if_exception( ) );
+
+	template<typename Waitable>
+	constexpr bool has_rethrow_if_exception_v =
+	  daw::is_detected_v<has_rethrow_if_exception_detector,
+	                     std::remove_reference_t<Waitable>>;
+
+	/// How tasks are distributed to the workers.
+	/// shared_queues: tasks are placed round-robin into the worker queues
+	/// work_stealing: tasks added from a worker go onto that workers own deque
+	/// and idle workers steal from the others.  Tasks added from outside the
+	/// pool use the shared queues
+	enum class scheduler_mode : bool { shared_queues, work_stealing };
+
+	/// Where the worker threads run.
+	/// any: wherever the OS puts them
+	/// numa_pinned: each worker is pinned to a cpu, with consecutive workers
+	/// filling one NUMA node before the next.  Stealing prefers workers on the
+	/// same node and partitioned algorithms send partition n to the same
+	/// worker every time, so data stays near the node that first touched it
+	enum class worker_placement : bool { any, numa_pinned };
+
+	/// Workers take high before normal before low.  Every
+	/// task_scheduler::priority_aging_interval'th pick looks at the lower
+	/// classes first, so a flood of urgent work cannot starve them
+	enum class task_priority : std::uint8_t { high, normal, low };
+
+	/// The time a task should start by.  Tasks with a deadline run ahead of
+	/// the priority classes, earliest deadline first
+	using task_deadline = std::chrono::steady_clock::time_point;
+
+#if defined( DAW_FS_SCHEDULER_STATS )
+	inline constexpr bool scheduler_stats_enabled = true;
+#else
+	inline constexpr bool scheduler_stats_enabled = false;
+#endif
+
+	/// A snapshot of one worker's counters
+	struct worker_stats {
+		std::uint64_t tasks_executed = 0;
+		std::uint64_t steals_attempted = 0;
+		std::uint64_t steals_succeeded = 0;
+		std::chrono::nanoseconds busy_time{ };
+		std::chrono::nanoseconds idle_time{ };
+		// Most tasks waiting in the worker's deque and queue at once
+		std::int64_t queue_high_water = 0;
+	};
+
+	/// Counters of a task_scheduler, read while it runs.  They are only
+	/// collected when built with DAW_FS_SCHEDULER_STATS, otherwise all are 0
+	struct scheduler_stats {
+		std::vector<worker_stats> workers{ };
+		// Submissions that found the queues full and had to wait for room
+		std::uint64_t push_back_blocks = 0;
+		std::uint64_t temp_runner_spawns = 0;
+	};
+
+	namespace impl {
+		/// The live counters behind worker_stats.  Relaxed, they are only
+		/// ever read as a snapshot
+		struct worker_counters_t {
+			std::atomic<std::uint64_t> tasks_executed{ };
+			std::atomic<std::uint64_t> steals_attempted{ };
+			std::atomic<std::uint64_t> steals_succeeded{ };
+			std::atomic<std::uint64_t> busy_ns{ };
+			std::atomic<std::uint64_t> idle_ns{ };
+			std::atomic<std::int64_t> queue_depth{ };
+			std::atomic<std::int64_t> queue_high_water{ };
+		};
+	} // namespace impl
+
+	/// Everything a task_scheduler can be built with.  The defaults match
+	/// task_scheduler( )
+	struct task_scheduler_config {
+		/// 0 uses available_cpu_count( ), which honours affinity and cgroup cpu
+		/// quotas
+		std::size_t num_threads = 0;
+		bool block_on_destruction = true;
+		scheduler_mode mode = scheduler_mode::work_stealing;
+		/// Tasks each worker queue holds before overflow
+		std::size_t queue_capacity =
+		  daw::parallel::mpmc_queue<daw::task_t>::default_capacity;
+		daw::parallel::queue_overflow overflow =
+		  daw::parallel::queue_overflow::grow;
+		worker_placement placement = worker_placement::any;
+		/// How long an idle worker keeps looking for work before it parks.
+		/// Empty spins for daw::parallel::default_spin_count tries
+		std::optional<std::chrono::nanoseconds> idle_spin{ };
+		/// The cpus the workers may run on, empty for all of them.  Ignored
+		/// with worker_placement::numa_pinned, which picks its own
+		std::vector<unsigned> cpu_affinity{ };
+		/// Workers are named prefix followed by their id.  Empty leaves the
+		/// OS thread names alone
+		std::string thread_name_prefix{ };
+		/// Stack size of the worker threads in bytes, 0 for the platform
+		/// default
+		std::size_t stack_size = 0;
+		/// When larger than num_threads the pool is elastic.  The num_threads
+		/// queue owning workers always run, and up to max_threads - num_threads
+		/// extra workers are added while the pool is saturated
+		std::size_t max_threads = 0;
+		/// How long every worker must have been busy, as seen by task
+		/// submissions, before an extra worker is added
+		std::chrono::nanoseconds grow_after = std::chrono::milliseconds( 5 );
+		/// How long an extra worker may find nothing to do before it exits
+		std::chrono::nanoseconds retire_after = std::chrono::seconds( 10 );
+		/// Workers per NUMA node the memory bound parallel algorithms, fill,
+		/// copy and transform of contiguous ranges, use.  A few cores saturate
+		/// the memory bandwidth of a node, more only contend for it.  0 uses
+		/// all of the workers
+		std::size_t bandwidth_workers_per_node = 4;
+		/// Called on the worker with the exceptions that escape a task.  Tasks
+		/// added with a latch, such as those of the parallel algorithms and
+		/// create_task_group, hand theirs to the waiting thread instead.  Empty
+		/// drops them
+		std::function<void( std::exception_ptr )> unhandled_exception_handler{ };
 	};
 
+	template<typename Urgency>
+	inline constexpr bool is_task_urgency_v =
+	  std::is_same_v<daw::remove_cvref_t<Urgency>, task_priority> or
+	  std::is_same_v<daw::remove_cvref_t<Urgency>, task_deadline>;
+
 	class task_scheduler {
-		using task_queue_t = daw::parallel::mpmc_bounded_queue<daw::task_t, 512>;
+		using task_queue_t = daw::parallel::mpmc_queue<daw::task_t>;
+		using local_task_queue_t =
+		  daw::parallel::work_stealing_deque<daw::task_t, 1024>;
+
+		struct deadline_task_t {
+			task_deadline deadline;
+			std::unique_ptr<daw::task_t> task;
+		};
 
 		class task_scheduler_impl
 		  : std::enable_shared_from_this<task_scheduler_impl> {
@@ -93,22 +379,76 @@ namespace daw {
 			std::deque<daw::parallel::ithread> m_threads{ };
 
 			std::atomic_size_t m_num_threads{ };    // from ctor
-			daw::fixed_array<task_queue_t> m_tasks; // from ctor
+			// Padded so pushes to one worker's queue do not contend with its
+			// neighbours
+			daw::fixed_array<daw::parallel::cache_padded<task_queue_t>>
+			  m_tasks; // from ctor
+			daw::fixed_array<local_task_queue_t> m_local_tasks; // from ctor
+			// The high and low priority classes are shared by all workers
+			daw::parallel::cache_padded<task_queue_t> m_high_tasks{ };
+			daw::parallel::cache_padded<task_queue_t> m_low_tasks{ };
+			// A min heap on deadline.  The count lets workers skip the lock when
+			// there are none
+			std::mutex m_deadline_mutex{ };
+			std::vector<deadline_task_t> m_deadline_tasks{ };
+			std::atomic_size_t m_deadline_count = std::atomic_size_t( 0ULL );
+			// Tasks waiting for a time to come, moved to the worker queues by
+			// timer_worker_id, or the idle worker parked for them, once due.  The
+			// count lets workers skip the lock
+			std::mutex m_timer_mutex{ };
+			daw::parallel::timer_wheel<std::unique_ptr<daw::task_t>> m_timers{ };
+			std::atomic_size_t m_timer_count = std::atomic_size_t( 0ULL );
+			// Set while one idle worker parks until the next timer is due
+			std::atomic_bool m_timer_keeper = std::atomic_bool( false );
+			// When that worker will wake, so that adding an earlier timer knows to
+			// wake it.  Under m_timer_mutex
+			std::chrono::steady_clock::time_point m_timer_wake_at{ };
+			// Empty unless scheduler_stats_enabled
+			daw::fixed_array<daw::parallel::cache_padded<impl::worker_counters_t>>
+			  m_worker_counters;
+			std::atomic<std::uint64_t> m_push_back_blocks{ };
+			std::atomic<std::uint64_t> m_temp_runner_spawns{ };
 			std::atomic_size_t m_task_count = std::atomic_size_t( 0ULL );
 			std::atomic_size_t m_current_id = std::atomic_size_t( 0ULL );
 			std::atomic_bool m_continue = false;
+			// Idle workers park here, each new task wakes one of them
+			daw::parallel::event_count m_idle{ };
 			bool m_block_on_destruction = false; // from ctor
+			scheduler_mode m_mode = scheduler_mode::work_stealing; // from ctor
+			worker_placement m_placement = worker_placement::any;  // from ctor
+			std::optional<std::chrono::nanoseconds> m_idle_spin{ }; // from ctor
+			std::vector<unsigned> m_cpu_affinity{ };                // from ctor
+			std::string m_thread_name_prefix{ };                    // from ctor
+			std::size_t m_stack_size = 0;                           // from ctor
+			// Elastic pools only.  Extra workers own no queue, they take work with
+			// try_get_task and exit when idle for m_retire_after
+			std::size_t m_max_threads = 0;                           // from ctor
+			std::chrono::nanoseconds m_grow_after{ };                // from ctor
+			std::chrono::nanoseconds m_retire_after{ };              // from ctor
+			std::size_t m_bandwidth_workers_per_node = 0;            // from ctor
+			std::function<void( std::exception_ptr )>
+			  m_unhandled_exception_handler{ }; // from ctor
+			std::list<daw::parallel::ithread> m_elastic_threads{ }; // m_threads_mutex
+			std::atomic_size_t m_elastic_count = std::atomic_size_t( 0ULL );
+			std::atomic_size_t m_elastic_idle = std::atomic_size_t( 0ULL );
+			// steady_clock ticks since the pool was first seen saturated, 0 when
+			// it is not
+			std::atomic<std::int64_t> m_saturated_since{ };
+			// numa_pinned only.  The cpu and node of each worker, and the workers
+			// on each node
+			std::vector<unsigned> m_worker_cpu{ };
+			std::vector<std::size_t> m_worker_node{ };
+			std::vector<std::vector<std::size_t>> m_node_workers{ };
 
 			friend task_scheduler;
 
-			template<typename, typename>
+			template<typename>
 			friend struct daw::impl::task_wrapper;
 
 			void stop( bool block_on_destruction );
 
 		public:
-			explicit task_scheduler_impl( std::size_t num_threads,
-			                              bool block_on_destruction );
+			explicit task_scheduler_impl( task_scheduler_config const &config );
 			task_scheduler_impl( task_scheduler_impl && ) = delete;
 			task_scheduler_impl( task_scheduler_impl const & ) = delete;
 			task_scheduler_impl &operator=( task_scheduler_impl && ) = delete;
@@ -118,9 +458,7 @@ namespace daw {
 		std::shared_ptr<task_scheduler_impl> m_impl = make_ts( );
 
 		[[nodiscard]] static std::shared_ptr<task_scheduler_impl>
-		make_ts( std::size_t const num_threads =
-		           ::daw::parallel::ithread::hardware_concurrency( ),
-		         bool block_on_destruct = true );
+		make_ts( task_scheduler_config const &config = task_scheduler_config{ } );
 
 		[[nodiscard]] inline auto get_handle( ) {
 			class handle_t {
@@ -159,54 +497,163 @@ namespace daw {
 		                          std::nullptr_t> = nullptr>
 		[[nodiscard]] std::unique_ptr<daw::task_t>
 		wait_for_task_from_pool( size_t id, Predicate &&pred ) {
-			if( not pred( ) ) {
-				return nullptr;
-			}
-			std::size_t const sz = std::size( m_impl->m_tasks );
-			std::size_t qid = id % sz;
-			bool const is_tmp_worker = id != qid;
-
-			for( auto m = ( qid + 1 ) % sz; m != qid and pred( );
-			     m = ( m + 1 ) % sz ) {
-
-				if( auto tsk = m_impl->m_tasks[m].try_pop_front( ); tsk ) {
-					if( not pred( ) ) {
-						return nullptr;
+			// Spin briefly and then park until send_task or stop wakes us.  Anything
+			// that can make pred false must notify m_idle.  A task that has been
+			// taken is always returned, dropping it would leave its waiters hanging
+			auto const try_fn = [&]( ) {
+				return try_get_task( id );
+			};
+			auto const park = [&]( auto &&can_continue ) {
+				if( m_impl->m_idle_spin ) {
+					return daw::parallel::spin_then_park(
+					  m_impl->m_idle, try_fn, can_continue, *m_impl->m_idle_spin );
+				}
+				return daw::parallel::spin_then_park( m_impl->m_idle, try_fn,
+				                                      can_continue );
+			};
+			// With no timers everyone parks with no deadline.  Otherwise one idle
+			// worker, the keeper, parks until the next timer is due and the rest
+			// park as usual.  A new task or an earlier timer wakes the keeper
+			// sooner, and a keeper that leaves with a task wakes another to take
+			// its place
+			auto &impl = *m_impl;
+			auto const has_timers = [&]( ) {
+				return impl.m_timer_count.load( std::memory_order_acquire ) != 0;
+			};
+			while( pred( ) ) {
+				if( not has_timers( ) ) {
+					if( auto tsk =
+					      park( [&]( ) { return not has_timers( ) and pred( ); } );
+					    tsk ) {
+						return tsk;
 					}
+					continue;
+				}
+				if( auto tsk = try_fn( ); tsk ) {
 					return tsk;
 				}
-			}
-			if( is_tmp_worker ) {
-				while( pred( ) ) {
-					if( auto tsk = m_impl->m_tasks[qid].try_pop_front( ); tsk ) {
-						if( not pred( ) ) {
-							return nullptr;
-						}
+				if( impl.m_timer_keeper.exchange( true, std::memory_order_acq_rel ) ) {
+					if( auto tsk = park( [&]( ) {
+						    return impl.m_timer_keeper.load( std::memory_order_acquire ) and
+						           has_timers( ) and pred( );
+					    } );
+					    tsk ) {
 						return tsk;
 					}
-					qid = ( qid + 1 ) % sz;
+					continue;
+				}
+				auto const key = impl.m_idle.prepare_wait( );
+				auto tsk = std::unique_ptr<daw::task_t>( );
+				bool waited = false;
+				if( pred( ) ) {
+					tsk = try_fn( );
+					waited = not tsk;
+				}
+				if( waited ) {
+					auto wake_at = std::chrono::steady_clock::now( );
+					{
+						auto const lck = std::lock_guard( impl.m_timer_mutex );
+						if( auto const next = impl.m_timers.next_due( ); next ) {
+							wake_at = *next;
+						}
+						impl.m_timer_wake_at = wake_at;
+					}
+					(void)impl.m_idle.wait_until( key, wake_at );
+				} else {
+					impl.m_idle.cancel_wait( );
+				}
+				impl.m_timer_keeper.store( false, std::memory_order_release );
+				if( waited ) {
+					run_due_timers( );
+					tsk = try_fn( );
+				}
+				if( tsk ) {
+					if( has_timers( ) ) {
+						impl.m_idle.notify_one( );
+					}
+					return tsk;
 				}
-				return nullptr;
-			} else {
-				return pop_front( m_impl->m_tasks[qid], DAW_FWD( pred ) );
 			}
+			return nullptr;
 		}
 
 		[[nodiscard]] std::unique_ptr<daw::task_t>
 		wait_for_task_from_pool( size_t id, daw::parallel::stop_token tok );
 
+		/// Try, without waiting, to find a task for worker id.  Deadlines come
+		/// first, then the high, normal and low priority classes
+		[[nodiscard]] std::unique_ptr<daw::task_t> try_get_task( size_t id );
+
+		/// A normal priority task for worker id.  The workers own deque is tried
+		/// first, then its queue, and then the other workers are stolen from
+		/// starting at a random victim
+		[[nodiscard]] std::unique_ptr<daw::task_t> try_get_normal_task( size_t id );
+
+		[[nodiscard]] std::unique_ptr<daw::task_t> try_get_deadline_task( );
+
+		/// Move the timers that are due to the worker queues.  timer_worker_id
+		/// calls it as it looks for tasks, and the timer keeper as it wakes
+		void run_due_timers( );
+
+		[[nodiscard]] bool send_urgent_task( std::unique_ptr<daw::task_t> &&tsk,
+		                                     task_priority priority );
+
+		/// Track how many tasks wait on worker id, for the high water mark
+		inline void note_queued( size_t id ) {
+			if constexpr( scheduler_stats_enabled ) {
+				auto &counters = *m_impl->m_worker_counters[id];
+				auto const depth =
+				  counters.queue_depth.fetch_add( 1, std::memory_order_relaxed ) + 1;
+				auto high = counters.queue_high_water.load( std::memory_order_relaxed );
+				while( depth > high and
+				       not counters.queue_high_water.compare_exchange_weak(
+				         high, depth, std::memory_order_relaxed ) ) {}
+			} else {
+				Unused( id );
+			}
+		}
+
+		inline void note_dequeued( size_t id ) {
+			if constexpr( scheduler_stats_enabled ) {
+				m_impl->m_worker_counters[id]->queue_depth.fetch_sub(
+				  1, std::memory_order_relaxed );
+			} else {
+				Unused( id );
+			}
+		}
+
+		[[nodiscard]] bool send_urgent_task( std::unique_ptr<daw::task_t> &&tsk,
+		                                     task_deadline deadline );
+
+		/// Hold tsk in the timer wheel until when, then send it to a worker
+		/// queue as a normal priority task
+		[[nodiscard]] bool
+		send_timer_task( std::unique_ptr<daw::task_t> &&tsk,
+		                 std::chrono::steady_clock::time_point when );
+
+		/// If the current thread is one of this schedulers workers, it's id
+		[[nodiscard]] std::optional<size_t> current_worker_id( ) const;
+
 		[[nodiscard]] bool send_task( std::unique_ptr<daw::task_t> &&tsk,
 		                              size_t id );
 
+		/// Send a task that is not ready yet to the back of a shared queue
+		[[nodiscard]] bool requeue_task( std::unique_ptr<daw::task_t> &&tsk );
+
+		/// Send a task to worker id's shared queue, bypassing the local deque
+		[[nodiscard]] bool send_to_queue( std::unique_ptr<daw::task_t> &&tsk,
+		                                  size_t id );
+
 		template<typename Task, std::enable_if_t<std::is_invocable_v<Task>,
 		                                         std::nullptr_t> = nullptr>
 		[[nodiscard]] inline bool add_task( Task &&task, size_t id ) {
-			return send_task( std::make_unique<daw::task_t>( impl::task_wrapper(
-			                    id, get_handle( ), DAW_FWD( task ) ) ),
-			                  id );
+			return send_task(
+			  std::make_unique<daw::task_t>(
+			    impl::task_wrapper( m_impl.get( ), DAW_FWD( task ) ) ),
+			  id );
 		}
 
-		template<typename, typename>
+		template<typename>
 		friend struct daw::impl::task_wrapper;
 
 		template<typename Task>
@@ -215,7 +662,7 @@ namespace daw {
 
 			return send_task(
 			  std::make_unique<daw::task_t>(
-			    impl::task_wrapper( id, get_handle( ), DAW_FWD( task ) ),
+			    impl::task_wrapper( m_impl.get( ), DAW_FWD( task ) ),
 			    ::daw::move( sem ) ),
 			  id );
 		}
@@ -223,8 +670,14 @@ namespace daw {
 		void task_runner( size_t id );
 		void task_runner( size_t id, daw::shared_latch &sem );
 		void task_runner( size_t id, daw::parallel::stop_token token );
+		void elastic_task_runner( size_t id, daw::parallel::stop_token token );
 		void run_task( std::unique_ptr<daw::task_t> &&tsk );
 
+		/// Called after each submission.  Adds an extra worker to an elastic
+		/// pool that has had no idle worker for m_grow_after
+		void maybe_grow( );
+		void add_elastic_worker( );
+
 		[[nodiscard]] size_t get_task_id( );
 
 	public:
@@ -236,8 +689,19 @@ namespace daw {
 		}
 
 		task_scheduler( );
-		explicit task_scheduler( std::size_t num_threads,
-		                         bool block_on_destruction = true );
+		/// @param queue_capacity tasks each worker queue holds before overflow
+		/// @param overflow grow lets queues absorb bursts without blocking the
+		/// submitter, block makes submitters wait for room
+		/// @param placement pin workers to cpus grouped by NUMA node, or not
+		explicit task_scheduler(
+		  std::size_t num_threads, bool block_on_destruction = true,
+		  scheduler_mode mode = scheduler_mode::work_stealing,
+		  std::size_t queue_capacity = task_queue_t::default_capacity,
+		  daw::parallel::queue_overflow overflow =
+		    daw::parallel::queue_overflow::grow,
+		  worker_placement placement = worker_placement::any );
+
+		explicit task_scheduler( task_scheduler_config const &config );
 
 		template<typename Task, std::enable_if_t<std::is_invocable_v<Task>,
 		                                         std::nullptr_t> = nullptr>
@@ -249,6 +713,97 @@ namespace daw {
 			return add_task( DAW_FWD( task ), get_task_id( ) );
 		}
 
+		/// Add a task with a priority class or a deadline.  Normal priority is
+		/// add_task( task )
+		template<typename Task, typename Urgency,
+		         std::enable_if_t<is_task_urgency_v<Urgency>, std::nullptr_t> =
+		           nullptr>
+		[[nodiscard]] bool add_task( Task &&task, Urgency urgency ) {
+			static_assert(
+			  std::is_invocable_v<Task>,
+			  "Task must be callable without arguments (e.g. task( );)" );
+
+			if constexpr( std::is_same_v<Urgency, task_priority> ) {
+				if( urgency == task_priority::normal ) {
+					return add_task( DAW_FWD( task ) );
+				}
+			}
+			return send_urgent_task(
+			  std::make_unique<daw::task_t>(
+			    impl::task_wrapper( m_impl.get( ), DAW_FWD( task ) ) ),
+			  urgency );
+		}
+
+		/// Run task at or soon after when, as a normal priority task.  Until then
+		/// it waits in a timer wheel kept by one of the workers, not on a thread
+		/// of its own.  Timers come due on ticks of a millisecond
+		template<typename Task>
+		[[nodiscard]] bool add_task_at( std::chrono::steady_clock::time_point when,
+		                                Task &&task ) {
+			static_assert(
+			  std::is_invocable_v<Task>,
+			  "Task must be callable without arguments (e.g. task( );)" );
+
+			return send_timer_task(
+			  std::make_unique<daw::task_t>(
+			    impl::task_wrapper( m_impl.get( ), DAW_FWD( task ) ) ),
+			  when );
+		}
+
+		/// Run task once delay has passed, see add_task_at
+		template<typename Task, typename Rep, typename Period>
+		[[nodiscard]] bool add_task_after( std::chrono::duration<Rep, Period> delay,
+		                                   Task &&task ) {
+			return add_task_at(
+			  std::chrono::steady_clock::now( ) +
+			    std::chrono::ceil<std::chrono::steady_clock::duration>( delay ),
+			  DAW_FWD( task ) );
+		}
+
+		/// Run task every period, the first time one period from now, until tok
+		/// is cancelled or the scheduler stops.  A run that throws is not
+		/// repeated
+		template<typename Task, typename Rep, typename Period>
+		[[nodiscard]] bool
+		add_periodic_task( std::chrono::duration<Rep, Period> period, Task &&task,
+		                   cancellation_token tok = cancellation_token{ } ) {
+			static_assert(
+			  std::is_invocable_v<Task>,
+			  "Task must be callable without arguments (e.g. task( );)" );
+			auto const interval =
+			  std::chrono::ceil<std::chrono::steady_clock::duration>( period );
+			daw::exception::precondition_check(
+			  interval > std::chrono::steady_clock::duration::zero( ),
+			  "Expected a positive period" );
+
+			auto const due = std::chrono::steady_clock::now( ) + interval;
+			return add_task_at(
+			  due, impl::periodic_task<decltype( get_handle( ) ),
+			                           daw::remove_cvref_t<Task>>{
+			         get_handle( ),
+			         std::make_shared<daw::remove_cvref_t<Task>>( DAW_FWD( task ) ),
+			         interval, due, daw::move( tok ) } );
+		}
+
+		/// Add every callable in tasks, a random access container, and notify
+		/// sem as each completes.  sem must already count them.  The callables
+		/// share one allocation, moved from tasks or copied when it is an
+		/// lvalue, and are spread over the worker queues in one pass, waking the
+		/// workers once.  Tasks that cannot be added notify sem and leave an
+		/// unable_to_add_task_exception in it
+		template<typename Tasks>
+		[[nodiscard]] bool add_tasks( Tasks &&tasks, daw::shared_latch sem ) {
+			return add_task_batch( DAW_FWD( tasks ), daw::move( sem ) );
+		}
+
+		/// As add_tasks above, with a latch the caller owns and waits on before
+		/// it goes away.  The tasks hold it by pointer, so nothing is reference
+		/// counted as they start and finish
+		template<typename Tasks>
+		[[nodiscard]] bool add_tasks( Tasks &&tasks, daw::latch &sem ) {
+			return add_task_batch( DAW_FWD( tasks ), &sem );
+		}
+
 		template<typename Task>
 		[[nodiscard]] bool add_task( Task &&task, daw::shared_latch sem ) {
 			static_assert(
@@ -258,6 +813,28 @@ namespace daw {
 			return add_task( DAW_FWD( task ), ::daw::move( sem ), get_task_id( ) );
 		}
 
+		/// Add the task for partition part of part_count.  With numa_pinned
+		/// placement partitions map to workers in order, so the same partition
+		/// of a range goes to the same node each time.  Otherwise this is
+		/// add_task( task )
+		template<typename Task>
+		[[nodiscard]] bool add_partition_task( Task &&task, size_t part,
+		                                       size_t part_count ) {
+			static_assert(
+			  std::is_invocable_v<Task>,
+			  "Task must be callable without arguments (e.g. task( );)" );
+
+			if( m_impl->m_placement != worker_placement::numa_pinned ) {
+				return add_task( DAW_FWD( task ) );
+			}
+			assert( part_count > 0 );
+			auto const id = ( part * size( ) ) / part_count;
+			return send_to_queue(
+			  std::make_unique<daw::task_t>(
+			    impl::task_wrapper( m_impl.get( ), DAW_FWD( task ) ) ),
+			  id );
+		}
+
 		[[nodiscard]] bool run_next_task( size_t id );
 
 		void start( );
@@ -269,7 +846,76 @@ namespace daw {
 			return std::size( m_impl->m_tasks );
 		}
 
+		/// task_scheduler_config::bandwidth_workers_per_node
+		[[nodiscard]] size_t bandwidth_workers_per_node( ) const {
+			return m_impl->m_bandwidth_workers_per_node;
+		}
+
+		/// size( ) plus the extra workers an elastic pool is running now
+		[[nodiscard]] size_t worker_count( ) const {
+			return size( ) +
+			       m_impl->m_elastic_count.load( std::memory_order_relaxed );
+		}
+
+		static constexpr size_t priority_aging_interval = 32U;
+
+		/// The worker that moves due timers to the queues
+		static constexpr size_t timer_worker_id = 0U;
+
+		/// A snapshot of the counters, taken without stopping the workers.
+		/// All zero unless built with DAW_FS_SCHEDULER_STATS
+		[[nodiscard]] scheduler_stats stats( ) const;
+
+		/// Would another task likely be picked up soon.  True when workers are
+		/// parked, when called from outside the pool, or when the calling
+		/// worker has nothing queued for others to steal
+		[[nodiscard]] bool wants_more_tasks( ) const;
+
 	private:
+		template<typename Tasks, typename Sem>
+		[[nodiscard]] bool add_task_batch( Tasks &&tasks, Sem sem ) {
+			using batch_t = impl::task_batch<daw::remove_cvref_t<Tasks>, Sem>;
+			static_assert(
+			  std::is_invocable_v<decltype( tasks[0] )>,
+			  "Tasks must hold callables without arguments (e.g. task( );)" );
+
+			auto const count = std::size( tasks );
+			if( count == 0 ) {
+				return true;
+			}
+			if( not m_impl->m_continue ) {
+				impl::latch_of( sem ).set_exception(
+				  std::make_exception_ptr( unable_to_add_task_exception{ } ) );
+				for( size_t n = 0; n < count; ++n ) {
+					impl::latch_of( sem ).notify( );
+				}
+				return false;
+			}
+			auto *batch = new batch_t( DAW_FWD( tasks ), daw::move( sem ) );
+			auto const queue_count = size( );
+			auto const first_id = get_task_id( );
+			bool const is_pinned =
+			  m_impl->m_placement == worker_placement::numa_pinned;
+			bool result = true;
+			for( size_t n = 0; n < count; ++n ) {
+				auto tsk = std::make_unique<daw::task_t>(
+				  impl::batch_task_t<batch_t>( batch, n ) );
+				// Partitions map to workers in order when pinned, as in
+				// add_partition_task
+				auto const id = is_pinned ? ( n * queue_count ) / count
+				                          : ( first_id + n ) % queue_count;
+				if( m_impl->m_tasks[id]->try_push_back( daw::move( tsk ) ) ==
+				    daw::parallel::push_back_result::success ) {
+					note_queued( id );
+				} else {
+					result = send_task( daw::move( tsk ), id ) and result;
+				}
+			}
+			m_impl->m_idle.notify_all( );
+			maybe_grow( );
+			return result;
+		}
+
 		struct temp_task_runner {
 			std::unique_ptr<daw::parallel::ithread> th;
 			daw::shared_latch sem;
@@ -304,11 +950,33 @@ namespace daw {
 		[[nodiscard]] bool add_task( daw::shared_latch const &sem );
 
 	private:
-		[[nodiscard]] bool has_empty_queue( ) const;
-
 		void add_queue( size_t n );
 
 	public:
+		/// Run queued tasks on the calling worker until is_done( ) is true.
+		/// Returns false, without waiting, when not called from one of our
+		/// workers or when the scheduler is stopping
+		template<typename Predicate>
+		[[nodiscard]] bool help_until( Predicate &&is_done ) {
+			auto const worker_id = current_worker_id( );
+			if( not worker_id ) {
+				return false;
+			}
+			while( not is_done( ) ) {
+				if( not m_impl->m_continue.load( std::memory_order_acquire ) ) {
+					return false;
+				}
+				// Nothing notifies us when is_done changes, so this cannot park
+				if( not run_next_task( *worker_id ) ) {
+					std::this_thread::yield( );
+				}
+			}
+			return true;
+		}
+
+		/// Run func, which may block.  When called from a worker, a temporary
+		/// runner takes its place until func returns.  Prefer wait_for, it
+		/// needs no extra thread
 		template<typename Function>
 		[[nodiscard]] auto wait_for_scope( Function &&func )
 		  -> decltype( DAW_FWD( func )( ) ) {
@@ -316,10 +984,16 @@ namespace daw {
 			               "Function passed to wait_for_scope must be callable "
 			               "without an arugment. e.g. func( )" );
 
-			if( not has_empty_queue( ) ) {
-				add_queue( m_impl->m_num_threads++ );
+			if( not current_worker_id( ) ) {
+				// The caller does not hold a worker, nothing to stand in for
+				return DAW_FWD( func )( );
 			}
-			auto const tmp_runner = start_temp_task_runner( );
+			auto tmp_runner = start_temp_task_runner( );
+			// The temp runner may be parked, wake it so it sees the stop
+			auto const stop_tmp_runner = daw::on_scope_exit( [&]( ) {
+				tmp_runner.stop( );
+				m_impl->m_idle.notify_all( );
+			} );
 			return DAW_FWD( func )( );
 		}
 
@@ -329,14 +1003,29 @@ namespace daw {
 			  is_waitable_v<Waitable>,
 			  "Waitable must have a wait( ) member. e.g. waitable.wait( )" );
 
-			struct wait_for_scope_helper {
-				mutable ::std::remove_reference_t<Waitable> w;
-
-				inline void operator( )( ) const {
-					w.wait( );
+			auto const span = trace_span( "wait" );
+			if constexpr( has_try_wait_v<Waitable> ) {
+				// A waiting worker runs other tasks instead of blocking, so nested
+				// waits in recursive algorithms do not need more threads
+				if( not help_until( [&]( ) { return waitable.try_wait( ); } ) ) {
+					waitable.wait( );
 				}
-			};
-			wait_for_scope( wait_for_scope_helper{ DAW_FWD( waitable ) } );
+				if constexpr( has_rethrow_if_exception_v<Waitable> ) {
+					waitable.rethrow_if_exception( );
+				}
+			} else {
+				struct wait_for_scope_helper {
+					mutable ::std::remove_reference_t<Waitable> w;
+
+					inline void operator( )( ) const {
+						w.wait( );
+						if constexpr( has_rethrow_if_exception_v<Waitable> ) {
+							w.rethrow_if_exception( );
+						}
+					}
+				};
+				wait_for_scope( wait_for_scope_helper{ DAW_FWD( waitable ) } );
+			}
 		}
 
 		[[nodiscard]] explicit operator bool( ) const {
@@ -344,8 +1033,53 @@ namespace daw {
 		}
 	}; // namespace daw
 
+	namespace impl {
+		template<typename Task>
+		void task_wrapper<Task>::operator( )( ) const {
+			{
+				auto const span = trace_span( "task" );
+				(void)task( );
+			}
+			// Anyone else running it, such as a thread helping in wait_for, goes
+			// back to its own loop
+			if( auto const &ctx = current_worker; ctx.owner == owner ) {
+				auto &self = *ctx.scheduler;
+				while( self.m_impl->m_continue and self.run_next_task( ctx.id ) ) {}
+			}
+		}
+	} // namespace impl
+
+	/// The shared scheduler used when none is given.  Built and started from
+	/// a default task_scheduler_config on first use unless one was installed
+	/// with set_global_task_scheduler
 	task_scheduler get_task_scheduler( );
 
+	/// Make ts what get_task_scheduler( ) returns.  This only works before
+	/// the first call to get_task_scheduler( ), afterwards it returns false and
+	/// changes nothing
+	bool set_global_task_scheduler( task_scheduler ts );
+
+	/// As schedule_task below, with a priority class or deadline for the task
+	template<typename Task, typename Urgency,
+	         std::enable_if_t<is_task_urgency_v<Urgency>, std::nullptr_t> =
+	           nullptr>
+	[[nodiscard]] bool
+	schedule_task( daw::shared_latch sem, Task &&task, Urgency urgency,
+	               task_scheduler ts = get_task_scheduler( ) ) {
+		static_assert( std::is_invocable_v<Task>,
+		               "Task task passed to schedule_task must be callable without "
+		               "an arugment. e.g. task( )" );
+
+		return ts.add_task(
+		  [task = daw::mutable_capture( DAW_FWD( task ) ),
+		   sem = daw::mutable_capture( ::daw::move( sem ) )]( ) {
+			  auto const at_exit =
+			    daw::on_scope_exit( [&sem]( ) { sem->notify( ); } );
+			  impl::run_group_task( *sem, ::daw::move( *task ) );
+		  },
+		  urgency );
+	}
+
 	/// Add a single task to the supplied task scheduler and notify supplied
 	/// semaphore when complete
 	///
@@ -356,17 +1090,67 @@ namespace daw {
 	[[nodiscard]] bool
 	schedule_task( daw::shared_latch sem, Task &&task,
 	               task_scheduler ts = get_task_scheduler( ) ) {
-		static_assert( std::is_invocable_v<Task>,
-		               "Task task passed to schedule_task must be callable without "
-		               "an arugment. e.g. task( )" );
+		return schedule_task( daw::move( sem ), DAW_FWD( task ),
+		                      task_priority::normal, daw::move( ts ) );
+	}
 
-		return ts.add_task( [task = daw::mutable_capture( DAW_FWD( task ) ),
-		                     sem = daw::mutable_capture( ::daw::move( sem ) )]( ) {
-			auto const at_exit = daw::on_scope_exit( [&sem]( ) { sem->notify( ); } );
-			::daw::move ( *task )( );
-		} );
+	/// Like schedule_task, but for partition part of part_count.  See
+	/// task_scheduler::add_partition_task
+	template<typename Task>
+	[[nodiscard]] bool schedule_partition_task( daw::shared_latch sem,
+	                                            Task &&task, size_t part,
+	                                            size_t part_count,
+	                                            task_scheduler ts ) {
+		static_assert( std::is_invocable_v<Task>,
+		               "Task task passed to schedule_partition_task must be "
+		               "callable without an arugment. e.g. task( )" );
+
+		return ts.add_partition_task(
+		  [task = daw::mutable_capture( DAW_FWD( task ) ),
+		   sem = daw::mutable_capture( ::daw::move( sem ) )]( ) {
+			  auto const at_exit =
+			    daw::on_scope_exit( [&sem]( ) { sem->notify( ); } );
+			  impl::run_group_task( *sem, ::daw::move( *task ) );
+		  },
+		  part, part_count );
 	}
 
+	namespace impl {
+		/// The task of schedule_task, notifying a latch by pointer
+		template<typename Task>
+		[[nodiscard]] auto latched_task( daw::latch &sem, Task &&task ) {
+			return [task = daw::mutable_capture( DAW_FWD( task ) ), sem = &sem]( ) {
+				auto const at_exit = daw::on_scope_exit( [sem]( ) { sem->notify( ); } );
+				run_group_task( *sem, ::daw::move( *task ) );
+			};
+		}
+
+		/// As schedule_task, for a latch the caller owns and waits on before it
+		/// goes away.  sem must already count the task, callers adding many
+		/// count them all up front.  Nothing is reference counted per task
+		template<typename Task>
+		[[nodiscard]] bool schedule_task_on( daw::latch &sem, Task &&task,
+		                                     task_scheduler &ts ) {
+			static_assert( std::is_invocable_v<Task>,
+			               "Task task passed to schedule_task_on must be callable "
+			               "without an arugment. e.g. task( )" );
+			return ts.add_task( latched_task( sem, DAW_FWD( task ) ) );
+		}
+
+		/// As schedule_partition_task, for a latch counted as in schedule_task_on
+		template<typename Task>
+		[[nodiscard]] bool schedule_partition_task_on( daw::latch &sem,
+		                                               Task &&task, size_t part,
+		                                               size_t part_count,
+		                                               task_scheduler &ts ) {
+			static_assert( std::is_invocable_v<Task>,
+			               "Task task passed to schedule_partition_task_on must be "
+			               "callable without an arugment. e.g. task( )" );
+			return ts.add_partition_task( latched_task( sem, DAW_FWD( task ) ),
+			                              part, part_count );
+		}
+	} // namespace impl
+
 	template<typename Task>
 	[[nodiscard]] daw::shared_latch
 	create_waitable_task( Task &&task,
@@ -377,10 +1161,10 @@ namespace daw {
 		               "e.g. task( )" );
 		auto sem = daw::shared_latch( );
 		if( not schedule_task( sem, DAW_FWD( task ), daw::move( ts ) ) ) {
-			// TODO, I don't like this but I don't want to change the return value to
-			// express that we failed to add the task... yet
+			// Waiting on sem rethrows this
+			sem.set_exception(
+			  std::make_exception_ptr( unable_to_add_task_exception{ } ) );
 			sem.notify( );
-			std::abort( );
 		}
 		return sem;
 	}
@@ -389,19 +1173,21 @@ namespace daw {
 	///
 	/// @param tasks callable items of the form void( )
 	/// @returns a semaphore that will request_stop waiting when all tasks
-	/// complete
+	/// complete.  Once a task throws, the tasks that have not started are
+	/// skipped and task_scheduler::wait_for on the semaphore rethrows the first
+	/// exception
 	template<typename... Tasks>
-	[[nodiscard]] daw::shared_latch create_task_group( Tasks &&...tasks ) {
+	[[nodiscard]] daw::shared_latch create_task_group( task_scheduler ts,
+	                                                   Tasks &&...tasks ) {
 		static_assert( are_tasks_v<Tasks...>,
 		               "Tasks passed to create_task_group must be callable without "
 		               "an arugment. e.g. task( )" );
-		auto ts = get_task_scheduler( );
 		auto sem = daw::shared_latch( sizeof...( tasks ) );
 
 		auto const st = [&]( auto &&task ) {
 			if( not schedule_task( sem, DAW_FWD( task ), ts ) ) {
-				// TODO, I don't like this but I don't want to change the return value
-				// to express that we failed to add the task... yet
+				sem.set_exception(
+				  std::make_exception_ptr( unable_to_add_task_exception{ } ) );
 				sem.notify( );
 			}
 			return 0;
@@ -411,12 +1197,18 @@ namespace daw {
 		return sem;
 	}
 
+	template<typename... Tasks>
+	[[nodiscard]] daw::shared_latch create_task_group( Tasks &&...tasks ) {
+		return create_task_group( get_task_scheduler( ), DAW_FWD( tasks )... );
+	}
+
 	/// Run concurrent tasks and return when completed
 	///
 	/// @param tasks callable items of the form void( )
+	/// @throws the first exception thrown by one of the tasks
 	template<typename... Tasks>
 	void invoke_tasks( task_scheduler ts, Tasks &&...tasks ) {
-		ts.wait_for( create_task_group( DAW_FWD( tasks )... ) );
+		ts.wait_for( create_task_group( ts, DAW_FWD( tasks )... ) );
 	}
 
 	template<typename... Tasks>
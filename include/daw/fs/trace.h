@@ -0,0 +1,140 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include <daw/daw_move.h>
+#include <daw/daw_utility.h>
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+
+namespace daw {
+#if defined( DAW_FS_SCHEDULER_TRACING )
+	inline constexpr bool scheduler_tracing_enabled = true;
+#else
+	inline constexpr bool scheduler_tracing_enabled = false;
+#endif
+
+	namespace impl {
+		enum class trace_phase : std::uint8_t { span, instant };
+
+		/// One recorded span or instant.  label is not copied, it must live
+		/// until the trace is written; string literals are intended
+		struct trace_event_t {
+			char const *label = nullptr;
+			std::int64_t begin_ns = 0;
+			std::int64_t end_ns = 0;
+			std::int64_t arg = 0;
+			bool has_arg = false;
+			trace_phase phase = trace_phase::span;
+		};
+
+		/// Nanoseconds since tracing started
+		[[nodiscard]] std::int64_t trace_now( );
+
+		/// Append to the calling thread's ring buffer.  Only that thread writes
+		/// to it, so this takes no lock.  When full the oldest events are
+		/// overwritten
+		void trace_record( trace_event_t const &event );
+	} // namespace impl
+
+	/// Name the calling thread in the exported trace
+	void set_trace_thread_name( std::string name );
+
+	/// Write the buffered events as Chrome trace JSON, which chrome://tracing
+	/// and ui.perfetto.dev load.  Call when no traced work is running, events
+	/// recorded during the write may be torn
+	void write_chrome_trace( std::ostream &os );
+
+	/// Drop every buffered event
+	void clear_trace( );
+
+	/// Records the time from construction to destruction as a span on the
+	/// calling thread.  Does nothing unless scheduler_tracing_enabled
+	class trace_span {
+		impl::trace_event_t m_event{ };
+
+	public:
+		explicit trace_span( char const *label ) {
+			if constexpr( scheduler_tracing_enabled ) {
+				m_event.label = label;
+				m_event.begin_ns = impl::trace_now( );
+			} else {
+				Unused( label );
+			}
+		}
+
+		/// arg is shown with the span, e.g. an index or a merge level
+		trace_span( char const *label, std::int64_t arg ) {
+			if constexpr( scheduler_tracing_enabled ) {
+				m_event.label = label;
+				m_event.arg = arg;
+				m_event.has_arg = true;
+				m_event.begin_ns = impl::trace_now( );
+			} else {
+				Unused( label, arg );
+			}
+		}
+
+		trace_span( trace_span const & ) = delete;
+		trace_span &operator=( trace_span const & ) = delete;
+
+		~trace_span( ) {
+			if constexpr( scheduler_tracing_enabled ) {
+				m_event.end_ns = impl::trace_now( );
+				impl::trace_record( m_event );
+			}
+		}
+	};
+
+	/// Records a point in time on the calling thread
+	inline void trace_instant( char const *label ) {
+		if constexpr( scheduler_tracing_enabled ) {
+			auto event = impl::trace_event_t{ };
+			event.label = label;
+			event.begin_ns = impl::trace_now( );
+			event.end_ns = event.begin_ns;
+			event.phase = impl::trace_phase::instant;
+			impl::trace_record( event );
+		} else {
+			Unused( label );
+		}
+	}
+
+	/// Wrap task so that its runs show up in the trace under label
+	template<typename Task>
+	[[nodiscard]] auto traced( char const *label, Task &&task ) {
+		if constexpr( scheduler_tracing_enabled ) {
+			return [label, task = daw::mutable_capture( DAW_FWD( task ) )]( ) {
+				auto const span = trace_span( label );
+				(void)( *task )( );
+			};
+		} else {
+			Unused( label );
+			return std::decay_t<Task>( DAW_FWD( task ) );
+		}
+	}
+} // namespace daw
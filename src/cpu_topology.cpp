@@ -0,0 +1,292 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "daw/fs/impl/cpu_topology.h"
+
+#include <daw/daw_move.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+#if defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#elif defined( __APPLE__ )
+#include <pthread.h>
+#endif
+
+namespace daw::parallel {
+	namespace {
+		// Parse a sysfs cpu list such as "0-3,8-11"
+		std::vector<unsigned> parse_cpu_list( std::string const &list ) {
+			auto result = std::vector<unsigned>( );
+			std::size_t pos = 0;
+			while( pos < list.size( ) ) {
+				auto const end = std::min( list.find( ',', pos ), list.size( ) );
+				auto const item = list.substr( pos, end - pos );
+				pos = end + 1;
+				if( item.empty( ) or item[0] < '0' or item[0] > '9' ) {
+					continue;
+				}
+				auto const dash = item.find( '-' );
+				auto const first =
+				  static_cast<unsigned>( std::stoul( item.substr( 0, dash ) ) );
+				auto const last =
+				  dash == std::string::npos
+				    ? first
+				    : static_cast<unsigned>( std::stoul( item.substr( dash + 1 ) ) );
+				for( auto cpu = first; cpu <= last; ++cpu ) {
+					result.push_back( cpu );
+				}
+			}
+			return result;
+		}
+
+		std::vector<std::vector<unsigned>> detect_node_cpus( ) {
+			auto result = std::vector<std::vector<unsigned>>( );
+#if defined( __linux__ )
+			cpu_set_t allowed;
+			CPU_ZERO( &allowed );
+			bool const has_mask =
+			  sched_getaffinity( 0, sizeof( allowed ), &allowed ) == 0;
+			try {
+				for( unsigned node = 0;; ++node ) {
+					auto file = std::ifstream( "/sys/devices/system/node/node" +
+					                           std::to_string( node ) + "/cpulist" );
+					if( not file ) {
+						break;
+					}
+					auto line = std::string( );
+					std::getline( file, line );
+					auto cpus = parse_cpu_list( line );
+					if( has_mask ) {
+						cpus.erase( std::remove_if( cpus.begin( ), cpus.end( ),
+						                            [&]( unsigned cpu ) {
+							                            return cpu >= CPU_SETSIZE or
+							                                   not CPU_ISSET( cpu, &allowed );
+						                            } ),
+						            cpus.end( ) );
+					}
+					if( not cpus.empty( ) ) {
+						result.push_back( daw::move( cpus ) );
+					}
+				}
+			} catch( ... ) { result.clear( ); }
+#endif
+			if( result.empty( ) ) {
+				auto cpus = std::vector<unsigned>(
+				  std::max( std::thread::hardware_concurrency( ), 1U ) );
+				std::iota( cpus.begin( ), cpus.end( ), 0U );
+				result.push_back( daw::move( cpus ) );
+			}
+			return result;
+		}
+
+#if defined( __linux__ )
+		// The cpus a cgroup cpu quota allows, e.g. 1.5 for a container limited to
+		// 150ms of cpu time per 100ms.  The container's own cgroup is the root
+		// of its view, so only the top level files are read
+		std::optional<double> cgroup_cpu_quota( ) {
+			try {
+				// cgroup v2, "max 100000" or "150000 100000"
+				if( auto file = std::ifstream( "/sys/fs/cgroup/cpu.max" ); file ) {
+					auto quota = std::string( );
+					auto period = 0.0;
+					if( file >> quota >> period and quota != "max" and period > 0 ) {
+						return std::stod( quota ) / period;
+					}
+					return { };
+				}
+				// cgroup v1, a quota of -1 means none
+				auto quota_file =
+				  std::ifstream( "/sys/fs/cgroup/cpu/cpu.cfs_quota_us" );
+				auto period_file =
+				  std::ifstream( "/sys/fs/cgroup/cpu/cpu.cfs_period_us" );
+				auto quota = 0.0;
+				auto period = 0.0;
+				if( quota_file >> quota and period_file >> period and quota > 0 and
+				    period > 0 ) {
+					return quota / period;
+				}
+			} catch( ... ) {}
+			return { };
+		}
+
+		// "48K" or "32M" as in sysfs cache size files
+		std::size_t parse_cache_size( std::string const &size ) {
+			auto pos = std::size_t{ 0 };
+			auto result = static_cast<std::size_t>( std::stoull( size, &pos ) );
+			if( pos < size.size( ) ) {
+				switch( size[pos] ) {
+				case 'K':
+					result *= 1024U;
+					break;
+				case 'M':
+					result *= 1024U * 1024U;
+					break;
+				case 'G':
+					result *= 1024U * 1024U * 1024U;
+					break;
+				default:
+					break;
+				}
+			}
+			return result;
+		}
+
+		cache_sizes detect_cache_sizes( ) {
+			auto result = cache_sizes{ };
+			try {
+				auto llc_level = 0;
+				for( unsigned index = 0;; ++index ) {
+					auto const dir = "/sys/devices/system/cpu/cpu0/cache/index" +
+					                 std::to_string( index ) + '/';
+					auto level_file = std::ifstream( dir + "level" );
+					auto type_file = std::ifstream( dir + "type" );
+					auto size_file = std::ifstream( dir + "size" );
+					if( not level_file or not type_file or not size_file ) {
+						break;
+					}
+					auto level = 0;
+					auto type = std::string( );
+					auto size = std::string( );
+					if( not( level_file >> level and type_file >> type and
+					         size_file >> size ) or
+					    type == "Instruction" ) {
+						continue;
+					}
+					auto const bytes = parse_cache_size( size );
+					if( bytes == 0 ) {
+						continue;
+					}
+					if( level == 2 ) {
+						result.l2 = bytes;
+					}
+					if( level >= 2 and level > llc_level ) {
+						result.llc = bytes;
+						llc_level = level;
+					}
+				}
+			} catch( ... ) { return cache_sizes{ }; }
+			return result;
+		}
+#endif
+	} // namespace
+
+	cpu_topology::cpu_topology( std::vector<std::vector<unsigned>> node_cpus )
+	  : m_node_cpus( daw::move( node_cpus ) ) {}
+
+	cpu_topology const &cpu_topology::get( ) {
+		static auto const topology = cpu_topology( detect_node_cpus( ) );
+		return topology;
+	}
+
+	std::size_t cpu_topology::cpu_count( ) const {
+		std::size_t result = 0;
+		for( auto const &cpus : m_node_cpus ) {
+			result += cpus.size( );
+		}
+		return result;
+	}
+
+	std::size_t available_cpu_count( ) {
+		static auto const count = []( ) {
+			auto result = static_cast<std::size_t>(
+			  std::max( std::thread::hardware_concurrency( ), 1U ) );
+#if defined( __linux__ )
+			cpu_set_t allowed;
+			CPU_ZERO( &allowed );
+			if( sched_getaffinity( 0, sizeof( allowed ), &allowed ) == 0 ) {
+				result = std::min(
+				  result, static_cast<std::size_t>( CPU_COUNT( &allowed ) ) );
+			}
+			if( auto const quota = cgroup_cpu_quota( ); quota ) {
+				result =
+				  std::min( result, static_cast<std::size_t>( std::ceil( *quota ) ) );
+			}
+#endif
+			return std::max( result, std::size_t{ 1 } );
+		}( );
+		return count;
+	}
+
+	cache_sizes const &cpu_cache_sizes( ) {
+#if defined( __linux__ )
+		static auto const sizes = detect_cache_sizes( );
+#else
+		static auto const sizes = cache_sizes{ };
+#endif
+		return sizes;
+	}
+
+	bool pin_current_thread_to_cpu( unsigned cpu ) {
+#if defined( __linux__ )
+		if( cpu >= CPU_SETSIZE ) {
+			return false;
+		}
+		cpu_set_t set;
+		CPU_ZERO( &set );
+		CPU_SET( cpu, &set );
+		return pthread_setaffinity_np( pthread_self( ), sizeof( set ), &set ) == 0;
+#else
+		(void)cpu;
+		return false;
+#endif
+	}
+
+	bool set_current_thread_affinity( std::vector<unsigned> const &cpus ) {
+#if defined( __linux__ )
+		cpu_set_t set;
+		CPU_ZERO( &set );
+		for( auto const cpu : cpus ) {
+			if( cpu >= CPU_SETSIZE ) {
+				return false;
+			}
+			CPU_SET( cpu, &set );
+		}
+		return not cpus.empty( ) and
+		       pthread_setaffinity_np( pthread_self( ), sizeof( set ), &set ) == 0;
+#else
+		(void)cpus;
+		return false;
+#endif
+	}
+
+	bool set_current_thread_name( std::string const &name ) {
+#if defined( __linux__ )
+		// Linux names hold at most 15 characters
+		return pthread_setname_np( pthread_self( ),
+		                           name.substr( 0, 15 ).c_str( ) ) == 0;
+#elif defined( __APPLE__ )
+		return pthread_setname_np( name.c_str( ) ) == 0;
+#else
+		(void)name;
+		return false;
+#endif
+	}
+} // namespace daw::parallel
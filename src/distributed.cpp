@@ -0,0 +1,621 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "daw/fs/distributed.h"
+#include "daw/fs/impl/ithread.h"
+
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#if defined( __linux__ ) or defined( __APPLE__ )
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <unistd.h>
+#define DAW_FS_HAS_SOCKETS
+#endif
+
+namespace daw::distributed {
+	bytes_t serialize( chunk_descriptor const &chunk ) {
+		auto result = bytes_t( );
+		result.reserve( sizeof( std::uint32_t ) + 3U * sizeof( std::uint64_t ) +
+		                chunk.args.size( ) );
+		write_value( result, chunk.function_id );
+		write_value( result, chunk.first );
+		write_value( result, chunk.last );
+		write_value( result, static_cast<std::uint64_t>( chunk.args.size( ) ) );
+		result.insert( result.end( ), chunk.args.begin( ), chunk.args.end( ) );
+		return result;
+	}
+
+	chunk_descriptor deserialize_chunk( bytes_t const &data ) {
+		std::size_t pos = 0;
+		auto result = chunk_descriptor( );
+		result.function_id = read_value<std::uint32_t>( data, pos );
+		result.first = read_value<std::uint64_t>( data, pos );
+		result.last = read_value<std::uint64_t>( data, pos );
+		auto const args_size = read_value<std::uint64_t>( data, pos );
+		if( args_size != data.size( ) - pos or result.first > result.last ) {
+			throw remote_error( "Malformed chunk descriptor" );
+		}
+		result.args.assign( data.begin( ) + static_cast<std::ptrdiff_t>( pos ),
+		                    data.end( ) );
+		return result;
+	}
+
+	bytes_t function_registry::run( chunk_descriptor const &chunk,
+	                                task_scheduler &ts ) const {
+		auto pos = m_functions.find( chunk.function_id );
+		if( pos == m_functions.end( ) ) {
+			throw remote_error( "Unknown function id " +
+			                    std::to_string( chunk.function_id ) );
+		}
+		return pos->second( chunk, ts );
+	}
+
+	executor::~executor( ) = default;
+
+	local_executor::local_executor( function_registry const &registry,
+	                                task_scheduler ts )
+	  : m_registry( &registry )
+	  , m_ts( daw::move( ts ) ) {}
+
+	future_result_t<bytes_t> local_executor::execute( chunk_descriptor chunk ) {
+		return make_future_result(
+		  m_ts, [registry = m_registry, ts = m_ts,
+		         chunk = daw::move( chunk )]( ) mutable {
+			  return registry->run( chunk, ts );
+		  } );
+	}
+
+	namespace {
+		enum class reply_status : std::uint8_t { success, failure };
+
+		[[nodiscard]] bytes_t make_reply( reply_status status,
+		                                  bytes_t const &payload ) {
+			auto result = bytes_t( );
+			result.reserve( payload.size( ) + 1U );
+			write_value( result, status );
+			result.insert( result.end( ), payload.begin( ), payload.end( ) );
+			return result;
+		}
+
+		[[nodiscard]] bytes_t make_failure( char const *message ) {
+			auto const size = std::strlen( message );
+			auto payload = bytes_t( size );
+			std::memcpy( payload.data( ), message, size );
+			return make_reply( reply_status::failure, payload );
+		}
+
+#if defined( DAW_FS_HAS_SOCKETS )
+		[[noreturn]] void throw_socket_error( char const *what ) {
+			throw remote_error( std::string( what ) + ": " +
+			                    std::strerror( errno ) );
+		}
+
+		class socket_t {
+			int m_fd = -1;
+
+		public:
+			socket_t( ) = default;
+
+			explicit socket_t( int fd ) noexcept
+			  : m_fd( fd ) {}
+
+			socket_t( socket_t &&other ) noexcept
+			  : m_fd( std::exchange( other.m_fd, -1 ) ) {}
+
+			socket_t &operator=( socket_t &&other ) noexcept {
+				if( this != &other ) {
+					reset( );
+					m_fd = std::exchange( other.m_fd, -1 );
+				}
+				return *this;
+			}
+
+			socket_t( socket_t const & ) = delete;
+			socket_t &operator=( socket_t const & ) = delete;
+
+			~socket_t( ) {
+				reset( );
+			}
+
+			void reset( ) noexcept {
+				if( m_fd >= 0 ) {
+					::close( m_fd );
+					m_fd = -1;
+				}
+			}
+
+			[[nodiscard]] int get( ) const noexcept {
+				return m_fd;
+			}
+		};
+
+		void send_all( socket_t const &sock, void const *data,
+		               std::size_t size ) {
+#if defined( MSG_NOSIGNAL )
+			constexpr int flags = MSG_NOSIGNAL;
+#else
+			constexpr int flags = 0;
+#endif
+			auto const *ptr = static_cast<char const *>( data );
+			while( size > 0 ) {
+				auto const sent = ::send( sock.get( ), ptr, size, flags );
+				if( sent < 0 ) {
+					if( errno == EINTR ) {
+						continue;
+					}
+					throw_socket_error( "send" );
+				}
+				ptr += sent;
+				size -= static_cast<std::size_t>( sent );
+			}
+		}
+
+		void recv_all( socket_t const &sock, void *data, std::size_t size ) {
+			auto *ptr = static_cast<char *>( data );
+			while( size > 0 ) {
+				auto const received = ::recv( sock.get( ), ptr, size, 0 );
+				if( received < 0 ) {
+					if( errno == EINTR ) {
+						continue;
+					}
+					throw_socket_error( "recv" );
+				}
+				if( received == 0 ) {
+					throw remote_error( "Connection closed" );
+				}
+				ptr += received;
+				size -= static_cast<std::size_t>( received );
+			}
+		}
+
+		/// Messages are a 64bit size followed by the bytes
+		void send_message( socket_t const &sock, bytes_t const &message ) {
+			auto const size = static_cast<std::uint64_t>( message.size( ) );
+			send_all( sock, &size, sizeof( size ) );
+			send_all( sock, message.data( ), message.size( ) );
+		}
+
+		/// Messages larger than max_size are refused instead of allocated
+		[[nodiscard]] bytes_t recv_message( socket_t const &sock,
+		                                    std::uint64_t max_size ) {
+			std::uint64_t size = 0;
+			recv_all( sock, &size, sizeof( size ) );
+			if( size > max_size ) {
+				throw remote_error( "Message is too large" );
+			}
+			auto result = bytes_t( static_cast<std::size_t>( size ) );
+			recv_all( sock, result.data( ), result.size( ) );
+			return result;
+		}
+
+		/// Connect sock to addr, giving up after timeout
+		[[nodiscard]] bool connect_within( socket_t const &sock,
+		                                   addrinfo const &addr,
+		                                   std::chrono::milliseconds timeout ) {
+			auto const flags = ::fcntl( sock.get( ), F_GETFL, 0 );
+			if( flags < 0 or
+			    ::fcntl( sock.get( ), F_SETFL, flags | O_NONBLOCK ) != 0 ) {
+				return false;
+			}
+			if( ::connect( sock.get( ), addr.ai_addr, addr.ai_addrlen ) != 0 ) {
+				if( errno != EINPROGRESS ) {
+					return false;
+				}
+				auto pfd = pollfd{ sock.get( ), POLLOUT, 0 };
+				if( ::poll( &pfd, 1, static_cast<int>( timeout.count( ) ) ) <= 0 ) {
+					return false;
+				}
+				int error = 0;
+				auto len = static_cast<socklen_t>( sizeof( error ) );
+				if( ::getsockopt( sock.get( ), SOL_SOCKET, SO_ERROR, &error, &len ) !=
+				      0 or
+				    error != 0 ) {
+					return false;
+				}
+			}
+			return ::fcntl( sock.get( ), F_SETFL, flags ) == 0;
+		}
+
+		[[nodiscard]] socket_t connect_to( std::string const &host,
+		                                   std::uint16_t port,
+		                                   std::chrono::milliseconds timeout ) {
+			auto hints = addrinfo{ };
+			hints.ai_family = AF_UNSPEC;
+			hints.ai_socktype = SOCK_STREAM;
+			addrinfo *addresses = nullptr;
+			auto const service = std::to_string( port );
+			if( auto const rc = ::getaddrinfo( host.c_str( ), service.c_str( ),
+			                                   &hints, &addresses );
+			    rc != 0 ) {
+				throw remote_error( "getaddrinfo " + host + ": " +
+				                    ::gai_strerror( rc ) );
+			}
+			auto result = socket_t( );
+			for( auto *addr = addresses; addr != nullptr; addr = addr->ai_next ) {
+				auto sock = socket_t(
+				  ::socket( addr->ai_family, addr->ai_socktype, addr->ai_protocol ) );
+				if( sock.get( ) >= 0 and connect_within( sock, *addr, timeout ) ) {
+					result = daw::move( sock );
+					break;
+				}
+			}
+			::freeaddrinfo( addresses );
+			if( result.get( ) < 0 ) {
+				throw remote_error( "Could not connect to " + host + ":" + service );
+			}
+			return result;
+		}
+
+		/// Bound how long a read or write on sock may block
+		void set_timeout( socket_t const &sock,
+		                  std::chrono::milliseconds timeout ) {
+			auto const usec =
+			  std::chrono::duration_cast<std::chrono::microseconds>( timeout )
+			    .count( );
+			auto tv = timeval{ };
+			tv.tv_sec = static_cast<decltype( tv.tv_sec )>( usec / 1'000'000 );
+			tv.tv_usec = static_cast<decltype( tv.tv_usec )>( usec % 1'000'000 );
+			if( ::setsockopt( sock.get( ), SOL_SOCKET, SO_RCVTIMEO, &tv,
+			                  sizeof( tv ) ) != 0 or
+			    ::setsockopt( sock.get( ), SOL_SOCKET, SO_SNDTIMEO, &tv,
+			                  sizeof( tv ) ) != 0 ) {
+				throw_socket_error( "setsockopt" );
+			}
+		}
+
+		/// Send request on sock and read the reply, unwrapping a failure
+		[[nodiscard]] bytes_t call_remote( socket_t const &sock,
+		                                   bytes_t const &request,
+		                                   std::uint64_t max_reply_size ) {
+			send_message( sock, request );
+			auto reply = recv_message( sock, max_reply_size );
+			std::size_t pos = 0;
+			auto const status = read_value<reply_status>( reply, pos );
+			if( status != reply_status::success ) {
+				throw remote_error(
+				  std::string( reinterpret_cast<char const *>( reply.data( ) ) + pos,
+				               reply.size( ) - pos ) );
+			}
+			reply.erase( reply.begin( ),
+			             reply.begin( ) + static_cast<std::ptrdiff_t>( pos ) );
+			return reply;
+		}
+#endif
+	} // namespace
+
+	struct tcp_executor::state_t {
+		std::string host;
+		std::uint16_t port;
+		task_scheduler ts;
+		tcp_executor_config config;
+#if defined( DAW_FS_HAS_SOCKETS )
+		/// A chunk in flight.  The socket is set once connected and outlives the
+		/// thread using it, so the destructor can shut it down under a blocked
+		/// read
+		struct call_t {
+			socket_t sock{ };
+			std::optional<daw::parallel::ithread> thread{ };
+			bool done = false;
+		};
+
+		std::mutex calls_mutex{ };
+		std::list<call_t> calls{ };
+		bool stopping = false;
+
+		/// Join the threads of calls that are done with.  Call with calls_mutex
+		/// held
+		void reap_calls( ) {
+			for( auto it = calls.begin( ); it != calls.end( ); ) {
+				if( it->done ) {
+					it->thread->join( );
+					it = calls.erase( it );
+				} else {
+					++it;
+				}
+			}
+		}
+
+		[[nodiscard]] bytes_t run_call( call_t &call, bytes_t const &request ) {
+			auto sock = connect_to( host, port, config.connect_timeout );
+			set_timeout( sock, config.io_timeout );
+			{
+				auto const lck = std::lock_guard<std::mutex>( calls_mutex );
+				if( stopping ) {
+					throw remote_error( "tcp_executor was destroyed" );
+				}
+				call.sock = daw::move( sock );
+			}
+			return call_remote( call.sock, request, config.max_reply_size );
+		}
+#endif
+
+		state_t( std::string h, std::uint16_t p, task_scheduler sched,
+		         tcp_executor_config cfg )
+		  : host( daw::move( h ) )
+		  , port( p )
+		  , ts( daw::move( sched ) )
+		  , config( cfg ) {}
+	};
+
+	tcp_executor::tcp_executor( std::string host, std::uint16_t port,
+	                            task_scheduler ts, tcp_executor_config config )
+	  : m_state( std::make_unique<state_t>( daw::move( host ), port,
+	                                        daw::move( ts ), config ) ) {}
+
+	tcp_executor::~tcp_executor( ) {
+#if defined( DAW_FS_HAS_SOCKETS )
+		auto lck = std::unique_lock<std::mutex>( m_state->calls_mutex );
+		m_state->stopping = true;
+		for( auto &call : m_state->calls ) {
+			(void)::shutdown( call.sock.get( ), SHUT_RDWR );
+		}
+		// The threads take the lock to finish, so join them without it
+		auto calls = daw::move( m_state->calls );
+		m_state->calls.clear( );
+		lck.unlock( );
+		for( auto &call : calls ) {
+			call.thread->join( );
+		}
+#endif
+	}
+
+	future_result_t<bytes_t> tcp_executor::execute( chunk_descriptor chunk ) {
+#if defined( DAW_FS_HAS_SOCKETS )
+		auto &state = *m_state;
+		auto result = future_result_t<bytes_t>( state.ts );
+		// Each chunk in flight waits for its reply on a thread of its own, so no
+		// worker is held by the network
+		auto const lck = std::lock_guard<std::mutex>( state.calls_mutex );
+		state.reap_calls( );
+		auto &call = state.calls.emplace_back( );
+		call.thread.emplace( [&state, &call, result,
+		                      request = serialize( chunk )]( ) mutable {
+			try {
+				result.set_value( state.run_call( call, request ) );
+			} catch( ... ) { result.set_exception( ); }
+			auto const done_lck = std::lock_guard<std::mutex>( state.calls_mutex );
+			call.done = true;
+		} );
+		return result;
+#else
+		(void)chunk;
+		throw remote_error( "tcp_executor is not supported on this platform" );
+#endif
+	}
+
+#if defined( DAW_FS_HAS_SOCKETS )
+	namespace {
+		/// Receive one chunk, run it and reply.  Failures are sent back
+		void serve( function_registry const &registry, task_scheduler &ts,
+		            socket_t const &sock, std::uint64_t max_message_size ) {
+			auto reply = bytes_t( );
+			try {
+				auto const chunk =
+				  deserialize_chunk( recv_message( sock, max_message_size ) );
+				reply = make_reply( reply_status::success, registry.run( chunk, ts ) );
+			} catch( std::exception const &ex ) {
+				reply = make_failure( ex.what( ) );
+			} catch( ... ) { reply = make_failure( "Unknown exception" ); }
+			try {
+				send_message( sock, reply );
+			} catch( remote_error const & ) {
+				// The executor has gone away, nobody is left to tell
+			}
+		}
+	} // namespace
+#endif
+
+	struct tcp_worker::state_t {
+		function_registry const *registry;
+		task_scheduler ts;
+		tcp_worker_config config;
+		std::uint16_t port = 0;
+#if defined( DAW_FS_HAS_SOCKETS )
+		/// A served connection.  The socket outlives the thread using it, so
+		/// stop( ) can shut it down under a blocked read
+		struct connection_t {
+			socket_t sock{ };
+			std::optional<daw::parallel::ithread> thread{ };
+			bool done = false;
+		};
+
+		socket_t listener{ };
+		std::optional<daw::parallel::ithread> accept_thread{ };
+		std::mutex connections_mutex{ };
+		std::condition_variable connection_done{ };
+		std::list<connection_t> connections{ };
+		std::size_t active_connections = 0;
+
+		/// Join the threads of connections that are done with.  Call with
+		/// connections_mutex held
+		void reap_connections( ) {
+			for( auto it = connections.begin( ); it != connections.end( ); ) {
+				if( it->done ) {
+					it->thread->join( );
+					it = connections.erase( it );
+				} else {
+					++it;
+				}
+			}
+		}
+
+		/// Poll so that a stop is noticed without closing the listener under a
+		/// blocked accept.  Each connection is served on a thread of its own,
+		/// the chunk runs on ts.  At max_connections, new ones are left in the
+		/// backlog until one finishes
+		void accept_loop( daw::parallel::stop_token tok ) {
+			while( tok ) {
+				{
+					auto lck = std::unique_lock<std::mutex>( connections_mutex );
+					reap_connections( );
+					if( not connection_done.wait_for(
+					      lck, std::chrono::milliseconds( 100 ), [&] {
+						      return active_connections < config.max_connections;
+					      } ) ) {
+						continue;
+					}
+				}
+				auto pfd = pollfd{ listener.get( ), POLLIN, 0 };
+				if( ::poll( &pfd, 1, 100 ) <= 0 ) {
+					continue;
+				}
+				auto sock = socket_t( ::accept( listener.get( ), nullptr, nullptr ) );
+				if( sock.get( ) < 0 ) {
+					continue;
+				}
+				try {
+					set_timeout( sock, config.io_timeout );
+				} catch( remote_error const & ) { continue; }
+				auto const lck = std::lock_guard<std::mutex>( connections_mutex );
+				auto &conn = connections.emplace_back( );
+				conn.sock = daw::move( sock );
+				++active_connections;
+				conn.thread.emplace( [this, &conn, sched = ts]( ) mutable {
+					serve( *registry, sched, conn.sock, config.max_message_size );
+					auto const done_lck =
+					  std::lock_guard<std::mutex>( connections_mutex );
+					conn.done = true;
+					--active_connections;
+					connection_done.notify_all( );
+				} );
+			}
+		}
+#endif
+
+		state_t( function_registry const &reg, tcp_worker_config cfg,
+		         task_scheduler sched )
+		  : registry( &reg )
+		  , ts( daw::move( sched ) )
+		  , config( daw::move( cfg ) ) {}
+	};
+
+	tcp_worker::tcp_worker( function_registry const &registry,
+	                        tcp_worker_config config, task_scheduler ts )
+	  : m_state( std::make_unique<state_t>( registry, daw::move( config ),
+	                                        daw::move( ts ) ) ) {
+#if defined( DAW_FS_HAS_SOCKETS )
+		auto &state = *m_state;
+		daw::exception::precondition_check(
+		  state.config.max_connections > 0, "At least one connection is needed" );
+		auto hints = addrinfo{ };
+		hints.ai_family = AF_UNSPEC;
+		hints.ai_socktype = SOCK_STREAM;
+		hints.ai_flags = AI_PASSIVE;
+		addrinfo *addresses = nullptr;
+		auto const service = std::to_string( state.config.port );
+		if( auto const rc =
+		      ::getaddrinfo( state.config.bind_address.c_str( ), service.c_str( ),
+		                     &hints, &addresses );
+		    rc != 0 ) {
+			throw remote_error( "getaddrinfo " + state.config.bind_address + ": " +
+			                    ::gai_strerror( rc ) );
+		}
+		for( auto *addr = addresses; addr != nullptr; addr = addr->ai_next ) {
+			auto sock = socket_t(
+			  ::socket( addr->ai_family, addr->ai_socktype, addr->ai_protocol ) );
+			if( sock.get( ) < 0 ) {
+				continue;
+			}
+			int const reuse = 1;
+			(void)::setsockopt( sock.get( ), SOL_SOCKET, SO_REUSEADDR, &reuse,
+			                    sizeof( reuse ) );
+			if( ::bind( sock.get( ), addr->ai_addr, addr->ai_addrlen ) == 0 ) {
+				state.listener = daw::move( sock );
+				break;
+			}
+		}
+		::freeaddrinfo( addresses );
+		if( state.listener.get( ) < 0 ) {
+			throw_socket_error( "bind" );
+		}
+		if( ::listen( state.listener.get( ), SOMAXCONN ) != 0 ) {
+			throw_socket_error( "listen" );
+		}
+		auto addr = sockaddr_storage{ };
+		auto len = static_cast<socklen_t>( sizeof( addr ) );
+		if( ::getsockname( state.listener.get( ),
+		                   reinterpret_cast<sockaddr *>( &addr ), &len ) != 0 ) {
+			throw_socket_error( "getsockname" );
+		}
+		state.port =
+		  addr.ss_family == AF_INET6
+		    ? ntohs( reinterpret_cast<sockaddr_in6 const &>( addr ).sin6_port )
+		    : ntohs( reinterpret_cast<sockaddr_in const &>( addr ).sin_port );
+		state.accept_thread.emplace( [&state]( daw::parallel::stop_token tok ) {
+			state.accept_loop( daw::move( tok ) );
+		} );
+#else
+		throw remote_error( "tcp_worker is not supported on this platform" );
+#endif
+	}
+
+	tcp_worker::tcp_worker( function_registry const &registry,
+	                        std::uint16_t port, task_scheduler ts )
+	  : tcp_worker( registry, tcp_worker_config{ "127.0.0.1", port },
+	                daw::move( ts ) ) {}
+
+	tcp_worker::~tcp_worker( ) {
+		stop( );
+	}
+
+	std::uint16_t tcp_worker::port( ) const {
+		return m_state->port;
+	}
+
+	void tcp_worker::stop( ) {
+#if defined( DAW_FS_HAS_SOCKETS )
+		if( m_state->accept_thread ) {
+			m_state->accept_thread->stop_and_wait( );
+			m_state->accept_thread.reset( );
+		}
+		m_state->listener.reset( );
+		auto lck = std::unique_lock<std::mutex>( m_state->connections_mutex );
+		for( auto &conn : m_state->connections ) {
+			(void)::shutdown( conn.sock.get( ), SHUT_RDWR );
+		}
+		// The threads take the lock to finish, so join them without it
+		auto connections = daw::move( m_state->connections );
+		m_state->connections.clear( );
+		lck.unlock( );
+		for( auto &conn : connections ) {
+			conn.thread->join( );
+		}
+#endif
+	}
+} // namespace daw::distributed
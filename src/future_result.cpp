@@ -26,16 +26,17 @@ namespace daw {
 	namespace impl {
 		future_result_base_t::~future_result_base_t( ) noexcept = default;
 
+		void member_data_t<void>::publish(
+		  member_data_t<void>::expected_result_t &&value ) {
+			m_data->m_result = daw::move( value );
+			if( m_data->try_publish( ) ) {
+				m_data->m_next( daw::move( m_data->m_result ) );
+			}
+		}
+
 		void member_data_t<void>::set_value(
 		  member_data_t<void>::expected_result_t result ) {
-			m_data->m_result = daw::move( result );
-
-			if( auto nxt = m_data->m_next.get( ); *nxt ) {
-				pass_next( daw::move( m_data->m_result ) );
-				return;
-			}
-			m_data->status( future_status::ready );
-			m_data->notify( );
+			publish( daw::move( result ) );
 		}
 
 		void member_data_t<void>::set_value( ) {
@@ -56,6 +57,10 @@ namespace daw {
 	future_result_t<void>::future_result_t( task_scheduler ts )
 	  : m_data( daw::move( ts ) ) {}
 
+	future_result_t<void>::future_result_t( task_scheduler ts,
+	                                        cancellation_token tok )
+	  : m_data( daw::move( ts ), daw::move( tok ) ) {}
+
 	future_result_t<void>::future_result_t( daw::shared_latch sem,
 	                                        task_scheduler ts )
 	  : m_data( daw::move( sem ), daw::move( ts ) ) {}
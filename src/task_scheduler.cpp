@@ -20,18 +20,56 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
 
 #include <daw/daw_scope_guard.h>
 
+#include "daw/fs/impl/cpu_topology.h"
 #include "daw/fs/impl/daw_latch.h"
 #include "daw/fs/impl/ithread.h"
 #include "daw/fs/task_scheduler.h"
 
 namespace daw {
+	namespace {
+		// What set_global_task_scheduler installed, taken by the first
+		// get_task_scheduler( )
+		struct global_scheduler_slot_t {
+			std::mutex mutex{ };
+			std::optional<task_scheduler> installed{ };
+			bool used = false;
+		};
+
+		global_scheduler_slot_t &global_scheduler_slot( ) {
+			static auto slot = global_scheduler_slot_t{ };
+			return slot;
+		}
+	} // namespace
+
+	bool set_global_task_scheduler( task_scheduler ts ) {
+		auto &slot = global_scheduler_slot( );
+		auto const lck = std::lock_guard( slot.mutex );
+		if( slot.used ) {
+			return false;
+		}
+		slot.installed = daw::move( ts );
+		return true;
+	}
+
 	task_scheduler get_task_scheduler( ) {
 		static auto ts = []( ) {
-			auto result = task_scheduler( );
+			auto &slot = global_scheduler_slot( );
+			auto const lck = std::lock_guard( slot.mutex );
+			slot.used = true;
+			auto result = slot.installed ? daw::move( *slot.installed )
+			                             : task_scheduler( );
+			slot.installed.reset( );
 			result.start( );
 			return result;
 		}( );
@@ -42,6 +80,55 @@ namespace daw {
 	}
 
 	namespace {
+		// How many times this thread has looked for a task, for priority aging
+		thread_local size_t task_pick_count = 0;
+
+		// Adds the time since it was made to a counter.  Does nothing, not even
+		// reading the clock, without DAW_FS_SCHEDULER_STATS
+		class stats_stopwatch {
+			std::chrono::steady_clock::time_point m_start{ };
+
+		public:
+			stats_stopwatch( ) {
+				if constexpr( scheduler_stats_enabled ) {
+					m_start = std::chrono::steady_clock::now( );
+				}
+			}
+
+			void add_to( std::atomic<std::uint64_t> *counter ) const {
+				if constexpr( scheduler_stats_enabled ) {
+					if( counter ) {
+						auto const elapsed = std::chrono::steady_clock::now( ) - m_start;
+						counter->fetch_add(
+						  static_cast<std::uint64_t>(
+						    std::chrono::duration_cast<std::chrono::nanoseconds>( elapsed )
+						      .count( ) ),
+						  std::memory_order_relaxed );
+					}
+				} else {
+					Unused( counter );
+				}
+			}
+		};
+
+		// Makes the std heap functions keep the earliest deadline on top
+		constexpr auto later_deadline = []( auto const &lhs, auto const &rhs ) {
+			return lhs.deadline > rhs.deadline;
+		};
+
+		// Cheap per thread xorshift for choosing steal victims.  Each thread
+		// starts at a different point in the sequence
+		size_t next_random_victim( ) {
+			static std::atomic<std::uint64_t> seed_source{ 0x9E37'79B9'7F4A'7C15ULL };
+			thread_local std::uint64_t state =
+			  seed_source.fetch_add( 0x9E37'79B9'7F4A'7C15ULL,
+			                         std::memory_order_relaxed ) |
+			  1ULL;
+			state ^= state << 13U;
+			state ^= state >> 7U;
+			state ^= state << 17U;
+			return static_cast<size_t>( state );
+		}
 		/*
 		template<typename Callable, typename... Args>
 		std::unique_ptr<daw::parallel::ithread> create_thread( Callable &&callable,
@@ -58,12 +145,49 @@ namespace daw {
 	} // namespace
 
 	task_scheduler::task_scheduler_impl::task_scheduler_impl(
-	  std::size_t num_threads, bool block_on_destruction )
-	  : m_num_threads( num_threads )
+	  task_scheduler_config const &config )
+	  : m_num_threads( config.num_threads != 0
+	                     ? config.num_threads
+	                     : daw::parallel::available_cpu_count( ) )
 	  , m_tasks( m_num_threads )
-	  , m_block_on_destruction( block_on_destruction ) {
-
-		std::cout << std::size( m_tasks ) << '\n';
+	  , m_local_tasks( m_num_threads )
+	  , m_worker_counters( scheduler_stats_enabled ? m_num_threads.load( ) : 0U )
+	  , m_block_on_destruction( config.block_on_destruction )
+	  , m_mode( config.mode )
+	  , m_placement( config.placement )
+	  , m_idle_spin( config.idle_spin )
+	  , m_cpu_affinity( config.cpu_affinity )
+	  , m_thread_name_prefix( config.thread_name_prefix )
+	  , m_stack_size( config.stack_size )
+	  , m_max_threads( config.max_threads )
+	  , m_grow_after( config.grow_after )
+	  , m_retire_after( config.retire_after )
+	  , m_bandwidth_workers_per_node( config.bandwidth_workers_per_node )
+	  , m_unhandled_exception_handler( config.unhandled_exception_handler ) {
+
+		for( auto &q : m_tasks ) {
+			q->configure( config.queue_capacity, config.overflow );
+		}
+		m_high_tasks->configure( config.queue_capacity, config.overflow );
+		m_low_tasks->configure( config.queue_capacity, config.overflow );
+		if( m_placement == worker_placement::numa_pinned ) {
+			// Fill the cpus node by node so consecutive workers share a node.  With
+			// more workers than cpus, wrap around
+			auto const &topology = daw::parallel::cpu_topology::get( );
+			auto cpu_nodes = std::vector<std::pair<unsigned, std::size_t>>( );
+			for( std::size_t node = 0; node < topology.node_count( ); ++node ) {
+				for( auto cpu : topology.node_cpus( node ) ) {
+					cpu_nodes.emplace_back( cpu, node );
+				}
+			}
+			m_node_workers.resize( topology.node_count( ) );
+			for( std::size_t id = 0; id < std::size( m_tasks ); ++id ) {
+				auto const [cpu, node] = cpu_nodes[id % cpu_nodes.size( )];
+				m_worker_cpu.push_back( cpu );
+				m_worker_node.push_back( node );
+				m_node_workers[node].push_back( id );
+			}
+		}
 	}
 
 	task_scheduler::task_scheduler( ) {
@@ -71,8 +195,17 @@ namespace daw {
 	}
 
 	task_scheduler::task_scheduler( std::size_t num_threads,
-	                                bool block_on_destruction )
-	  : m_impl( make_ts( num_threads, block_on_destruction ) ) {
+	                                bool block_on_destruction,
+	                                scheduler_mode mode,
+	                                std::size_t queue_capacity,
+	                                daw::parallel::queue_overflow overflow,
+	                                worker_placement placement )
+	  : task_scheduler( task_scheduler_config{ num_threads, block_on_destruction,
+	                                           mode, queue_capacity, overflow,
+	                                           placement } ) {}
+
+	task_scheduler::task_scheduler( task_scheduler_config const &config )
+	  : m_impl( make_ts( config ) ) {
 
 		start( );
 	}
@@ -86,97 +219,217 @@ namespace daw {
 		return m_impl->m_continue;
 	}
 
-	std::unique_ptr<daw::task_t>
-	task_scheduler::wait_for_task_from_pool( size_t id ) {
-		// Get task.  First try own queue, if not try the others and finally
-		// wait for own queue to fill
+	std::optional<size_t> task_scheduler::current_worker_id( ) const {
 		assert( m_impl );
-		if( not m_impl or not m_impl->m_continue ) {
+		if( impl::current_worker.owner != m_impl.get( ) ) {
 			return { };
 		}
-		std::size_t const queue_count = std::size( m_impl->m_tasks );
-		std::size_t const q_id = id % queue_count;
-		for( size_t n = q_id; n < queue_count; ++n ) {
-			if( auto tsk = m_impl->m_tasks[n].try_pop_front( ); tsk ) {
+		return impl::current_worker.id;
+	}
+
+	bool task_scheduler::wants_more_tasks( ) const {
+		assert( m_impl );
+		if( m_impl->m_idle.has_waiters( ) ) {
+			return true;
+		}
+		auto const worker_id = current_worker_id( );
+		if( not worker_id ) {
+			return true;
+		}
+		if( m_impl->m_mode == scheduler_mode::work_stealing ) {
+			return m_impl->m_local_tasks[*worker_id].is_empty( );
+		}
+		return m_impl->m_tasks[*worker_id]->is_empty( );
+	}
+
+	std::unique_ptr<daw::task_t> task_scheduler::try_get_task( size_t id ) {
+		assert( m_impl );
+		auto &impl = *m_impl;
+		if( impl.m_timer_count.load( std::memory_order_relaxed ) != 0 and
+		    current_worker_id( ) == timer_worker_id ) {
+			run_due_timers( );
+		}
+		if( ++task_pick_count % priority_aging_interval == 0 ) {
+			// Age the lower classes, they go first this time
+			if( auto tsk = impl.m_low_tasks->try_pop_front( ); tsk ) {
 				return tsk;
 			}
-		}
-		for( size_t n = 0; n < q_id; ++n ) {
-			if( auto tsk = m_impl->m_tasks[n].try_pop_front( ); tsk ) {
+			if( auto tsk = try_get_normal_task( id ); tsk ) {
 				return tsk;
 			}
 		}
-		if( id >= queue_count ) {
-			return m_impl->m_tasks[q_id].try_pop_front( );
+		if( auto tsk = try_get_deadline_task( ); tsk ) {
+			return tsk;
 		}
-		return pop_front( m_impl->m_tasks[q_id], [&]( ) {
-			bool result = m_impl->m_continue.load( std::memory_order_acquire );
-			return result;
-		} );
+		if( auto tsk = impl.m_high_tasks->try_pop_front( ); tsk ) {
+			return tsk;
+		}
+		if( auto tsk = try_get_normal_task( id ); tsk ) {
+			return tsk;
+		}
+		return impl.m_low_tasks->try_pop_front( );
 	}
 
-	[[nodiscard]] std::unique_ptr<daw::task_t>
-	task_scheduler::wait_for_task_from_pool( size_t id,
-	                                         daw::parallel::stop_token tok ) {
+	std::unique_ptr<daw::task_t> task_scheduler::try_get_deadline_task( ) {
 		assert( m_impl );
-		// Get task.  First try own queue, if not try the others and finally
-		// wait for own queue to fill
-		if( not m_impl or not m_impl->m_continue or not tok ) {
-			return { };
+		auto &impl = *m_impl;
+		if( impl.m_deadline_count.load( std::memory_order_acquire ) == 0 ) {
+			return nullptr;
 		}
-		std::size_t const sz = std::size( m_impl->m_tasks );
-		std::size_t qid = id % sz;
-		bool const is_tmp_worker = id != qid;
+		auto const lck = std::lock_guard( impl.m_deadline_mutex );
+		auto &heap = impl.m_deadline_tasks;
+		if( heap.empty( ) ) {
+			return nullptr;
+		}
+		std::pop_heap( heap.begin( ), heap.end( ), later_deadline );
+		auto tsk = daw::move( heap.back( ).task );
+		heap.pop_back( );
+		impl.m_deadline_count.fetch_sub( 1U, std::memory_order_release );
+		return tsk;
+	}
 
-		for( auto m = ( qid + 1 ) % sz; m_impl->m_continue and m != qid and tok;
-		     m = ( m + 1 ) % sz ) {
+	void task_scheduler::run_due_timers( ) {
+		assert( m_impl );
+		auto &impl = *m_impl;
+		auto due = std::vector<std::unique_ptr<daw::task_t>>( );
+		{
+			auto const lck = std::lock_guard( impl.m_timer_mutex );
+			impl.m_timers.advance( std::chrono::steady_clock::now( ),
+			                       [&]( std::unique_ptr<daw::task_t> &&tsk ) {
+				                       due.push_back( daw::move( tsk ) );
+			                       } );
+			impl.m_timer_count.store( impl.m_timers.size( ),
+			                          std::memory_order_release );
+		}
+		// Sent outside of the lock, a full queue may make us wait for room
+		for( auto &tsk : due ) {
+			(void)send_to_queue( daw::move( tsk ), get_task_id( ) );
+		}
+	}
 
-			if( auto tsk = m_impl->m_tasks[m].try_pop_front( ); tsk ) {
-				if( not tok or not m_impl->m_continue ) {
-					return { };
+	std::unique_ptr<daw::task_t>
+	task_scheduler::try_get_normal_task( size_t id ) {
+		assert( m_impl );
+		auto &impl = *m_impl;
+		std::size_t const queue_count = std::size( impl.m_tasks );
+		auto const worker_id = current_worker_id( );
+		std::size_t const q_id = worker_id ? *worker_id : id % queue_count;
+		bool const is_stealing = impl.m_mode == scheduler_mode::work_stealing;
+		auto const note_steal = [&]( bool succeeded ) {
+			if constexpr( scheduler_stats_enabled ) {
+				if( worker_id ) {
+					auto &counters = *impl.m_worker_counters[*worker_id];
+					counters.steals_attempted.fetch_add( 1U, std::memory_order_relaxed );
+					if( succeeded ) {
+						counters.steals_succeeded.fetch_add( 1U,
+						                                     std::memory_order_relaxed );
+					}
 				}
+			} else {
+				Unused( succeeded );
+			}
+		};
+
+		if( is_stealing and worker_id ) {
+			if( auto tsk = impl.m_local_tasks[q_id].try_pop_back( ); tsk ) {
+				note_dequeued( q_id );
 				return tsk;
 			}
 		}
-		if( is_tmp_worker ) {
-			while( m_impl->m_continue and tok ) {
-				if( auto tsk = m_impl->m_tasks[qid].try_pop_front( ); tsk ) {
-					if( not tok or not m_impl->m_continue ) {
-						return { };
-					}
+		if( auto tsk = impl.m_tasks[q_id]->try_pop_front( ); tsk ) {
+			note_dequeued( q_id );
+			return tsk;
+		}
+		if( is_stealing and worker_id and not impl.m_node_workers.empty( ) ) {
+			// Steal from our own NUMA node before crossing to another
+			auto const &neighbours = impl.m_node_workers[impl.m_worker_node[q_id]];
+			std::size_t const first_victim =
+			  next_random_victim( ) % std::size( neighbours );
+			for( size_t n = 0; n < std::size( neighbours ); ++n ) {
+				auto const victim =
+				  neighbours[( first_victim + n ) % std::size( neighbours )];
+				if( victim == q_id ) {
+					continue;
+				}
+				auto tsk = impl.m_local_tasks[victim].try_steal( );
+				note_steal( static_cast<bool>( tsk ) );
+				if( tsk ) {
+					trace_instant( "steal" );
+					note_dequeued( victim );
 					return tsk;
 				}
-				qid = ( qid + 1 ) % sz;
 			}
+		}
+		if( is_stealing ) {
+			std::size_t const first_victim = next_random_victim( ) % queue_count;
+			for( size_t n = 0; n < queue_count; ++n ) {
+				std::size_t const victim = ( first_victim + n ) % queue_count;
+				if( worker_id and victim == q_id ) {
+					continue;
+				}
+				auto tsk = impl.m_local_tasks[victim].try_steal( );
+				note_steal( static_cast<bool>( tsk ) );
+				if( tsk ) {
+					trace_instant( "steal" );
+					note_dequeued( victim );
+					return tsk;
+				}
+			}
+		}
+		for( size_t n = 1; n < queue_count; ++n ) {
+			std::size_t const victim = ( q_id + n ) % queue_count;
+			auto tsk = impl.m_tasks[victim]->try_pop_front( );
+			note_steal( static_cast<bool>( tsk ) );
+			if( tsk ) {
+				trace_instant( "steal" );
+				note_dequeued( victim );
+				return tsk;
+			}
+		}
+		return nullptr;
+	}
+
+	std::unique_ptr<daw::task_t>
+	task_scheduler::wait_for_task_from_pool( size_t id ) {
+		// Get task.  First try own deque and queue, if not try the others and
+		// finally wait for one of them to fill
+		assert( m_impl );
+		if( not m_impl or not m_impl->m_continue ) {
 			return { };
-		} else {
-			return pop_front( m_impl->m_tasks[qid],
-			                  [&]( ) { return m_impl->m_continue and tok; } );
 		}
+		if( id >= std::size( m_impl->m_tasks ) ) {
+			return try_get_task( id );
+		}
+		return wait_for_task_from_pool( id, [&]( ) {
+			return m_impl->m_continue.load( std::memory_order_acquire );
+		} );
+	}
+
+	[[nodiscard]] std::unique_ptr<daw::task_t>
+	task_scheduler::wait_for_task_from_pool( size_t id,
+	                                         daw::parallel::stop_token tok ) {
+		assert( m_impl );
+		if( not m_impl or not m_impl->m_continue or not tok ) {
+			return { };
+		}
+		return wait_for_task_from_pool(
+		  id, [&]( ) { return m_impl->m_continue and tok; } );
 	}
 
 	[[nodiscard]] std::unique_ptr<daw::task_t>
 	task_scheduler::wait_for_task_from_pool( size_t id, daw::shared_latch sem ) {
 		assert( m_impl );
-		// Get task.  First try own queue, if not try the others and finally
-		// wait for own queue to fill
 		if( not m_impl or not m_impl->m_continue ) {
 			return nullptr;
 		}
-		if( auto tsk = m_impl->m_tasks[id].try_pop_front( ); tsk ) {
-			return tsk;
-		}
-		for( auto m = ( id + 1 ) % m_impl->m_num_threads;
-		     m_impl->m_continue and m != id;
-		     m = ( m + 1 ) % m_impl->m_num_threads ) {
-
-			if( auto tsk = m_impl->m_tasks[m].try_pop_front( ); tsk ) {
+		// Nothing notifies m_idle when the latch is released, so this cannot park
+		while( m_impl->m_continue and not sem.try_wait( ) ) {
+			if( auto tsk = try_get_task( id ); tsk ) {
 				return tsk;
 			}
+			std::this_thread::yield( );
 		}
-		return pop_front( m_impl->m_tasks[id], [&]( ) {
-			return static_cast<bool>( m_impl->m_continue and not sem.try_wait( ) );
-		} );
+		return nullptr;
 	}
 
 	void task_scheduler::run_task( std::unique_ptr<daw::task_t> &&tsk_ptr ) {
@@ -193,43 +446,49 @@ namespace daw {
 				return;
 			}
 			if( tsk.is_ready( ) ) {
-				(void)send_task( daw::move( tsk_ptr ), get_task_id( ) );
-			} else {
+				if constexpr( scheduler_stats_enabled ) {
+					if( auto const worker_id = current_worker_id( ); worker_id ) {
+						m_impl->m_worker_counters[*worker_id]->tasks_executed.fetch_add(
+						  1U, std::memory_order_relaxed );
+					}
+				}
 				(void)daw::move( tsk )( );
+			} else {
+				// Still waiting on its latch.  Put it behind the shared queue so the
+				// local tasks it may be waiting on get to run first
+				(void)requeue_task( daw::move( tsk_ptr ) );
 			}
 		} catch( ... ) {
-			daw::breakpoint( );
 			// Don't let a task take down thread
-			// TODO: add callback to task_scheduler for handling
-			// task exceptions
+			auto const &handler = m_impl->m_unhandled_exception_handler;
+			if( handler ) {
+				try {
+					handler( std::current_exception( ) );
+				} catch( ... ) { daw::breakpoint( ); }
+			} else {
+				daw::breakpoint( );
+			}
 		}
 	}
 
 	size_t task_scheduler::get_task_id( ) {
 		assert( m_impl );
-		auto const tc = m_impl->m_task_count++;
-		// return tc % m_impl->m_num_threads;
+		// A worker keeps what it submits in its own queue.  Only threads outside
+		// the pool share the round robin counter
+		if( auto const &ctx = impl::current_worker; ctx.owner == m_impl.get( ) ) {
+			return ctx.id;
+		}
+		auto const tc =
+		  m_impl->m_task_count.fetch_add( 1U, std::memory_order_relaxed );
 		return tc % std::size( m_impl->m_tasks );
 	}
 
 	bool task_scheduler::run_next_task( size_t id ) {
 		assert( m_impl );
-		if( auto tsk = m_impl->m_tasks[id].try_pop_front( ); tsk ) {
+		if( auto tsk = try_get_task( id ); tsk ) {
 			run_task( daw::move( tsk ) );
 			return true;
 		}
-		for( size_t n = id + 1; n < std::size( m_impl->m_tasks ); ++n ) {
-			if( auto tsk = m_impl->m_tasks[n].try_pop_front( ); tsk ) {
-				run_task( daw::move( tsk ) );
-				return true;
-			}
-		}
-		for( size_t n = 0; n < id; ++n ) {
-			if( auto tsk = m_impl->m_tasks[n].try_pop_front( ); tsk ) {
-				run_task( daw::move( tsk ) );
-				return true;
-			}
-		}
 		return false;
 	}
 
@@ -239,6 +498,7 @@ namespace daw {
 		auto &threads = m_impl->m_threads;
 		try {
 			threads.emplace_back(
+			  daw::parallel::thread_options{ m_impl->m_stack_size },
 			  []( daw::parallel::stop_token tok, size_t id, auto wself ) {
 				  if( auto self = wself.lock( ); self ) {
 					  self->task_runner( id );
@@ -265,6 +525,13 @@ namespace daw {
 
 	void task_scheduler::task_scheduler_impl::stop( bool block_on_destruction ) {
 		m_continue.store( false, std::memory_order_release );
+		// Wake parked workers and senders so they see m_continue is false
+		m_idle.notify_all( );
+		for( auto &q : m_tasks ) {
+			q->notify_all_waiters( );
+		}
+		m_high_tasks->notify_all_waiters( );
+		m_low_tasks->notify_all_waiters( );
 		try {
 			auto const th_lck = std::lock_guard( m_threads_mutex );
 			for( auto &th : m_threads ) {
@@ -278,6 +545,17 @@ namespace daw {
 				} catch( ... ) {}
 			}
 			m_threads.clear( );
+			for( auto &th : m_elastic_threads ) {
+				try {
+					if( block_on_destruction ) {
+						th.stop_and_wait( );
+					} else {
+						th.detach( );
+						th.stop( );
+					}
+				} catch( ... ) {}
+			}
+			m_elastic_threads.clear( );
 		} catch( ... ) {}
 	}
 
@@ -287,7 +565,11 @@ namespace daw {
 
 	daw::parallel::ithread task_scheduler::start_temp_task_runner( ) {
 		assert( m_impl );
+		if constexpr( scheduler_stats_enabled ) {
+			m_impl->m_temp_runner_spawns.fetch_add( 1U, std::memory_order_relaxed );
+		}
 		return daw::parallel::ithread(
+		  daw::parallel::thread_options{ m_impl->m_stack_size },
 		  [id = m_impl->m_current_id++,
 		   wself = get_handle( )]( daw::parallel::stop_token tok ) {
 			  if( auto self = wself.lock( ); self ) {
@@ -296,6 +578,165 @@ namespace daw {
 		  } );
 	}
 
+	void task_scheduler::maybe_grow( ) {
+		assert( m_impl );
+		auto &impl = *m_impl;
+		if( impl.m_max_threads <= std::size( impl.m_tasks ) or
+		    impl.m_elastic_count.load( std::memory_order_relaxed ) >=
+		      impl.m_max_threads - std::size( impl.m_tasks ) ) {
+			return;
+		}
+		if( impl.m_idle.has_waiters( ) or
+		    impl.m_elastic_idle.load( std::memory_order_relaxed ) != 0 ) {
+			impl.m_saturated_since.store( 0, std::memory_order_relaxed );
+			return;
+		}
+		auto const now = static_cast<std::int64_t>(
+		  std::chrono::steady_clock::now( ).time_since_epoch( ).count( ) );
+		auto since = impl.m_saturated_since.load( std::memory_order_relaxed );
+		if( since == 0 ) {
+			(void)impl.m_saturated_since.compare_exchange_strong(
+			  since, now, std::memory_order_relaxed );
+			return;
+		}
+		auto const grow_after =
+		  std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		    impl.m_grow_after )
+		    .count( );
+		if( now - since < grow_after ) {
+			return;
+		}
+		// Only the submitter that resets the clock adds the worker
+		if( impl.m_saturated_since.compare_exchange_strong(
+		      since, 0, std::memory_order_relaxed ) ) {
+			add_elastic_worker( );
+		}
+	}
+
+	void task_scheduler::add_elastic_worker( ) {
+		assert( m_impl );
+		auto &impl = *m_impl;
+		// stop( ) holds the lock while it joins the workers, and one of them may
+		// be submitting.  Skip growing rather than wait for it
+		auto const th_lck =
+		  std::unique_lock( impl.m_threads_mutex, std::try_to_lock );
+		if( not th_lck or not impl.m_continue.load( std::memory_order_acquire ) ) {
+			return;
+		}
+		if( impl.m_elastic_count.load( std::memory_order_relaxed ) >=
+		    impl.m_max_threads - std::size( impl.m_tasks ) ) {
+			return;
+		}
+		// Retired workers have finished, joining them is quick
+		impl.m_elastic_threads.remove_if(
+		  []( daw::parallel::ithread const &th ) { return not th.joinable( ); } );
+		impl.m_elastic_count.fetch_add( 1U, std::memory_order_relaxed );
+		try {
+			impl.m_elastic_threads.emplace_back(
+			  daw::parallel::thread_options{ impl.m_stack_size },
+			  []( daw::parallel::stop_token tok, size_t id, auto wself ) {
+				  if( auto self = wself.lock( ); self ) {
+					  self->elastic_task_runner( id, tok );
+				  }
+			  },
+			  impl.m_current_id++, get_handle( ) );
+		} catch( std::system_error const & ) {
+			// Growing is an optimization, the pool keeps working without it
+			impl.m_elastic_count.fetch_sub( 1U, std::memory_order_relaxed );
+		}
+	}
+
+	bool task_scheduler::requeue_task( std::unique_ptr<daw::task_t> &&tsk ) {
+		return send_to_queue( daw::move( tsk ), get_task_id( ) );
+	}
+
+	bool task_scheduler::send_to_queue( std::unique_ptr<daw::task_t> &&tsk,
+	                                    size_t id ) {
+		assert( m_impl );
+		assert( id < std::size( m_impl->m_tasks ) );
+		if( m_impl->m_tasks[id]->try_push_back( daw::move( tsk ) ) ==
+		    daw::parallel::push_back_result::success ) {
+			note_queued( id );
+			m_impl->m_idle.notify_one( );
+			maybe_grow( );
+			return true;
+		}
+		return send_task( daw::move( tsk ), id );
+	}
+
+	bool task_scheduler::send_urgent_task( std::unique_ptr<daw::task_t> &&tsk,
+	                                       task_priority priority ) {
+		assert( m_impl );
+		assert( priority != task_priority::normal );
+		if( not tsk or not m_impl->m_continue ) {
+			return true;
+		}
+		auto &q = priority == task_priority::high ? *m_impl->m_high_tasks
+		                                          : *m_impl->m_low_tasks;
+		if( q.try_push_back( daw::move( tsk ) ) ==
+		    daw::parallel::push_back_result::success ) {
+			m_impl->m_idle.notify_one( );
+			maybe_grow( );
+			return true;
+		}
+		if constexpr( scheduler_stats_enabled ) {
+			m_impl->m_push_back_blocks.fetch_add( 1U, std::memory_order_relaxed );
+		}
+		if( push_back( q, daw::move( tsk ), [&]( ) {
+			    return static_cast<bool>( m_impl->m_continue );
+		    } ) == daw::parallel::push_back_result::success ) {
+			m_impl->m_idle.notify_one( );
+			maybe_grow( );
+			return true;
+		}
+		return false;
+	}
+
+	bool task_scheduler::send_urgent_task( std::unique_ptr<daw::task_t> &&tsk,
+	                                       task_deadline deadline ) {
+		assert( m_impl );
+		if( not tsk or not m_impl->m_continue ) {
+			return true;
+		}
+		{
+			auto const lck = std::lock_guard( m_impl->m_deadline_mutex );
+			auto &heap = m_impl->m_deadline_tasks;
+			heap.push_back( deadline_task_t{ deadline, daw::move( tsk ) } );
+			std::push_heap( heap.begin( ), heap.end( ), later_deadline );
+			m_impl->m_deadline_count.fetch_add( 1U, std::memory_order_release );
+		}
+		m_impl->m_idle.notify_one( );
+		maybe_grow( );
+		return true;
+	}
+
+	bool task_scheduler::send_timer_task(
+	  std::unique_ptr<daw::task_t> &&tsk,
+	  std::chrono::steady_clock::time_point when ) {
+		assert( m_impl );
+		if( not tsk or not m_impl->m_continue ) {
+			return true;
+		}
+		bool was_empty = false;
+		bool is_earlier = false;
+		{
+			auto const lck = std::lock_guard( m_impl->m_timer_mutex );
+			m_impl->m_timers.add( when, daw::move( tsk ) );
+			was_empty = m_impl->m_timer_count.fetch_add(
+			              1U, std::memory_order_release ) == 0;
+			is_earlier = when < m_impl->m_timer_wake_at;
+		}
+		if( was_empty ) {
+			// The timer worker may be parked and there is no waking it alone
+			m_impl->m_idle.notify_all( );
+		} else if( is_earlier ) {
+			// The keeper is parked until a later timer.  The other timed waiters
+			// are idle elastic workers, which park again
+			m_impl->m_idle.notify_timed( );
+		}
+		return true;
+	}
+
 	bool task_scheduler::send_task( std::unique_ptr<daw::task_t> &&tsk,
 	                                size_t id ) {
 		if( not tsk ) {
@@ -305,45 +746,100 @@ namespace daw {
 		if( not m_impl->m_continue ) {
 			return true;
 		}
+		if( m_impl->m_mode == scheduler_mode::work_stealing ) {
+			// Tasks spawned from a worker stay local to it until stolen
+			if( auto const worker_id = current_worker_id( ); worker_id ) {
+				if( m_impl->m_local_tasks[*worker_id].try_push_back(
+				      daw::move( tsk ) ) == daw::parallel::push_back_result::success ) {
+					note_queued( *worker_id );
+					m_impl->m_idle.notify_one( );
+					maybe_grow( );
+					return true;
+				}
+			}
+		}
 		assert( ( std::size( m_impl->m_tasks ) > id ) );
-		if( m_impl->m_tasks[id].try_push_back( daw::move( tsk ) ) ==
+		if( m_impl->m_tasks[id]->try_push_back( daw::move( tsk ) ) ==
 		    daw::parallel::push_back_result::success ) {
+			note_queued( id );
+			m_impl->m_idle.notify_one( );
+			maybe_grow( );
 			return true;
 		}
 		// Could not add to queue, try someone elses
-		assert( m_impl->m_num_threads <= std::size( m_impl->m_tasks ) );
-		for( auto m = ( id + 1 ) % m_impl->m_num_threads; m != id;
-		     m = ( m + 1 ) % m_impl->m_num_threads ) {
+		auto const queue_count = std::size( m_impl->m_tasks );
+		for( auto m = ( id + 1 ) % queue_count; m != id;
+		     m = ( m + 1 ) % queue_count ) {
 			if( not m_impl->m_continue ) {
 				return true;
 			}
-			if( m_impl->m_tasks[m].try_push_back( daw::move( tsk ) ) ==
+			if( m_impl->m_tasks[m]->try_push_back( daw::move( tsk ) ) ==
 			    daw::parallel::push_back_result::success ) {
+				note_queued( m );
+				m_impl->m_idle.notify_one( );
+				maybe_grow( );
 				return true;
 			}
 		}
 		// Could not add to another queue, wait for ours to have room
-		return push_back( m_impl->m_tasks[id], daw::move( tsk ), [&]( ) {
-			       return static_cast<bool>( m_impl->m_continue );
-		       } ) == daw::parallel::push_back_result::success;
+		if constexpr( scheduler_stats_enabled ) {
+			m_impl->m_push_back_blocks.fetch_add( 1U, std::memory_order_relaxed );
+		}
+		if( push_back( *m_impl->m_tasks[id], daw::move( tsk ), [&]( ) {
+			    return static_cast<bool>( m_impl->m_continue );
+		    } ) == daw::parallel::push_back_result::success ) {
+			note_queued( id );
+			m_impl->m_idle.notify_one( );
+			maybe_grow( );
+			return true;
+		}
+		return false;
 	}
 
 	void task_scheduler::task_runner( size_t id ) {
-		auto self = get_handle( ).lock( );
-		if( not self ) {
-			return;
-		}
+		// The thread's entry point holds this scheduler for as long as it runs
+		auto *const self = this;
 		assert( self->m_impl );
+		if( id < std::size( self->m_impl->m_tasks ) ) {
+			impl::current_worker =
+			  impl::worker_context_t{ self->m_impl.get( ), self, id };
+			if( id < std::size( self->m_impl->m_worker_cpu ) ) {
+				(void)daw::parallel::pin_current_thread_to_cpu(
+				  self->m_impl->m_worker_cpu[id] );
+			} else if( not self->m_impl->m_cpu_affinity.empty( ) ) {
+				(void)daw::parallel::set_current_thread_affinity(
+				  self->m_impl->m_cpu_affinity );
+			}
+			auto const &prefix = self->m_impl->m_thread_name_prefix;
+			if( not prefix.empty( ) ) {
+				(void)daw::parallel::set_current_thread_name( prefix +
+				                                              std::to_string( id ) );
+			}
+			if constexpr( scheduler_tracing_enabled ) {
+				set_trace_thread_name( ( prefix.empty( ) ? "worker " : prefix ) +
+				                       std::to_string( id ) );
+			}
+		}
+		auto const reset_context =
+		  daw::on_scope_exit( []( ) { impl::current_worker = { }; } );
+		auto *const counters = id < std::size( self->m_impl->m_worker_counters )
+		                         ? &*self->m_impl->m_worker_counters[id]
+		                         : nullptr;
 		bool keep_going =
 		  self->m_impl->m_continue.load( std::memory_order_acquire );
 		while( keep_going ) {
+			auto const idle = stats_stopwatch( );
 			auto tsk = self->wait_for_task_from_pool( id );
+			idle.add_to( counters ? &counters->idle_ns : nullptr );
 			keep_going = self->m_impl->m_continue.load( std::memory_order_acquire );
 			if( not keep_going ) {
 				return;
 			}
 			if( tsk ) {
+				// Tasks run while this one waits count as busy time here too
+				auto const busy = stats_stopwatch( );
 				run_task( daw::move( tsk ) );
+				busy.add_to( counters ? &counters->busy_ns : nullptr );
 			} else if( id >= std::size( self->m_impl->m_tasks ) ) {
 				return;
 			}
@@ -351,10 +847,8 @@ namespace daw {
 	}
 
 	void task_scheduler::task_runner( size_t id, daw::parallel::stop_token tok ) {
-		auto self = get_handle( ).lock( );
-		if( not self ) {
-			return;
-		}
+		// The thread's entry point holds this scheduler for as long as it runs
+		auto *const self = this;
 		assert( self->m_impl );
 
 		bool keep_going =
@@ -362,17 +856,65 @@ namespace daw {
 		while( keep_going and tok ) {
 			auto tsk = self->wait_for_task_from_pool( id, tok );
 			keep_going = self->m_impl->m_continue.load( std::memory_order_acquire );
-			if( keep_going and tok and tsk ) {
+			if( keep_going and tsk ) {
 				run_task( daw::move( tsk ) );
 			}
 		}
 	}
 
-	void task_scheduler::task_runner( size_t id, daw::shared_latch &sem ) {
-		auto self = get_handle( ).lock( );
-		if( not self ) {
-			return;
+	void task_scheduler::elastic_task_runner( size_t id,
+	                                          daw::parallel::stop_token tok ) {
+		auto *const self = this;
+		assert( self->m_impl );
+		auto &impl = *self->m_impl;
+		auto idle_since = std::chrono::steady_clock::now( );
+		bool is_idle = false;
+		auto const retire = daw::on_scope_exit( [&]( ) {
+			if( is_idle ) {
+				impl.m_elastic_idle.fetch_sub( 1U, std::memory_order_relaxed );
+			}
+			impl.m_elastic_count.fetch_sub( 1U, std::memory_order_relaxed );
+		} );
+		auto const run = [&]( std::unique_ptr<daw::task_t> tsk ) {
+			if( is_idle ) {
+				impl.m_elastic_idle.fetch_sub( 1U, std::memory_order_relaxed );
+				is_idle = false;
+			}
+			run_task( daw::move( tsk ) );
+			idle_since = std::chrono::steady_clock::now( );
+		};
+		while( impl.m_continue.load( std::memory_order_acquire ) and tok ) {
+			if( auto tsk = self->try_get_task( id ); tsk ) {
+				run( daw::move( tsk ) );
+				continue;
+			}
+			auto const retire_at = idle_since + impl.m_retire_after;
+			if( std::chrono::steady_clock::now( ) >= retire_at ) {
+				return;
+			}
+			if( not is_idle ) {
+				impl.m_elastic_idle.fetch_add( 1U, std::memory_order_relaxed );
+				is_idle = true;
+			}
+			// Park until a task is added or the idle time is up
+			auto const key = impl.m_idle.prepare_wait( );
+			if( not impl.m_continue.load( std::memory_order_acquire ) or
+			    not tok ) {
+				impl.m_idle.cancel_wait( );
+				return;
+			}
+			if( auto tsk = self->try_get_task( id ); tsk ) {
+				impl.m_idle.cancel_wait( );
+				run( daw::move( tsk ) );
+				continue;
+			}
+			(void)impl.m_idle.wait_until( key, retire_at );
 		}
+	}
+
+	void task_scheduler::task_runner( size_t id, daw::shared_latch &sem ) {
+		// The thread's entry point holds this scheduler for as long as it runs
+		auto *const self = this;
 		assert( self->m_impl );
 
 		bool keep_going =
@@ -380,20 +922,34 @@ namespace daw {
 		while( keep_going and sem ) {
 			auto tsk = self->wait_for_task_from_pool( id, sem );
 			keep_going = self->m_impl->m_continue.load( std::memory_order_acquire );
-			if( keep_going and sem and tsk ) {
+			if( keep_going and tsk ) {
 				run_task( daw::move( tsk ) );
 			}
 		}
 	}
 
-	bool task_scheduler::has_empty_queue( ) const {
+	scheduler_stats task_scheduler::stats( ) const {
 		assert( m_impl );
-		for( auto &q : m_impl->m_tasks ) {
-			if( q.is_empty( ) ) {
-				return true;
-			}
+		auto const &impl = *m_impl;
+		auto result = scheduler_stats{ };
+		result.workers.reserve( std::size( impl.m_worker_counters ) );
+		for( auto const &counters : impl.m_worker_counters ) {
+			constexpr auto relaxed = std::memory_order_relaxed;
+			auto &ws = result.workers.emplace_back( );
+			ws.tasks_executed = counters->tasks_executed.load( relaxed );
+			ws.steals_attempted = counters->steals_attempted.load( relaxed );
+			ws.steals_succeeded = counters->steals_succeeded.load( relaxed );
+			ws.busy_time = std::chrono::nanoseconds(
+			  static_cast<std::int64_t>( counters->busy_ns.load( relaxed ) ) );
+			ws.idle_time = std::chrono::nanoseconds(
+			  static_cast<std::int64_t>( counters->idle_ns.load( relaxed ) ) );
+			ws.queue_high_water = counters->queue_high_water.load( relaxed );
 		}
-		return false;
+		result.push_back_blocks =
+		  impl.m_push_back_blocks.load( std::memory_order_relaxed );
+		result.temp_runner_spawns =
+		  impl.m_temp_runner_spawns.load( std::memory_order_relaxed );
+		return result;
 	}
 
 	char const *unable_to_add_task_exception::what( ) const noexcept {
@@ -401,11 +957,10 @@ namespace daw {
 	}
 
 	std::shared_ptr<task_scheduler::task_scheduler_impl>
-	task_scheduler::make_ts( std::size_t const num_threads,
-	                         bool block_on_destruct ) {
-		auto ptr =
-		  std::make_shared<task_scheduler_impl>( num_threads, block_on_destruct );
-		assert( std::size( ptr->m_tasks ) == num_threads );
+	task_scheduler::make_ts( task_scheduler_config const &config ) {
+		auto ptr = std::make_shared<task_scheduler_impl>( config );
+		assert( config.num_threads == 0 or
+		        std::size( ptr->m_tasks ) == config.num_threads );
 		return ptr;
 	}
 
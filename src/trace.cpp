@@ -0,0 +1,231 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "daw/fs/trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace daw {
+	namespace {
+		/// Written only by its own thread, read by write_chrome_trace
+		struct trace_ring_t {
+			static constexpr std::size_t capacity = 1U << 16U;
+
+			std::unique_ptr<impl::trace_event_t[]> events =
+			  std::make_unique<impl::trace_event_t[]>( capacity );
+			std::atomic_size_t head = std::atomic_size_t( 0ULL );
+			// Events before this were dropped by clear_trace
+			std::atomic_size_t start = std::atomic_size_t( 0ULL );
+			std::size_t tid = 0;
+			// Guarded by the registry mutex
+			std::string name{ };
+			// Its thread has exited.  Guarded by the registry mutex
+			bool retired = false;
+		};
+
+		/// Rings of exited threads kept for their events until clear_trace.
+		/// Past this the oldest are dropped, so that short lived threads do not
+		/// grow the trace without bound
+		constexpr std::size_t max_retired_rings = 8;
+
+		/// Every ring of a running thread, and the retired rings that still
+		/// hold events, so that events from stopped workers get written
+		struct trace_registry_t {
+			std::mutex mutex{ };
+			std::vector<std::shared_ptr<trace_ring_t>> rings{ };
+			std::size_t next_tid = 1;
+			std::chrono::steady_clock::time_point epoch =
+			  std::chrono::steady_clock::now( );
+
+			/// Drop the retired rings until at most keep are left, oldest first.
+			/// Requires mutex to be held
+			void drop_retired( std::size_t keep ) {
+				auto retired = static_cast<std::size_t>(
+				  std::count_if( rings.begin( ), rings.end( ),
+				                 []( auto const &r ) { return r->retired; } ) );
+				auto it = rings.begin( );
+				while( retired > keep and it != rings.end( ) ) {
+					if( ( *it )->retired ) {
+						it = rings.erase( it );
+						--retired;
+					} else {
+						++it;
+					}
+				}
+			}
+		};
+
+		trace_registry_t &trace_registry( ) {
+			// Never destroyed, workers of the global scheduler may still trace
+			// after static destruction starts
+			static auto *const registry = new trace_registry_t{ };
+			return *registry;
+		}
+
+		/// Registers the calling thread's ring and retires it when the thread
+		/// exits
+		struct thread_ring_owner_t {
+			std::shared_ptr<trace_ring_t> ring = std::make_shared<trace_ring_t>( );
+
+			thread_ring_owner_t( ) {
+				auto &registry = trace_registry( );
+				auto const lck = std::lock_guard<std::mutex>( registry.mutex );
+				ring->tid = registry.next_tid++;
+				registry.rings.push_back( ring );
+			}
+
+			thread_ring_owner_t( thread_ring_owner_t const & ) = delete;
+			thread_ring_owner_t &operator=( thread_ring_owner_t const & ) = delete;
+
+			~thread_ring_owner_t( ) {
+				auto &registry = trace_registry( );
+				auto const lck = std::lock_guard<std::mutex>( registry.mutex );
+				ring->retired = true;
+				if( ring->head.load( std::memory_order_relaxed ) ==
+				    ring->start.load( std::memory_order_relaxed ) ) {
+					// Nothing to write, free it now
+					registry.rings.erase( std::find( registry.rings.begin( ),
+					                                 registry.rings.end( ), ring ) );
+				} else {
+					registry.drop_retired( max_retired_rings );
+				}
+			}
+		};
+
+		trace_ring_t &this_thread_ring( ) {
+			thread_local auto const owner = thread_ring_owner_t( );
+			return *owner.ring;
+		}
+
+		void write_json_string( std::ostream &os, char const *str ) {
+			static constexpr char const hex[] = "0123456789abcdef";
+			os << '"';
+			for( ; str and *str; ++str ) {
+				auto const c = static_cast<unsigned char>( *str );
+				if( c == '"' or c == '\\' ) {
+					os << '\\' << *str;
+				} else if( c < 0x20U ) {
+					os << "\\u00" << hex[c >> 4U] << hex[c & 0xFU];
+				} else {
+					os << *str;
+				}
+			}
+			os << '"';
+		}
+
+		// Chrome traces count in microseconds
+		void write_micros( std::ostream &os, std::int64_t ns ) {
+			auto const frac = static_cast<int>( ns % 1000 );
+			os << ns / 1000 << '.' << static_cast<char>( '0' + frac / 100 )
+			   << static_cast<char>( '0' + ( frac / 10 ) % 10 )
+			   << static_cast<char>( '0' + frac % 10 );
+		}
+	} // namespace
+
+	namespace impl {
+		std::int64_t trace_now( ) {
+			auto const epoch = trace_registry( ).epoch;
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			         std::chrono::steady_clock::now( ) - epoch )
+			  .count( );
+		}
+
+		void trace_record( trace_event_t const &event ) {
+			auto &ring = this_thread_ring( );
+			auto const head = ring.head.load( std::memory_order_relaxed );
+			ring.events[head % trace_ring_t::capacity] = event;
+			ring.head.store( head + 1U, std::memory_order_release );
+		}
+	} // namespace impl
+
+	void set_trace_thread_name( std::string name ) {
+		auto &ring = this_thread_ring( );
+		auto &registry = trace_registry( );
+		auto const lck = std::lock_guard<std::mutex>( registry.mutex );
+		ring.name = daw::move( name );
+	}
+
+	void write_chrome_trace( std::ostream &os ) {
+		auto &registry = trace_registry( );
+		auto const lck = std::lock_guard<std::mutex>( registry.mutex );
+		os << "{\"traceEvents\":[";
+		bool is_first = true;
+		auto const next_event = [&]( ) {
+			os << ( is_first ? "\n" : ",\n" );
+			is_first = false;
+		};
+		for( auto const &ring : registry.rings ) {
+			if( not ring->name.empty( ) ) {
+				next_event( );
+				os << R"({"name":"thread_name","ph":"M","pid":1,"tid":)"
+				   << ring->tid << R"(,"args":{"name":)";
+				write_json_string( os, ring->name.c_str( ) );
+				os << "}}";
+			}
+			auto const head = ring->head.load( std::memory_order_acquire );
+			auto const first =
+			  std::max( ring->start.load( std::memory_order_relaxed ),
+			            head > trace_ring_t::capacity
+			              ? head - trace_ring_t::capacity
+			              : std::size_t{ 0 } );
+			for( auto n = first; n < head; ++n ) {
+				auto const &event = ring->events[n % trace_ring_t::capacity];
+				next_event( );
+				os << R"({"name":)";
+				write_json_string( os, event.label );
+				if( event.phase == impl::trace_phase::instant ) {
+					os << R"(,"ph":"i","s":"t")";
+				} else {
+					os << R"(,"ph":"X","dur":)";
+					write_micros( os, event.end_ns - event.begin_ns );
+				}
+				os << R"(,"pid":1,"tid":)" << ring->tid << R"(,"ts":)";
+				write_micros( os, event.begin_ns );
+				if( event.has_arg ) {
+					os << R"(,"args":{"value":)" << event.arg << '}';
+				}
+				os << '}';
+			}
+		}
+		os << "\n]}\n";
+	}
+
+	void clear_trace( ) {
+		auto &registry = trace_registry( );
+		auto const lck = std::lock_guard<std::mutex>( registry.mutex );
+		registry.drop_retired( 0 );
+		for( auto const &ring : registry.rings ) {
+			ring->start.store( ring->head.load( std::memory_order_acquire ),
+			                   std::memory_order_relaxed );
+		}
+	}
+} // namespace daw
@@ -0,0 +1,114 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+
+void any_of_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto values = std::vector<std::int64_t>( 1'000'000 );
+	std::iota( values.begin( ), values.end( ), 0 );
+	namespace par = daw::algorithm::parallel;
+
+	auto const is_needle = []( std::int64_t v ) {
+		return v == 765'432;
+	};
+	daw::expecting(
+	  par::any_of( values.begin( ), values.end( ), is_needle, ts ) );
+	daw::expecting(
+	  not par::none_of( values.begin( ), values.end( ), is_needle, ts ) );
+	daw::expecting( not par::any_of( values.begin( ), values.end( ),
+	                                 []( std::int64_t v ) { return v < 0; },
+	                                 ts ) );
+	daw::expecting( par::all_of( values.begin( ), values.end( ),
+	                             []( std::int64_t v ) { return v >= 0; }, ts ) );
+	daw::expecting( not par::all_of( values.begin( ), values.end( ),
+	                                 []( std::int64_t v ) { return v != 10; },
+	                                 ts ) );
+	auto const empty = std::vector<std::int64_t>( );
+	daw::expecting(
+	  not par::any_of( empty.begin( ), empty.end( ), is_needle, ts ) );
+	daw::expecting( par::all_of( empty.begin( ), empty.end( ), is_needle, ts ) );
+}
+
+void any_of_early_exit_test_001( ) {
+	// A match at the front stops the parts behind it long before they finish
+	auto ts = daw::task_scheduler( 4U );
+	auto values = std::vector<std::int64_t>( 4'000'000, 1 );
+	values.front( ) = 0;
+	auto calls = std::atomic_size_t( 0U );
+	daw::expecting( daw::algorithm::parallel::any_of(
+	  values.begin( ), values.end( ),
+	  [&calls]( std::int64_t v ) {
+		  calls.fetch_add( 1U, std::memory_order_relaxed );
+		  return v == 0;
+	  },
+	  ts ) );
+	daw::expecting( calls.load( ) < values.size( ) );
+}
+
+void find_if_leftmost_test_001( ) {
+	// Every part holds matches, the first of them must win
+	auto ts = daw::task_scheduler( 4U );
+	auto values = std::vector<std::int64_t>( 1'000'000 );
+	std::iota( values.begin( ), values.end( ), 0 );
+	auto const pos = daw::algorithm::parallel::find_if(
+	  values.begin( ), values.end( ),
+	  []( std::int64_t v ) { return v % 100'000 == 99'999; }, ts );
+	daw::expecting( pos != values.end( ) );
+	daw::expecting( std::int64_t{ 99'999 }, *pos );
+}
+
+void equal_early_exit_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto a = std::vector<std::int64_t>( 4'000'000, 1 );
+	auto b = a;
+	daw::expecting( daw::algorithm::parallel::equal( a.begin( ), a.end( ),
+	                                                 b.begin( ), b.end( ), ts ) );
+	b.front( ) = 2;
+	auto calls = std::atomic_size_t( 0U );
+	daw::expecting( not daw::algorithm::parallel::equal(
+	  a.begin( ), a.end( ), b.begin( ), b.end( ),
+	  [&calls]( std::int64_t l, std::int64_t r ) {
+		  calls.fetch_add( 1U, std::memory_order_relaxed );
+		  return l == r;
+	  },
+	  ts ) );
+	daw::expecting( calls.load( ) < a.size( ) );
+}
+
+int main( ) {
+	any_of_test_001( );
+	any_of_early_exit_test_001( );
+	find_if_leftmost_test_001( );
+	equal_early_exit_test_001( );
+	std::cout << "any_of tests passed\n";
+}
@@ -0,0 +1,156 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+
+namespace par = daw::algorithm::parallel;
+
+std::vector<std::int64_t> make_values( std::size_t count ) {
+	auto rng = std::mt19937_64( count );
+	auto dist = std::uniform_int_distribution<std::int64_t>( 0, 9 );
+	auto result = std::vector<std::int64_t>( count );
+	for( auto &v : result ) {
+		v = dist( rng );
+	}
+	return result;
+}
+
+void copy_if_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto const is_odd = []( std::int64_t v ) { return v % 2 == 1; };
+	for( std::size_t count : { 0U, 10U, 1'000'000U } ) {
+		auto const values = make_values( count );
+		auto expected = std::vector<std::int64_t>( );
+		std::copy_if( values.begin( ), values.end( ),
+		              std::back_inserter( expected ), is_odd );
+		auto result = std::vector<std::int64_t>( values.size( ) );
+		auto const last = par::copy_if( values.begin( ), values.end( ),
+		                                result.begin( ), is_odd, ts );
+		result.erase( last, result.end( ) );
+		daw::expecting( result == expected );
+	}
+}
+
+void remove_if_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto values = std::vector<std::string>( 200'000 );
+	for( std::size_t n = 0; n < values.size( ); ++n ) {
+		values[n] = std::to_string( n );
+	}
+	auto expected = values;
+	auto const has_seven = []( std::string const &s ) {
+		return s.find( '7' ) != std::string::npos;
+	};
+	expected.erase(
+	  std::remove_if( expected.begin( ), expected.end( ), has_seven ),
+	  expected.end( ) );
+	values.erase( par::remove_if( values.begin( ), values.end( ), has_seven, ts ),
+	              values.end( ) );
+	daw::expecting( values == expected );
+}
+
+void stable_partition_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto values = make_values( 1'000'000U );
+	auto expected = values;
+	auto const is_small = []( std::int64_t v ) { return v < 3; };
+	auto const expected_mid =
+	  std::stable_partition( expected.begin( ), expected.end( ), is_small );
+	auto const mid =
+	  par::stable_partition( values.begin( ), values.end( ), is_small, ts );
+	daw::expecting( values == expected );
+	daw::expecting( std::distance( values.begin( ), mid ) ==
+	                std::distance( expected.begin( ), expected_mid ) );
+	auto const mid2 = par::partition( values.begin( ), values.end( ),
+	                                  []( std::int64_t v ) { return v >= 3; },
+	                                  ts );
+	daw::expecting( std::all_of( values.begin( ), mid2,
+	                             []( std::int64_t v ) { return v >= 3; } ) );
+	daw::expecting( std::none_of( mid2, values.end( ),
+	                              []( std::int64_t v ) { return v >= 3; } ) );
+}
+
+void unique_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto values = make_values( 1'000'000U );
+	auto expected = values;
+	expected.erase( std::unique( expected.begin( ), expected.end( ) ),
+	                expected.end( ) );
+	auto copy = values;
+	values.erase( par::unique( values.begin( ), values.end( ), ts ),
+	              values.end( ) );
+	daw::expecting( values == expected );
+	// Runs of values in the same group of three
+	expected = copy;
+	auto const same_group = []( std::int64_t l, std::int64_t r ) {
+		return l / 3 == r / 3;
+	};
+	expected.erase( std::unique( expected.begin( ), expected.end( ), same_group ),
+	                expected.end( ) );
+	copy.erase( par::unique( copy.begin( ), copy.end( ), same_group, ts ),
+	            copy.end( ) );
+	daw::expecting( copy == expected );
+}
+
+// A predicate that throws fails the copy instead of hanging it
+void copy_if_throws_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto values = make_values( 1'000'000 );
+	values[700'000] = 100;
+	auto result = std::vector<std::int64_t>( values.size( ) );
+	for( int n = 0; n < 3; ++n ) {
+		bool threw = false;
+		try {
+			(void)par::copy_if( values.begin( ), values.end( ), result.begin( ),
+			                    []( std::int64_t v ) {
+				                    if( v == 100 ) {
+					                    throw std::runtime_error( "bad value" );
+				                    }
+				                    return v % 2 == 1;
+			                    },
+			                    ts );
+		} catch( std::runtime_error const & ) { threw = true; }
+		daw::expecting( threw );
+	}
+}
+
+int main( ) {
+	copy_if_test_001( );
+	copy_if_throws_test_001( );
+	remove_if_test_001( );
+	stable_partition_test_001( );
+	unique_test_001( );
+	std::cout << "copy_if tests passed\n";
+}
@@ -0,0 +1,102 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+#include <daw/daw_random.h>
+#include <daw/daw_utility.h>
+
+#include "daw/fs/algorithms.h"
+
+#include "common.h"
+
+template<typename T>
+void copy_test( size_t SZ ) {
+	auto ts = daw::get_task_scheduler( );
+	auto const a = daw::make_random_data<T>( SZ );
+	auto b = std::vector<T>( SZ );
+	auto c = std::vector<T>( SZ );
+	auto const result_1 = daw::benchmark( [&]( ) {
+		daw::algorithm::parallel::copy( a.cbegin( ), a.cend( ), b.begin( ), ts );
+		daw::do_not_optimize( b );
+	} );
+	auto const result_2 = daw::benchmark( [&]( ) {
+		std::copy( a.cbegin( ), a.cend( ), c.begin( ) );
+		daw::do_not_optimize( c );
+	} );
+	daw::expecting( b == c );
+	auto const result_3 = daw::benchmark( [&]( ) {
+		daw::algorithm::parallel::copy( a.cbegin( ), a.cend( ), b.begin( ), ts );
+		daw::do_not_optimize( b );
+	} );
+	auto const result_4 = daw::benchmark( [&]( ) {
+		std::copy( a.cbegin( ), a.cend( ), c.begin( ) );
+		daw::do_not_optimize( c );
+	} );
+	daw::expecting( b == c );
+	auto const par_min = ( result_1 + result_3 ) / 2;
+	auto const seq_min = ( result_2 + result_4 ) / 2;
+	display_info( seq_min, par_min, SZ, sizeof( T ), "copy" );
+}
+
+void copy_int64_t( ) {
+	std::cout << "copy tests - int64_t\n";
+	for( size_t n = MAX_ITEMS; n >= 100; n /= 10 ) {
+		copy_test<int64_t>( n );
+	}
+}
+
+/// Large enough to be written with streamed stores, with the source and
+/// destination off the store boundaries by different amounts
+void copy_streamed( ) {
+	std::cout << "copy tests - streamed\n";
+	auto ts = daw::get_task_scheduler( );
+	auto const SZ =
+	  daw::parallel::cpu_cache_sizes( ).llc / sizeof( int32_t ) * 2U + 5U;
+	auto const a = daw::make_random_data<int32_t>( SZ + 1U );
+	auto b = std::vector<int32_t>( SZ + 3U, 0 );
+	auto const last_out = daw::algorithm::parallel::copy(
+	  std::next( a.cbegin( ) ), a.cend( ), std::next( b.begin( ), 2 ), ts );
+	daw::expecting( last_out == std::prev( b.end( ) ) );
+	daw::expecting( std::equal( std::next( a.cbegin( ) ), a.cend( ),
+	                            std::next( b.cbegin( ), 2 ) ) );
+	daw::expecting( 0, b.back( ) );
+
+	// Not trivially copyable, copied item by item
+	auto const strs = std::vector<std::string>( MAX_ITEMS, "copy" );
+	auto strs_out = std::vector<std::string>( MAX_ITEMS );
+	(void)daw::algorithm::parallel::copy( strs.cbegin( ), strs.cend( ),
+	                                      strs_out.begin( ), ts );
+	daw::expecting( strs == strs_out );
+}
+
+int main( ) {
+	copy_int64_t( );
+	copy_streamed( );
+}
@@ -0,0 +1,165 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+
+namespace par = daw::algorithm::parallel;
+
+void should_run_inline_test( daw::task_scheduler const &ts ) {
+	using par::impl::min_parallel_work;
+	using par::impl::should_run_inline;
+	daw::expecting( should_run_inline<int64_t>( 1'000, par::cost_hint{ }, ts ) );
+	daw::expecting(
+	  not should_run_inline<int64_t>( min_parallel_work, par::cost_hint{ }, ts ) );
+	// Expensive items make small inputs worth splitting
+	daw::expecting(
+	  not should_run_inline<int64_t>( 1'000, par::cost_hint{ 1'000 }, ts ) );
+	// Large items count as more work each
+	struct big_t {
+		int64_t values[16];
+	};
+	daw::expecting( not should_run_inline<big_t>( min_parallel_work / 8,
+	                                              par::cost_hint{ }, ts ) );
+	// No overflow with silly hints
+	daw::expecting( not should_run_inline<int64_t>(
+	  2, par::cost_hint{ std::numeric_limits<size_t>::max( ) / 2 }, ts ) );
+}
+
+void small_input_runs_on_caller_test( daw::task_scheduler ts ) {
+	auto data = std::vector<int64_t>( 1'000, 1 );
+	auto const caller = std::this_thread::get_id( );
+	bool all_on_caller = true;
+	par::for_each(
+	  data.begin( ), data.end( ),
+	  [&]( int64_t ) {
+		  all_on_caller &= std::this_thread::get_id( ) == caller;
+	  },
+	  ts );
+	daw::expecting( all_on_caller );
+}
+
+void results_match_test( daw::task_scheduler ts, size_t sz,
+                         par::cost_hint hint ) {
+	auto data = std::vector<int64_t>( sz );
+	par::fill( data.begin( ), data.end( ), int64_t{ 2 }, ts, hint );
+	daw::expecting( static_cast<int64_t>( sz * 2 ),
+	                par::reduce( data.cbegin( ), data.cend( ), int64_t{ 0 },
+	                             std::plus<>{ }, ts, hint ) );
+
+	std::iota( data.begin( ), data.end( ), 0 );
+	auto out = std::vector<int64_t>( sz );
+	par::transform(
+	  data.cbegin( ), data.cend( ), out.begin( ),
+	  []( int64_t v ) { return v * 2; }, ts, hint );
+	daw::expecting( int64_t{ 2 } * static_cast<int64_t>( sz - 1 ), out.back( ) );
+
+	daw::expecting( static_cast<ptrdiff_t>( sz / 2 ),
+	                par::count_if(
+	                  data.cbegin( ), data.cend( ),
+	                  []( int64_t v ) { return v % 2 == 0; }, ts, hint ) );
+
+	auto const it = par::find_if(
+	  data.cbegin( ), data.cend( ),
+	  []( int64_t v ) { return v == 7; }, ts, hint );
+	daw::expecting( int64_t{ 7 }, *it );
+
+	daw::expecting( int64_t{ 0 },
+	                *par::min_element( data.cbegin( ), data.cend( ), ts,
+	                                   std::less<>{ }, hint ) );
+	daw::expecting( static_cast<int64_t>( sz - 1 ),
+	                *par::max_element( data.cbegin( ), data.cend( ), ts,
+	                                   std::less<>{ }, hint ) );
+
+	daw::expecting( par::equal( data.cbegin( ), data.cend( ), data.cbegin( ),
+	                            data.cend( ), ts, hint ) );
+
+	par::scan( data.cbegin( ), data.cend( ), out.begin( ), out.end( ),
+	           std::plus<>{ }, ts, hint );
+	auto expected = std::vector<int64_t>( sz );
+	std::partial_sum( data.cbegin( ), data.cend( ), expected.begin( ) );
+	daw::expecting( expected == out );
+}
+
+void bandwidth_bound_test( ) {
+	using par::impl::bandwidth_worker_count;
+	using par::impl::is_bandwidth_bound;
+	daw::expecting( is_bandwidth_bound( par::cost_hint{ } ) );
+	daw::expecting( not is_bandwidth_bound( par::cost_hint{ 1'000 } ) );
+
+	auto const nodes = daw::parallel::cpu_topology::get( ).node_count( );
+	auto config = daw::task_scheduler_config{ };
+	config.num_threads = 4U;
+	config.bandwidth_workers_per_node = 1U;
+	auto ts = daw::task_scheduler( config );
+	daw::expecting( ts.bandwidth_workers_per_node( ) == 1U );
+	daw::expecting( bandwidth_worker_count( ts ) ==
+	                std::min<size_t>( 4U, nodes ) );
+	config.bandwidth_workers_per_node = 0U;
+	daw::expecting( bandwidth_worker_count( daw::task_scheduler( config ) ) ==
+	                4U );
+
+	// A cheap op stays on the bandwidth workers, a costly one may use them all
+	constexpr size_t sz = 1'000'000U;
+	auto data = std::vector<int64_t>( sz );
+	std::iota( data.begin( ), data.end( ), 0 );
+	auto out = std::vector<int64_t>( sz );
+	auto mut = std::mutex( );
+	auto threads = std::set<std::thread::id>( );
+	auto const op = [&]( int64_t v ) {
+		auto const lck = std::lock_guard<std::mutex>( mut );
+		threads.insert( std::this_thread::get_id( ) );
+		return v * 2;
+	};
+	par::transform( data.cbegin( ), data.cend( ), out.begin( ), op, ts );
+	daw::expecting( threads.size( ) <= bandwidth_worker_count( ts ) );
+	daw::expecting( int64_t{ 2 } * static_cast<int64_t>( sz - 1 ), out.back( ) );
+
+	std::fill( out.begin( ), out.end( ), int64_t{ 0 } );
+	par::transform( data.cbegin( ), data.cend( ), out.begin( ), op, ts,
+	                par::cost_hint{ 1'000 } );
+	daw::expecting( int64_t{ 2 } * static_cast<int64_t>( sz - 1 ), out.back( ) );
+	daw::expecting( std::all_of( out.begin( ), out.end( ), []( int64_t v ) {
+		return v % 2 == 0;
+	} ) );
+}
+
+int main( ) {
+	auto ts = daw::task_scheduler( 4U );
+	should_run_inline_test( ts );
+	small_input_runs_on_caller_test( ts );
+	results_match_test( ts, 1'000, par::cost_hint{ } );
+	results_match_test( ts, 1'000, par::cost_hint{ 1'000 } );
+	results_match_test( ts, 200'000, par::cost_hint{ } );
+	bandwidth_bound_test( );
+	std::cout << "cost model tests passed\n";
+}
@@ -61,6 +61,11 @@ void fill_test( size_t SZ ) {
 		std::fill( a.begin( ), a.end( ), 4 );
 		daw::do_not_optimize( a );
 	} );
+	daw::expecting( std::all_of( a.cbegin( ), a.cend( ),
+	                             []( T const &v ) { return v == T( 4 ); } ) );
+	daw::algorithm::parallel::fill( a.begin( ), a.end( ), 5, ts );
+	daw::expecting( std::all_of( a.cbegin( ), a.cend( ),
+	                             []( T const &v ) { return v == T( 5 ); } ) );
 	auto const par_min = ( result_1 + result_3 ) / 2;
 	auto const seq_min = ( result_2 + result_4 ) / 2;
 	display_info( seq_min, par_min, SZ, sizeof( T ), "fill" );
@@ -87,8 +92,25 @@ void fill_int32_t( ) {
 	}
 }
 
+/// Large enough to be written with streamed stores, starting off the store
+/// boundaries
+void fill_streamed( ) {
+	std::cout << "fill tests - streamed\n";
+	auto ts = daw::get_task_scheduler( );
+	auto const SZ =
+	  daw::parallel::cpu_cache_sizes( ).llc / sizeof( int32_t ) * 2U;
+	auto a = std::vector<int32_t>( SZ + 2U, 0 );
+	daw::algorithm::parallel::fill( std::next( a.begin( ) ),
+	                                std::prev( a.end( ) ), 7, ts );
+	daw::expecting( 0, a.front( ) );
+	daw::expecting( 0, a.back( ) );
+	daw::expecting( std::all_of( std::next( a.cbegin( ) ), std::prev( a.cend( ) ),
+	                             []( int32_t v ) { return v == 7; } ) );
+}
+
 int main( ) {
 	fill_double( );
 	fill_int64_t( );
 	fill_int32_t( );
+	fill_streamed( );
 }
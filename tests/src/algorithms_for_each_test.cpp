@@ -27,6 +27,7 @@
 #include <date/date.h>
 #include <iostream>
 #include <numeric>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
@@ -97,7 +98,26 @@ void for_each_int32_t( ) {
 	}
 }
 
+void for_each_throws_test( ) {
+	auto ts = daw::get_task_scheduler( );
+	auto a = std::vector<int>( MAX_ITEMS, 1 );
+	a[a.size( ) / 2] = 4;
+	bool caught = false;
+	try {
+		daw::algorithm::parallel::for_each(
+		  a.cbegin( ), a.cend( ),
+		  []( int x ) {
+			  if( x == 4 ) {
+				  throw std::runtime_error( "bad element" );
+			  }
+		  },
+		  ts );
+	} catch( std::runtime_error const & ) { caught = true; }
+	daw::expecting( caught );
+}
+
 int main( ) {
+	for_each_throws_test( );
 	for_each_double( );
 	for_each_int64_t( );
 	for_each_int32_t( );
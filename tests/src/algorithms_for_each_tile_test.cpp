@@ -0,0 +1,147 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2017-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+#include <daw/daw_random.h>
+
+#include "daw/fs/algorithms.h"
+
+#include "common.h"
+
+namespace par = daw::algorithm::parallel;
+
+/// Every index is in exactly one tile, whatever the order
+template<std::size_t N>
+void cover_test( par::extents<N> const &space, par::extents<N> const &shape,
+                 par::tile_order order ) {
+	auto ts = daw::get_task_scheduler( );
+	std::size_t total = 1;
+	for( auto e : space ) {
+		total *= e;
+	}
+	auto visits = std::vector<std::atomic_int>( total );
+	par::for_each_tile(
+	  space, shape,
+	  [&]( par::tile_bounds<N> const &tile ) {
+		  auto idx = tile.first;
+		  while( true ) {
+			  std::size_t flat = 0;
+			  for( std::size_t d = 0; d < N; ++d ) {
+				  daw::expecting( tile.size( d ) <= shape[d] );
+				  flat = flat * space[d] + idx[d];
+			  }
+			  ++visits[flat];
+			  auto d = N;
+			  while( d-- > 0 and ++idx[d] == tile.last[d] ) {
+				  idx[d] = tile.first[d];
+			  }
+			  if( d >= N ) {
+				  break;
+			  }
+		  }
+	  },
+	  order, ts );
+	daw::expecting( std::all_of( visits.begin( ), visits.end( ),
+	                             []( auto const &v ) { return v == 1; } ) );
+}
+
+void cover_tests( ) {
+	std::cout << "for_each_tile tests - cover\n";
+	for( auto order : { par::tile_order::row_major, par::tile_order::morton,
+	                    par::tile_order::hilbert } ) {
+		cover_test<2>( { 1'000U, 777U }, { 64U, 48U }, order );
+		cover_test<2>( { 3U, 5U }, { 8U, 8U }, order );
+	}
+	cover_test<1>( { 100'000U }, { 4'096U }, par::tile_order::morton );
+	cover_test<3>( { 61U, 70U, 129U }, { 16U, 16U, 32U },
+	               par::tile_order::morton );
+	cover_test<3>( { 61U, 70U, 129U }, { 16U, 16U, 32U },
+	               par::tile_order::row_major );
+	cover_test<2>( { 0U, 10U }, { 4U, 4U }, par::tile_order::morton );
+
+	// Consecutive tiles along a Hilbert curve share an edge
+	auto const tiles = daw::algorithm::parallel::impl::make_tiles<2>(
+	  { 64U, 64U }, { 8U, 8U }, par::tile_order::hilbert );
+	daw::expecting( 64U, tiles.size( ) );
+	for( std::size_t n = 1; n < tiles.size( ); ++n ) {
+		auto const dist = [&]( std::size_t d ) {
+			return std::max( tiles[n].first[d], tiles[n - 1].first[d] ) -
+			       std::min( tiles[n].first[d], tiles[n - 1].first[d] );
+		};
+		daw::expecting( 8U, dist( 0 ) + dist( 1 ) );
+	}
+
+	auto const shape = par::cache_tile_shape<2>( sizeof( double ) );
+	daw::expecting( shape[0] > 0 and shape[1] > 0 );
+	daw::expecting( shape[1] % ( daw::parallel::cache_line_size /
+	                             sizeof( double ) ) ==
+	                0 );
+}
+
+/// Transpose a matrix tile by tile
+void transpose_test( std::size_t SZ ) {
+	auto ts = daw::get_task_scheduler( );
+	auto const a = daw::make_random_data<int64_t>( SZ * SZ );
+	auto b = std::vector<int64_t>( SZ * SZ );
+	auto c = std::vector<int64_t>( SZ * SZ );
+	auto const shape = par::extents<2>{ 64U, 64U };
+	auto const result_1 = daw::benchmark( [&]( ) {
+		par::for_each_tile(
+		  par::extents<2>{ SZ, SZ }, shape,
+		  [&]( par::tile_bounds<2> const &tile ) {
+			  for( auto i = tile.first[0]; i < tile.last[0]; ++i ) {
+				  for( auto j = tile.first[1]; j < tile.last[1]; ++j ) {
+					  b[j * SZ + i] = a[i * SZ + j];
+				  }
+			  }
+		  },
+		  par::tile_order::morton, ts );
+		daw::do_not_optimize( b );
+	} );
+	auto const result_2 = daw::benchmark( [&]( ) {
+		for( std::size_t i = 0; i < SZ; ++i ) {
+			for( std::size_t j = 0; j < SZ; ++j ) {
+				c[j * SZ + i] = a[i * SZ + j];
+			}
+		}
+		daw::do_not_optimize( c );
+	} );
+	daw::expecting( b == c );
+	display_info( result_2, result_1, SZ * SZ, sizeof( int64_t ),
+	              "for_each_tile transpose" );
+}
+
+int main( ) {
+	cover_tests( );
+	std::cout << "for_each_tile tests - transpose\n";
+	for( std::size_t n = 2'048U; n >= 64U; n /= 4U ) {
+		transpose_test( n );
+	}
+}
@@ -0,0 +1,108 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+
+using lazy_t = daw::algorithm::parallel::lazy_range_splitter<64>;
+namespace impl = daw::algorithm::parallel::impl;
+
+void for_each_test( daw::task_scheduler ts ) {
+	auto data = std::vector<int64_t>( 100'000 );
+	impl::parallel_for_each<lazy_t>(
+	  daw::view( data.begin( ), data.end( ) ), []( int64_t &v ) { v = 1; }, ts );
+	daw::expecting( static_cast<int64_t>( data.size( ) ),
+	                std::accumulate( data.begin( ), data.end( ), int64_t{ 0 } ) );
+}
+
+void uneven_for_each_test( daw::task_scheduler ts ) {
+	// Items near the front cost far more than the rest
+	auto data = std::vector<int64_t>( 100'000 );
+	std::iota( data.begin( ), data.end( ), 0 );
+	auto sum = std::atomic<int64_t>( 0 );
+	impl::parallel_for_each<lazy_t>(
+	  daw::view( data.begin( ), data.end( ) ),
+	  [&sum]( int64_t v ) {
+		  int64_t x = v;
+		  for( int64_t n = 0; n < ( v < 100 ? 100'000 : 10 ); ++n ) {
+			  x = ( x * 31 + n ) % 1'000'003;
+		  }
+		  daw::do_not_optimize( x );
+		  sum += v;
+	  },
+	  ts );
+	daw::expecting( int64_t{ ( 99'999LL * 100'000LL ) / 2 }, sum.load( ) );
+}
+
+void reduce_test( daw::task_scheduler ts ) {
+	auto data = std::vector<int64_t>( 100'001 );
+	std::iota( data.begin( ), data.end( ), 0 );
+	auto const result = impl::parallel_reduce<lazy_t>(
+	  daw::view( data.cbegin( ), data.cend( ) ), int64_t{ 0 }, std::plus<>{ },
+	  ts );
+	daw::expecting( int64_t{ ( 100'000LL * 100'001LL ) / 2 }, result );
+}
+
+void map_reduce_test( daw::task_scheduler ts ) {
+	auto data = std::vector<int64_t>( 100'000, 3 );
+	auto const result = impl::parallel_map_reduce<lazy_t>(
+	  daw::view( data.cbegin( ), data.cend( ) ), int64_t{ 0 },
+	  []( int64_t v ) { return v * 2; }, std::plus<>{ }, ts );
+	daw::expecting( int64_t{ 600'000 }, result );
+}
+
+void find_if_test( daw::task_scheduler ts ) {
+	auto data = std::vector<int64_t>( 100'000 );
+	std::iota( data.begin( ), data.end( ), 0 );
+	auto const it = impl::parallel_find_if<lazy_t>(
+	  daw::view( data.cbegin( ), data.cend( ) ),
+	  []( int64_t v ) { return v >= 54'321; }, ts );
+	daw::expecting( it != data.cend( ) );
+	daw::expecting( int64_t{ 54'321 }, *it );
+}
+
+void tiny_input_test( daw::task_scheduler ts ) {
+	auto data = std::vector<int64_t>( 3, 1 );
+	auto const result = impl::parallel_reduce<lazy_t>(
+	  daw::view( data.cbegin( ), data.cend( ) ), int64_t{ 0 }, std::plus<>{ },
+	  ts );
+	daw::expecting( int64_t{ 3 }, result );
+}
+
+int main( ) {
+	// Enough workers that splitting happens even on small machines
+	auto ts = daw::task_scheduler( 4U );
+	for_each_test( ts );
+	uneven_for_each_test( ts );
+	reduce_test( ts );
+	map_reduce_test( ts );
+	find_if_test( ts );
+	tiny_input_test( ts );
+	std::cout << "lazy split tests passed\n";
+}
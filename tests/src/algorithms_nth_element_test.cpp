@@ -0,0 +1,100 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+
+namespace par = daw::algorithm::parallel;
+
+std::vector<std::int64_t> make_values( std::size_t count,
+                                       std::int64_t max_value ) {
+	auto rng = std::mt19937_64( count );
+	auto dist = std::uniform_int_distribution<std::int64_t>( 0, max_value );
+	auto result = std::vector<std::int64_t>( count );
+	for( auto &v : result ) {
+		v = dist( rng );
+	}
+	return result;
+}
+
+void nth_element_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	// Mostly distinct values, then many duplicates
+	for( std::int64_t max_value : { 1'000'000'000, 10 } ) {
+		auto values = make_values( 1'000'000U, max_value );
+		auto sorted = values;
+		std::sort( sorted.begin( ), sorted.end( ) );
+		for( std::size_t pos : { 0U, 1U, 500'000U, 999'999U } ) {
+			auto const nth = std::next( values.begin( ), static_cast<long>( pos ) );
+			par::nth_element( values.begin( ), nth, values.end( ), ts );
+			daw::expecting( *nth == sorted[pos] );
+			daw::expecting( std::all_of(
+			  values.begin( ), nth, [&]( std::int64_t v ) { return v <= *nth; } ) );
+			daw::expecting( std::all_of(
+			  nth, values.end( ), [&]( std::int64_t v ) { return v >= *nth; } ) );
+		}
+	}
+}
+
+void partial_sort_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto values = make_values( 1'000'000U, 1'000'000'000 );
+	auto sorted = values;
+	std::sort( sorted.begin( ), sorted.end( ), std::greater<>{ } );
+	auto const middle = std::next( values.begin( ), 10'000 );
+	par::partial_sort( values.begin( ), middle, values.end( ), ts,
+	                   std::greater<>{ } );
+	daw::expecting( std::equal( values.begin( ), middle, sorted.begin( ) ) );
+}
+
+void top_k_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto const values = make_values( 1'000'000U, 1'000'000'000 );
+	auto sorted = values;
+	std::sort( sorted.begin( ), sorted.end( ) );
+	auto const top = par::top_k( values.begin( ), values.end( ), 100U, ts );
+	daw::expecting( top.size( ) == 100U );
+	daw::expecting( std::equal( top.begin( ), top.end( ), sorted.begin( ) ) );
+	auto const all = par::top_k( values.begin( ), std::next( values.begin( ), 5 ),
+	                             100U, ts );
+	daw::expecting( all.size( ) == 5U );
+	daw::expecting( std::is_sorted( all.begin( ), all.end( ) ) );
+	daw::expecting(
+	  par::top_k( values.begin( ), values.end( ), 0U, ts ).empty( ) );
+}
+
+int main( ) {
+	nth_element_test_001( );
+	partial_sort_test_001( );
+	top_k_test_001( );
+	std::cout << "nth_element tests passed\n";
+}
@@ -0,0 +1,149 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+#include "daw/fs/pipeline.h"
+
+namespace par = daw::algorithm::parallel;
+
+std::vector<int64_t> make_data( size_t sz ) {
+	auto result = std::vector<int64_t>( sz );
+	std::iota( result.begin( ), result.end( ), int64_t{ -1'000 } );
+	return result;
+}
+
+constexpr auto square = []( int64_t v ) { return v * v; };
+constexpr auto is_odd = []( int64_t v ) { return v % 2 != 0; };
+constexpr auto plus = []( int64_t lhs, int64_t rhs ) { return lhs + rhs; };
+
+void pipeline_test( daw::task_scheduler ts, size_t sz ) {
+	auto const data = make_data( sz );
+
+	auto expected = std::vector<int64_t>( );
+	for( auto v : data ) {
+		if( is_odd( v ) ) {
+			auto const sq = square( v );
+			if( sq % 3 == 0 ) {
+				expected.push_back( sq + 1 );
+			}
+		}
+	}
+	auto const p = par::pipeline( data.cbegin( ), data.cend( ) )
+	                 .filter( is_odd )
+	                 .map( square )
+	                 .filter( []( int64_t v ) { return v % 3 == 0; } )
+	                 .map( []( int64_t v ) { return v + 1; } );
+
+	daw::expecting( std::accumulate( expected.cbegin( ), expected.cend( ),
+	                                 int64_t{ 5 } ),
+	                p.reduce( int64_t{ 5 }, plus, ts ) );
+	daw::expecting( expected.size( ), p.count( ts ) );
+	daw::expecting( p.to_vector( ts ) == expected );
+
+	auto sum = std::atomic<int64_t>( 0 );
+	p.for_each( [&sum]( int64_t v ) { sum += v; }, ts );
+	daw::expecting(
+	  std::accumulate( expected.cbegin( ), expected.cend( ), int64_t{ 0 } ),
+	  sum.load( ) );
+
+	if( sz < 3 ) {
+		// map_reduce needs at least 2 items after the first
+		return;
+	}
+	// map_reduce written as a pipeline
+	daw::expecting(
+	  par::map_reduce( data.cbegin( ), data.cend( ), square, plus, ts ),
+	  par::pipeline( data.cbegin( ) + 1, data.cend( ) )
+	    .map( square )
+	    .reduce( square( data.front( ) ), plus, ts ) );
+}
+
+void type_change_test( daw::task_scheduler ts ) {
+	auto const data = make_data( 200'000 );
+	auto const strs =
+	  par::pipeline( data.cbegin( ), data.cend( ) )
+	    .filter( []( int64_t v ) { return v >= 0 and v % 1'000 == 0; } )
+	    .map( []( int64_t v ) { return std::to_string( v ); } )
+	    .to_vector( ts );
+	daw::expecting( size_t{ 199 }, strs.size( ) );
+	daw::expecting( strs.front( ) == "0" );
+	daw::expecting( strs.back( ) == "198000" );
+	auto const total_len =
+	  par::pipeline( strs.cbegin( ), strs.cend( ) )
+	    .map( []( std::string const &s ) { return s.size( ); } )
+	    .reduce( size_t{ 0 }, std::plus<>{ }, ts );
+	auto expected_len = size_t{ 0 };
+	for( auto const &s : strs ) {
+		expected_len += s.size( );
+	}
+	daw::expecting( expected_len, total_len );
+}
+
+// The same filter, map and reduce as three separate algorithms with buffers
+// between them versus one fused pass
+void bench_test( daw::task_scheduler ts, size_t sz ) {
+	auto const data = make_data( sz );
+	int64_t fused_result = 0;
+	int64_t staged_result = 0;
+	auto const fused_time = daw::benchmark( [&]( ) {
+		fused_result = par::pipeline( data.cbegin( ), data.cend( ) )
+		                 .filter( is_odd )
+		                 .map( square )
+		                 .reduce( int64_t{ 0 }, plus, ts );
+		daw::do_not_optimize( fused_result );
+	} );
+	auto const staged_time = daw::benchmark( [&]( ) {
+		auto odd = std::vector<int64_t>( );
+		std::copy_if( data.cbegin( ), data.cend( ), std::back_inserter( odd ),
+		              is_odd );
+		auto squares = std::vector<int64_t>( odd.size( ) );
+		par::transform( odd.cbegin( ), odd.cend( ), squares.begin( ), square, ts );
+		staged_result =
+		  par::reduce( squares.cbegin( ), squares.cend( ), int64_t{ 0 }, plus, ts );
+		daw::do_not_optimize( staged_result );
+	} );
+	daw::expecting( staged_result, fused_result );
+	std::cout << "pipeline " << sz << " items: fused " << fused_time
+	          << "s, staged " << staged_time << "s\n";
+}
+
+int main( ) {
+	auto ts = daw::task_scheduler( 4U );
+	for( size_t sz : { 2U, 100U, 10'000U, 1'000'003U } ) {
+		pipeline_test( ts, sz );
+	}
+	type_change_test( ts );
+
+	bench_test( ts, 10'000'000 );
+	std::cout << "pipeline tests passed\n";
+}
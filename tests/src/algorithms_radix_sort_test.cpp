@@ -0,0 +1,112 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+
+namespace par = daw::algorithm::parallel;
+
+template<typename T>
+std::vector<T> make_data( size_t sz ) {
+	auto rng = std::mt19937_64( sz );
+	auto result = std::vector<T>( sz );
+	if constexpr( std::is_floating_point_v<T> ) {
+		auto dist = std::uniform_real_distribution<T>( -1e6, 1e6 );
+		for( auto &v : result ) {
+			v = dist( rng );
+		}
+	} else {
+		auto dist = std::uniform_int_distribution<T>(
+		  std::numeric_limits<T>::min( ), std::numeric_limits<T>::max( ) );
+		for( auto &v : result ) {
+			v = dist( rng );
+		}
+	}
+	return result;
+}
+
+template<typename T>
+void radix_sort_test( daw::task_scheduler ts, size_t sz ) {
+	auto data = make_data<T>( sz );
+	auto expected = data;
+	std::sort( expected.begin( ), expected.end( ) );
+	par::radix_sort( data.begin( ), data.end( ), ts );
+	daw::expecting( expected == data );
+}
+
+void radix_key_order_test( ) {
+	using par::impl::to_radix_key;
+	daw::expecting( to_radix_key( int32_t{ -5 } ) < to_radix_key( int32_t{ 3 } ) );
+	daw::expecting( to_radix_key( std::numeric_limits<int64_t>::min( ) ) <
+	                to_radix_key( int64_t{ -1 } ) );
+	daw::expecting( to_radix_key( -2.5 ) < to_radix_key( -1.0 ) );
+	daw::expecting( to_radix_key( -0.0 ) < to_radix_key( 0.0 ) );
+	daw::expecting( to_radix_key( 1.0f ) < to_radix_key( 2.0f ) );
+	daw::expecting( to_radix_key( -std::numeric_limits<double>::infinity( ) ) <
+	                to_radix_key( std::numeric_limits<double>::lowest( ) ) );
+}
+
+struct record_t {
+	uint16_t key;
+	size_t position;
+};
+
+void radix_sort_key_test( daw::task_scheduler ts, size_t sz ) {
+	// Few distinct keys, many ties that must keep their order
+	auto const keys = make_data<uint16_t>( sz );
+	auto data = std::vector<record_t>( sz );
+	for( size_t n = 0; n < sz; ++n ) {
+		data[n] = record_t{ static_cast<uint16_t>( keys[n] % 64U ), n };
+	}
+	auto scratch = std::vector<record_t>( sz );
+	par::radix_sort( data.begin( ), data.end( ),
+	                 daw::view( scratch.begin( ), scratch.end( ) ), ts,
+	                 []( record_t const &r ) { return r.key; } );
+	daw::expecting( std::is_sorted( data.begin( ), data.end( ),
+	                                []( record_t const &lhs, record_t const &rhs ) {
+		                                return lhs.key < rhs.key or
+		                                       ( lhs.key == rhs.key and
+		                                         lhs.position < rhs.position );
+	                                } ) );
+}
+
+int main( ) {
+	auto ts = daw::task_scheduler( 4U );
+	radix_key_order_test( );
+	for( size_t sz : { 0, 1, 1'000, 100'000, 1'000'003 } ) {
+		radix_sort_test<uint32_t>( ts, sz );
+		radix_sort_test<int64_t>( ts, sz );
+		radix_sort_test<int16_t>( ts, sz );
+		radix_sort_test<double>( ts, sz );
+		radix_sort_test<float>( ts, sz );
+		radix_sort_key_test( ts, sz );
+	}
+	std::cout << "radix sort tests passed\n";
+}
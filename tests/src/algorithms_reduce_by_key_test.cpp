@@ -0,0 +1,106 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+
+void reduce_by_key_test_001( ) {
+	// Many more keys than workers, with collisions in the low bits
+	auto ts = daw::task_scheduler( 4U );
+	auto rng = std::mt19937_64( 1 );
+	auto dist = std::uniform_int_distribution<std::int64_t>( 0, 5'000 );
+	auto values = std::vector<std::int64_t>( 1'000'000 );
+	for( auto &v : values ) {
+		v = dist( rng ) * 1024;
+	}
+	auto expected = std::map<std::int64_t, std::int64_t>( );
+	for( auto v : values ) {
+		expected[v] += v / 1024;
+	}
+	auto const result = daw::algorithm::parallel::reduce_by_key(
+	  values.begin( ), values.end( ), []( std::int64_t v ) { return v; },
+	  []( std::int64_t v ) { return v / 1024; },
+	  []( std::int64_t lhs, std::int64_t rhs ) { return lhs + rhs; }, ts );
+	daw::expecting( result.size( ) == expected.size( ) );
+	auto const actual =
+	  std::map<std::int64_t, std::int64_t>( result.begin( ), result.end( ) );
+	daw::expecting( actual == expected );
+}
+
+void reduce_by_key_test_002( ) {
+	// Word counts, run inline for the empty and single worker cases too
+	auto const words = std::vector<std::string>{ "a", "bb", "a", "c", "bb", "a" };
+	for( std::size_t workers : { 1U, 4U } ) {
+		auto ts = daw::task_scheduler( workers );
+		auto const counts = daw::algorithm::parallel::reduce_by_key(
+		  words.begin( ), words.end( ), []( std::string const &w ) { return w; },
+		  []( std::string const & ) { return std::size_t{ 1 }; },
+		  []( std::size_t lhs, std::size_t rhs ) { return lhs + rhs; }, ts );
+		auto const actual =
+		  std::map<std::string, std::size_t>( counts.begin( ), counts.end( ) );
+		daw::expecting( actual ==
+		                std::map<std::string, std::size_t>{
+		                  { "a", 3U }, { "bb", 2U }, { "c", 1U } } );
+	}
+	auto const empty = std::vector<int>( );
+	auto const none = daw::algorithm::parallel::reduce_by_key(
+	  empty.begin( ), empty.end( ), []( int v ) { return v; },
+	  []( int v ) { return v; }, []( int l, int r ) { return l + r; } );
+	daw::expecting( none.empty( ) );
+}
+
+void group_by_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto values = std::vector<std::int64_t>( 500'000 );
+	for( std::size_t n = 0; n < values.size( ); ++n ) {
+		values[n] = static_cast<std::int64_t>( n );
+	}
+	auto const groups = daw::algorithm::parallel::group_by(
+	  values.begin( ), values.end( ), []( std::int64_t v ) { return v % 7; },
+	  ts );
+	daw::expecting( groups.size( ) == 7U );
+	std::size_t total = 0;
+	for( auto const &group : groups ) {
+		for( auto v : group.second ) {
+			daw::expecting( v % 7 == group.first );
+		}
+		total += group.second.size( );
+	}
+	daw::expecting( total == values.size( ) );
+}
+
+int main( ) {
+	reduce_by_key_test_001( );
+	reduce_by_key_test_002( );
+	group_by_test_001( );
+	std::cout << "reduce_by_key tests passed\n";
+}
@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdint>
 #include <cstdlib>
@@ -156,9 +157,47 @@ void reduce3_double( ) {
 	}
 }
 
+/// The same blocks give bit for bit the same sums, whatever the pool size
+void reduce_deterministic( ) {
+	std::cout << "reduce tests - deterministic\n";
+	auto const a = daw::make_random_data<int64_t>( MAX_ITEMS, -1'000, 1'000 );
+	auto b = std::vector<double>( MAX_ITEMS );
+	std::transform( a.cbegin( ), a.cend( ), b.begin( ), []( int64_t v ) {
+		return static_cast<double>( v ) / 7.0;
+	} );
+	auto const opts = daw::algorithm::parallel::deterministic{ 1'000U };
+	auto const compensated =
+	  daw::algorithm::parallel::deterministic{ 1'000U, true };
+	auto const square = []( double v ) { return v * v; };
+
+	auto const run = [&]( daw::task_scheduler ts ) {
+		return std::array<double, 3>{
+		  daw::algorithm::parallel::reduce( b.cbegin( ), b.cend( ), 0.5, opts, ts ),
+		  daw::algorithm::parallel::reduce( b.cbegin( ), b.cend( ), 0.5,
+		                                    compensated, ts ),
+		  daw::algorithm::parallel::map_reduce( b.cbegin( ), b.cend( ), 2.0,
+		                                        square, std::plus<>{ }, opts,
+		                                        ts ) };
+	};
+	auto const expected = run( daw::task_scheduler( 1U ) );
+	daw::expecting( expected == run( daw::task_scheduler( 2U ) ) );
+	daw::expecting( expected == run( daw::task_scheduler( 7U ) ) );
+	daw::expecting( daw::math::nearly_equal(
+	  expected[0], std::accumulate( b.cbegin( ), b.cend( ), 0.5 ) ) );
+
+	// Each 1.0 is lost when added to 1e16 without compensation
+	auto c = std::vector<double>( MAX_ITEMS, 1.0 );
+	c.front( ) = 1e16;
+	c.back( ) = -1e16;
+	daw::expecting( static_cast<double>( MAX_ITEMS - 2U ),
+	                daw::algorithm::parallel::reduce( c.cbegin( ), c.cend( ), 0.0,
+	                                                  compensated ) );
+}
+
 int main( ) {
 	reduce_double( );
 	reduce_int64_t( );
 	reduce2_int64_t( );
 	reduce3_double( );
+	reduce_deterministic( );
 }
@@ -0,0 +1,171 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+
+namespace par = daw::algorithm::parallel;
+
+std::vector<int64_t> make_data( size_t sz ) {
+	auto rng = std::mt19937_64( sz );
+	auto dist = std::uniform_int_distribution<int64_t>( -1'000, 1'000 );
+	auto result = std::vector<int64_t>( sz );
+	for( auto &v : result ) {
+		v = dist( rng );
+	}
+	return result;
+}
+
+/// x -> a * x + b.  Composition is associative but not commutative, so it
+/// catches scans that combine tiles out of order
+struct affine_t {
+	int64_t a;
+	int64_t b;
+
+	bool operator==( affine_t const &rhs ) const {
+		return a == rhs.a and b == rhs.b;
+	}
+};
+
+affine_t compose( affine_t const &lhs, affine_t const &rhs ) {
+	constexpr int64_t mod = 1'000'003;
+	return affine_t{ ( lhs.a * rhs.a ) % mod, ( lhs.b * rhs.a + rhs.b ) % mod };
+}
+
+void inclusive_scan_test( daw::task_scheduler ts, size_t sz ) {
+	auto const data = make_data( sz );
+	auto out = std::vector<int64_t>( sz );
+	par::scan( data.cbegin( ), data.cend( ), out.begin( ), out.end( ),
+	           std::plus<>{ }, ts );
+	auto expected = std::vector<int64_t>( sz );
+	std::partial_sum( data.cbegin( ), data.cend( ), expected.begin( ) );
+	daw::expecting( expected == out );
+
+	// In place
+	auto in_place = data;
+	par::scan( in_place.begin( ), in_place.end( ), std::plus<>{ }, ts );
+	daw::expecting( expected == in_place );
+}
+
+void ordered_scan_test( daw::task_scheduler ts, size_t sz ) {
+	auto const values = make_data( sz );
+	auto data = std::vector<affine_t>( sz );
+	for( size_t n = 0; n < sz; ++n ) {
+		data[n] = affine_t{ values[n] + 1'001, values[n] + 2'000 };
+	}
+	auto out = std::vector<affine_t>( sz );
+	par::scan( data.cbegin( ), data.cend( ), out.begin( ), out.end( ), compose,
+	           ts );
+	auto expected = std::vector<affine_t>( sz );
+	std::partial_sum( data.cbegin( ), data.cend( ), expected.begin( ), compose );
+	daw::expecting( expected == out );
+}
+
+void exclusive_scan_test( daw::task_scheduler ts, size_t sz ) {
+	auto const data = make_data( sz );
+	auto out = std::vector<int64_t>( sz );
+	par::exclusive_scan( data.cbegin( ), data.cend( ), out.begin( ), out.end( ),
+	                     int64_t{ 5 }, std::plus<>{ }, ts );
+	auto expected = std::vector<int64_t>( sz );
+	int64_t sum = 5;
+	for( size_t n = 0; n < sz; ++n ) {
+		expected[n] = sum;
+		sum += data[n];
+	}
+	daw::expecting( expected == out );
+
+	auto in_place = data;
+	par::exclusive_scan( in_place.begin( ), in_place.end( ), in_place.begin( ),
+	                     in_place.end( ), int64_t{ 5 }, std::plus<>{ }, ts );
+	daw::expecting( expected == in_place );
+}
+
+void segmented_scan_test( daw::task_scheduler ts, size_t sz,
+                          size_t segment_every ) {
+	auto const data = make_data( sz );
+	auto flags = std::vector<bool>( sz );
+	auto rng = std::mt19937_64( sz + segment_every );
+	for( size_t n = 0; n < sz; ++n ) {
+		flags[n] = rng( ) % segment_every == 0;
+	}
+	auto out = std::vector<int64_t>( sz );
+	par::segmented_scan( data.cbegin( ), data.cend( ), flags.cbegin( ),
+	                     out.begin( ), out.end( ), std::plus<>{ }, ts );
+	auto expected = std::vector<int64_t>( sz );
+	int64_t sum = 0;
+	for( size_t n = 0; n < sz; ++n ) {
+		sum = ( n == 0 or flags[n] ) ? data[n] : sum + data[n];
+		expected[n] = sum;
+	}
+	daw::expecting( expected == out );
+}
+
+// An op that throws in one tile fails the scan instead of leaving the tiles
+// after it waiting
+void throwing_scan_test( daw::task_scheduler ts ) {
+	constexpr int64_t poison = 1'000'000;
+	auto data = make_data( 1'000'000 );
+	data[600'000] = poison;
+	auto const op = []( int64_t lhs, int64_t rhs ) {
+		if( rhs == poison ) {
+			throw std::runtime_error( "poison" );
+		}
+		return lhs + rhs;
+	};
+	auto out = std::vector<int64_t>( data.size( ) );
+	for( int n = 0; n < 3; ++n ) {
+		bool threw = false;
+		try {
+			par::scan( data.cbegin( ), data.cend( ), out.begin( ), out.end( ), op,
+			           ts );
+		} catch( std::runtime_error const & ) { threw = true; }
+		daw::expecting( threw );
+
+		threw = false;
+		try {
+			par::exclusive_scan( data.cbegin( ), data.cend( ), out.begin( ),
+			                     out.end( ), int64_t{ 0 }, op, ts );
+		} catch( std::runtime_error const & ) { threw = true; }
+		daw::expecting( threw );
+	}
+}
+
+int main( ) {
+	auto ts = daw::task_scheduler( 4U );
+	for( size_t sz : { 1, 2, 1'000, 8'193, 100'000, 1'000'003 } ) {
+		inclusive_scan_test( ts, sz );
+		ordered_scan_test( ts, sz );
+		exclusive_scan_test( ts, sz );
+		segmented_scan_test( ts, sz, 7 );
+		segmented_scan_test( ts, sz, 100'000 );
+	}
+	throwing_scan_test( ts );
+	std::cout << "lookback scan tests passed\n";
+}
@@ -97,6 +97,40 @@ void scan_int64_t( ) {
 	}
 }
 
+/// The same blocks give bit for bit the same prefixes, whatever the pool size
+void scan_deterministic( ) {
+	std::cout << "scan tests - deterministic\n";
+	auto const data = daw::make_random_data<int64_t>( MAX_ITEMS, -1'000, 1'000 );
+	auto a = std::vector<double>( MAX_ITEMS );
+	std::transform( data.cbegin( ), data.cend( ), a.begin( ), []( int64_t v ) {
+		return static_cast<double>( v ) / 3.0;
+	} );
+	auto const opts = daw::algorithm::parallel::deterministic{ 1'000U };
+	auto const run = [&]( daw::task_scheduler ts ) {
+		auto result = std::vector<double>( a.size( ) * 2U );
+		auto const mid = std::next( result.begin( ),
+		                            static_cast<std::ptrdiff_t>( a.size( ) ) );
+		daw::algorithm::parallel::scan( a.cbegin( ), a.cend( ), result.begin( ),
+		                                mid, std::plus<>{ }, opts, ts );
+		daw::algorithm::parallel::exclusive_scan( a.cbegin( ), a.cend( ), mid,
+		                                          result.end( ), 1.5,
+		                                          std::plus<>{ }, opts, ts );
+		return result;
+	};
+	auto const expected = run( daw::task_scheduler( 1U ) );
+	daw::expecting( expected == run( daw::task_scheduler( 3U ) ) );
+	daw::expecting( expected == run( daw::task_scheduler( 8U ) ) );
+
+	auto seq = std::vector<double>( a.size( ) );
+	std::partial_sum( a.cbegin( ), a.cend( ), seq.begin( ) );
+	daw::expecting(
+	  daw::math::nearly_equal( seq.back( ), expected[a.size( ) - 1U] ) );
+	daw::expecting( 1.5, expected[a.size( )] );
+	daw::expecting( daw::math::nearly_equal(
+	  seq[a.size( ) - 2U] + 1.5, expected.back( ) ) );
+}
+
 int main( ) {
 	scan_int64_t( );
+	scan_deterministic( );
 }
@@ -0,0 +1,139 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+
+namespace par = daw::algorithm::parallel;
+
+std::vector<int64_t> make_data( size_t sz, int64_t max_value ) {
+	auto rng = std::mt19937_64( sz );
+	auto dist = std::uniform_int_distribution<int64_t>( 0, max_value );
+	auto result = std::vector<int64_t>( sz );
+	for( auto &v : result ) {
+		v = dist( rng );
+	}
+	return result;
+}
+
+void co_rank_test( ) {
+	auto const a = std::vector<int>{ 1, 3, 3, 5, 7 };
+	auto const b = std::vector<int>{ 2, 3, 6 };
+	auto cmp = std::less<>{ };
+	for( size_t k = 0; k <= a.size( ) + b.size( ); ++k ) {
+		auto const i = par::impl::merge_co_rank( k, a.data( ), a.size( ), b.data( ),
+		                                         b.size( ), cmp );
+		auto const j = k - i;
+		daw::expecting( i <= a.size( ) and j <= b.size( ) );
+		// Everything taken sorts no later than everything left, ties from a
+		daw::expecting( i == 0 or j == b.size( ) or not( b[j] < a[i - 1] ) );
+		daw::expecting( j == 0 or i == a.size( ) or b[j - 1] < a[i] );
+	}
+}
+
+void sort_test( daw::task_scheduler ts, size_t sz ) {
+	auto data = make_data( sz, 1'000'000 );
+	auto expected = data;
+	std::sort( expected.begin( ), expected.end( ) );
+	par::sort( data.begin( ), data.end( ), ts );
+	daw::expecting( expected == data );
+}
+
+void sort_scratch_test( daw::task_scheduler ts, size_t sz ) {
+	auto data = make_data( sz, 1'000'000 );
+	auto expected = data;
+	std::sort( expected.begin( ), expected.end( ), std::greater<>{ } );
+	auto scratch = std::vector<int64_t>( sz );
+	par::sort( data.begin( ), data.end( ),
+	           daw::view( scratch.begin( ), scratch.end( ) ), ts,
+	           std::greater<>{ } );
+	daw::expecting( expected == data );
+}
+
+struct keyed_t {
+	int64_t key;
+	size_t position;
+};
+
+void stable_sort_test( daw::task_scheduler ts, size_t sz ) {
+	// Few distinct keys so there are many ties to keep in order
+	auto const keys = make_data( sz, 16 );
+	auto data = std::vector<keyed_t>( sz );
+	for( size_t n = 0; n < sz; ++n ) {
+		data[n] = keyed_t{ keys[n], n };
+	}
+	auto const by_key = []( keyed_t const &lhs, keyed_t const &rhs ) {
+		return lhs.key < rhs.key;
+	};
+	par::stable_sort( data.begin( ), data.end( ), ts, by_key );
+	daw::expecting( std::is_sorted( data.begin( ), data.end( ),
+	                                []( keyed_t const &lhs, keyed_t const &rhs ) {
+		                                return lhs.key < rhs.key or
+		                                       ( lhs.key == rhs.key and
+		                                         lhs.position < rhs.position );
+	                                } ) );
+}
+
+struct no_default_t {
+	int64_t value;
+	explicit no_default_t( int64_t v )
+	  : value( v ) {}
+};
+
+void no_default_ctor_sort_test( daw::task_scheduler ts ) {
+	auto const values = make_data( 100'000, 1'000'000 );
+	auto data = std::vector<no_default_t>( );
+	data.reserve( values.size( ) );
+	for( auto v : values ) {
+		data.emplace_back( v );
+	}
+	par::sort( data.begin( ), data.end( ), ts,
+	           []( no_default_t const &lhs, no_default_t const &rhs ) {
+		           return lhs.value < rhs.value;
+	           } );
+	daw::expecting( std::is_sorted(
+	  data.begin( ), data.end( ),
+	  []( no_default_t const &lhs, no_default_t const &rhs ) {
+		  return lhs.value < rhs.value;
+	  } ) );
+}
+
+int main( ) {
+	auto ts = daw::task_scheduler( 4U );
+	co_rank_test( );
+	for( size_t sz : { 0, 1, 4'095, 4'096, 12'289, 100'000, 1'000'003 } ) {
+		sort_test( ts, static_cast<size_t>( sz ) );
+		sort_scratch_test( ts, static_cast<size_t>( sz ) );
+		stable_sort_test( ts, static_cast<size_t>( sz ) );
+	}
+	// An odd number of runs leaves one out of every other merge pass
+	sort_test( daw::task_scheduler( 3U ), 100'000 );
+	no_default_ctor_sort_test( ts );
+	std::cout << "sort merge tests passed\n";
+}
@@ -119,6 +119,29 @@ void transform_test2( size_t SZ ) {
 	display_info( seq_max, par_max, SZ, sizeof( value_t ), "transform" );
 }
 
+/// Large enough to be written with streamed stores, starting and ending off
+/// the store boundaries
+void transform_streamed_test( ) {
+	std::cout << "transform tests - streamed\n";
+	auto ts = daw::get_task_scheduler( );
+	auto const SZ =
+	  daw::parallel::cpu_cache_sizes( ).llc / sizeof( int32_t ) * 2U + 3U;
+	auto a = daw::make_random_data<int32_t>( SZ, -10, 10 );
+	auto b = std::vector<int32_t>( SZ + 1U );
+	auto c = std::vector<int32_t>( SZ + 1U );
+	auto unary_op = []( int32_t value ) { return value * 3; };
+	daw::algorithm::parallel::transform( a.cbegin( ), a.cend( ),
+	                                     std::next( b.begin( ) ), unary_op, ts );
+	std::transform( a.cbegin( ), a.cend( ), std::next( c.begin( ) ), unary_op );
+	daw::expecting( b == c );
+
+	auto binary_op = []( int32_t lhs, int32_t rhs ) { return lhs - rhs; };
+	daw::algorithm::parallel::transform( a.cbegin( ), a.cend( ), c.cbegin( ),
+	                                     b.begin( ), binary_op, ts );
+	std::transform( a.cbegin( ), a.cend( ), c.cbegin( ), c.begin( ), binary_op );
+	daw::expecting( b == c );
+}
+
 void transform_int64_t( ) {
 	std::cout << "transform tests - int64_t\n";
 	transform_test<int64_t>( LARGE_TEST_SZ );
@@ -138,4 +161,5 @@ void transform2_int64_t( ) {
 int main( ) {
 	transform_int64_t( );
 	transform2_int64_t( );
+	transform_streamed_test( );
 }
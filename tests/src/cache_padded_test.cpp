@@ -0,0 +1,107 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+#include "daw/fs/impl/cache_padded.h"
+
+namespace par = daw::algorithm::parallel;
+using daw::parallel::cache_line_size;
+using daw::parallel::cache_padded;
+
+static_assert( alignof( cache_padded<char> ) == cache_line_size );
+static_assert( sizeof( cache_padded<char> ) == cache_line_size );
+static_assert( sizeof( cache_padded<std::optional<int64_t>> ) ==
+               cache_line_size );
+static_assert( sizeof( cache_padded<char[cache_line_size + 1U]> ) ==
+               2U * cache_line_size );
+
+void layout_test( ) {
+	auto slots = std::vector<cache_padded<int64_t>>( 8 );
+	for( auto const &slot : slots ) {
+		auto const addr = reinterpret_cast<std::uintptr_t>( &*slot );
+		daw::expecting( addr % cache_line_size == 0U );
+		daw::expecting( *slot == 0 );
+	}
+	auto const padded = cache_padded<std::string>( std::in_place, 3U, 'a' );
+	daw::expecting( *padded == "aaa" );
+	daw::expecting( padded->size( ) == 3U );
+}
+
+void counter_test( ) {
+	constexpr size_t thread_count = 4U;
+	constexpr int64_t iterations = 1'000'000;
+	auto counters = std::vector<cache_padded<int64_t>>( thread_count );
+	auto threads = std::vector<std::thread>( );
+	for( size_t n = 0; n < thread_count; ++n ) {
+		threads.emplace_back( [&counter = *counters[n]] {
+			for( int64_t i = 0; i < iterations; ++i ) {
+				// volatile so the loop is not folded into one store
+				++static_cast<int64_t volatile &>( counter );
+			}
+		} );
+	}
+	for( auto &th : threads ) {
+		th.join( );
+	}
+	for( auto const &counter : counters ) {
+		daw::expecting( iterations, *counter );
+	}
+}
+
+void algorithm_test( daw::task_scheduler ts ) {
+	auto data = std::vector<int64_t>( 1'000'003 );
+	std::iota( data.begin( ), data.end( ), int64_t{ -500'000 } );
+	daw::expecting(
+	  std::accumulate( data.cbegin( ), data.cend( ), int64_t{ 1 } ),
+	  par::reduce( data.cbegin( ), data.cend( ), int64_t{ 1 },
+	               []( int64_t lhs, int64_t rhs ) { return lhs + rhs; }, ts ) );
+	daw::expecting( data.cbegin( ) + 700'000 ==
+	                par::find_if( data.cbegin( ), data.cend( ),
+	                              []( int64_t v ) { return v >= 200'000; },
+	                              ts ) );
+	daw::expecting( data.cbegin( ) ==
+	                par::min_element( data.cbegin( ), data.cend( ), ts ) );
+	daw::expecting( data.cend( ) - 1 ==
+	                par::max_element( data.cbegin( ), data.cend( ), ts ) );
+	daw::expecting(
+	  500'003, par::count_if( data.cbegin( ), data.cend( ),
+	                          []( int64_t v ) { return v >= 0; }, ts ) );
+}
+
+int main( ) {
+	layout_test( );
+	counter_test( );
+	algorithm_test( daw::task_scheduler( 4U ) );
+	std::cout << "cache_padded tests passed\n";
+}
@@ -0,0 +1,201 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+#include "daw/fs/cancellation.h"
+#include "daw/fs/future_result.h"
+#include "daw/fs/task_scheduler.h"
+
+template<typename Future>
+bool holds_cancelled( Future &fut ) {
+	try {
+		(void)fut.get( );
+	} catch( daw::operation_cancelled_exception const & ) { return true; }
+	return false;
+}
+
+void cancellation_token_test_001( ) {
+	auto never = daw::cancellation_token( );
+	daw::expecting( not never.can_be_cancelled( ) );
+	daw::expecting( not never.is_cancelled( ) );
+
+	auto source = daw::cancellation_source( );
+	auto tok = source.get_token( );
+	auto copy = source;
+	daw::expecting( tok.can_be_cancelled( ) );
+	daw::expecting( not tok.is_cancelled( ) );
+	copy.request_cancel( );
+	daw::expecting( tok.is_cancelled( ) );
+	daw::expecting( source.is_cancelled( ) );
+	bool thrown = false;
+	try {
+		tok.throw_if_cancelled( );
+	} catch( daw::operation_cancelled_exception const & ) { thrown = true; }
+	daw::expecting( thrown );
+}
+
+void cancellable_task_test_001( ) {
+	auto ts = daw::task_scheduler( 2U );
+	auto source = daw::cancellation_source( );
+	source.request_cancel( );
+	auto ran = std::atomic_bool( false );
+	auto sem = daw::shared_latch( 1 );
+	daw::expecting( daw::schedule_task(
+	  sem, daw::cancellable( source.get_token( ), [&]( ) { ran = true; } ),
+	  ts ) );
+	ts.wait_for( sem );
+	daw::expecting( not ran.load( ) );
+}
+
+void future_cancel_test_001( ) {
+	auto ts = daw::task_scheduler( 2U );
+	auto source = daw::cancellation_source( );
+	source.request_cancel( );
+	auto ran = std::atomic_bool( false );
+	auto fut = daw::make_future_result( ts, source.get_token( ), [&]( ) {
+		ran = true;
+		return 5;
+	} );
+	daw::expecting( holds_cancelled( fut ) );
+	daw::expecting( not ran.load( ) );
+}
+
+void future_cancel_test_002( ) {
+	// Cancelling while the first stage runs drops the continuations
+	auto ts = daw::task_scheduler( 2U );
+	auto source = daw::cancellation_source( );
+	auto started = std::atomic_bool( false );
+	auto release = std::atomic_bool( false );
+	auto next_ran = std::atomic_bool( false );
+	auto first = daw::make_future_result( ts, source.get_token( ), [&]( ) {
+		started = true;
+		while( not release ) {
+			std::this_thread::yield( );
+		}
+		return 1;
+	} );
+	auto last = first
+	              .next( [&]( int v ) {
+		              next_ran = true;
+		              return v + 1;
+	              } )
+	              .next( [&]( int v ) {
+		              next_ran = true;
+		              return v + 1;
+	              } );
+	while( not started ) {
+		std::this_thread::yield( );
+	}
+	source.request_cancel( );
+	release = true;
+	daw::expecting( holds_cancelled( last ) );
+	daw::expecting( not next_ran.load( ) );
+}
+
+void future_cancel_test_003( ) {
+	// A token given to next only affects that continuation and later ones
+	auto ts = daw::task_scheduler( 2U );
+	auto source = daw::cancellation_source( );
+	auto fut = daw::make_future_result( ts, []( ) { return 1; } );
+	auto kept = daw::make_future_result( ts, []( ) { return 2; } )
+	              .next( []( int v ) { return v * 2; } );
+	source.request_cancel( );
+	auto dropped = fut.next( []( int v ) { return v * 2; }, source.get_token( ) );
+	daw::expecting( holds_cancelled( dropped ) );
+	daw::expecting( 4, kept.get( ) );
+}
+
+void find_if_cancel_test_001( ) {
+	auto ts = daw::task_scheduler( 2U );
+	auto values = std::vector<int>( 100'000 );
+	std::iota( values.begin( ), values.end( ), 0 );
+	auto source = daw::cancellation_source( );
+	auto const pos = daw::algorithm::parallel::find_if(
+	  values.begin( ), values.end( ), []( int v ) { return v == 54'321; },
+	  source.get_token( ), ts );
+	daw::expecting( pos != values.end( ) );
+	daw::expecting( 54'321, *pos );
+
+	source.request_cancel( );
+	auto calls = std::atomic_size_t( 0U );
+	bool thrown = false;
+	try {
+		(void)daw::algorithm::parallel::find_if(
+		  values.begin( ), values.end( ),
+		  [&calls]( int ) {
+			  ++calls;
+			  return false;
+		  },
+		  source.get_token( ), ts );
+	} catch( daw::operation_cancelled_exception const & ) { thrown = true; }
+	daw::expecting( thrown );
+	daw::expecting( calls.load( ) == 0U );
+}
+
+void chunked_for_each_cancel_test_001( ) {
+	auto ts = daw::task_scheduler( 2U );
+	auto values = std::vector<int>( 100'000, 1 );
+	auto source = daw::cancellation_source( );
+	auto const tok = source.get_token( );
+	auto items = std::atomic_size_t( 0U );
+	bool thrown = false;
+	try {
+		daw::algorithm::parallel::chunked_for_each(
+		  values.begin( ), values.end( ),
+		  [&]( auto rng ) {
+			  for( auto it = rng.begin( ); it != rng.end( ); ++it ) {
+				  // A long running chunk polls the token itself
+				  if( tok.is_cancelled( ) ) {
+					  return;
+				  }
+				  if( ++items == 10U ) {
+					  source.request_cancel( );
+				  }
+			  }
+		  },
+		  tok, ts );
+	} catch( daw::operation_cancelled_exception const & ) { thrown = true; }
+	daw::expecting( thrown );
+	daw::expecting( items.load( ) < values.size( ) );
+}
+
+int main( ) {
+	cancellation_token_test_001( );
+	cancellable_task_test_001( );
+	future_cancel_test_001( );
+	future_cancel_test_002( );
+	future_cancel_test_003( );
+	find_if_cancel_test_001( );
+	chunked_for_each_cancel_test_001( );
+	std::cout << "cancellation tests passed\n";
+}
@@ -0,0 +1,209 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/function_stream.h"
+#include "daw/fs/message_queue.h"
+#include "daw/fs/task_scheduler.h"
+
+void bounded_channel_test_001( ) {
+	auto ch = daw::parallel::bounded_channel<int>( 4U );
+	for( int n = 0; n < 4; ++n ) {
+		daw::expecting( ch.push( n ) );
+	}
+	daw::expecting( ch.is_full( ) );
+	int extra = 4;
+	daw::expecting( not ch.try_push( extra ) );
+	daw::expecting( extra == 4 );
+
+	// A full channel makes the producer wait for the consumer
+	auto producer = std::thread( [&]( ) {
+		for( int n = 4; n < 100; ++n ) {
+			daw::expecting( ch.push( n ) );
+		}
+		ch.close( );
+	} );
+	int expected = 0;
+	while( auto item = ch.pop( ) ) {
+		daw::expecting( ch.size( ) <= ch.capacity( ) );
+		daw::expecting( *item == expected );
+		++expected;
+	}
+	producer.join( );
+	daw::expecting( expected == 100 );
+	daw::expecting( not ch.push( 1 ) );
+}
+
+// A capacity that is not a power of 2 is still the most it holds, and batches
+// arrive in order
+void spsc_channel_test_001( ) {
+	auto ch = daw::parallel::spsc_channel<std::size_t>( 6U );
+	auto const batch = std::vector<std::size_t>{ 0, 1, 2, 3, 4, 5, 6, 7 };
+	daw::expecting( 6U, ch.try_push_n( batch.begin( ), batch.size( ) ) );
+	daw::expecting( ch.is_full( ) );
+	auto out = std::vector<std::size_t>( 4 );
+	daw::expecting( 4U, ch.try_pop_n( out.begin( ), out.size( ) ) );
+	daw::expecting( out == std::vector<std::size_t>{ 0, 1, 2, 3 } );
+	while( ch.try_pop( ) ) {}
+
+	constexpr std::size_t ITEMS = 100'000U;
+	auto producer = std::thread( [&]( ) {
+		auto values = std::vector<std::size_t>( 16 );
+		for( std::size_t n = 0; n < ITEMS; n += values.size( ) ) {
+			for( std::size_t i = 0; i < values.size( ); ++i ) {
+				values[i] = n + i;
+			}
+			daw::expecting( values.size( ),
+			                ch.push_n( values.begin( ), values.size( ) ) );
+		}
+		ch.close( );
+	} );
+	std::size_t expected = 0;
+	auto items = std::vector<std::size_t>( 5 );
+	while( auto const n = ch.pop_n( items.begin( ), items.size( ) ) ) {
+		daw::expecting( n <= ch.capacity( ) );
+		for( std::size_t i = 0; i < n; ++i ) {
+			daw::expecting( expected++, items[i] );
+		}
+	}
+	producer.join( );
+	daw::expecting( ITEMS, expected );
+	daw::expecting( not ch.push( 1U ) );
+}
+
+// Every item pushed by the producers is popped exactly once
+void mpmc_channel_test_001( ) {
+	constexpr std::size_t ITEMS = 100'000U;
+	constexpr std::size_t THREADS = 4U;
+	auto ch = daw::parallel::mpmc_channel<std::size_t>( 64U );
+	auto seen = std::vector<std::atomic_int>( ITEMS );
+	auto producers = std::vector<std::thread>( );
+	auto consumers = std::vector<std::thread>( );
+	for( std::size_t t = 0; t < THREADS; ++t ) {
+		consumers.emplace_back( [&]( ) {
+			auto items = std::vector<std::size_t>( 8 );
+			while( auto const n = ch.pop_n( items.begin( ), items.size( ) ) ) {
+				for( std::size_t i = 0; i < n; ++i ) {
+					seen[items[i]].fetch_add( 1 );
+				}
+			}
+		} );
+		producers.emplace_back( [&, t]( ) {
+			for( std::size_t n = t; n < ITEMS; n += THREADS ) {
+				daw::expecting( ch.push( n ) );
+			}
+		} );
+	}
+	for( auto &th : producers ) {
+		th.join( );
+	}
+	ch.close( );
+	for( auto &th : consumers ) {
+		th.join( );
+	}
+	for( auto const &s : seen ) {
+		daw::expecting( 1, s.load( ) );
+	}
+	daw::expecting( ch.is_empty( ) );
+}
+
+void channel_stream_test_001( ) {
+	constexpr std::size_t ITEMS = 2000U;
+	constexpr std::size_t CAPACITY = 8U;
+	auto produced = std::atomic_size_t( 0U );
+	auto consumed = std::atomic_size_t( 0U );
+	auto most_in_flight = std::atomic_size_t( 0U );
+	auto sum = std::atomic_size_t( 0U );
+
+	auto options = daw::channel_stream_options{ };
+	options.capacity = CAPACITY;
+	options.batch_size = 4U;
+	auto stream = daw::make_channel_stream<std::size_t>(
+	  options,
+	  [&]( std::size_t n ) {
+		  ++produced;
+		  return n * 2U;
+	  },
+	  []( std::size_t n ) { return n + 1U; },
+	  [&]( std::size_t n ) {
+		  // A slow sink, the first stage must not run ahead of it
+		  std::this_thread::sleep_for( std::chrono::microseconds( 20 ) );
+		  auto const in_flight = produced.load( ) - consumed.load( );
+		  auto most = most_in_flight.load( );
+		  while( in_flight > most and
+		         not most_in_flight.compare_exchange_weak( most, in_flight ) ) {}
+		  sum += n;
+		  ++consumed;
+	  } );
+	for( std::size_t n = 0; n < ITEMS; ++n ) {
+		daw::expecting( stream.push( n ) );
+	}
+	stream.close( );
+	daw::expecting( not stream.push( 0U ) );
+	stream.wait( );
+	daw::expecting( consumed.load( ) == ITEMS );
+	daw::expecting( sum.load( ) == ITEMS * ITEMS );
+	// Two channels of CAPACITY and one item in each of the last two stages
+	daw::expecting( most_in_flight.load( ) <= 2U * CAPACITY + 2U );
+}
+
+void channel_stream_test_002( ) {
+	auto options = daw::channel_stream_options{ };
+	options.capacity = 4U;
+	auto stream = daw::make_channel_stream<int>(
+	  options,
+	  []( int n ) {
+		  if( n == 50 ) {
+			  throw std::runtime_error( "bad item" );
+		  }
+		  return n;
+	  },
+	  []( int ) {} );
+	for( int n = 0; n < 200; ++n ) {
+		(void)stream.push( n );
+	}
+	stream.close( );
+	bool caught = false;
+	try {
+		stream.wait( );
+	} catch( std::runtime_error const & ) { caught = true; }
+	daw::expecting( caught );
+}
+
+int main( ) {
+	bounded_channel_test_001( );
+	spsc_channel_test_001( );
+	mpmc_channel_test_001( );
+	channel_stream_test_001( );
+	channel_stream_test_002( );
+	std::cout << "channel_stream tests passed\n";
+}
@@ -0,0 +1,140 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/coroutine.h"
+#include "daw/fs/future_result.h"
+#include "daw/fs/task_scheduler.h"
+
+#if __has_include( <coroutine> ) and defined( __cpp_impl_coroutine )
+
+daw::task<int> answer( ) {
+	co_return 41;
+}
+
+daw::task<int> add_one( int value ) {
+	co_return value + 1;
+}
+
+daw::task<int> chained( ) {
+	auto const value = co_await answer( );
+	co_return co_await add_one( value );
+}
+
+daw::task<void> throws( ) {
+	throw std::runtime_error( "from a coroutine" );
+	co_return;
+}
+
+daw::task<bool> catches( ) {
+	try {
+		co_await throws( );
+	} catch( std::runtime_error const & ) { co_return true; }
+	co_return false;
+}
+
+void task_test( daw::task_scheduler ts ) {
+	daw::expecting( 42, daw::sync_wait( chained( ), ts ) );
+	daw::expecting( daw::sync_wait( catches( ), ts ) );
+	bool has_thrown = false;
+	try {
+		daw::sync_wait( throws( ), ts );
+	} catch( std::runtime_error const & ) { has_thrown = true; }
+	daw::expecting( has_thrown );
+}
+
+daw::task<int> await_future( daw::future_result_t<int> fut ) {
+	co_return co_await fut + 1;
+}
+
+void future_test( daw::task_scheduler ts ) {
+	auto slow = daw::make_future_result( ts, []( ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+		return 41;
+	} );
+	daw::expecting( 42, daw::sync_wait( await_future( slow ), ts ) );
+
+	auto ready = daw::future_result_t<int>( ts );
+	ready.set_value( 1 );
+	daw::expecting( 2, daw::sync_wait( await_future( ready ), ts ) );
+}
+
+daw::task<void> await_latch( daw::shared_latch sem,
+                             std::atomic<size_t> &count ) {
+	co_await sem;
+	++count;
+}
+
+// Far more coroutines wait than there are workers, none of them hold one
+void latch_test( daw::task_scheduler ts ) {
+	constexpr size_t waiter_count = 256U;
+	auto const thread_count = ts.size( );
+	auto sem = daw::shared_latch( 1U );
+	auto count = std::atomic<size_t>( 0U );
+	auto results = std::vector<daw::future_result_t<void>>( );
+	for( size_t n = 0; n < waiter_count; ++n ) {
+		results.push_back( daw::spawn_task( await_latch( sem, count ), ts ) );
+	}
+	daw::expecting( 0U, count.load( ) );
+	daw::expecting( thread_count, ts.size( ) );
+	sem.notify( );
+	for( auto &result : results ) {
+		result.wait( );
+	}
+	daw::expecting( waiter_count, count.load( ) );
+	daw::expecting( thread_count, ts.size( ) );
+}
+
+daw::task<std::thread::id> thread_of( daw::task_scheduler ts ) {
+	co_await daw::resume_on( ts );
+	co_return std::this_thread::get_id( );
+}
+
+void resume_on_test( daw::task_scheduler ts ) {
+	auto other = daw::task_scheduler( 1U );
+	auto const id = daw::sync_wait( thread_of( other ), ts );
+	daw::expecting( id != std::this_thread::get_id( ) );
+}
+
+int main( ) {
+	auto ts = daw::task_scheduler( 2U );
+	task_test( ts );
+	future_test( ts );
+	latch_test( ts );
+	resume_on_test( ts );
+	std::cout << "coroutine tests passed\n";
+}
+#else
+int main( ) {
+	std::cout << "coroutines are not supported, skipping\n";
+}
+#endif
@@ -0,0 +1,293 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined( __linux__ ) or defined( __APPLE__ )
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+#include "daw/fs/distributed.h"
+#include "daw/fs/task_scheduler.h"
+
+namespace dist = daw::distributed;
+
+namespace {
+	constexpr std::uint32_t sum_scaled = 1;
+	constexpr std::uint32_t touch = 2;
+	constexpr std::uint32_t fails = 3;
+
+	struct scale_args {
+		std::int64_t factor;
+	};
+
+	// Every node holds the whole input here, a real one would hold its slice
+	std::vector<std::int64_t> const &input( ) {
+		static auto const data = [] {
+			auto result = std::vector<std::int64_t>( 1'000'000 );
+			std::iota( result.begin( ), result.end( ), 0 );
+			return result;
+		}( );
+		return data;
+	}
+
+	std::vector<std::atomic_int> touched( input( ).size( ) );
+
+	dist::function_registry make_registry( ) {
+		auto registry = dist::function_registry( );
+		registry.add<scale_args>(
+		  sum_scaled, []( std::uint64_t first, std::uint64_t last,
+		                  scale_args const &args, daw::task_scheduler &ts ) {
+			  auto const &data = input( );
+			  return daw::algorithm::parallel::map_reduce(
+			    data.begin( ) + static_cast<std::ptrdiff_t>( first ),
+			    data.begin( ) + static_cast<std::ptrdiff_t>( last ),
+			    std::int64_t{ 0 },
+			    [f = args.factor]( std::int64_t v ) { return v * f; },
+			    std::plus<>{ }, ts );
+		  } );
+		registry.add<scale_args>(
+		  touch, []( std::uint64_t first, std::uint64_t last, scale_args const &,
+		             daw::task_scheduler & ) {
+			  for( auto n = first; n < last; ++n ) {
+				  touched[n].fetch_add( 1 );
+			  }
+		  } );
+		registry.add<scale_args>(
+		  fails, []( std::uint64_t, std::uint64_t, scale_args const &,
+		             daw::task_scheduler & ) -> int {
+			  throw std::runtime_error( "chunk failed" );
+		  } );
+		return registry;
+	}
+} // namespace
+
+void chunk_descriptor_test_001( ) {
+	auto const chunk = dist::chunk_descriptor{
+	  7, 10, 20, dist::to_bytes( scale_args{ 3 } ) };
+	auto bytes = dist::serialize( chunk );
+	auto const copy = dist::deserialize_chunk( bytes );
+	daw::expecting( 7U, copy.function_id );
+	daw::expecting( 10U, copy.first );
+	daw::expecting( 20U, copy.last );
+	auto const args = dist::from_bytes<scale_args>( copy.args );
+	daw::expecting( 3, args.factor );
+
+	// Chunk boundaries of huge sizes do not overflow
+	constexpr auto huge = std::numeric_limits<std::uint64_t>::max( ) - 1U;
+	auto const chunks = dist::impl::make_chunks( 3U, 7U, huge, scale_args{ 1 } );
+	daw::expecting( 0U, chunks.front( ).first );
+	daw::expecting( huge, chunks.back( ).last );
+	for( std::size_t n = 1; n < chunks.size( ); ++n ) {
+		daw::expecting( chunks[n - 1U].last, chunks[n].first );
+		daw::expecting( chunks[n].first > chunks[n - 1U].first );
+	}
+
+	bytes.pop_back( );
+	bool threw = false;
+	try {
+		(void)dist::deserialize_chunk( bytes );
+	} catch( dist::remote_error const & ) { threw = true; }
+	daw::expecting( threw );
+}
+
+// Two nodes over tcp on this machine and one in process share the work
+void distributed_map_reduce_test_001( ) {
+	auto const registry = make_registry( );
+	auto ts = daw::get_task_scheduler( );
+	auto w1 = dist::tcp_worker( registry );
+	auto w2 = dist::tcp_worker( registry );
+	auto const executors = std::vector<std::shared_ptr<dist::executor>>{
+	  std::make_shared<dist::tcp_executor>( "127.0.0.1", w1.port( ) ),
+	  std::make_shared<dist::tcp_executor>( "localhost", w2.port( ) ),
+	  std::make_shared<dist::local_executor>( registry, ts ) };
+
+	auto const size = input( ).size( );
+	auto const expected = std::accumulate( input( ).begin( ), input( ).end( ),
+	                                       std::int64_t{ 0 } ) *
+	                      2;
+	auto const result = dist::map_reduce<std::int64_t>(
+	  executors, sum_scaled, size, scale_args{ 2 }, std::plus<>{ } );
+	daw::expecting( expected, result.get( ) );
+
+	dist::for_each( executors, touch, size, scale_args{ 1 } ).get( );
+	for( auto const &t : touched ) {
+		daw::expecting( 1, t.load( ) );
+	}
+
+	// A chunk that throws on a node, or is not registered there, fails the
+	// whole map_reduce with a remote_error
+	auto const remote = std::vector<std::shared_ptr<dist::executor>>(
+	  executors.begin( ), executors.begin( ) + 2 );
+	bool remote_failed = false;
+	try {
+		(void)dist::map_reduce<int>( remote, fails, size, scale_args{ 1 },
+		                             std::plus<>{ } )
+		  .get( );
+	} catch( dist::remote_error const &ex ) {
+		remote_failed = std::string( ex.what( ) ) == "chunk failed";
+	}
+	daw::expecting( remote_failed );
+
+	bool unknown = false;
+	try {
+		(void)dist::map_reduce<int>( remote, 99, size, scale_args{ 1 },
+		                             std::plus<>{ } )
+		  .get( );
+	} catch( dist::remote_error const & ) { unknown = true; }
+	daw::expecting( unknown );
+	w1.stop( );
+	w2.stop( );
+}
+
+// Workers refuse messages past their limit, serve no more connections than
+// configured, and stop with connections still open
+void tcp_worker_limits_test_001( ) {
+	auto const registry = make_registry( );
+	auto config = dist::tcp_worker_config( );
+	config.max_message_size = 8U;
+	auto small = dist::tcp_worker( registry, config );
+	auto const small_executor = std::vector<std::shared_ptr<dist::executor>>{
+	  std::make_shared<dist::tcp_executor>( "127.0.0.1", small.port( ) ) };
+	bool too_large = false;
+	try {
+		(void)dist::map_reduce<std::int64_t>( small_executor, sum_scaled, 100U,
+		                                      scale_args{ 1 }, std::plus<>{ } )
+		  .get( );
+	} catch( dist::remote_error const & ) {
+		// The unread request may reset the connection before the reply is read
+		too_large = true;
+	}
+	daw::expecting( too_large );
+	small.stop( );
+
+	config = dist::tcp_worker_config( );
+	config.max_connections = 1U;
+	auto single = dist::tcp_worker( registry, config );
+	auto const executors = std::vector<std::shared_ptr<dist::executor>>{
+	  std::make_shared<dist::tcp_executor>( "127.0.0.1", single.port( ) ),
+	  std::make_shared<dist::tcp_executor>( "127.0.0.1", single.port( ) ),
+	  std::make_shared<dist::tcp_executor>( "127.0.0.1", single.port( ) ) };
+	auto const size = input( ).size( );
+	auto const expected = std::accumulate( input( ).begin( ), input( ).end( ),
+	                                       std::int64_t{ 0 } );
+	auto const result = dist::map_reduce<std::int64_t>(
+	  executors, sum_scaled, size, scale_args{ 1 }, std::plus<>{ } );
+	daw::expecting( expected, result.get( ) );
+
+	single.stop( );
+
+#if defined( __linux__ ) or defined( __APPLE__ )
+	// A client that connects and never sends must not keep stop( ) waiting
+	// for the read timeout
+	auto idle = dist::tcp_worker( registry );
+	auto const client = ::socket( AF_INET, SOCK_STREAM, 0 );
+	auto addr = sockaddr_in{ };
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	addr.sin_port = htons( idle.port( ) );
+	daw::expecting( ::connect( client, reinterpret_cast<sockaddr *>( &addr ),
+	                           sizeof( addr ) ) == 0 );
+	std::this_thread::sleep_for( std::chrono::milliseconds( 250 ) );
+	auto const start = std::chrono::steady_clock::now( );
+	idle.stop( );
+	daw::expecting( std::chrono::steady_clock::now( ) - start <
+	                std::chrono::seconds( 5 ) );
+	::close( client );
+#endif
+}
+
+#if defined( __linux__ ) or defined( __APPLE__ )
+// A node that accepts and never replies fails the chunk after io_timeout, and
+// destroying the executor fails the chunks still waiting
+void tcp_executor_timeout_test_001( ) {
+	auto const listener = ::socket( AF_INET, SOCK_STREAM, 0 );
+	auto addr = sockaddr_in{ };
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	daw::expecting( ::bind( listener, reinterpret_cast<sockaddr *>( &addr ),
+	                        sizeof( addr ) ) == 0 );
+	daw::expecting( ::listen( listener, 16 ) == 0 );
+	auto len = static_cast<socklen_t>( sizeof( addr ) );
+	daw::expecting( ::getsockname( listener,
+	                               reinterpret_cast<sockaddr *>( &addr ),
+	                               &len ) == 0 );
+	auto const port = ntohs( addr.sin_port );
+
+	auto config = dist::tcp_executor_config( );
+	config.io_timeout = std::chrono::milliseconds( 200 );
+	auto const start = std::chrono::steady_clock::now( );
+	bool timed_out = false;
+	try {
+		auto exec = dist::tcp_executor( "127.0.0.1", port,
+		                                daw::get_task_scheduler( ), config );
+		auto const chunk = dist::chunk_descriptor{ sum_scaled, 0, 1, { } };
+		(void)exec.execute( chunk ).get( );
+	} catch( dist::remote_error const & ) { timed_out = true; }
+	daw::expecting( timed_out );
+	daw::expecting( std::chrono::steady_clock::now( ) - start <
+	                std::chrono::seconds( 5 ) );
+
+	auto pending = std::optional<daw::future_result_t<dist::bytes_t>>( );
+	{
+		auto exec = dist::tcp_executor( "127.0.0.1", port );
+		pending = exec.execute( dist::chunk_descriptor{ sum_scaled, 0, 1, { } } );
+		std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+	}
+	bool failed = false;
+	try {
+		(void)pending->get( );
+	} catch( dist::remote_error const & ) { failed = true; }
+	daw::expecting( failed );
+	::close( listener );
+}
+#endif
+
+int main( ) {
+	chunk_descriptor_test_001( );
+	distributed_map_reduce_test_001( );
+	tcp_worker_limits_test_001( );
+#if defined( __linux__ ) or defined( __APPLE__ )
+	tcp_executor_timeout_test_001( );
+#endif
+	std::cout << "distributed tests passed\n";
+}
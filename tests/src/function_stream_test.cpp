@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include <iostream>
+#include <stdexcept>
 #include <string>
 
 #include <daw/daw_benchmark.h>
@@ -122,6 +123,28 @@ namespace part1 {
 		std::cout << *std::get<1>( v ) << '\n';
 		return true;
 	}
+
+	bool function_stream_test_003( ) {
+		// a and b run in the task of the stage before them
+		auto const fs = daw::make_function_stream(
+		  &c, daw::cheap_stage( &a ), daw::fuse_stages( &b, &c ),
+		  []( int x ) { return std::to_string( x ); } );
+		auto result = fs( 1 ).get( );
+		daw::expecting( result, std::string( "96" ) );
+
+		auto const throws = daw::make_function_stream(
+		  &a,
+		  daw::cheap_stage( []( int ) -> int {
+			  throw std::runtime_error( "cheap stage" );
+		  } ),
+		  &b );
+		bool caught = false;
+		try {
+			(void)throws( 1 ).get( );
+		} catch( std::runtime_error const & ) { caught = true; }
+		daw::expecting( caught );
+		return true;
+	}
 } // namespace part1
 
 std::string blah( int i ) {
@@ -179,4 +202,5 @@ int main( ) {
 	part1::function_stream_test_001( );
 	future_result_test_001( );
 	part1::function_stream_test_002( );
+	part1::function_stream_test_003( );
 }
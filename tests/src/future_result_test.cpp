@@ -20,9 +20,15 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <atomic>
 #include <cmath>
 #include <exception>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <daw/daw_benchmark.h>
 #include <daw/daw_size_literals.h>
@@ -173,6 +179,210 @@ void future_result_test_010( ) {
 	daw::expecting( result, 42 );
 }
 
+// Inline continuations run on the thread completing the input, so a chain of
+// them completes on one worker
+void future_result_test_011( ) {
+	auto const inl = daw::continuation_mode::run_inline;
+	auto f1 = daw::future_result_t<int>( );
+	auto ids = std::make_shared<std::vector<std::thread::id>>( );
+	auto record = [ids]( int i ) {
+		ids->push_back( std::this_thread::get_id( ) );
+		return i + 1;
+	};
+	auto f2 = f1.next( record, inl )
+	            .next( record, inl )
+	            .next( record, inl )
+	            .next( record, inl );
+	auto th = std::thread( [&f1]( ) { f1.set_value( 1 ); } );
+	auto const th_id = th.get_id( );
+	th.join( );
+	daw::expecting( 5, f2.get( ) );
+	daw::expecting( size_t{ 4 }, ids->size( ) );
+	for( auto id : *ids ) {
+		daw::expecting( id == th_id );
+	}
+
+	// An input that is already complete runs the continuation on the caller
+	auto f3 = daw::future_result_t<int>( );
+	f3.set_value( 2 );
+	auto const caller_id = std::this_thread::get_id( );
+	auto f4 = f3.next(
+	  [caller_id]( int i ) {
+		  daw::expecting( std::this_thread::get_id( ) == caller_id );
+		  return i * 2;
+	  },
+	  inl );
+	daw::expecting( 4, f4.get( ) );
+}
+
+void future_result_test_012( ) {
+	auto const inl = daw::continuation_mode::run_inline;
+	auto count = std::atomic_int( 0 );
+	auto throws = [&count]( int i ) -> int {
+		++count;
+		if( i > 2 ) {
+			throw std::exception{ };
+		}
+		return i + 1;
+	};
+	auto f1 = daw::async( []( ) { return 1; } )
+	            .next( throws, inl )
+	            .next( throws, inl )
+	            .next( throws, inl )
+	            .next( throws );
+	daw::expecting( f1.is_exception( ) );
+	daw::expecting( 3, count.load( ) );
+}
+
+// Race a producer against adding the continuation, exactly one of them must
+// run it
+void future_result_test_013( ) {
+	for( int n = 0; n < 1'000; ++n ) {
+		auto f1 = daw::future_result_t<int>( );
+		auto th = std::thread( [f1, n]( ) mutable { f1.set_value( n ); } );
+		auto f2 = f1.next( []( int i ) { return i * 2; },
+		                   daw::continuation_mode::run_inline );
+		th.join( );
+		daw::expecting( n * 2, f2.get( ) );
+	}
+}
+
+template<typename T>
+struct counting_allocator {
+	using value_type = T;
+	std::shared_ptr<std::atomic_int> count;
+
+	explicit counting_allocator( std::shared_ptr<std::atomic_int> c )
+	  : count( daw::move( c ) ) {}
+
+	template<typename U>
+	counting_allocator( counting_allocator<U> const &other )
+	  : count( other.count ) {}
+
+	T *allocate( size_t n ) {
+		++*count;
+		return std::allocator<T>{ }.allocate( n );
+	}
+
+	void deallocate( T *p, size_t n ) {
+		--*count;
+		std::allocator<T>{ }.deallocate( p, n );
+	}
+
+	template<typename U>
+	bool operator==( counting_allocator<U> const &rhs ) const {
+		return count == rhs.count;
+	}
+
+	template<typename U>
+	bool operator!=( counting_allocator<U> const &rhs ) const {
+		return count != rhs.count;
+	}
+};
+
+// The shared state of a future is a single allocation from the allocator
+// given and is released when the last future and task let go of it
+void future_result_test_014( ) {
+	auto count = std::make_shared<std::atomic_int>( 0 );
+	{
+		auto alloc = counting_allocator<int>( count );
+		auto f1 = daw::future_result_t<int>( std::allocator_arg, alloc );
+		daw::expecting( 1, count->load( ) );
+		f1.set_value( 5 );
+		daw::expecting( 5, f1.get( ) );
+
+		auto f2 = daw::make_future_result( std::allocator_arg, alloc,
+		                                   daw::get_task_scheduler( ),
+		                                   []( int i ) { return i * 2; }, 21 );
+		daw::expecting( 42, f2.get( ) );
+	}
+	while( count->load( ) != 0 ) {
+		// The task may still be letting go of its copy of the future
+		std::this_thread::yield( );
+	}
+}
+
+void future_result_test_015( ) {
+	using namespace std::chrono_literals;
+	auto f1 = daw::future_result_t<int>( );
+	daw::expecting( not f1.try_wait( ) );
+	daw::expecting( f1.wait_for( 1ms ) == daw::future_status::timeout );
+	auto th = std::thread( [f1]( ) mutable {
+		std::this_thread::sleep_for( 10ms );
+		f1.set_value( 3 );
+	} );
+	f1.wait( );
+	th.join( );
+	daw::expecting( f1.try_wait( ) );
+	daw::expecting( f1.wait_for( 1ms ) == daw::future_status::ready );
+	daw::expecting( 3, f1.get( ) );
+
+	// A timed waiter parks and is woken by the value, not by its deadline
+	auto f3 = daw::future_result_t<int>( );
+	auto th3 = std::thread( [f3]( ) mutable {
+		std::this_thread::sleep_for( 10ms );
+		f3.set_value( 5 );
+	} );
+	auto const start = std::chrono::steady_clock::now( );
+	daw::expecting( f3.wait_for( 10s ) == daw::future_status::ready );
+	daw::expecting( std::chrono::steady_clock::now( ) - start < 5s );
+	th3.join( );
+	daw::expecting( 5, f3.get( ) );
+
+	// A latch given at construction is notified on completion
+	auto sem = daw::shared_latch( 1 );
+	auto f2 = daw::make_future_result( daw::get_task_scheduler( ), sem,
+	                                   []( ) { return 7; } );
+	sem.wait( );
+	daw::expecting( 7, f2.get( ) );
+}
+
+// when_all keeps the order of the range and reports the first failure in
+// it.  when_any reports the first to finish
+void future_result_test_016( ) {
+	constexpr std::size_t count = 5000;
+	auto futures = std::vector<daw::future_result_t<std::size_t>>( );
+	futures.reserve( count );
+	for( std::size_t n = 0; n < count; ++n ) {
+		futures.push_back( daw::async( [n]( ) { return n * 2U; } ) );
+	}
+	auto const values = daw::when_all( futures.begin( ), futures.end( ) ).get( );
+	daw::expecting( count, values.size( ) );
+	for( std::size_t n = 0; n < count; ++n ) {
+		daw::expecting( n * 2U, values[n] );
+	}
+
+	auto none = std::vector<daw::future_result_t<int>>( );
+	daw::expecting( daw::when_all( none.begin( ), none.end( ) ).get( ).empty( ) );
+
+	auto failing = std::vector<daw::future_result_t<int>>( 3 );
+	failing[0].set_value( 1 );
+	failing[2].set_exception( std::runtime_error( "second" ) );
+	auto all = daw::when_all( failing.begin( ), failing.end( ) );
+	daw::expecting( not all.try_wait( ) );
+	failing[1].set_exception( std::logic_error( "first" ) );
+	bool threw = false;
+	try {
+		(void)all.get( );
+	} catch( std::logic_error const & ) { threw = true; }
+	daw::expecting( threw );
+
+	auto voids = std::vector<daw::future_result_t<void>>( 2 );
+	auto all_voids = daw::when_all( voids.begin( ), voids.end( ) );
+	voids[1].set_value( );
+	voids[0].set_value( );
+	all_voids.get( );
+
+	auto racers = std::vector<daw::future_result_t<int>>( 4 );
+	auto any = daw::when_any( racers.begin( ), racers.end( ) );
+	daw::expecting( not any.try_wait( ) );
+	racers[2].set_value( 42 );
+	racers[0].set_value( 1 );
+	auto const first = any.get( );
+	daw::expecting( 2U, first.index );
+	daw::expecting( 42, first.value.get( ) );
+}
+
 void fork_join_test_001( ) {
 	/*
 	auto const f1 =
@@ -208,5 +418,11 @@ int main( ) {
 	future_result_test_008( );
 	future_result_test_009( );
 	future_result_test_010( );
+	future_result_test_011( );
+	future_result_test_012( );
+	future_result_test_013( );
+	future_result_test_014( );
+	future_result_test_015( );
+	future_result_test_016( );
 	fork_join_test_001( );
 }
@@ -20,109 +20,90 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <array>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <random>
 #include <vector>
 
 #include <daw/daw_benchmark.h>
-#include <daw/daw_random.h>
-#include <daw/daw_span.h>
 
-#include "daw/fs/algorithms.h"
+#include "daw/fs/k_means.h"
 
-/*
-template<typename T, typename BinaryFunction>
-void k_means_run( daw::span<T> view, daw::span<size_t> labels,
-                  daw::span<size_t> centres, BinaryFunction dist_func ) {
+namespace par = daw::algorithm::parallel;
 
-  daw::exception::precondition_check(
-    view.size( ) != labels.size( ),
-    "Size mismatch between size of label's span and items view" );
-  using iterator = decltype( centres.begin( ) );
-  auto ts = daw::get_task_scheduler( );
-  // Find closest cluster centre and associate item with it
-  using daw::algorithm::parallel::chunked_for_each_pos;
-
-  chunked_for_each_pos(
-    labels.begin( ), labels.end( ),
-    [view, centres, dist_func]( auto range, size_t start_pos ) {
-      auto const sz = range.size( );
-      // Iterator over all labells in this range
-      auto view_range = view.subset( start_pos, range.size( ) );
-      for( size_t n = 0; n < sz; ++n ) {
-        auto cur_cent = 0;
-        auto cur_dist = dist_func( view_range[n], view[centres[0]] );
-        for( size_t m = 1; m < centres.size( ); ++m ) {
-          if( auto tmp_dist =
-                dist_func( view[range[n]], view[centres[m]] ) < cur_dist ) {
-            cur_cent = m;
-            cur_dist = daw::move( tmp_dist );
-          }
-        }
-        range[n] = m;
-      }
-    } );
-  // Find centre of each cluster
-
-  chunked_for_each_pos(
-    centres.begin( ), centres.end( ),
-    [view, labels, dist_func]( auto range, size_t start_pos ) {
-      auto const sz = range.size( );
-    } );
-}
- */
-
-template<size_t N, typename Iterator, typename Position>
-constexpr decltype( auto ) random_value( Iterator first, size_t const &count,
-                                         Position &cur_dist,
-                                         Position const &max_dist ) {
-	auto const range =
-	  ( max_dist - cur_dist ) / static_cast<Position>( N - count );
-	auto const pos = ::daw::randint<Position>( cur_dist, cur_dist + range );
-	std::advance( first, pos );
-	cur_dist += pos;
-	return *first;
-}
-
-template<size_t N, typename Iterator, typename LastType, size_t... Is>
-constexpr auto random_values( Iterator first, LastType last,
-                              std::index_sequence<Is...> ) {
-	auto const max_dist = std::distance( first, last );
-	typename std::iterator_traits<Iterator>::difference_type cur_pos = 0;
-	return std::array{random_value<N>( first, Is, cur_pos, max_dist )...};
+template<typename T>
+par::soa_points<T>
+make_clusters( std::array<std::array<T, 2>, 3> const &centres,
+               std::size_t count ) {
+	auto rng = std::mt19937_64( count );
+	auto noise = std::normal_distribution<T>( T{ 0 }, T{ 1 } );
+	auto result = par::soa_points<T>( 2U, count );
+	for( std::size_t n = 0; n < count; ++n ) {
+		auto const &centre = centres[n % centres.size( )];
+		result( n, 0 ) = centre[0] + noise( rng );
+		result( n, 1 ) = centre[1] + noise( rng );
+	}
+	return result;
 }
 
-template<size_t N, typename Values,
-         typename Indices = std::make_index_sequence<N>>
-constexpr auto random_values( Values &&values ) {
-	using ::std::begin;
-	using ::std::end;
-	return random_values<N>( begin( values ), end( values ), Indices{} );
+template<typename T>
+void k_means_test_001( ) {
+	auto ts = daw::task_scheduler( 4U );
+	auto const centres = std::array<std::array<T, 2>, 3>{
+	  { { T{ -20 }, T{ 0 } }, { T{ 20 }, T{ 5 } }, { T{ 0 }, T{ 30 } } } };
+	constexpr std::size_t POINTS = 300'000U;
+	auto const points = make_clusters( centres, POINTS );
+	auto result = par::k_means_result<T>{ };
+	// Start away from the centres so that points move for a while
+	auto const initial = std::vector<T>{ T{ 0 }, T{ 10 }, T{ 1 },
+	                                     T{ 10 }, T{ 0 }, T{ 11 } };
+	auto const t = daw::benchmark(
+	  [&]( ) { result = par::k_means( points, initial, { }, ts ); } );
+	std::cout << "k_means of " << POINTS << " points took "
+	          << daw::utility::format_seconds( t, 3 ) << " for "
+	          << result.iterations << " iterations\n";
+	daw::expecting( result.converged );
+	daw::expecting( result.labels.size( ) == POINTS );
+	// Every true centre has a centroid close by, and its points share a label
+	for( std::size_t c = 0; c < centres.size( ); ++c ) {
+		auto const label = result.labels[c];
+		auto const dx = result.centroids[label * 2U] - centres[c][0];
+		auto const dy = result.centroids[label * 2U + 1U] - centres[c][1];
+		daw::expecting( std::sqrt( dx * dx + dy * dy ) < T{ 0.1 } );
+		for( std::size_t n = c; n < POINTS; n += 3U * 997U ) {
+			daw::expecting( result.labels[n] == label );
+		}
+	}
+	// Two points per sample, each with unit variance per dimension
+	daw::expecting( std::abs( result.inertia / POINTS - 2.0 ) < 0.1 );
 }
 
-template<size_t k_num_clusters, typename Values>
-auto k_means( Values const &values ) {
-	using iterator_t = decltype( std::begin( values ) );
-	using value_t = daw::remove_cvref_t<decltype( *std::declval<iterator_t>( ) )>;
-	struct result_t {
-		std::array<std::vector<iterator_t>, k_num_clusters> clusters;
-		std::array<value_t, k_num_clusters> centres;
-	};
-	result_t result = {{}, random_values<k_num_clusters>( values )};
+void k_means_test_002( ) {
+	// A single cluster is the mean, no points is nothing to do
+	auto points = par::soa_points<double>( 3U, 4U );
+	for( std::size_t n = 0; n < 4U; ++n ) {
+		for( std::size_t d = 0; d < 3U; ++d ) {
+			points( n, d ) = static_cast<double>( n * ( d + 1U ) );
+		}
+	}
+	auto const one = par::k_means( points, 1U );
+	daw::expecting( one.converged );
+	daw::expecting( one.iterations == 2U );
+	daw::expecting( one.centroids == std::vector<double>{ 1.5, 3.0, 4.5 } );
 
-	return result;
+	auto const none =
+	  par::k_means( par::soa_points<double>( 3U, 0U ),
+	                std::vector<double>{ 0.0, 0.0, 0.0 } );
+	daw::expecting( none.converged and none.labels.empty( ) );
 }
 
-int main( int, char ** ) {
-	std::cout << "k-means test\n";
-	auto points = ::std::vector<std::pair<int64_t, int64_t>>( );
-	points.resize( 10'000'000 );
-	for( auto &p : points ) {
-		p.first = ::daw::randint<int64_t>( -100, 100 );
-		p.second = ::daw::randint<int64_t>( -100, 100 );
-	}
-	auto result = k_means<3>( points );
-	::daw::do_not_optimize( result );
+int main( ) {
+	k_means_test_001<float>( );
+	k_means_test_001<double>( );
+	k_means_test_002( );
+	std::cout << "k-means tests passed\n";
 	return EXIT_SUCCESS;
 }
@@ -37,6 +37,7 @@
 #include "daw/fs/algorithms.h"
 #include "daw/fs/function_stream.h"
 #include "daw/fs/message_queue.h"
+#include "daw/fs/record_input.h"
 
 template<size_t max_find, typename Function>
 constexpr void find_commas( daw::string_view line, Function on_commas ) {
@@ -231,5 +232,38 @@ int main( int argc, char **argv ) {
 		std::cout << result.get( ) << '\n';
 	}
 
+	{
+		// Record aligned chunks of the mapping, their fields indexed in parallel
+		auto result = std::numeric_limits<intmax_t>::max( );
+		auto const time3 = daw::benchmark( [&]( ) {
+			auto const file = daw::mapped_records( argv[1] );
+			result = daw::algorithm::parallel::map_reduce(
+			  file.begin( ), file.end( ),
+			  []( std::string_view chunk ) {
+				  intmax_t cur_min = std::numeric_limits<intmax_t>::max( );
+				  auto const fields = daw::field_index( chunk );
+				  for( std::size_t r = 0; r < fields.record_count( ); ++r ) {
+					  if( fields.field_count( r ) < 4U ) {
+						  continue;
+					  }
+					  auto const value = fields.field( r, 3 );
+					  parse_int(
+					    daw::string_view( value.data( ), value.size( ) ),
+					    [&]( intmax_t v ) { cur_min = std::min( cur_min, v ); } );
+				  }
+				  return cur_min;
+			  },
+			  []( intmax_t lhs, intmax_t rhs ) { return std::min( lhs, rhs ); } );
+		} );
+
+		std::cout << "Chunked file test\n";
+		std::cout << "Processed " << daw::utility::to_bytes_per_second( sz )
+		          << " bytes in " << daw::utility::format_seconds( time3, 3 )
+		          << " seconds\n";
+		std::cout << "Speed " << daw::utility::to_bytes_per_second( sz, time3 )
+		          << "/s\n";
+		std::cout << "Minimum surplus is " << result << '\n';
+	}
+
 	return EXIT_SUCCESS;
 }
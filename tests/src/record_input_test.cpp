@@ -0,0 +1,218 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+#include "daw/fs/record_input.h"
+
+std::string make_records( std::size_t count ) {
+	auto result = std::string( );
+	for( std::size_t n = 0; n < count; ++n ) {
+		result += std::to_string( n );
+		result += ",x\n";
+	}
+	return result;
+}
+
+void check_chunks( std::string_view data,
+                   std::vector<std::string_view> const &chunks ) {
+	// The chunks cover data in order and each ends on a record boundary
+	auto const *next = data.data( );
+	for( auto chunk : chunks ) {
+		daw::expecting( not chunk.empty( ) );
+		daw::expecting( chunk.data( ) == next );
+		next += chunk.size( );
+		daw::expecting( chunk.back( ) == '\n' or
+		                next == data.data( ) + data.size( ) );
+	}
+	daw::expecting( next == data.data( ) + data.size( ) );
+}
+
+void split_records_test_001( ) {
+	constexpr std::size_t RECORDS = 10'000U;
+	auto const data = make_records( RECORDS );
+	auto options = daw::record_split_options{ };
+	options.chunk_size = 1000U;
+	auto const chunks = daw::split_records( data, options );
+	daw::expecting( chunks.size( ) > 1U );
+	check_chunks( data, chunks );
+
+	auto const records = daw::algorithm::parallel::map_reduce(
+	  chunks.begin( ), chunks.end( ),
+	  []( std::string_view chunk ) {
+		  std::size_t count = 0;
+		  daw::for_each_record( chunk, [&]( std::string_view rec ) {
+			  daw::expecting( rec.back( ) == 'x' );
+			  ++count;
+		  } );
+		  return count;
+	  },
+	  []( std::size_t lhs, std::size_t rhs ) { return lhs + rhs; } );
+	daw::expecting( records == RECORDS );
+}
+
+void split_records_test_002( ) {
+	// Records longer than a chunk, a custom delimiter and no final delimiter
+	auto const data = std::string( 5000U, 'a' ) + ";b;" + std::string( 10U, 'c' );
+	auto options = daw::record_split_options{ };
+	options.delimiter = ';';
+	options.chunk_size = 64U;
+	auto const chunks = daw::split_records( data, options );
+	daw::expecting( chunks.size( ) == 2U );
+	daw::expecting( chunks[0].size( ) == 5001U );
+	daw::expecting( chunks[1] == "b;" + std::string( 10U, 'c' ) );
+	auto records = std::vector<std::string_view>( );
+	daw::for_each_record(
+	  chunks[1], [&]( std::string_view rec ) { records.push_back( rec ); }, ';' );
+	daw::expecting( records.size( ) == 2U );
+	daw::expecting( records[0] == "b" );
+	daw::expecting( daw::split_records( std::string_view( ) ).empty( ) );
+}
+
+void mapped_records_test_001( ) {
+	constexpr std::size_t RECORDS = 5'000U;
+	auto const data = make_records( RECORDS );
+	auto const path = std::string( "record_input_test.tmp" );
+	{
+		auto out = std::ofstream( path, std::ios::binary );
+		out << data;
+	}
+	{
+		auto options = daw::record_split_options{ };
+		options.chunk_size = 0U;
+		auto const file = daw::mapped_records( path, options );
+		daw::expecting( file.data( ) == data );
+		check_chunks( file.data( ), file.chunks( ) );
+		std::size_t count = 0;
+		for( auto chunk : file ) {
+			daw::for_each_record( chunk, [&]( std::string_view ) { ++count; } );
+		}
+		daw::expecting( count == RECORDS );
+	}
+	std::remove( path.c_str( ) );
+}
+
+// Byte at a time reference for field_index
+std::vector<std::vector<std::string_view>>
+reference_fields( std::string_view chunk ) {
+	auto result = std::vector<std::vector<std::string_view>>( );
+	auto record = std::vector<std::string_view>( );
+	bool in_quote = false;
+	std::size_t start = 0;
+	for( std::size_t n = 0; n < chunk.size( ); ++n ) {
+		if( chunk[n] == '"' ) {
+			in_quote = not in_quote;
+		} else if( not in_quote and ( chunk[n] == ',' or chunk[n] == '\n' ) ) {
+			record.push_back( chunk.substr( start, n - start ) );
+			start = n + 1U;
+			if( chunk[n] == '\n' ) {
+				result.push_back( std::move( record ) );
+				record.clear( );
+			}
+		}
+	}
+	if( start < chunk.size( ) or not record.empty( ) ) {
+		record.push_back( chunk.substr( start ) );
+		result.push_back( std::move( record ) );
+	}
+	return result;
+}
+
+void field_index_test_001( ) {
+	auto const data = std::string_view( "a,\"b,\n\"\"c\"\"\",,d\n\ne,f" );
+	auto const index = daw::field_index( data );
+	daw::expecting( index.record_count( ) == 3U );
+	daw::expecting( index.field_count( 0 ) == 4U );
+	daw::expecting( index.field( 0, 0 ) == "a" );
+	daw::expecting( index.field( 0, 1 ) == "\"b,\n\"\"c\"\"\"" );
+	daw::expecting( index.field( 0, 2 ).empty( ) );
+	daw::expecting( index.field( 0, 3 ) == "d" );
+	daw::expecting( index.field_count( 1 ) == 1U );
+	daw::expecting( index.field( 1, 0 ).empty( ) );
+	daw::expecting( index.field( 2, 1 ) == "f" );
+	daw::expecting( not index.has_open_quote( ) );
+	daw::expecting( daw::field_index( "a,\"b" ).has_open_quote( ) );
+	daw::expecting( daw::field_index( ).record_count( ) == 0U );
+}
+
+void field_index_test_002( ) {
+	// Random text crossing many 64 byte blocks, against the reference
+	auto rng = std::mt19937( 42 );
+	auto const alphabet = std::string_view( "ab,,\n\"" );
+	auto dist = std::uniform_int_distribution<std::size_t>(
+	  0, alphabet.size( ) - 1U );
+	for( std::size_t sz : { 1U, 63U, 64U, 65U, 1000U, 4099U } ) {
+		auto data = std::string( );
+		for( std::size_t n = 0; n < sz; ++n ) {
+			data += alphabet[dist( rng )];
+		}
+		auto const index = daw::field_index( data );
+		auto const expected = reference_fields( data );
+		daw::expecting( index.record_count( ) == expected.size( ) );
+		for( std::size_t r = 0; r < expected.size( ); ++r ) {
+			daw::expecting( index.field_count( r ) == expected[r].size( ) );
+			for( std::size_t f = 0; f < expected[r].size( ); ++f ) {
+				daw::expecting( index.field( r, f ) == expected[r][f] );
+			}
+		}
+	}
+}
+
+void index_fields_test_001( ) {
+	constexpr std::size_t RECORDS = 10'000U;
+	auto const data = make_records( RECORDS );
+	auto options = daw::record_split_options{ };
+	options.chunk_size = 1000U;
+	auto const chunks = daw::split_records( data, options );
+	auto const indices = daw::index_fields( chunks );
+	daw::expecting( indices.size( ) == chunks.size( ) );
+	std::size_t count = 0;
+	for( auto const &index : indices ) {
+		for( std::size_t r = 0; r < index.record_count( ); ++r ) {
+			daw::expecting( index.field_count( r ) == 2U );
+			daw::expecting( index.field( r, 0 ) == std::to_string( count ) );
+			daw::expecting( index.field( r, 1 ) == "x" );
+			++count;
+		}
+	}
+	daw::expecting( count == RECORDS );
+}
+
+int main( ) {
+	split_records_test_001( );
+	split_records_test_002( );
+	mapped_records_test_001( );
+	field_index_test_001( );
+	field_index_test_002( );
+	index_fields_test_001( );
+	std::cout << "record_input tests passed\n";
+}
@@ -0,0 +1,129 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/algorithms.h"
+#include "daw/fs/impl/simd_kernels.h"
+
+namespace par = daw::algorithm::parallel;
+namespace simd = daw::algorithm::parallel::impl::simd;
+
+template<typename T>
+std::vector<T> make_data( size_t sz ) {
+	auto rng = std::mt19937_64( sz );
+	auto dist = std::uniform_int_distribution<int32_t>( -50, 50 );
+	auto result = std::vector<T>( sz );
+	for( auto &v : result ) {
+		v = static_cast<T>( dist( rng ) );
+	}
+	return result;
+}
+
+template<typename T>
+void kernel_test( size_t sz ) {
+	auto data = make_data<T>( sz );
+	// Values are small integers, so even floating point sums are exact
+	daw::expecting( std::accumulate( data.begin( ), data.end( ), T{ } ),
+	                simd::sum( data.data( ), data.size( ) ) );
+	daw::expecting( static_cast<size_t>(
+	                  std::count( data.begin( ), data.end( ), T{ 7 } ) ),
+	                simd::count_equal( data.data( ), data.size( ), T{ 7 } ) );
+	daw::expecting( std::min_element( data.begin( ), data.end( ) ) ==
+	                simd::min_max_element<false>( data.begin( ), data.end( ) ) );
+	daw::expecting( std::max_element( data.begin( ), data.end( ) ) ==
+	                simd::min_max_element<true>( data.begin( ), data.end( ) ) );
+
+	auto other = data;
+	daw::expecting( simd::equal( data.data( ), other.data( ), data.size( ) ) );
+	if( not other.empty( ) ) {
+		other[sz / 2] += T{ 1 };
+		daw::expecting(
+		  not simd::equal( data.data( ), other.data( ), data.size( ) ) );
+	}
+}
+
+template<typename T>
+void nan_test( ) {
+	auto data = make_data<T>( 1'000 );
+	data[0] = std::numeric_limits<T>::quiet_NaN( );
+	data[500] = std::numeric_limits<T>::quiet_NaN( );
+	daw::expecting( std::min_element( data.begin( ), data.end( ) ) ==
+	                simd::min_max_element<false>( data.begin( ), data.end( ) ) );
+	daw::expecting( std::max_element( data.begin( ), data.end( ) ) ==
+	                simd::min_max_element<true>( data.begin( ), data.end( ) ) );
+}
+
+template<typename T>
+void algorithm_test( daw::task_scheduler ts, size_t sz ) {
+	auto data = make_data<T>( sz );
+	daw::expecting( std::accumulate( data.begin( ), data.end( ), T{ 3 } ),
+	                par::reduce( data.cbegin( ), data.cend( ), T{ 3 },
+	                             std::plus<>{ }, ts ) );
+	daw::expecting( std::count( data.cbegin( ), data.cend( ), T{ -3 } ),
+	                par::count( data.cbegin( ), data.cend( ), T{ -3 }, ts ) );
+	daw::expecting( std::min_element( data.cbegin( ), data.cend( ) ) ==
+	                par::min_element( data.cbegin( ), data.cend( ), ts ) );
+	daw::expecting( std::max_element( data.cbegin( ), data.cend( ) ) ==
+	                par::max_element( data.cbegin( ), data.cend( ), ts ) );
+	auto other = data;
+	daw::expecting( par::equal( data.cbegin( ), data.cend( ), other.cbegin( ),
+	                            other.cend( ), ts ) );
+	other[sz - 1] += T{ 1 };
+	daw::expecting( not par::equal( data.cbegin( ), data.cend( ),
+	                                other.cbegin( ), other.cend( ), ts ) );
+	par::fill( other.begin( ), other.end( ), T{ 9 }, ts );
+	daw::expecting( std::all_of( other.cbegin( ), other.cend( ),
+	                             []( T v ) { return v == T{ 9 }; } ) );
+}
+
+template<typename T>
+void run_tests( daw::task_scheduler ts ) {
+	for( size_t sz = 0; sz < 100; ++sz ) {
+		kernel_test<T>( sz );
+	}
+	kernel_test<T>( 1'000'003 );
+	algorithm_test<T>( ts, 1'000 );
+	algorithm_test<T>( ts, 1'000'003 );
+}
+
+int main( ) {
+	std::cout << "simd instruction set: "
+	          << static_cast<int>( simd::detected_isa( ) ) << '\n';
+	auto ts = daw::task_scheduler( 4U );
+	run_tests<int32_t>( ts );
+	run_tests<int64_t>( ts );
+	run_tests<float>( ts );
+	run_tests<double>( ts );
+	nan_test<float>( );
+	nan_test<double>( );
+	std::cout << "simd kernel tests passed\n";
+}
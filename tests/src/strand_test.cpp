@@ -0,0 +1,130 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/impl/daw_latch.h"
+#include "daw/fs/strand.h"
+#include "daw/fs/task_scheduler.h"
+
+// Several producers add to a few strands.  Each strand must see every
+// producer's tasks in the order they were added, and never two at once
+void order_test( daw::task_scheduler ts ) {
+	constexpr std::size_t strand_count = 4U;
+	constexpr std::size_t producer_count = 4U;
+	constexpr std::size_t per_producer = 10'000U;
+	struct checked_t {
+		daw::strand strand;
+		std::atomic_size_t running = std::atomic_size_t( 0U );
+		// Only touched by the strand's tasks
+		std::vector<std::size_t> last_seen;
+		bool in_order = true;
+		std::size_t count = 0;
+
+		explicit checked_t( daw::task_scheduler s )
+		  : strand( daw::move( s ) )
+		  , last_seen( producer_count, 0U ) {}
+	};
+	auto strands = std::vector<std::unique_ptr<checked_t>>( );
+	for( std::size_t n = 0; n < strand_count; ++n ) {
+		strands.push_back( std::make_unique<checked_t>( ts ) );
+	}
+	auto sem = daw::shared_latch( strand_count * producer_count * per_producer );
+	auto producers = std::vector<std::thread>( );
+	for( std::size_t p = 0; p < producer_count; ++p ) {
+		producers.emplace_back( [&, p]( ) {
+			for( std::size_t i = 1; i <= per_producer; ++i ) {
+				for( auto &s : strands ) {
+					s->strand.add_task( [&, p, i, s = s.get( )]( ) {
+						if( s->running.fetch_add( 1U ) != 0 ) {
+							s->in_order = false;
+						}
+						if( s->last_seen[p] + 1U != i ) {
+							s->in_order = false;
+						}
+						s->last_seen[p] = i;
+						++s->count;
+						s->running.fetch_sub( 1U );
+						sem.notify( );
+					} );
+				}
+			}
+		} );
+	}
+	for( auto &th : producers ) {
+		th.join( );
+	}
+	ts.wait_for( sem );
+	for( auto const &s : strands ) {
+		daw::expecting( s->in_order );
+		daw::expecting( s->count == producer_count * per_producer );
+	}
+}
+
+// A task that throws is reported and the strand keeps going
+void exception_test( ) {
+	auto failures = std::atomic_size_t( 0U );
+	auto config = daw::task_scheduler_config{ };
+	config.num_threads = 2U;
+	config.unhandled_exception_handler = [&]( std::exception_ptr ) {
+		++failures;
+	};
+	auto ts = daw::task_scheduler( config );
+	auto s = daw::strand( ts );
+	auto sem = daw::shared_latch( 1 );
+	s.add_task( []( ) { throw std::runtime_error( "strand" ); } );
+	s.add_task( [&]( ) { sem.notify( ); } );
+	ts.wait_for( sem );
+	daw::expecting( failures.load( ) == 1U );
+}
+
+// Strands are cheap enough to make one per item
+void many_strands_test( daw::task_scheduler ts ) {
+	constexpr std::size_t count = 100'000U;
+	auto strands = std::vector<daw::strand>( );
+	strands.reserve( count );
+	for( std::size_t n = 0; n < count; ++n ) {
+		strands.emplace_back( ts );
+	}
+	auto sem = daw::shared_latch( count );
+	for( auto &s : strands ) {
+		s.add_task( [&]( ) { sem.notify( ); } );
+	}
+	ts.wait_for( sem );
+}
+
+int main( ) {
+	auto ts = daw::task_scheduler( 4U );
+	order_test( ts );
+	exception_test( );
+	many_strands_test( ts );
+	std::cout << "strand tests passed\n";
+}
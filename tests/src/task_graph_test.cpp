@@ -0,0 +1,123 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+#include <daw/daw_random.h>
+
+#include "daw/fs/task_graph.h"
+#include "daw/fs/task_scheduler.h"
+
+// Every node records when it ran, and each edge must see its ends in order
+void random_graph_test( daw::task_scheduler ts ) {
+	constexpr std::size_t node_count = 200U;
+	constexpr std::size_t runs = 50U;
+	auto graph = daw::task_graph( );
+	auto clock = std::atomic_size_t( 0U );
+	auto ran_at = std::vector<std::atomic_size_t>( node_count );
+	for( std::size_t n = 0; n < node_count; ++n ) {
+		(void)graph.add_node( [&, n]( ) { ran_at[n] = ++clock; } );
+	}
+	auto edges = std::vector<std::pair<std::size_t, std::size_t>>( );
+	for( std::size_t after = 1; after < node_count; ++after ) {
+		auto const count = daw::randint<std::size_t>( 0, 3 );
+		for( std::size_t e = 0; e < count; ++e ) {
+			auto const before = daw::randint<std::size_t>( 0, after - 1U );
+			graph.add_edge( before, after );
+			edges.emplace_back( before, after );
+		}
+	}
+	daw::expecting( graph.size( ) == node_count );
+	for( std::size_t r = 0; r < runs; ++r ) {
+		for( auto &t : ran_at ) {
+			t = 0U;
+		}
+		graph.run( ts );
+		for( auto const &t : ran_at ) {
+			daw::expecting( t.load( ) != 0U );
+		}
+		for( auto [before, after] : edges ) {
+			daw::expecting( ran_at[before].load( ) < ran_at[after].load( ) );
+		}
+	}
+	daw::expecting( clock.load( ) == node_count * runs );
+}
+
+// a -> { b, c } -> d, where c throws.  d is skipped and the exception
+// reaches the waiter, and the next run starts clean
+void exception_test( daw::task_scheduler ts ) {
+	auto graph = daw::task_graph( );
+	bool should_throw = true;
+	auto d_runs = std::atomic_size_t( 0U );
+	auto const a = graph.add_node( []( ) {} );
+	auto const b = graph.add_node( []( ) {} );
+	auto const c = graph.add_node( [&]( ) {
+		if( should_throw ) {
+			throw std::runtime_error( "c" );
+		}
+	} );
+	auto const d = graph.add_node( [&]( ) { ++d_runs; } );
+	graph.add_edge( a, b );
+	graph.add_edge( a, c );
+	graph.add_edge( b, d );
+	graph.add_edge( c, d );
+	bool caught = false;
+	try {
+		graph.run( ts );
+	} catch( std::runtime_error const & ) { caught = true; }
+	daw::expecting( caught );
+	daw::expecting( d_runs.load( ) == 0U );
+	should_throw = false;
+	graph.run( ts );
+	daw::expecting( d_runs.load( ) == 1U );
+}
+
+void cycle_test( daw::task_scheduler ts ) {
+	auto graph = daw::task_graph( );
+	auto const a = graph.add_node( []( ) {} );
+	auto const b = graph.add_node( []( ) {} );
+	graph.add_edge( a, b );
+	graph.add_edge( b, a );
+	bool caught = false;
+	try {
+		graph.run( ts );
+	} catch( std::exception const & ) { caught = true; }
+	daw::expecting( caught );
+
+	auto empty = daw::task_graph( );
+	empty.run( ts );
+}
+
+int main( ) {
+	auto ts = daw::task_scheduler( 4U );
+	random_graph_test( ts );
+	exception_test( ts );
+	cycle_test( ts );
+	std::cout << "task_graph tests passed\n";
+}
@@ -20,15 +20,30 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include <daw/daw_benchmark.h>
 #include <daw/daw_random.h>
 #include <daw/parallel/daw_locked_stack.h>
+#include "daw/fs/impl/cpu_topology.h"
 #include "daw/fs/impl/daw_latch.h"
 
+#include "daw/fs/cancellation.h"
+#include "daw/fs/future_result.h"
 #include "daw/fs/task_scheduler.h"
+#include "daw/fs/trace.h"
 
 using real_t = double;
 
@@ -101,7 +116,569 @@ void create_waitable_task_test_001( ) {
 	daw::expecting( 832040U, ans );
 }
 
+void queue_overflow_test_001( ) {
+	// A burst far larger than the queues, submitted from a worker, must not
+	// stall the submitter
+	constexpr size_t ITEMS = 20'000U;
+	auto ts = daw::task_scheduler( 2U, true, daw::scheduler_mode::shared_queues,
+	                               16U, daw::parallel::queue_overflow::grow );
+	auto sem = daw::shared_latch( ITEMS );
+	auto count = std::atomic_size_t( 0U );
+	daw::expecting( ts.add_task( [&]( ) {
+		for( size_t n = 0; n < ITEMS; ++n ) {
+			daw::expecting( ts.add_task( [&]( ) {
+				++count;
+				sem.notify( );
+			} ) );
+		}
+	} ) );
+	sem.wait( );
+	daw::expecting( ITEMS, count.load( ) );
+}
+
+// A blocking queue holds exactly its configured capacity, whether it was
+// sized at construction or by configure as the scheduler does
+void queue_block_capacity_test_001( ) {
+	using queue_t = daw::parallel::mpmc_queue<int>;
+	constexpr size_t CAPACITY = 16U;
+	auto const fill = []( queue_t &q ) {
+		for( size_t n = 0; n < CAPACITY; ++n ) {
+			daw::expecting( q.try_push_back( std::make_unique<int>( 1 ) ) ==
+			                daw::parallel::push_back_result::success );
+		}
+		daw::expecting( q.try_push_back( std::make_unique<int>( 1 ) ) ==
+		                daw::parallel::push_back_result::failed );
+		daw::expecting( q.try_pop_front( ) != nullptr );
+		daw::expecting( q.try_push_back( std::make_unique<int>( 1 ) ) ==
+		                daw::parallel::push_back_result::success );
+	};
+	{
+		auto q = queue_t( CAPACITY, daw::parallel::queue_overflow::block );
+		daw::expecting( CAPACITY, q.capacity( ) );
+		fill( q );
+	}
+	{
+		auto q = queue_t( );
+		q.configure( CAPACITY, daw::parallel::queue_overflow::block );
+		daw::expecting( CAPACITY, q.capacity( ) );
+		fill( q );
+	}
+}
+
+void numa_pinned_test_001( ) {
+	auto const &topology = daw::parallel::cpu_topology::get( );
+	daw::expecting( topology.node_count( ) >= 1U );
+	daw::expecting( topology.cpu_count( ) >= 1U );
+
+	constexpr size_t PARTS = 64U;
+	auto ts = daw::task_scheduler(
+	  4U, true, daw::scheduler_mode::work_stealing,
+	  daw::parallel::mpmc_queue<daw::task_t>::default_capacity,
+	  daw::parallel::queue_overflow::grow, daw::worker_placement::numa_pinned );
+	auto sem = daw::shared_latch( PARTS );
+	auto count = std::atomic_size_t( 0U );
+	for( size_t n = 0; n < PARTS; ++n ) {
+		daw::expecting( daw::schedule_partition_task(
+		  sem, [&]( ) { ++count; }, n, PARTS, ts ) );
+	}
+	sem.wait( );
+	daw::expecting( PARTS, count.load( ) );
+}
+
+// Recursive waits from workers run the nested tasks on the waiting workers
+// instead of starting threads for them
+size_t nested_sum( daw::task_scheduler ts, size_t depth, std::mutex &mut,
+                   std::set<std::thread::id> &thread_ids ) {
+	if( depth == 0 ) {
+		auto const lck = std::lock_guard<std::mutex>( mut );
+		thread_ids.insert( std::this_thread::get_id( ) );
+		return 1U;
+	}
+	size_t left = 0;
+	size_t right = 0;
+	daw::invoke_tasks(
+	  ts, [&]( ) { left = nested_sum( ts, depth - 1, mut, thread_ids ); },
+	  [&]( ) { right = nested_sum( ts, depth - 1, mut, thread_ids ); } );
+	return left + right;
+}
+
+void nested_wait_test_001( ) {
+	auto ts = daw::task_scheduler( 2U );
+	auto mut = std::mutex( );
+	auto thread_ids = std::set<std::thread::id>( );
+	auto sem = daw::shared_latch( 1U );
+	size_t sum = 0;
+	daw::expecting( ts.add_task( [&]( ) {
+		sum = nested_sum( ts, 10U, mut, thread_ids );
+		sem.notify( );
+	} ) );
+	sem.wait( );
+	daw::expecting( 1024U, sum );
+	daw::expecting( thread_ids.size( ) <= ts.size( ) );
+}
+
+void priority_test_001( ) {
+	// One worker, held until everything is queued so the order it picks tasks
+	// in is the order they run
+	auto ts = daw::task_scheduler( 1U );
+	auto gate = daw::shared_latch( 1U );
+	auto holding = daw::shared_latch( 1U );
+	daw::expecting( ts.add_task( [gate, holding]( ) mutable {
+		holding.notify( );
+		gate.wait( );
+	} ) );
+	holding.wait( );
+
+	constexpr size_t PER_CLASS = 8U;
+	auto mut = std::mutex( );
+	auto order = std::vector<int>( );
+	auto sem = daw::shared_latch( 3U * PER_CLASS + 2U );
+	auto const record = [&]( int label ) {
+		return [&, label]( ) {
+			auto const lck = std::lock_guard<std::mutex>( mut );
+			order.push_back( label );
+		};
+	};
+	for( size_t n = 0; n < PER_CLASS; ++n ) {
+		daw::expecting(
+		  daw::schedule_task( sem, record( 2 ), daw::task_priority::low, ts ) );
+		daw::expecting( daw::schedule_task( sem, record( 1 ), ts ) );
+		daw::expecting(
+		  daw::schedule_task( sem, record( 0 ), daw::task_priority::high, ts ) );
+	}
+	auto const now = std::chrono::steady_clock::now( );
+	daw::expecting( daw::schedule_task(
+	  sem, record( -1 ), now + std::chrono::seconds( 2 ), ts ) );
+	daw::expecting( daw::schedule_task(
+	  sem, record( -2 ), now + std::chrono::seconds( 1 ), ts ) );
+	gate.notify( );
+	sem.wait( );
+
+	auto const position = [&]( int label ) {
+		return std::find( order.begin( ), order.end( ), label ) - order.begin( );
+	};
+	auto const average_position = [&]( int label ) {
+		double sum = 0.0;
+		for( size_t n = 0; n < order.size( ); ++n ) {
+			if( order[n] == label ) {
+				sum += static_cast<double>( n );
+			}
+		}
+		return sum / static_cast<double>( PER_CLASS );
+	};
+	daw::expecting( position( -2 ) < position( -1 ) );
+	daw::expecting( average_position( 0 ) < average_position( 1 ) );
+	daw::expecting( average_position( 1 ) < average_position( 2 ) );
+
+	auto fut = daw::make_future_result( ts, daw::task_priority::high,
+	                                    []( int v ) { return v * 2; }, 21 );
+	daw::expecting( 42, fut.get( ) );
+}
+
+void priority_aging_test_001( ) {
+	// A flood of high priority work must not starve the low priority class
+	auto ts = daw::task_scheduler( 1U );
+	auto gate = daw::shared_latch( 1U );
+	auto holding = daw::shared_latch( 1U );
+	daw::expecting( ts.add_task( [gate, holding]( ) mutable {
+		holding.notify( );
+		gate.wait( );
+	} ) );
+	holding.wait( );
+
+	constexpr size_t HIGH_COUNT =
+	  8U * daw::task_scheduler::priority_aging_interval;
+	auto sem = daw::shared_latch( HIGH_COUNT + 1U );
+	auto high_done = std::atomic_size_t( 0U );
+	auto high_done_at_low = std::atomic_size_t( 0U );
+	daw::expecting( daw::schedule_task(
+	  sem, [&]( ) { high_done_at_low = high_done.load( ); },
+	  daw::task_priority::low, ts ) );
+	for( size_t n = 0; n < HIGH_COUNT; ++n ) {
+		daw::expecting( daw::schedule_task(
+		  sem, [&]( ) { ++high_done; }, daw::task_priority::high, ts ) );
+	}
+	gate.notify( );
+	sem.wait( );
+	daw::expecting( high_done_at_low.load( ) < HIGH_COUNT );
+}
+
+void add_tasks_test_001( ) {
+	constexpr size_t ITEMS = 10'000U;
+	auto ts = daw::task_scheduler( 4U );
+	auto count = std::atomic_size_t( 0U );
+	// Every callable holds a copy, all are gone once the batch is freed
+	auto token = std::make_shared<int>( 0 );
+	auto tasks = std::vector<std::function<void( )>>( );
+	tasks.reserve( ITEMS );
+	for( size_t n = 0; n < ITEMS; ++n ) {
+		tasks.emplace_back( [&count, token]( ) { ++count; } );
+	}
+	auto sem = daw::shared_latch( ITEMS );
+	daw::expecting( ts.add_tasks( daw::move( tasks ), sem ) );
+	ts.wait_for( sem );
+	daw::expecting( ITEMS, count.load( ) );
+	// The batch is released by whichever worker finishes last, after the
+	// latch is notified
+	while( token.use_count( ) != 1 ) {
+		std::this_thread::yield( );
+	}
+	daw::expecting( ts.add_tasks( std::vector<std::function<void( )>>( ),
+	                              daw::shared_latch( 0 ) ) );
+
+	// An lvalue container is copied and left as it was
+	count = 0U;
+	auto const lvalue_tasks =
+	  std::vector<std::function<void( )>>( 100U, [&count]( ) { ++count; } );
+	auto lvalue_sem = daw::shared_latch( std::size( lvalue_tasks ) );
+	daw::expecting( ts.add_tasks( lvalue_tasks, lvalue_sem ) );
+	ts.wait_for( lvalue_sem );
+	daw::expecting( std::size( lvalue_tasks ), count.load( ) );
+	daw::expecting( 100U, std::size( lvalue_tasks ) );
+	daw::expecting( static_cast<bool>( lvalue_tasks.front( ) ) );
+}
+
+// A latch on the waiter's stack, counted up front and held by pointer
+void stack_latch_test_001( ) {
+	constexpr size_t ITEMS = 1'000U;
+	auto ts = daw::task_scheduler( 4U );
+	auto count = std::atomic_size_t( 0U );
+	auto tasks = std::vector<std::function<void( )>>( );
+	for( size_t n = 0; n < ITEMS; ++n ) {
+		tasks.emplace_back( [&count]( ) { ++count; } );
+	}
+	auto sem = daw::latch( ITEMS * 2U );
+	daw::expecting( ts.add_tasks( daw::move( tasks ), sem ) );
+	for( size_t n = 0; n < ITEMS; ++n ) {
+		daw::expecting(
+		  daw::impl::schedule_task_on( sem, [&count]( ) { ++count; }, ts ) );
+	}
+	ts.wait_for( sem );
+	daw::expecting( ITEMS * 2U, count.load( ) );
+
+	// The first exception reaches the waiter
+	auto failed = daw::latch( 2 );
+	daw::expecting( daw::impl::schedule_task_on(
+	  failed, []( ) { throw std::runtime_error( "stack" ); }, ts ) );
+	daw::expecting( daw::impl::schedule_task_on( failed, []( ) {}, ts ) );
+	bool caught = false;
+	try {
+		ts.wait_for( failed );
+	} catch( std::runtime_error const & ) { caught = true; }
+	daw::expecting( caught );
+}
+
+void worker_context_test_001( ) {
+	constexpr size_t ITEMS = 1'000U;
+	auto ts = daw::task_scheduler( 4U );
+	auto other = daw::task_scheduler( 2U );
+	auto count = std::atomic_size_t( 0U );
+	auto sem = daw::shared_latch( ITEMS );
+	auto outer = daw::shared_latch( 1 );
+	// Tasks submitted from a worker go to its own queue, those for another
+	// scheduler go to that one's queues, and all of them run
+	daw::expecting( daw::schedule_task(
+	  outer,
+	  [&]( ) {
+		  for( size_t n = 0; n < ITEMS; ++n ) {
+			  daw::expecting( daw::schedule_task(
+			    sem, [&count]( ) { ++count; }, n % 2U == 0 ? ts : other ) );
+		  }
+	  },
+	  ts ) );
+	ts.wait_for( outer );
+	ts.wait_for( sem );
+	daw::expecting( ITEMS, count.load( ) );
+}
+
+void stats_test_001( ) {
+	constexpr size_t ITEMS = 1'000U;
+	auto ts = daw::task_scheduler( 2U );
+	auto sem = daw::shared_latch( ITEMS );
+	for( size_t n = 0; n < ITEMS; ++n ) {
+		daw::expecting( daw::schedule_task(
+		  sem,
+		  []( ) {
+			  daw::do_not_optimize( fib( 100 ) );
+		  },
+		  ts ) );
+	}
+	ts.wait_for( sem );
+	auto const stats = ts.stats( );
+	if constexpr( daw::scheduler_stats_enabled ) {
+		daw::expecting( ts.size( ), stats.workers.size( ) );
+		std::uint64_t executed = 0;
+		for( auto const &worker : stats.workers ) {
+			executed += worker.tasks_executed;
+			daw::expecting( worker.steals_succeeded <= worker.steals_attempted );
+		}
+		daw::expecting( executed >= ITEMS );
+	} else {
+		daw::expecting( stats.workers.empty( ) );
+		daw::expecting( 0U, stats.push_back_blocks );
+		daw::expecting( 0U, stats.temp_runner_spawns );
+	}
+}
+
+void trace_test_001( ) {
+	constexpr size_t ITEMS = 100U;
+	daw::clear_trace( );
+	{
+		auto ts = daw::task_scheduler( 2U );
+		auto sem = daw::shared_latch( ITEMS );
+		for( size_t n = 0; n < ITEMS; ++n ) {
+			daw::expecting( daw::schedule_task(
+			  sem, daw::traced( "fib \"quoted\"", []( ) {
+				  daw::do_not_optimize( fib( 100 ) );
+			  } ),
+			  ts ) );
+		}
+		ts.wait_for( sem );
+	}
+	auto ss = std::ostringstream( );
+	daw::write_chrome_trace( ss );
+	auto const json = ss.str( );
+	if constexpr( daw::scheduler_tracing_enabled ) {
+		daw::expecting( json.find( R"("name":"task","ph":"X")" ) !=
+		                std::string::npos );
+		daw::expecting( json.find( R"("name":"fib \"quoted\"")" ) !=
+		                std::string::npos );
+		daw::expecting( json.find( R"("args":{"name":"worker 0"})" ) !=
+		                std::string::npos );
+	} else {
+		daw::expecting( std::string( "{\"traceEvents\":[\n]}\n" ), json );
+	}
+	daw::clear_trace( );
+}
+
+void trace_test_002( ) {
+	// Only the last few exited threads keep their rings
+	constexpr size_t THREADS = 50U;
+	daw::clear_trace( );
+	for( size_t n = 0; n < THREADS; ++n ) {
+		std::thread( []( ) { daw::trace_instant( "short lived" ); } ).join( );
+	}
+	auto ss = std::ostringstream( );
+	daw::write_chrome_trace( ss );
+	auto const json = ss.str( );
+	auto const label = std::string( R"("name":"short lived")" );
+	size_t count = 0;
+	for( auto pos = json.find( label ); pos != std::string::npos;
+	     pos = json.find( label, pos + 1U ) ) {
+		++count;
+	}
+	if constexpr( daw::scheduler_tracing_enabled ) {
+		daw::expecting( count > 0U );
+		daw::expecting( count < THREADS );
+	} else {
+		daw::expecting( 0U, count );
+	}
+	daw::clear_trace( );
+}
+
+void config_test_001( ) {
+	constexpr size_t ITEMS = 100U;
+	daw::expecting( daw::parallel::available_cpu_count( ) >= 1U );
+	auto config = daw::task_scheduler_config{ };
+	config.num_threads = 2U;
+	config.queue_capacity = 16U;
+	config.idle_spin = std::chrono::microseconds( 50 );
+	config.cpu_affinity = daw::parallel::cpu_topology::get( ).node_cpus( 0 );
+	config.thread_name_prefix = "cfg worker ";
+	config.stack_size = 1024U * 1024U;
+	auto ts = daw::task_scheduler( config );
+	daw::expecting( ts.size( ) == 2U );
+	auto count = std::atomic_size_t( 0U );
+	auto sem = daw::shared_latch( ITEMS );
+	for( size_t n = 0; n < ITEMS; ++n ) {
+		daw::expecting( daw::schedule_task(
+		  sem, [&count]( ) { ++count; }, ts ) );
+	}
+	ts.wait_for( sem );
+	daw::expecting( count.load( ) == ITEMS );
+
+	// The global scheduler is already in use, so it cannot be replaced
+	(void)daw::get_task_scheduler( );
+	daw::expecting( not daw::set_global_task_scheduler( ts ) );
+	daw::expecting( daw::get_task_scheduler( ).size( ) != 0U );
+}
+
+void elastic_test_001( ) {
+	constexpr size_t ITEMS = 40U;
+	auto config = daw::task_scheduler_config{ };
+	config.num_threads = 1U;
+	config.max_threads = 3U;
+	config.grow_after = std::chrono::microseconds( 500 );
+	config.retire_after = std::chrono::milliseconds( 50 );
+	auto ts = daw::task_scheduler( config );
+	daw::expecting( ts.worker_count( ) == 1U );
+	auto most_workers = std::atomic_size_t( 0U );
+	auto sem = daw::shared_latch( ITEMS );
+	for( size_t n = 0; n < ITEMS; ++n ) {
+		daw::expecting( daw::schedule_task(
+		  sem,
+		  [&]( ) {
+			  auto const count = ts.worker_count( );
+			  auto most = most_workers.load( );
+			  while( count > most and
+			         not most_workers.compare_exchange_weak( most, count ) ) {}
+			  std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+		  },
+		  ts ) );
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+	ts.wait_for( sem );
+	daw::expecting( most_workers.load( ) > 1U );
+	daw::expecting( most_workers.load( ) <= 3U );
+	// The extra workers retire once idle
+	auto const give_up =
+	  std::chrono::steady_clock::now( ) + std::chrono::seconds( 5 );
+	while( ts.worker_count( ) != 1U and
+	       std::chrono::steady_clock::now( ) < give_up ) {
+		std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+	}
+	daw::expecting( ts.worker_count( ) == 1U );
+}
+
+void exception_test_001( ) {
+	auto failures = std::atomic_size_t( 0U );
+	auto handled = daw::shared_latch( 1 );
+	auto config = daw::task_scheduler_config{ };
+	config.num_threads = 2U;
+	config.unhandled_exception_handler = [&]( std::exception_ptr ex ) {
+		daw::expecting( static_cast<bool>( ex ) );
+		++failures;
+		handled.notify( );
+	};
+	auto ts = daw::task_scheduler( config );
+
+	// The first exception of a group is rethrown on the waiting thread and
+	// does not reach the handler
+	bool caught = false;
+	try {
+		daw::invoke_tasks(
+		  ts, []( ) {}, []( ) { throw std::runtime_error( "group" ); } );
+	} catch( std::runtime_error const & ) { caught = true; }
+	daw::expecting( caught );
+	daw::expecting( failures.load( ) == 0U );
+
+	// Once a task has failed, the ones that have not started are skipped
+	auto ran = std::atomic_size_t( 0U );
+	auto sem = daw::shared_latch( 2 );
+	sem.set_exception( std::make_exception_ptr( std::logic_error( "first" ) ) );
+	daw::expecting( daw::schedule_task(
+	  sem, [&]( ) { ++ran; }, ts ) );
+	daw::expecting( daw::schedule_task(
+	  sem, [&]( ) { ++ran; }, ts ) );
+	caught = false;
+	try {
+		ts.wait_for( sem );
+	} catch( std::logic_error const & ) { caught = true; }
+	daw::expecting( caught );
+	daw::expecting( ran.load( ) == 0U );
+
+	// Tasks without a latch report to the handler
+	daw::expecting(
+	  ts.add_task( []( ) { throw std::runtime_error( "lost" ); } ) );
+	ts.wait_for( handled );
+	daw::expecting( failures.load( ) == 1U );
+}
+
+void timer_test_001( ) {
+	using clock_t = std::chrono::steady_clock;
+	using std::chrono::milliseconds;
+	auto ts = daw::task_scheduler( 2U );
+	auto const start = clock_t::now( );
+
+	// Timers run in due order, and never early
+	auto order_mutex = std::mutex( );
+	auto order = std::vector<int>( );
+	auto sem = daw::shared_latch( 4 );
+	auto const record = [&]( int n, clock_t::time_point due ) {
+		return [&, n, due]( ) {
+			daw::expecting( clock_t::now( ) >= due );
+			{
+				auto const lck = std::lock_guard( order_mutex );
+				order.push_back( n );
+			}
+			sem.notify( );
+		};
+	};
+	auto const after = [&]( int n, milliseconds delay ) {
+		return ts.add_task_after( delay, record( n, start + delay ) );
+	};
+	daw::expecting( after( 3, milliseconds( 60 ) ) );
+	daw::expecting( after( 1, milliseconds( 20 ) ) );
+	auto const at = start + milliseconds( 40 );
+	daw::expecting( ts.add_task_at( at, record( 2, at ) ) );
+	// Already due
+	auto const past = start - milliseconds( 5 );
+	daw::expecting( ts.add_task_at( past, record( 0, past ) ) );
+	ts.wait_for( sem );
+	daw::expecting( order == std::vector<int>{ 0, 1, 2, 3 } );
+
+	// A periodic task repeats until cancelled
+	auto runs = std::atomic_size_t( 0U );
+	auto source = daw::cancellation_source( );
+	auto three_runs = daw::shared_latch( 3 );
+	daw::expecting( ts.add_periodic_task(
+	  milliseconds( 5 ),
+	  [&]( ) {
+		  if( ++runs <= 3U ) {
+			  three_runs.notify( );
+		  }
+	  },
+	  source.get_token( ) ) );
+	ts.wait_for( three_runs );
+	source.request_cancel( );
+	std::this_thread::sleep_for( milliseconds( 20 ) );
+	auto const stopped_at = runs.load( );
+	std::this_thread::sleep_for( milliseconds( 30 ) );
+	daw::expecting( runs.load( ) == stopped_at );
+
+	// A timer can cancel waiting work without a thread of its own
+	auto timeout = daw::cancellation_source( );
+	auto cancelled = daw::shared_latch( 1 );
+	daw::expecting( ts.add_task_after( milliseconds( 10 ), [timeout]( ) mutable {
+		timeout.request_cancel( );
+	} ) );
+	daw::expecting( ts.add_task( [&, tok = timeout.get_token( )]( ) {
+		while( not tok.is_cancelled( ) ) {
+			std::this_thread::yield( );
+		}
+		cancelled.notify( );
+	} ) );
+	ts.wait_for( cancelled );
+
+	// The timer worker parks until the next timer is due, and an earlier one
+	// added meanwhile wakes it
+	daw::expecting( ts.add_task_after( std::chrono::seconds( 10 ), []( ) {} ) );
+	std::this_thread::sleep_for( milliseconds( 20 ) );
+	auto const early_start = clock_t::now( );
+	auto early = daw::shared_latch( 1 );
+	daw::expecting(
+	  ts.add_task_after( milliseconds( 20 ), [&]( ) { early.notify( ); } ) );
+	early.wait( );
+	daw::expecting( clock_t::now( ) - early_start < std::chrono::seconds( 5 ) );
+}
+
 int main( ) {
 	test_task_scheduler( );
 	create_waitable_task_test_001( );
+	queue_overflow_test_001( );
+	queue_block_capacity_test_001( );
+	numa_pinned_test_001( );
+	nested_wait_test_001( );
+	priority_test_001( );
+	priority_aging_test_001( );
+	add_tasks_test_001( );
+	stack_latch_test_001( );
+	worker_context_test_001( );
+	stats_test_001( );
+	trace_test_001( );
+	trace_test_002( );
+	config_test_001( );
+	elastic_test_001( );
+	exception_test_001( );
+	timer_test_001( );
 }
@@ -0,0 +1,69 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#include "daw/fs/impl/task.h"
+
+template<typename Bool>
+void expect( Bool const &b, char const *msg ) {
+	if( not b ) {
+		std::cerr << "Failed: " << msg << '\n';
+		std::exit( EXIT_FAILURE );
+	}
+}
+
+int main( ) {
+	// Small and move only callables are stored in place
+	int count = 0;
+	auto small = std::make_unique<daw::task_t>(
+	  [&count, p = std::make_unique<int>( 1 )]( ) { count += *p; } );
+	( *small )( );
+	expect( count == 1, "small task ran" );
+
+	// Larger callables go to the heap but behave the same
+	auto big_data = std::array<char, daw::task_t::inline_size * 2>{ };
+	big_data[0] = 2;
+	auto big = daw::task_t( [&count, big_data]( ) { count += big_data[0]; } );
+	auto moved = daw::move( big );
+	expect( not big and static_cast<bool>( moved ), "task moved" );
+	moved( );
+	expect( count == 3, "large task ran" );
+
+	// Freed nodes are reused by the next task on this thread
+	auto *const first = small.get( );
+	small.reset( );
+	auto again = std::make_unique<daw::task_t>( [&count]( ) { ++count; } );
+	expect( again.get( ) == first, "task node reused" );
+
+	auto sem = daw::shared_latch( );
+	auto waiting = daw::task_t( []( ) {}, sem );
+	expect( not waiting.is_ready( ), "latched task waits" );
+	sem.notify( );
+	expect( waiting.is_ready( ), "latched task ready once released" );
+	expect( daw::task_t( []( ) {} ).is_ready( ), "plain task is ready" );
+
+	std::cout << "task_t tests passed\n";
+}
@@ -0,0 +1,113 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <daw/daw_benchmark.h>
+
+#include "daw/fs/impl/timer_wheel.h"
+
+using wheel_t = daw::parallel::timer_wheel<std::uint64_t>;
+using std::chrono::milliseconds;
+
+// Values are the tick they are due on.  Step through time a tick at a time
+// and check that each comes due on its tick, never early
+void due_time_test( ) {
+	auto const start = wheel_t::clock_t::now( );
+	auto wheel = wheel_t( start, milliseconds( 1 ) );
+	auto const due_ticks = std::vector<std::uint64_t>{
+	  1, 2, 63, 64, 65, 100, 4095, 4096, 4097, 5000, 262'145, 3, 64 };
+	for( auto tick : due_ticks ) {
+		wheel.add( start + milliseconds( tick ), tick );
+	}
+	daw::expecting( wheel.size( ) == due_ticks.size( ) );
+	auto fired = std::vector<std::uint64_t>( );
+	for( std::uint64_t now = 1; now <= 262'145; ++now ) {
+		wheel.advance( start + milliseconds( now ), [&]( std::uint64_t due ) {
+			daw::expecting( due, now );
+			fired.push_back( due );
+		} );
+	}
+	daw::expecting( fired.size( ) == due_ticks.size( ) );
+	daw::expecting( wheel.empty( ) );
+}
+
+// A large jump fires everything that was passed, earliest first, and times
+// already passed come due on the next advance
+void jump_test( ) {
+	auto const start = wheel_t::clock_t::now( );
+	auto wheel = wheel_t( start, milliseconds( 1 ) );
+	for( std::uint64_t tick : { 70'000U, 10U, 700U } ) {
+		wheel.add( start + milliseconds( tick ), tick );
+	}
+	auto fired = std::vector<std::uint64_t>( );
+	auto const on_due = [&]( std::uint64_t due ) {
+		fired.push_back( due );
+	};
+	wheel.advance( start + milliseconds( 5 ), on_due );
+	daw::expecting( fired.empty( ) );
+	wheel.advance( start + milliseconds( 100'000 ), on_due );
+	daw::expecting( fired == std::vector<std::uint64_t>{ 10, 700, 70'000 } );
+
+	wheel.add( start, 0 );
+	daw::expecting( wheel.size( ) == 1U );
+	wheel.advance( start + milliseconds( 100'001 ), on_due );
+	daw::expecting( fired.size( ) == 4U and fired.back( ) == 0U );
+}
+
+// Advancing only to each next_due( ) still fires every value on its tick,
+// and takes far fewer steps than a tick at a time
+void next_due_test( ) {
+	auto const start = wheel_t::clock_t::now( );
+	auto wheel = wheel_t( start, milliseconds( 1 ) );
+	daw::expecting( not wheel.next_due( ) );
+	auto const due_ticks = std::vector<std::uint64_t>{
+	  1, 2, 63, 64, 65, 100, 4095, 4096, 4097, 5000, 262'145, 3, 64 };
+	for( auto tick : due_ticks ) {
+		wheel.add( start + milliseconds( tick ), tick );
+	}
+	daw::expecting( wheel.next_due( ) == start + milliseconds( 1 ) );
+	std::size_t fired = 0;
+	std::size_t steps = 0;
+	while( auto const next = wheel.next_due( ) ) {
+		auto const now = static_cast<std::uint64_t>(
+		  std::chrono::duration_cast<milliseconds>( *next - start ).count( ) );
+		wheel.advance( *next, [&]( std::uint64_t due ) {
+			daw::expecting( due, now );
+			++fired;
+		} );
+		++steps;
+	}
+	daw::expecting( fired == due_ticks.size( ) );
+	daw::expecting( steps < 100U );
+}
+
+int main( ) {
+	due_time_test( );
+	jump_test( );
+	next_due_test( );
+	std::cout << "timer_wheel tests passed\n";
+}
@@ -0,0 +1,81 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2016-2019 Darrell Wright
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and / or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "daw/fs/impl/work_stealing_deque.h"
+
+int main( ) {
+	constexpr size_t item_count = 100'000;
+	constexpr size_t thief_count = 3;
+	auto dq = std::make_unique<daw::parallel::work_stealing_deque<size_t, 256>>( );
+	std::atomic<size_t> sum = 0;
+	std::atomic<size_t> items_taken = 0;
+	std::atomic_bool owner_done = false;
+
+	auto const thief = [&]( ) {
+		while( not owner_done or not dq->is_empty( ) ) {
+			if( auto item = dq->try_steal( ); item ) {
+				sum += *item;
+				++items_taken;
+			} else {
+				std::this_thread::yield( );
+			}
+		}
+	};
+
+	auto thieves = std::vector<std::thread>( );
+	for( size_t n = 0; n < thief_count; ++n ) {
+		thieves.emplace_back( thief );
+	}
+	for( size_t n = 1; n <= item_count; ++n ) {
+		auto item = std::make_unique<size_t>( n );
+		while( dq->try_push_back( std::move( item ) ) !=
+		       daw::parallel::push_back_result::success ) {
+			// Full, the owner works through its own items LIFO
+			if( auto mine = dq->try_pop_back( ); mine ) {
+				sum += *mine;
+				++items_taken;
+			}
+		}
+	}
+	while( auto mine = dq->try_pop_back( ) ) {
+		sum += *mine;
+		++items_taken;
+	}
+	owner_done = true;
+	for( auto &th : thieves ) {
+		th.join( );
+	}
+	constexpr size_t expected = ( item_count * ( item_count + 1 ) ) / 2;
+	std::cout << "items: " << items_taken << " sum: " << sum << '\n';
+	if( items_taken != item_count or sum != expected ) {
+		std::cerr << "Expected " << item_count << " items with a sum of "
+		          << expected << '\n';
+		return EXIT_FAILURE;
+	}
+}